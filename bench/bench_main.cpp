@@ -0,0 +1,1076 @@
+//*****************
+// bench/bench_main.cpp
+// Engine, generator and regression benchmarks of the sort library.
+//*****************
+#include <algorithm>
+#include <chrono>     // for std::chrono::steady_clock
+#include <cstdint>
+#include <cstdio>     // for std::remove
+#include <cstring>    // for std::strcmp
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bubblesort/bubblesort.hpp"
+#include "bench_regression.hpp"
+
+//*****************
+// Function name: elapsedMs
+// Purpose: Returns the milliseconds elapsed since start.
+//*****************
+inline double elapsedMs(std::chrono::steady_clock::time_point start) noexcept
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Benchmark cross-checks that failed; runBenchmarkCommand exits with 1 when there are any
+inline std::size_t benchCheckFailures = 0;
+
+//*****************
+// Function name: checkMark
+// Purpose: Records the outcome of a benchmark cross-check and returns the mark printed after its timings:
+//          nothing when it passed, failure when it did not.
+//*****************
+inline const char* checkMark(bool passed, const char* failure = " (MISMATCH)")
+{
+	if (passed) return "";
+	++benchCheckFailures;
+	return failure;
+}
+
+//*****************
+// Function name: benchRadixPhases
+// Purpose: Times an LSD radix sort of n random 32-bit integers phase by phase, running the histogram,
+//          scan and scatter primitives directly so the cost split between them is visible.
+// Parameters:
+//    - n: Number of integers to sort.
+// Returns: void
+//*****************
+inline void benchRadixPhases(std::size_t n)
+{
+	GeneratorOptions options;
+	options.high = std::numeric_limits<std::uint32_t>::max();
+	std::vector<std::uint32_t> data = generateData<std::uint32_t>(n, options), buffer(n);
+
+	WorkerPool pool(sortThreadCount(n));
+	const unsigned threads = pool.size();
+	std::vector<std::size_t> histograms(threads * kRadixBuckets);
+	double histogramMs = 0, scanMs = 0, scatterMs = 0;
+	std::uint32_t* src = data.data();
+	std::uint32_t* dst = buffer.data();
+
+	for (unsigned shift = 0; shift < 32; shift += 8)
+	{
+		const auto digitOf = [shift](std::uint32_t value) { return static_cast<std::size_t>((value >> shift) & 0xFF); };
+		auto start = std::chrono::steady_clock::now();
+		parallelHistogram(src, n, digitOf, kRadixBuckets, pool, histograms.data());
+		histogramMs += elapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		scatterOffsets(histograms.data(), kRadixBuckets, threads, histograms.data());
+		scanMs += elapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		parallelScatter(src, dst, n, digitOf, kRadixBuckets, pool, histograms.data());
+		scatterMs += elapsedMs(start);
+		std::swap(src, dst);
+	}
+
+	std::cout << "radix phases (n = " << n << ", threads = " << threads << "): histogram " << histogramMs
+		<< " ms, scan " << scanMs << " ms, scatter " << scatterMs << " ms"
+		<< checkMark(std::is_sorted(src, src + n), " [NOT SORTED]") << "\n";
+}
+
+//*****************
+// Function name: benchExclusiveScan
+// Purpose: Times exclusiveScan alone over n counters, repeated until about n * repeats values were scanned.
+// Parameters:
+//    - n: Number of counters per scan.
+//    - repeats: Number of scans to time.
+// Returns: void
+//*****************
+inline void benchExclusiveScan(std::size_t n, std::size_t repeats)
+{
+	std::vector<std::size_t> counts(n, 1), offsets(n);
+	std::size_t check = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (std::size_t r = 0; r < repeats; ++r)
+	{
+		check += exclusiveScan(counts.data(), offsets.data(), n);
+	}
+	const double ms = elapsedMs(start);
+	std::cout << "exclusive scan (n = " << n << ", x" << repeats << "): " << ms << " ms, "
+		<< (ms > 0 ? n * repeats / ms / 1e6 : 0) << " G counters/s" << checkMark(check == n * repeats, " [WRONG SUM]") << "\n";
+}
+
+//*****************
+// Function name: benchSimdKernels
+// Purpose: Times every SIMD kernel in every instruction set variant this CPU supports, so the variants
+//          can be compared on one host. The variant selected for the rest of the program is marked.
+// Parameters:
+//    - n: Number of values per kernel call.
+// Returns: void
+//*****************
+inline void benchSimdKernels(std::size_t n)
+{
+	GeneratorOptions options;
+	options.low = std::numeric_limits<int>::min();
+	options.high = std::numeric_limits<int>::max();
+	const std::vector<int> values = generateData<int>(n, options);
+	std::vector<int> sorted = values;
+	std::sort(sorted.begin(), sorted.end());
+	std::vector<int> out(n), scratch(n);
+	std::vector<std::size_t> counts(n, 1), offsets(n);
+	std::vector<unsigned char> classes(n);
+
+	std::cout << "simd kernels (n = " << n << ", detected " << simdIsaName(detectSimdIsa()) << ", selected "
+		<< simdIsaName(selectSimdIsa()) << ", ns per value):\n";
+	for (SimdIsa isa : { SimdIsa::Baseline, SimdIsa::Sse42, SimdIsa::Avx2, SimdIsa::Avx512 })
+	{
+		if (isa > detectSimdIsa()) break;
+		const SimdKernels& kernels = simdKernelsFor(isa);
+		const auto time = [n](auto&& kernel)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			kernel();
+			return elapsedMs(start) * 1e6 / static_cast<double>(std::max<std::size_t>(n, 1));
+		};
+
+		const double scanNs = time([&] { kernels.exclusiveScan(counts.data(), offsets.data(), n, 0); });
+		const double digitNs = time([&] { kernels.digitSums(values.data(), out.data(), n); });
+		const double mergeNs = time([&] { kernels.mergeInts(sorted.data(), n / 2, sorted.data() + n / 2, n - n / 2, out.data()); });
+		scratch = values;
+		const double sortNs = time([&] { kernels.sortInts(scratch.data(), n); });
+		const double intersectNs = time([&] { kernels.intersectInts(sorted.data(), n, sorted.data(), n, out.data()); });
+		const double divisibleNs = time([&] { kernels.classifyDivisible(values.data(), n, 3, true, classes.data()); });
+
+		std::cout << "  " << std::left << std::setw(9) << simdIsaName(isa) << std::right << std::fixed << std::setprecision(3)
+			<< " scan " << scanNs << "  digit sums " << digitNs << "  merge " << mergeNs
+			<< "  sort " << sortNs << "  intersect " << intersectNs << "  divisible " << divisibleNs << (isa == selectSimdIsa() ? "  (selected)" : "") << "\n";
+		std::cout.unsetf(std::ios::floatfield);
+		std::cout << std::setprecision(6);
+	}
+}
+
+//*****************
+// Function name: benchGenerators
+// Purpose: Prints the throughput of the data generators, so generation cost can be checked against sort cost.
+// Parameters:
+//    - n: Number of values per generator run.
+// Returns: void
+//*****************
+inline void benchGenerators(std::size_t n)
+{
+	const auto report = [](const char* name, std::size_t count, double ms)
+	{
+		std::cout << "generate " << name << " (n = " << count << "): " << ms << " ms, " << (ms > 0 ? count / ms / 1e3 : 0) << " M values/s\n";
+	};
+	const std::pair<const char*, Distribution> distributions[] = {
+		{ "uniform int", Distribution::Uniform }, { "zipf int", Distribution::Zipf }, { "gaussian int", Distribution::Gaussian },
+		{ "sorted_runs int", Distribution::SortedRuns } };
+	for (const auto& distribution : distributions)
+	{
+		GeneratorOptions options;
+		options.distribution = distribution.second;
+		const auto start = std::chrono::steady_clock::now();
+		const std::vector<int> values = generateData<int>(n, options);
+		report(distribution.first, values.size(), elapsedMs(start));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	const std::vector<double> reals = generateData<double>(n);
+	report("uniform double", reals.size(), elapsedMs(start));
+
+	start = std::chrono::steady_clock::now();
+	const std::vector<std::string> strings = generateStrings(n / 8, 8, 24);
+	report("strings (8-24 chars)", strings.size(), elapsedMs(start));
+}
+
+//*****************
+// Function name: benchCollation
+// Purpose: Times collated string sorts against the byte-wise string engine on the same mixed-case strings,
+//          so the cost of computing the sort keys is visible.
+// Parameters:
+//    - n: Number of strings.
+// Returns: void
+//*****************
+inline void benchCollation(std::size_t n)
+{
+	const std::vector<std::string> strings = generateStrings(n, 4, 16, 42, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ");
+	const auto time = [&strings](auto&& sort)
+	{
+		std::vector<std::string> holder(strings);
+		const auto start = std::chrono::steady_clock::now();
+		sort(holder);
+		return elapsedMs(start);
+	};
+
+	const double bytewiseMs = time([](auto& holder) { stringSort(holder); });
+	const double asciiMs = time([](auto& holder) { collatedSort(holder, Collation::AsciiCaseFold); });
+	const double utf8Ms = time([](auto& holder) { collatedSort(holder, Collation::Utf8); });
+	std::cout << "collation (n = " << n << "): byte-wise " << bytewiseMs << " ms, ascii case-fold " << asciiMs
+		<< " ms, utf-8 " << utf8Ms << " ms\n";
+}
+
+//*****************
+// Function name: benchNaturalSort
+// Purpose: Times natural-order sorting of file-name-like strings ("file" and a number) against the
+//          byte-wise string engine on the same strings.
+// Parameters:
+//    - n: Number of strings.
+// Returns: void
+//*****************
+inline void benchNaturalSort(std::size_t n)
+{
+	GeneratorOptions options;
+	options.distribution = Distribution::Zipf;
+	const std::vector<int> numbers = generateData<int>(n, options);
+	std::vector<std::string> names;
+	names.reserve(n);
+	for (int number : numbers) names.push_back("file" + std::to_string(number) + ".txt");
+
+	std::vector<std::string> holder(names);
+	auto start = std::chrono::steady_clock::now();
+	stringSort(holder);
+	const double bytewiseMs = elapsedMs(start);
+	holder = names;
+	start = std::chrono::steady_clock::now();
+	naturalSort(holder);
+	std::cout << "natural order (n = " << n << "): byte-wise " << bytewiseMs << " ms, natural " << elapsedMs(start) << " ms\n";
+}
+
+//*****************
+// Function name: benchStringTable
+// Purpose: Times the string engine on the same strings held as std::string, std::string_view and in a
+//          StringTable, showing the cost of moving heap-owning strings against compact records.
+// Parameters:
+//    - n: Number of strings.
+// Returns: void
+//*****************
+inline void benchStringTable(std::size_t n)
+{
+	const std::vector<std::string> strings = generateStrings(n, 4, 24, 11);
+	const auto time = [](auto& holder)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		recursiveSort(holder);
+		return elapsedMs(start);
+	};
+
+	std::vector<std::string> owned(strings);
+	std::vector<std::string_view> views(strings.begin(), strings.end());
+	StringTable table(strings.begin(), strings.end());
+	const double ownedMs = time(owned);
+	const double viewMs = time(views);
+	const double tableMs = time(table);
+	std::cout << "string storage (n = " << n << "): std::string " << ownedMs << " ms, std::string_view " << viewMs
+		<< " ms, StringTable " << tableMs << " ms\n";
+}
+
+//*****************
+// Struct: BenchRecord
+// Purpose: A 128-byte record keyed by one int member, standing in for production structs.
+//*****************
+struct BenchRecord
+{
+	int key;
+	std::uint32_t id;
+	std::uint64_t payload[15];
+};
+
+//*****************
+// Function name: benchRecordSort
+// Purpose: Times sorting 128-byte records by their int member through key/index pairs (recordSort) against
+//          projectedSort and std::stable_sort on the records themselves.
+// Parameters:
+//    - n: Number of records.
+// Returns: void
+//*****************
+inline void benchRecordSort(std::size_t n)
+{
+	GeneratorOptions options;
+	options.low = std::numeric_limits<int>::min();
+	options.high = std::numeric_limits<int>::max();
+	const std::vector<int> keys = generateData<int>(n, options);
+	std::vector<BenchRecord> records(n);
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		records[i].key = keys[i];
+		records[i].id = static_cast<std::uint32_t>(i);
+	}
+	const auto time = [&records](auto&& sort)
+	{
+		std::vector<BenchRecord> holder(records);
+		const auto start = std::chrono::steady_clock::now();
+		sort(holder);
+		return elapsedMs(start);
+	};
+
+	const double pairsMs = time([](auto& holder) { recordSort(holder, &BenchRecord::key); });
+	const double projectedMs = time([](auto& holder) { projectedSort(holder, std::greater<int>(), &BenchRecord::key); });
+	const double stableMs = time([](auto& holder)
+	{
+		std::stable_sort(holder.begin(), holder.end(), [](const BenchRecord& a, const BenchRecord& b) { return a.key < b.key; });
+	});
+	std::cout << "records (n = " << n << ", " << sizeof(BenchRecord) << " bytes): key/index pairs " << pairsMs
+		<< " ms, projected keys " << projectedMs << " ms, std::stable_sort " << stableMs << " ms\n";
+}
+
+//*****************
+// Function name: benchScratchBudget
+// Purpose: Reports the engine recursiveSort picks for uniform ints under shrinking scratch budgets, with
+//          its time and peak scratch, and times externalSortFile on a file eight times the budget.
+// Parameters:
+//    - n: Number of integers.
+// Returns: void
+//*****************
+inline void benchScratchBudget(std::size_t n)
+{
+	GeneratorOptions options;
+	options.low = std::numeric_limits<int>::min();
+	options.high = std::numeric_limits<int>::max();
+	const std::vector<int> values = generateData<int>(n, options);
+	const auto report = [](const char* name, const SortReport& sortReport, double ms)
+	{
+		std::cout << "  " << std::left << std::setw(20) << name << std::right << std::setw(14) << sortAlgorithmName(sortReport.last)
+			<< std::setw(12) << ms << " ms, peak scratch " << sortReport.peakScratchBytes << " bytes\n";
+	};
+	const auto time = [&values, &report](const char* name, auto holder, std::size_t budget)
+	{
+		SortReport sortReport;
+		const auto start = std::chrono::steady_clock::now();
+		recursiveSort(holder, std::greater<int>(), SortOptions(SortEngine::Automatic, budget, &sortReport));
+		report(name, sortReport, elapsedMs(start));
+	};
+
+	std::cout << "scratch budget (n = " << n << "):\n";
+	time("vector unlimited", std::vector<int>(values), kUnlimitedScratch);
+	time("vector 64 KiB", std::vector<int>(values), 1 << 16);
+	time("vector in place", std::vector<int>(values), 0);
+	time("deque in place", std::deque<int>(values.begin(), values.end()), 0);
+	time("list in place", std::list<int>(values.begin(), values.end()), 0);
+
+	const std::string path = (std::filesystem::temp_directory_path() / "bubblesort_bench_external.bin").string();
+	IoFile file;
+	const bool written = file.openWrite(path) && file.writeAt(values.data(), n * sizeof(int), 0);
+	if (file.close() && written)
+	{
+		SortReport sortReport;
+		const auto start = std::chrono::steady_clock::now();
+		if (externalSortFile<int>(path, path, SortOptions(SortEngine::Automatic, n * sizeof(int) / 8, &sortReport)))
+		{
+			report("file, 1/8 budget", sortReport, elapsedMs(start));
+			std::cout << "  (" << sortReport.spilledRuns << " spilled runs, " << sortReport.spilledBytes << " bytes spilled for "
+				<< n * sizeof(int) << " bytes of data, " << AsyncIo().backendName() << " I/O)\n";
+		}
+	}
+	std::remove(path.c_str());
+}
+
+//*****************
+// Function name: benchBlockCodec
+// Purpose: Times packing sorted uniform ints into delta bit-packed blocks and unpacking them again (the spill
+//          format of externalSortFile), and reports the packed size.
+// Parameters:
+//    - n: Number of integers.
+// Returns: void
+//*****************
+inline void benchBlockCodec(std::size_t n)
+{
+	GeneratorOptions options;
+	options.low = 0;
+	options.high = std::numeric_limits<int>::max();
+	std::vector<int> values = generateData<int>(n, options);
+	std::sort(values.begin(), values.end());
+	std::vector<unsigned char> packed((n + kPackedBlock - 1) / kPackedBlock * maxPackedBlockBytes<int>());
+
+	auto start = std::chrono::steady_clock::now();
+	std::size_t bytes = 0;
+	for (std::size_t begin = 0; begin < n; begin += kPackedBlock)
+	{
+		bytes += packSortedBlock(values.data() + begin, std::min(kPackedBlock, n - begin), false, packed.data() + bytes);
+	}
+	const double packMs = elapsedMs(start);
+
+	std::vector<int> unpacked(n + kPackedBlock);
+	start = std::chrono::steady_clock::now();
+	std::size_t count = 0;
+	for (std::size_t offset = 0; offset < bytes; offset += packedBlockBytes<int>(packed.data() + offset))
+	{
+		count += unpackSortedBlock(packed.data() + offset, false, unpacked.data() + count);
+	}
+	const double unpackMs = elapsedMs(start);
+	const bool same = count == n && std::equal(values.begin(), values.end(), unpacked.begin());
+	std::cout << "block codec (n = " << n << "): " << bytes << " packed bytes for " << n * sizeof(int) << ", pack " << packMs
+		<< " ms, unpack " << unpackMs << " ms" << checkMark(same) << "\n";
+}
+
+//*****************
+// Function name: benchCompactOutput
+// Purpose: Times writing sorted uniform ints in the compact format and decoding them again, and compares
+//          the compact size with the text printContainer writes.
+// Parameters:
+//    - n: Number of integers.
+// Returns: void
+//*****************
+inline void benchCompactOutput(std::size_t n)
+{
+	std::vector<int> values = generateData<int>(n);
+	recursiveSort(values);
+	std::ostringstream text;
+	for (int value : values) text << value << " ";
+
+	std::stringstream compact(std::ios::in | std::ios::out | std::ios::binary);
+	auto start = std::chrono::steady_clock::now();
+	writeCompact(compact, values);
+	const double writeMs = elapsedMs(start);
+	std::vector<int> decoded;
+	start = std::chrono::steady_clock::now();
+	const bool same = readCompact(compact, decoded) && decoded == values;
+	const double readMs = elapsedMs(start);
+	std::cout << "compact output (n = " << n << "): " << compact.str().size() << " bytes vs " << text.str().size()
+		<< " bytes of text, write " << writeMs << " ms, read " << readMs << " ms" << checkMark(same) << "\n";
+}
+
+//*****************
+// Function name: benchColumnarFile
+// Purpose: Writes sixteen sorted columns of uniform ints as a columnar file, then times reading it back
+//          whole and a range query that only decodes the pages overlapping one percent of the values.
+// Parameters:
+//    - n: Number of integers over all columns.
+// Returns: void
+//*****************
+inline void benchColumnarFile(std::size_t n)
+{
+	GeneratorOptions options;
+	options.low = 0;
+	options.high = 1 << 24;
+	std::vector<std::vector<int>> columns(16);
+	for (std::vector<int>& column : columns) column = generateData<int>(n / columns.size(), options);
+	recursiveSort(columns, std::greater<int>());
+
+	const std::string path = (std::filesystem::temp_directory_path() / "bubblesort_bench_columnar.bin").string();
+	auto start = std::chrono::steady_clock::now();
+	if (!writeColumnarFile(path, columns)) return;
+	const double writeMs = elapsedMs(start);
+	const std::uint64_t bytes = std::filesystem::file_size(path);
+
+	std::vector<std::vector<int>> decoded;
+	start = std::chrono::steady_clock::now();
+	const bool same = readColumnarFile(path, decoded) && decoded == columns;
+	const double readMs = elapsedMs(start);
+
+	ColumnarReader<int> reader;
+	std::size_t pages = 0, pagesRead = 0, matches = 0;
+	start = std::chrono::steady_clock::now();
+	if (reader.open(path))
+	{
+		std::vector<int> values;
+		for (std::size_t column = 0; column < reader.rowGroupCount(); ++column)
+		{
+			std::size_t read = 0;
+			values.clear();
+			reader.readRange(column, 0, 1 << 20, (1 << 20) + (1 << 24) / 100, values, &read);
+			pages += reader.pageCount(column, 0);
+			pagesRead += read;
+			matches += values.size();
+		}
+	}
+	const double rangeMs = elapsedMs(start);
+	std::cout << "columnar file (n = " << n << "): " << bytes << " bytes, write " << writeMs << " ms, read " << readMs << " ms"
+		<< checkMark(same) << ", range query " << rangeMs << " ms (" << matches << " values, " << pagesRead << " of "
+		<< pages << " pages decoded)\n";
+	std::remove(path.c_str());
+}
+
+//*****************
+// Function name: benchFenceIndex
+// Purpose: Sorts a file of uniform ints with a fence index, then times random point lookups through
+//          SortedFileReader against loading the whole file and searching it with std::lower_bound.
+// Parameters:
+//    - n: Number of integers.
+// Returns: void
+//*****************
+inline void benchFenceIndex(std::size_t n)
+{
+	const std::vector<int> values = generateData<int>(n);
+	const std::vector<int> probes = generateData<int>(10000);
+	const std::string path = (std::filesystem::temp_directory_path() / "bubblesort_bench_fences.bin").string();
+	const std::string indexPath = path + ".idx";
+	IoFile file;
+	const bool written = file.openWrite(path) && file.writeAt(values.data(), n * sizeof(int), 0);
+	if (file.close() && written && externalSortFile<int>(path, path, SortOptions(), false, std::string(), indexPath))
+	{
+		std::uint64_t checksum = 0;
+		auto start = std::chrono::steady_clock::now();
+		SortedFileReader<int> reader;
+		if (reader.open(path, indexPath))
+		{
+			for (int probe : probes) checksum += reader.lowerBound(probe);
+		}
+		const double indexMs = elapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		std::vector<int> loaded(n);
+		if (file.openRead(path) && file.readAt(loaded.data(), n * sizeof(int), 0))
+		{
+			for (int probe : probes) checksum -= static_cast<std::uint64_t>(std::lower_bound(loaded.begin(), loaded.end(), probe) - loaded.begin());
+		}
+		file.close();
+		const double loadMs = elapsedMs(start);
+		std::cout << "fence index (n = " << n << ", " << probes.size() << " lookups): " << indexMs << " ms reading "
+			<< reader.blocksRead() << " blocks, full load " << loadMs << " ms" << checkMark(checksum == 0) << "\n";
+	}
+	std::remove(path.c_str());
+	std::remove(indexPath.c_str());
+}
+
+//*****************
+// Function name: benchSearchTree
+// Purpose: Times random lower_bound lookups on sorted uniform ints with std::lower_bound, an EytzingerIndex
+//          and an STreeIndex built from the sorted vector.
+// Parameters:
+//    - n: Number of integers.
+// Returns: void
+//*****************
+inline void benchSearchTree(std::size_t n)
+{
+	GeneratorOptions options;
+	options.low = std::numeric_limits<int>::min();
+	options.high = std::numeric_limits<int>::max();
+	std::vector<int> values = generateData<int>(n, options);
+	options.seed = 7;
+	const std::vector<int> probes = generateData<int>(1 << 20, options);
+	recursiveSort(values, std::greater<int>());
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<EytzingerIndex<int>> eytzinger;
+	std::vector<STreeIndex<int>> sTree;
+	buildSearchIndexes(values, eytzinger);
+	buildSearchIndexes(values, sTree);
+	const double buildMs = elapsedMs(start);
+
+	std::size_t expected = 0, eytzingerSum = 0, sTreeSum = 0;
+	start = std::chrono::steady_clock::now();
+	for (int probe : probes) expected += static_cast<std::size_t>(std::lower_bound(values.begin(), values.end(), probe) - values.begin());
+	const double binaryMs = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	for (int probe : probes) eytzingerSum += eytzinger[0].lowerBound(probe);
+	const double eytzingerMs = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	for (int probe : probes) sTreeSum += sTree[0].lowerBound(probe);
+	const double sTreeMs = elapsedMs(start);
+
+	const bool same = eytzingerSum == expected && sTreeSum == expected;
+	std::cout << "search tree (n = " << n << ", " << probes.size() << " lookups): std::lower_bound " << binaryMs << " ms, eytzinger "
+		<< eytzingerMs << " ms, s-tree " << sTreeMs << " ms, build " << buildMs << " ms" << checkMark(same) << "\n";
+}
+
+//*****************
+// Function name: benchSetOperations
+// Purpose: Times intersectSorted against std::set_intersection on two sorted uniform int runs of equal
+//          size (the SIMD kernel) and on every 1000th value of one against the other (galloping).
+// Parameters:
+//    - n: Number of integers in the longer run.
+// Returns: void
+//*****************
+inline void benchSetOperations(std::size_t n)
+{
+	GeneratorOptions options;
+	options.high = static_cast<double>(4 * n);
+	std::vector<int> a = generateData<int>(n, options);
+	options.seed = 7;
+	std::vector<int> b = generateData<int>(n, options);
+	std::sort(a.begin(), a.end());
+	std::sort(b.begin(), b.end());
+	a.erase(std::unique(a.begin(), a.end()), a.end());
+	b.erase(std::unique(b.begin(), b.end()), b.end());
+	std::vector<int> sparse;
+	for (std::size_t i = 0; i < b.size(); i += 1000) sparse.push_back(b[i]);
+	std::vector<int> out(n), expected(n);
+
+	for (const std::vector<int>* other : { &b, &sparse })
+	{
+		auto start = std::chrono::steady_clock::now();
+		expected.resize(static_cast<std::size_t>(std::set_intersection(a.begin(), a.end(), other->begin(), other->end(), expected.begin()) - expected.begin()));
+		const double stdMs = elapsedMs(start);
+		start = std::chrono::steady_clock::now();
+		out.resize(intersectSorted(a.data(), a.size(), other->data(), other->size(), out.data()));
+		const double setMs = elapsedMs(start);
+		std::cout << "set intersection (" << a.size() << " x " << other->size() << "): std::set_intersection " << stdMs
+			<< " ms, intersectSorted " << setMs << " ms" << checkMark(out == expected) << "\n";
+		out.resize(n);
+		expected.resize(n);
+	}
+}
+
+//*****************
+// Function name: benchDistinctSort
+// Purpose: Times sortDistinct with counts against integerSort followed by a counting pass and std::unique,
+//          on ints with 10000 distinct values spread over the whole range (the radix path) and on ints
+//          spanning 1000 values (the counting path).
+// Parameters:
+//    - n: Number of integers.
+// Returns: void
+//*****************
+inline void benchDistinctSort(std::size_t n)
+{
+	GeneratorOptions options;
+	options.high = 9999;
+	std::vector<int> spread = generateData<int>(n, options);
+	for (int& value : spread) value *= 214747;
+	options.high = 999;
+	std::vector<int> narrow = generateData<int>(n, options);
+
+	for (const std::vector<int>* values : { &spread, &narrow })
+	{
+		std::vector<int> data = *values;
+		std::vector<std::size_t> expected, counts;
+		auto start = std::chrono::steady_clock::now();
+		integerSort(data);
+		for (std::size_t i = 0; i < data.size(); ++i)
+		{
+			if (i == 0 || data[i] != data[i - 1]) expected.push_back(0);
+			++expected.back();
+		}
+		data.erase(std::unique(data.begin(), data.end()), data.end());
+		const double twoPassMs = elapsedMs(start);
+
+		std::vector<int> fused = *values;
+		start = std::chrono::steady_clock::now();
+		sortDistinct(fused, false, SortOptions(), &counts);
+		const double fusedMs = elapsedMs(start);
+		std::cout << "distinct sort (n = " << n << ", " << fused.size() << " values): sort + count + unique " << twoPassMs
+			<< " ms, sortDistinct " << fusedMs << " ms" << checkMark(fused == data && counts == expected) << "\n";
+	}
+}
+
+//*****************
+// Function name: benchGroupBy
+// Purpose: Times the hash and sort strategies of groupByKeys, and the one Automatic picks, on uniform int
+//          keys with 16, n / 64 and n possible values.
+// Parameters:
+//    - n: Number of keys.
+// Returns: void
+//*****************
+inline void benchGroupBy(std::size_t n)
+{
+	GeneratorOptions options;
+	options.low = 0;
+	options.high = 999;
+	const std::vector<int> values = generateData<int>(n, options);
+	options.seed = 7;
+	for (std::size_t groups : { std::size_t(16), n / 64, n })
+	{
+		options.high = static_cast<double>(groups - 1);
+		const std::vector<int> keys = generateData<int>(n, options);
+		std::cout << "group by (n = " << n << ", keys below " << groups << "):";
+		GroupByResult<int, int> first;
+		for (GroupByStrategy strategy : { GroupByStrategy::Hash, GroupByStrategy::Sort, GroupByStrategy::Automatic })
+		{
+			const auto start = std::chrono::steady_clock::now();
+			GroupByResult<int, int> result = groupByKeys(keys.data(), values.data(), n, strategy);
+			const double ms = elapsedMs(start);
+			std::cout << (strategy == GroupByStrategy::Hash ? " hash " : strategy == GroupByStrategy::Sort ? ", sort " : ", automatic ") << ms << " ms";
+			if (strategy == GroupByStrategy::Automatic) std::cout << " (" << (result.strategy == GroupByStrategy::Hash ? "hash" : "sort") << ")";
+			if (strategy == GroupByStrategy::Hash)
+			{
+				first = std::move(result);
+			}
+			else
+			{
+				std::cout << checkMark(result.keys == first.keys && result.counts == first.counts && result.sums == first.sums
+					&& result.mins == first.mins && result.maxs == first.maxs);
+			}
+		}
+		std::cout << ", " << first.size() << " groups\n";
+	}
+}
+
+//*****************
+// Template Function: benchDivisibilityClassification
+// Purpose: Times classifying ints by divisibility with the classifyDivisible kernel against calling the
+//          classifier functor on every element, as the grouping comparators test every value they compare.
+// Parameters:
+//    - name: Name of the classifier for the report.
+//    - values: The ints to classify.
+// Returns: void
+//*****************
+template <typename Classifier>
+void benchDivisibilityClassification(const char* name, const std::vector<int>& values)
+{
+	std::vector<unsigned char> scalar(values.size()), kernel(values.size());
+	auto start = std::chrono::steady_clock::now();
+	Classifier classify;
+	for (std::size_t i = 0; i < values.size(); ++i)
+	{
+		scalar[i] = static_cast<unsigned char>(classify(values[i]));
+	}
+	const double scalarMs = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	classifyElements(values.data(), values.size(), classify, kernel.data());
+	const double kernelMs = elapsedMs(start);
+	std::cout << "divisibility classes " << name << " (n = " << values.size() << "): functor " << scalarMs << " ms, "
+		<< simdIsaName(selectSimdIsa()) << " kernel " << kernelMs << " ms" << checkMark(scalar == kernel) << "\n";
+}
+
+//*****************
+// Function name: benchClassPartition
+// Purpose: Times recursiveSort with the grouping comparators (OddFirst, EvenFirst, DivisibleBy3First), which
+//          partition into classes and radix sort each one, against std::stable_sort calling the comparator.
+// Parameters:
+//    - n: Number of integers.
+// Returns: void
+//*****************
+inline void benchClassPartition(std::size_t n)
+{
+	GeneratorOptions options;
+	options.low = -1000000;
+	options.high = 1000000;
+	const std::vector<int> values = generateData<int>(n, options);
+	auto benchComparator = [&values, n](const char* name, auto compare)
+	{
+		std::vector<int> expected(values);
+		auto start = std::chrono::steady_clock::now();
+		std::stable_sort(expected.begin(), expected.end(), [&compare](int a, int b) { return compare(b, a); });
+		const double stableMs = elapsedMs(start);
+
+		std::vector<int> partitioned(values);
+		start = std::chrono::steady_clock::now();
+		recursiveSort(partitioned, compare);
+		const double partitionMs = elapsedMs(start);
+		std::cout << "class partition " << name << " (n = " << n << "): std::stable_sort " << stableMs << " ms, partition first "
+			<< partitionMs << " ms" << checkMark(partitioned == expected) << "\n";
+	};
+	benchComparator("OddFirst", OddFirst());
+	benchComparator("EvenFirst", EvenFirst());
+	benchComparator("DivisibleBy3First", DivisibleBy3First());
+	benchDivisibilityClassification<OddFirst::classifier>("OddFirst", values);
+	benchDivisibilityClassification<DivisibleBy3First::classifier>("DivisibleBy3First", values);
+}
+
+//*****************
+// Template Function: benchSortCase
+// Purpose: Times recursiveSort on a fresh copy of input in the given container type, repeatedly.
+// Parameters:
+//    - container: Name of the container type for the report.
+//    - distribution: Name of the input distribution for the report.
+//    - engineName: Name of the engine for the report.
+//    - engine: The engine passed to recursiveSort.
+//    - input: The data to be sorted.
+//    - repetitions: Number of timed sorts.
+// Returns: The summary of the timings.
+//*****************
+template <typename Container, typename T>
+BenchSummary benchSortCase(const char* container, const char* distribution, const char* engineName, SortEngine engine,
+	const std::vector<T>& input, std::size_t repetitions)
+{
+	std::vector<double> samplesMs;
+	for (std::size_t r = 0; r < repetitions; ++r)
+	{
+		Container holder(input.begin(), input.end());
+		const auto start = std::chrono::steady_clock::now();
+		recursiveSort(holder, std::greater<T>(), engine);
+		samplesMs.push_back(elapsedMs(start));
+		if (r == 0 && !std::is_sorted(holder.begin(), holder.end()))
+		{
+			++benchCheckFailures;
+			std::cerr << engineName << " " << container << " " << distribution << ": recursiveSort left the input unsorted\n";
+		}
+	}
+
+	BenchSummary summary;
+	summary.engine = engineName;
+	summary.container = container;
+	summary.distribution = distribution;
+	summary.n = input.size();
+	summarizeSamples(samplesMs, summary);
+	return summary;
+}
+
+//*****************
+// Template Function: benchProjectionCase
+// Purpose: Times recursiveSort by projected keys (ascending) on a fresh copy of input, repeatedly.
+// Parameters:
+//    - distribution: Name of the input distribution for the report.
+//    - engineName: Name of the engine for the report.
+//    - engine: The engine passed to recursiveSort.
+//    - project: The projection.
+//    - input: The data to be sorted.
+//    - repetitions: Number of timed sorts.
+// Returns: The summary of the timings.
+//*****************
+template <typename T, typename Projection>
+BenchSummary benchProjectionCase(const char* distribution, const char* engineName, SortEngine engine, Projection project,
+	const std::vector<T>& input, std::size_t repetitions)
+{
+	using Key = projected_key_t<Projection, T>;
+	std::vector<double> samplesMs;
+	for (std::size_t r = 0; r < repetitions; ++r)
+	{
+		std::vector<T> holder(input);
+		const auto start = std::chrono::steady_clock::now();
+		recursiveSort(holder, std::greater<Key>(), project, engine);
+		samplesMs.push_back(elapsedMs(start));
+		const auto byKey = [&project](const T& a, const T& b) { return std::invoke(project, a) < std::invoke(project, b); };
+		if (r == 0 && !std::is_sorted(holder.begin(), holder.end(), byKey))
+		{
+			++benchCheckFailures;
+			std::cerr << engineName << " projected " << distribution << ": recursiveSort left the input unsorted by key\n";
+		}
+	}
+
+	BenchSummary summary;
+	summary.engine = engineName;
+	summary.container = "vector";
+	summary.distribution = distribution;
+	summary.n = input.size();
+	summarizeSamples(samplesMs, summary);
+	return summary;
+}
+
+//*****************
+// Function name: runSortBenchmarks
+// Purpose: Runs every engine, container and input distribution combination.
+// Parameters:
+//    - n: Number of elements per case (bubbleSort cases use n / 256).
+//    - repetitions: Number of timed sorts per case.
+// Returns: The summaries of all cases.
+//*****************
+inline std::vector<BenchSummary> runSortBenchmarks(std::size_t n, std::size_t repetitions)
+{
+	const std::pair<const char*, Distribution> distributions[] = {
+		{ "uniform", Distribution::Uniform }, { "zipf", Distribution::Zipf }, { "gaussian", Distribution::Gaussian },
+		{ "sorted_runs", Distribution::SortedRuns }, { "reverse", Distribution::Reverse }, { "organ_pipe", Distribution::OrganPipe },
+		{ "all_equal", Distribution::AllEqual } };
+	std::vector<std::pair<const char*, std::vector<int>>> inputs;
+	for (const auto& distribution : distributions)
+	{
+		GeneratorOptions options;
+		options.distribution = distribution.second;
+		options.low = std::numeric_limits<int>::min();
+		options.high = std::numeric_limits<int>::max();
+		inputs.emplace_back(distribution.first, generateData<int>(n, options));
+	}
+
+	const std::pair<const char*, SortEngine> engines[] = {
+		{ "automatic", SortEngine::Automatic }, { "radix", SortEngine::Radix }, { "inplace_radix", SortEngine::InPlaceRadix } };
+
+	std::vector<BenchSummary> summaries;
+	for (const auto& input : inputs)
+	{
+		for (const auto& engine : engines)
+		{
+			summaries.push_back(benchSortCase<std::vector<int>>("vector", input.first, engine.first, engine.second, input.second, repetitions));
+			summaries.push_back(benchSortCase<std::deque<int>>("deque", input.first, engine.first, engine.second, input.second, repetitions));
+			summaries.push_back(benchSortCase<std::list<int>>("list", input.first, engine.first, engine.second, input.second, repetitions));
+		}
+		const std::vector<int> small(input.second.begin(), input.second.begin() + n / 256);
+		summaries.push_back(benchSortCase<std::vector<int>>("vector", input.first, "bubble", SortEngine::Bubble, small, repetitions));
+		summaries.push_back(benchProjectionCase(input.first, "digits_proj", SortEngine::Automatic, DigitSum(), input.second, repetitions));
+		summaries.push_back(benchProjectionCase(input.first, "digits_bubble", SortEngine::Bubble, DigitSum(), small, repetitions));
+	}
+	return summaries;
+}
+
+//*****************
+// Function name: runTrainingWorkload
+// Purpose: Exercises every engine, container, comparator and input distribution once without timing,
+//          as the training run of profile-guided builds (see BUBBLESORT_PGO in CMakeLists.txt).
+// Parameters:
+//    - n: Number of elements per engine input; bubbleSort inputs use n / 128.
+// Returns: A checksum of the sorted data, so the work cannot be optimized away.
+//*****************
+inline std::size_t runTrainingWorkload(std::size_t n)
+{
+	std::size_t checksum = 0;
+	const auto consume = [&checksum](const auto& holder)
+	{
+		if (!holder.empty()) checksum += static_cast<std::size_t>(*holder.begin()) + holder.size();
+	};
+
+	for (Distribution distribution : { Distribution::Uniform, Distribution::Zipf, Distribution::Gaussian, Distribution::Sorted,
+		Distribution::Reverse, Distribution::SortedRuns, Distribution::OrganPipe, Distribution::AllEqual, Distribution::AntiQuicksort })
+	{
+		GeneratorOptions options;
+		options.distribution = distribution;
+		options.low = std::numeric_limits<int>::min();
+		options.high = std::numeric_limits<int>::max();
+		const std::vector<int> values = generateData<int>(n, options);
+		for (SortEngine engine : { SortEngine::Automatic, SortEngine::Radix, SortEngine::InPlaceRadix })
+		{
+			std::vector<int> vec(values);
+			recursiveSort(vec, std::greater<int>(), engine);
+			consume(vec);
+			std::deque<int> deq(values.begin(), values.end());
+			recursiveSort(deq, std::less<int>(), engine);
+			consume(deq);
+		}
+		std::list<int> lst(values.begin(), values.end());
+		recursiveSort(lst);
+		consume(lst);
+		std::vector<int> byDigitSum(values);
+		recursiveSort(byDigitSum, std::greater<int>(), DigitSum());
+		consume(byDigitSum);
+		std::vector<BenchRecord> records(values.size() / 8);
+		for (std::size_t i = 0; i < records.size(); ++i) records[i].key = values[i];
+		recursiveSort(records, std::less<int>(), &BenchRecord::key);
+		checksum += records.empty() ? 0 : static_cast<std::size_t>(records.front().key);
+		std::vector<int> inPlace(values);
+		recursiveSort(inPlace, std::greater<int>(), SortOptions(SortEngine::Automatic, 0));
+		consume(inPlace);
+
+		// The grouping functors declare a classifier and train the class partition, SumOfDigits declares a
+		// projection and trains the projected-key engine
+		options.low = 0;
+		options.high = 100000;
+		const std::vector<int> small = generateData<int>(std::max<std::size_t>(n / 128, 2), options);
+		std::vector<int> byOdd(small), byEven(small), byThree(small), byDigits(small);
+		recursiveSort(byOdd, OddFirst());
+		recursiveSort(byEven, EvenFirst());
+		recursiveSort(byThree, DivisibleBy3First());
+		recursiveSort(byDigits, SumOfDigits());
+		consume(byOdd);
+		consume(byEven);
+		consume(byThree);
+		consume(byDigits);
+
+		std::vector<double> reals = generateData<double>(std::max<std::size_t>(n / 128, 2), options);
+		recursiveSort(reals);
+		consume(reals);
+	}
+
+	std::vector<std::string> strings = generateStrings(n / 4, 4, 16);
+	recursiveSort(strings);
+	checksum += strings.empty() ? 0 : strings.front().size();
+	StringTable table(strings.rbegin(), strings.rend());
+	recursiveSort(table, std::less<std::string_view>());
+	checksum += table.empty() ? 0 : table[0].size();
+	std::vector<std::vector<std::string>> words = { generateStrings(n / 128, 2, 8, 7), generateStrings(n / 128, 2, 8, 8) };
+	recursiveSort(words, AlphabeticalPosition());
+	checksum += words.front().size();
+	std::vector<std::string> mixedCase = generateStrings(n / 16, 4, 16, 9, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ");
+	std::vector<std::string> mixedCaseUtf8(mixedCase);
+	recursiveSort(mixedCase, CaseInsensitiveOrder());
+	recursiveSort(mixedCaseUtf8, Utf8CollatedOrder());
+	checksum += mixedCase.size() + mixedCaseUtf8.size();
+	std::vector<std::string> versions;
+	for (std::size_t i = 0; i < n / 16; ++i) versions.push_back("v" + std::to_string(i % 7) + "." + std::to_string(i % 131) + "-rc" + std::to_string(i % 3));
+	recursiveSort(versions, NaturalOrder<>());
+	checksum += versions.size();
+
+	auto grid = generateRagged2D<int>(64, n / 256, n / 64);
+	recursiveSort(grid, std::greater<int>());
+	auto cube = generateRagged3D<int>(8, 4, 16, n / 1024, n / 256);
+	recursiveSort(cube, std::less<int>());
+	checksum += grid.size() + cube.size();
+	return checksum;
+}
+
+//*****************
+// Function name: runBenchmarkCommand
+// Purpose: Handles the benchmark command line: runs the phase and regression benchmarks, appends the results
+//          to the history file, compares them with a baseline and optionally stores them as the new baseline.
+//          Options: --size N, --reps N, --history FILE, --baseline FILE, --save-baseline FILE, and --train,
+//          which only runs the profile training workload.
+//          Set BUBBLESORT_ISA=baseline|sse42|avx2|avx512 to run the library kernels with one instruction set.
+// Parameters:
+//    - argc, argv: The command line arguments following the program name.
+// Returns: The process exit code, 1 if any case regressed against the baseline or any cross-check of an
+//          engine's result failed.
+//*****************
+inline int runBenchmarkCommand(int argc, char* argv[])
+{
+	std::size_t n = std::size_t(1) << 20;
+	std::size_t repetitions = 5;
+	std::string historyPath = "bench_history.csv", baselinePath, saveBaselinePath;
+	bool train = false;
+	for (int i = 0; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--train") == 0)
+		{
+			train = true;
+			continue;
+		}
+		if (i + 1 == argc)
+		{
+			std::cerr << "missing value for benchmark option " << argv[i] << "\n";
+			return 2;
+		}
+		if (std::strcmp(argv[i], "--size") == 0) n = static_cast<std::size_t>(std::stoull(argv[++i]));
+		else if (std::strcmp(argv[i], "--reps") == 0) repetitions = static_cast<std::size_t>(std::stoull(argv[++i]));
+		else if (std::strcmp(argv[i], "--history") == 0) historyPath = argv[++i];
+		else if (std::strcmp(argv[i], "--baseline") == 0) baselinePath = argv[++i];
+		else if (std::strcmp(argv[i], "--save-baseline") == 0) saveBaselinePath = argv[++i];
+		else
+		{
+			std::cerr << "unknown benchmark option " << argv[i] << "\n";
+			return 2;
+		}
+	}
+
+	if (train)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const std::size_t checksum = runTrainingWorkload(std::max<std::size_t>(n, 1 << 10));
+		std::cout << "training workload (n = " << n << "): " << elapsedMs(start) << " ms, checksum " << checksum << "\n";
+		return 0;
+	}
+
+	benchRadixPhases(std::max<std::size_t>(n, 1 << 16) * 16);
+	benchExclusiveScan(kRadixBuckets * 64, 1 << 14);
+	benchSimdKernels(std::max<std::size_t>(n, 1 << 16));
+	benchGenerators(std::max<std::size_t>(n, 1 << 16) * 4);
+	benchCollation(std::max<std::size_t>(n, 1 << 10));
+	benchNaturalSort(std::max<std::size_t>(n, 1 << 10));
+	benchStringTable(std::max<std::size_t>(n, 1 << 10));
+	benchRecordSort(std::max<std::size_t>(n, 1 << 10));
+	benchScratchBudget(std::max<std::size_t>(n, 1 << 16));
+	benchBlockCodec(std::max<std::size_t>(n, 1 << 16));
+	benchCompactOutput(std::max<std::size_t>(n, 1 << 16));
+	benchColumnarFile(std::max<std::size_t>(n, 1 << 16));
+	benchFenceIndex(std::max<std::size_t>(n, 1 << 16));
+	benchSearchTree(std::max<std::size_t>(n, 1 << 16));
+	benchSetOperations(std::max<std::size_t>(n, 1 << 16));
+	benchDistinctSort(std::max<std::size_t>(n, 1 << 16));
+	benchGroupBy(std::max<std::size_t>(n, 1 << 16));
+	benchClassPartition(std::max<std::size_t>(n, 1 << 16));
+
+	const std::vector<BenchSummary> summaries = runSortBenchmarks(std::max<std::size_t>(n, 256), std::max<std::size_t>(repetitions, 2));
+	const std::string runId = std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count());
+	if (!historyPath.empty() && !writeBenchCsv(historyPath, runId, summaries, true))
+	{
+		std::cerr << "could not write benchmark history " << historyPath << "\n";
+	}
+	if (!saveBaselinePath.empty() && !writeBenchCsv(saveBaselinePath, runId, summaries, false))
+	{
+		std::cerr << "could not write benchmark baseline " << saveBaselinePath << "\n";
+	}
+
+	std::vector<BenchSummary> baseline;
+	if (!baselinePath.empty() && !readBenchCsv(baselinePath, baseline))
+	{
+		std::cerr << "could not read benchmark baseline " << baselinePath << "\n";
+		return 2;
+	}
+	const std::size_t regressions = compareToBaseline(summaries, baseline);
+	if (regressions > 0) std::cout << regressions << " case(s) slower than the baseline\n";
+	if (benchCheckFailures > 0) std::cerr << benchCheckFailures << " benchmark cross-check(s) failed\n";
+	return regressions > 0 || benchCheckFailures > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+	return runBenchmarkCommand(argc - 1, argv + 1);
+}
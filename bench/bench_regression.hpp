@@ -0,0 +1,231 @@
+//*****************
+// bench/bench_regression.hpp
+// Benchmark statistics, CSV history and baseline comparison.
+//*****************
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>    // for benchmark CSV files
+#include <iomanip>    // for std::setw
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//*****************
+// Regression benchmarks
+// Each case sorts the same input several times with one engine, container and input distribution.
+// Results are appended to a CSV history and compared against a stored baseline run with Welch's t-test,
+// so a slowdown in any bubbleSort replacement is reported before it ships.
+//*****************
+
+//*****************
+// Struct: BenchSummary
+// Purpose: Statistics of the repeated timings of one benchmark case, as stored in the CSV files.
+//*****************
+struct BenchSummary
+{
+	std::string engine;
+	std::string container;
+	std::string distribution;
+	std::size_t n = 0;
+	std::size_t repetitions = 0;
+	double meanMs = 0;
+	double stddevMs = 0;
+	double minMs = 0;
+	double ciLowMs = 0;   // 95% confidence interval of the mean
+	double ciHighMs = 0;
+};
+
+// Coefficient of variation above which a case is reported as noisy instead of getting a verdict
+constexpr double kBenchNoiseLimit = 0.10;
+
+// Relative change of the mean below which a case is reported as unchanged even when significant
+constexpr double kBenchMinimumChange = 0.05;
+
+//*****************
+// Function name: studentT95
+// Purpose: Returns the two-sided 95% critical value of Student's t distribution.
+// Parameters:
+//    - degrees: Degrees of freedom.
+// Returns: The critical value (1.96 for large degrees of freedom).
+//*****************
+inline double studentT95(double degrees) noexcept
+{
+	static const double table[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086 };
+	if (degrees < 1) return table[0];
+	if (degrees <= 20) return table[static_cast<std::size_t>(degrees) - 1];
+	if (degrees <= 30) return 2.042;
+	if (degrees <= 60) return 2.000;
+	return 1.960;
+}
+
+//*****************
+// Function name: summarizeSamples
+// Purpose: Computes mean, standard deviation, minimum and the 95% confidence interval of timings.
+// Parameters:
+//    - samplesMs: The timings of every repetition in milliseconds.
+//    - summary: The summary to fill in; its key fields are left untouched.
+// Returns: void
+//*****************
+inline void summarizeSamples(const std::vector<double>& samplesMs, BenchSummary& summary)
+{
+	const std::size_t reps = samplesMs.size();
+	summary.repetitions = reps;
+	if (reps == 0) return;
+
+	double sum = 0;
+	for (double sample : samplesMs) sum += sample;
+	summary.meanMs = sum / reps;
+
+	double squares = 0;
+	for (double sample : samplesMs) squares += (sample - summary.meanMs) * (sample - summary.meanMs);
+	summary.stddevMs = reps > 1 ? std::sqrt(squares / (reps - 1)) : 0;
+	summary.minMs = *std::min_element(samplesMs.begin(), samplesMs.end());
+
+	const double margin = studentT95(static_cast<double>(reps - 1)) * summary.stddevMs / std::sqrt(static_cast<double>(reps));
+	summary.ciLowMs = summary.meanMs - margin;
+	summary.ciHighMs = summary.meanMs + margin;
+}
+
+// Header line of the benchmark CSV files
+constexpr const char* kBenchCsvHeader = "run,engine,container,distribution,n,repetitions,mean_ms,stddev_ms,min_ms,ci_low_ms,ci_high_ms";
+
+//*****************
+// Function name: writeBenchCsv
+// Purpose: Writes benchmark summaries as CSV rows tagged with a run identifier.
+// Parameters:
+//    - path: The CSV file to write.
+//    - runId: Identifier stored in the run column (e.g. a timestamp).
+//    - summaries: The rows to write.
+//    - append: Appends to an existing history when true, otherwise replaces the file.
+// Returns: true if the file could be written.
+//*****************
+inline bool writeBenchCsv(const std::string& path, const std::string& runId, const std::vector<BenchSummary>& summaries, bool append)
+{
+	const bool needsHeader = !append || !std::ifstream(path).good();
+	std::ofstream out(path, append ? std::ios::app : std::ios::trunc);
+	if (!out) return false;
+
+	if (needsHeader) out << kBenchCsvHeader << "\n";
+	out << std::setprecision(9);
+	for (const auto& row : summaries)
+	{
+		out << runId << "," << row.engine << "," << row.container << "," << row.distribution << "," << row.n << ","
+			<< row.repetitions << "," << row.meanMs << "," << row.stddevMs << "," << row.minMs << ","
+			<< row.ciLowMs << "," << row.ciHighMs << "\n";
+	}
+	return static_cast<bool>(out);
+}
+
+//*****************
+// Function name: readBenchCsv
+// Purpose: Reads benchmark summaries written by writeBenchCsv. When the file holds several runs,
+//          only the rows of the last run are returned.
+// Parameters:
+//    - path: The CSV file to read.
+//    - summaries: Receives the rows of the last run.
+// Returns: true if the file could be opened.
+//*****************
+inline bool readBenchCsv(const std::string& path, std::vector<BenchSummary>& summaries)
+{
+	std::ifstream in(path);
+	if (!in) return false;
+
+	summaries.clear();
+	std::string line, lastRun;
+	while (std::getline(in, line))
+	{
+		if (line.empty() || line.compare(0, 4, "run,") == 0) continue;
+
+		std::vector<std::string> fields;
+		std::stringstream stream(line);
+		for (std::string field; std::getline(stream, field, ',');) fields.push_back(field);
+		if (fields.size() != 11) continue;
+
+		if (fields[0] != lastRun)
+		{
+			summaries.clear(); // A newer run starts
+			lastRun = fields[0];
+		}
+		BenchSummary row;
+		row.engine = fields[1];
+		row.container = fields[2];
+		row.distribution = fields[3];
+		row.n = static_cast<std::size_t>(std::stoull(fields[4]));
+		row.repetitions = static_cast<std::size_t>(std::stoull(fields[5]));
+		row.meanMs = std::stod(fields[6]);
+		row.stddevMs = std::stod(fields[7]);
+		row.minMs = std::stod(fields[8]);
+		row.ciLowMs = std::stod(fields[9]);
+		row.ciHighMs = std::stod(fields[10]);
+		summaries.push_back(row);
+	}
+	return true;
+}
+
+//*****************
+// Function name: compareToBaseline
+// Purpose: Prints a report comparing every current case with the matching baseline case. A case is
+//          SLOWER or FASTER when Welch's t-test finds the means differ at 95% confidence and the change
+//          exceeds kBenchMinimumChange; cases whose timings vary too much are reported as noisy.
+// Parameters:
+//    - current: Summaries of the new run.
+//    - baseline: Summaries of the stored baseline run.
+// Returns: The number of cases that got slower.
+//*****************
+inline std::size_t compareToBaseline(const std::vector<BenchSummary>& current, const std::vector<BenchSummary>& baseline)
+{
+	std::size_t regressions = 0;
+	std::cout << std::left << std::setw(14) << "engine" << std::setw(8) << "cont." << std::setw(12) << "dist." << std::right
+		<< std::setw(10) << "n" << std::setw(12) << "base ms" << std::setw(12) << "new ms" << std::setw(9) << "change" << "  verdict\n";
+
+	for (const auto& now : current)
+	{
+		const auto match = std::find_if(baseline.begin(), baseline.end(), [&now](const BenchSummary& base)
+		{
+			return base.engine == now.engine && base.container == now.container && base.distribution == now.distribution && base.n == now.n;
+		});
+
+		std::cout << std::left << std::setw(14) << now.engine << std::setw(8) << now.container << std::setw(12) << now.distribution
+			<< std::right << std::setw(10) << now.n << std::fixed << std::setprecision(3);
+		if (match == baseline.end())
+		{
+			std::cout << std::setw(12) << "-" << std::setw(12) << now.meanMs << std::setw(9) << "-" << "  new case\n";
+			continue;
+		}
+
+		const BenchSummary& base = *match;
+		const double change = base.meanMs > 0 ? (now.meanMs - base.meanMs) / base.meanMs : 0;
+		std::cout << std::setw(12) << base.meanMs << std::setw(12) << now.meanMs << std::setw(8) << std::setprecision(1) << change * 100 << "%";
+
+		// Welch's t-test on the two means, with Welch-Satterthwaite degrees of freedom
+		const double varBase = base.stddevMs * base.stddevMs / std::max<std::size_t>(base.repetitions, 1);
+		const double varNow = now.stddevMs * now.stddevMs / std::max<std::size_t>(now.repetitions, 1);
+		const double error = std::sqrt(varBase + varNow);
+		bool significant = true;
+		if (error > 0)
+		{
+			const double degrees = (varBase + varNow) * (varBase + varNow) /
+				(varBase * varBase / std::max<double>(1, base.repetitions - 1.0) + varNow * varNow / std::max<double>(1, now.repetitions - 1.0));
+			significant = std::abs(now.meanMs - base.meanMs) / error > studentT95(degrees);
+		}
+
+		const bool noisy = (base.meanMs > 0 && base.stddevMs / base.meanMs > kBenchNoiseLimit) ||
+			(now.meanMs > 0 && now.stddevMs / now.meanMs > kBenchNoiseLimit);
+		if (noisy) std::cout << "  noisy\n";
+		else if (significant && change > kBenchMinimumChange)
+		{
+			std::cout << "  SLOWER\n";
+			++regressions;
+		}
+		else if (significant && change < -kBenchMinimumChange) std::cout << "  faster\n";
+		else std::cout << "  ok\n";
+	}
+	std::cout.unsetf(std::ios::floatfield);
+	std::cout << std::setprecision(6);
+	return regressions;
+}
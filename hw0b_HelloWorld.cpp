@@ -1,238 +1,15 @@
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <array>
 #include <deque>
 #include <list>
+#include <algorithm>  // for std::is_sorted
 #include <cmath>      // for std::abs
-#include <utility>  // for std::swap
-#include <type_traits> // for std::enable_if and std::is_same C++ 17
 
-// Functors for custom sorting based on different criteria
-
-//*****************
-// Functor: OddFirst
-// Purpose: Sorts integers such that odd numbers come before even numbers,
-//          and within the same group, sorts in ascending order.
-//*****************
-struct OddFirst
-{
-	bool operator()(const int& a, const int& b) const
-	{
-		if ((a % 2 != 0) && (b % 2 == 0)) return false; // Odd numbers first
-		if ((a % 2 == 0) && (b % 2 != 0)) return true;  // Even numbers after
-		return a < b;  // Sort within the same group (odd or even) in ascending order
-	}
-};
-
-//*****************
-// Functor: DivisibleBy3First
-// Purpose: Sorts integers such that numbers divisible by 3 come first,
-//          and within the same group, sorts in ascending order.
-//*****************
-struct DivisibleBy3First
-{
-	bool operator()(const int& a, const int& b) const
-	{
-		if ((a % 3 == 0) && (b % 3 != 0)) return false; // Divisible by 3 come first
-		if ((a % 3 != 0) && (b % 3 == 0)) return true;
-		return a < b;  // Sort within the same group (divisible by 3 or not)
-	}
-};
-
-//*****************
-// Functor: EvenFirst
-// Purpose: Sorts integers such that even numbers come before odd numbers,
-//          and within the same group, sorts in ascending order.
-//*****************
-struct EvenFirst
-{
-	bool operator()(const int& a, const int& b) const
-	{
-		if ((a % 2 == 0) && (b % 2 != 0)) return false; // Even numbers first
-		if ((a % 2 != 0) && (b % 2 == 0)) return true;  // Odd numbers after
-		return a < b;  // Sort within same group (even or odd)
-	}
-};
-
-//*****************
-// Functor: SumOfDigits
-// Purpose: Sorts integers based on the sum of their digits in ascending order.
-//*****************
-struct SumOfDigits
-{
-	//*****************
-	// Helper Function: sumDigits
-	// Purpose: Returns the sum of the digits of a given integer.
-	//*****************
-	int sumDigits(int n) const
-	{
-		int sum = 0;
-		while (n > 0)
-		{
-			sum += n % 10;
-			n /= 10;
-		}
-		return sum;
-	}
-
-	// Overloaded operator() to compare numbers based on the sum of their digits.
-	bool operator()(const int& a, const int& b) const
-	{
-		return sumDigits(a) < sumDigits(b); // Sort by sum of digits
-	}
-};
-
-//*****************
-// Functor: AlphabeticalPosition
-// Purpose: Sorts strings based on the sum of their alphabetical positions
-//          (e.g., 'a' = 1, 'b' = 2, ..., 'z' = 26).
-//*****************
-struct AlphabeticalPosition
-{
-	bool operator()(const std::string& a, const std::string& b) const
-	{
-		int posA = 0, posB = 0;
-		for (char c : a) posA += c - 'a' + 1;  // Calculate position for a
-		for (char c : b) posB += c - 'a' + 1;  // Calculate position for b
-		return posA < posB;  // Compare positions
-	}
-};
-
-//*****************
-// Function name: printContainer
-// Purpose: Prints the contents of any container that supports iteration.
-// Parameters:
-//    - holder: A const reference to a container that holds elements to be printed.
-// Returns: void
-// Return type: void
-//*****************
-template <typename Container>
-void printContainer(const Container& holder) noexcept
-{
-	// Loop through the container and print each item, separated by spaces.
-	for (const auto& item : holder)
-	{
-		std::cout << item << " ";
-	}
-	// Using newline escape sequence to avoid buffer flush
-	std::cout << "\n";
-}
-
-// Helper type trait to detect if a type is a container
-template<typename T, typename _ = void>
-struct is_container : std::false_type {};
-
-// This helper struct checks for the presence of typical container types and iterators
-template<typename... Ts>
-struct is_container_helper {};
-
-// Specialization for containers that have value_type, iterators, and a size method
-template<typename T>
-struct is_container<T, std::conditional_t<false, is_container_helper<
-	typename T::value_type,
-	typename T::iterator,
-	typename T::const_iterator,
-	decltype(std::declval<T>().size())
->, void>> : std::true_type {};
-
-//*****************
-// Template Function: printNDVector (for non-containers)
-// Purpose: Prints nested vectors (N-dimensional containers) with indentation based on depth.
-// Parameters:
-//    - holder: A const reference to a potentially multi-dimensional container.
-//    - depth: An optional integer specifying the level of depth for indentation (default: 0).
-// Returns: void
-//*****************
-template <typename T>
-typename std::enable_if<!is_container<T>::value and std::is_arithmetic<T>::value>::type
-printNDVector(const T& holder, int depth = 0)
-{
-	// Indent based on depth to visually show nesting
-	std::cout << std::string(depth * 4, ' ') << holder;  // Increase indentation per depth level
-}
-
-//*****************
-// Template Function: printNDVector (for containers)
-// Purpose: Prints higher-dimensional containers (e.g., vectors of vectors) recursively.
-// Parameters:
-//    - holder: A const reference to a container that may hold other containers (multi-dimensional).
-//    - depth: An integer specifying the level of depth for indentation.
-// Returns: void
-//*****************
-template <typename T>
-typename std::enable_if<is_container<T>::value>::type
-printNDVector(const T& holder, int depth = 0)
-{
-	std::cout << std::string(depth * 4, ' ') << "\n{";  // Opening bracket to denote dimension
-
-	for (const auto& subHolder : holder)
-	{
-		printNDVector(subHolder, depth + 1);  // Recursive call for nested elements
-		;  // Newline for better readability after each element
-	}
-
-	std::cout << std::string(depth * 4, ' ') << "}\n";  // Closing bracket for this dimension
-}
-
-//*****************
-// Template Function: bubbleSort
-// Purpose: Performs a Bubble Sort on a given container using a specified comparator.
-// Parameters:
-//    - holder: A reference to a container that needs to be sorted.
-//    - compare: A comparator function or functor for custom sorting true bubbles up (default: greater).
-// Returns: void
-//*****************
-template <typename Container, typename Comparator = std::greater<typename Container::value_type>>
-void bubbleSort(Container& holder, Comparator compare = Comparator()) noexcept
-{
-	bool swapped;
-	const std::size_t n = std::distance(holder.begin(), holder.end());
-	if (n < 2) return;
-
-	// Perform bubble sort with a comparator to define sorting order
-	for (std::size_t i = 0; i < n - 1; ++i)
-	{
-		swapped = false;
-		auto it = holder.begin();
-		for (std::size_t j = 0; j < n - i - 1; ++j)
-		{
-			auto next = std::next(it);
-			if (compare(*it, *next))
-			{
-				std::swap(*it, *next);
-				swapped = true;
-			}
-			it = next;
-		}
-		if (!swapped) break;
-	}
-}
-
-//*****************
-// Template Function: recursiveSort
-// Purpose: Recursively sorts a container and its nested containers (if any) using the provided comparator.
-// Parameters:
-//    - container: A reference to a container that may contain nested containers to be sorted.
-//    - compare: A comparator function or functor for custom sorting (default: greater).
-// Returns: void
-//*****************
-template <typename Container, typename Comparator = std::greater<typename Container::value_type>>
-void recursiveSort(Container& container, Comparator compare = Comparator())
-{
-	// If elements of the container are themselves containers, sort them recursively
-	if constexpr (is_container<typename Container::value_type>::value) // If subContainer is a container
-	{
-		for (auto& subContainer : container)
-		{
-			recursiveSort(subContainer, compare); // Recursively sort nested containers
-		}
-	}
-	else // Base case: Sort if it's not a nested container
-	{
-		bubbleSort(container, compare);
-	}
-}
+#include "bubblesort/bubblesort.hpp"
 
 int main()
 {
@@ -300,5 +77,69 @@ int main()
 	printNDVector(list3D);
 	std::cout << "\n";
 
-	return 0;
+	std::vector<std::string> vecStr = { "pear", "apple", "fig", "banana", "cherry", "apricot" };
+	std::cout << "Original string vector: ";
+	printContainer(vecStr);
+	recursiveSort(vecStr); // Whole strings, ascending
+	std::cout << "Sorted string vector (Ascending): ";
+	printContainer(vecStr);
+	std::cout << "\n";
+
+	std::vector<std::vector<std::string>> vecStr2D = { {"cab", "abc", "zz"}, {"dog", "cat", "bird"} };
+	std::cout << "Original 2D string vector:\n";
+	printNDVector(vecStr2D);
+	recursiveSort(vecStr2D, AlphabeticalPosition()); // Sum of alphabetical positions
+	std::cout << "Sorted 2D string vector (Alphabetical position):\n";
+	printNDVector(vecStr2D);
+	std::cout << "\n";
+
+	StringTable tableStr = { "pear", "apple", "fig", "banana", "cherry", "apricot" };
+	std::cout << "Original string table: ";
+	printContainer(tableStr);
+	recursiveSort(tableStr, std::less<std::string_view>()); // Records are permuted, characters stay in the arena
+	std::cout << "Sorted string table (Descending): ";
+	printContainer(tableStr);
+	std::cout << "\n";
+
+	std::vector<std::string> vecNames = { "Zoe", "\xC3\xA9mile", "adam", "Eve", "\xC3\x89lodie", "bob", "eli" };
+	std::cout << "Original name vector: ";
+	printContainer(vecNames);
+	recursiveSort(vecNames, Utf8CollatedOrder()); // Case- and accent-insensitive first, then accents, then case
+	std::cout << "Sorted name vector (UTF-8 collation): ";
+	printContainer(vecNames);
+	std::cout << "\n";
+
+	std::vector<std::vector<std::string>> vecFiles2D = { {"img12.png", "img10.png", "img2.png", "img1.png"}, {"v1.10", "v1.9", "v1.09", "v1.1"} };
+	std::cout << "Original 2D file name vector:\n";
+	printNDVector(vecFiles2D);
+	recursiveSort(vecFiles2D, NaturalOrder<>()); // Digit runs compare as numbers
+	std::cout << "Sorted 2D file name vector (Natural order):\n";
+	printNDVector(vecFiles2D);
+	std::cout << "\n";
+
+	std::vector<int> vecKeys = { 234, 56, 123, 12, 345, 678 };
+	std::cout << "Original 1D vector: ";
+	printContainer(vecKeys);
+	recursiveSort(vecKeys, std::greater<int>(), DigitSum()); // Projection: ascending digit sums
+	std::cout << "Sorted 1D vector (Projected digit sums, ascending): ";
+	printContainer(vecKeys);
+	std::cout << "\n";
+
+	std::vector<int> vecLarge = generateData<int>(100000);
+	SortReport report;
+	recursiveSort(vecLarge, std::greater<int>(), SortOptions(SortEngine::Automatic, 0, &report)); // No scratch memory allowed
+	const bool sorted = std::is_sorted(vecLarge.begin(), vecLarge.end());
+	std::cout << "Sorted 100000 integers in place: " << sortAlgorithmName(report.last) << ", peak scratch "
+		<< report.peakScratchBytes << " bytes, " << (sorted ? "sorted" : "NOT sorted") << "\n";
+	std::cout << "\n";
+
+	std::stringstream compact(std::ios::in | std::ios::out | std::ios::binary);
+	writeCompact(compact, vecLarge);
+	std::vector<int> vecDecoded;
+	const bool decoded = readCompact(compact, vecDecoded) && vecDecoded == vecLarge;
+	std::cout << "Compact output of the 100000 sorted integers: " << compact.str().size() << " bytes, "
+		<< (decoded ? "decoded" : "NOT decoded") << "\n";
+	std::cout << "\n";
+
+	return sorted && decoded ? 0 : 1;
 }
\ No newline at end of file
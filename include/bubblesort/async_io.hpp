@@ -0,0 +1,711 @@
+//*****************
+// bubblesort/async_io.hpp
+// Positional file I/O, read-only file mappings and asynchronous read/write requests (io_uring on Linux,
+// worker threads elsewhere).
+//*****************
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>  // for std::max
+#include <atomic>
+#include <chrono>     // for std::chrono::milliseconds
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>    // for std::getenv
+#include <cstring>    // for std::memset and std::strcmp
+#include <filesystem>
+#include <memory>
+#include <stdexcept>  // for std::length_error
+#include <utility>    // for std::swap
+
+// POSIX file descriptors give positional reads and writes without a shared file position
+#if defined(__unix__) || defined(__APPLE__)
+#define BUBBLESORT_POSIX_IO 1
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define BUBBLESORT_POSIX_IO 0
+#endif
+
+// io_uring is driven through raw system calls, so only the kernel header is needed (no liburing).
+// Define BUBBLESORT_IO_URING=0 to always use the worker threads.
+#ifndef BUBBLESORT_IO_URING
+#if BUBBLESORT_POSIX_IO && defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define BUBBLESORT_IO_URING 1
+#endif
+#endif
+#endif
+#ifndef BUBBLESORT_IO_URING
+#define BUBBLESORT_IO_URING 0
+#endif
+
+#if BUBBLESORT_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+// Requests an AsyncIo can have in flight at once
+constexpr unsigned kAsyncIoQueueDepth = 128;
+
+// Worker threads of the AsyncIo fallback
+constexpr unsigned kAsyncIoThreads = 2;
+
+// Times io_uring_enter is retried after a transient error before a request or the ring is given up
+constexpr unsigned kAsyncIoRetries = 1000;
+
+//*****************
+// Class: IoFile
+// Purpose: A file opened for positional reads and writes, closed on destruction. Temporary files are
+//          created exclusively and deleted once closed. Reads and writes at different offsets may run
+//          concurrently from several threads.
+//*****************
+class IoFile
+{
+public:
+	IoFile() = default;
+	~IoFile() { close(); }
+	IoFile(const IoFile&) = delete;
+	IoFile& operator=(const IoFile&) = delete;
+	IoFile(IoFile&& other) noexcept { swap(other); }
+	IoFile& operator=(IoFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			swap(other);
+		}
+		return *this;
+	}
+
+	//*****************
+	// Function name: openRead
+	// Purpose: Opens an existing file for reading. Returns false on failure.
+	//*****************
+	bool openRead(const std::string& path)
+	{
+		close();
+#if BUBBLESORT_POSIX_IO
+		fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		return fd_ >= 0;
+#else
+		file_ = std::fopen(path.c_str(), "rb");
+		return file_ != nullptr;
+#endif
+	}
+
+	//*****************
+	// Function name: openWrite
+	// Purpose: Creates or truncates a file for writing. Returns false on failure.
+	//*****************
+	bool openWrite(const std::string& path)
+	{
+		close();
+#if BUBBLESORT_POSIX_IO
+		fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		return fd_ >= 0;
+#else
+		file_ = std::fopen(path.c_str(), "wb");
+		return file_ != nullptr;
+#endif
+	}
+
+	//*****************
+	// Function name: openTemporary
+	// Purpose: Creates a new, uniquely named file for reading and writing in a directory (the system
+	//          temporary directory when empty), deleted once closed. Returns false on failure.
+	//*****************
+	bool openTemporary(const std::string& directory)
+	{
+		close();
+		static std::atomic<std::size_t> counter{ 0 };
+		std::error_code error;
+		const std::filesystem::path base = directory.empty() ? std::filesystem::temp_directory_path(error) : std::filesystem::path(directory);
+		if (error) return false;
+		for (int attempt = 0; attempt < 100; ++attempt)
+		{
+			const std::string path = (base / ("bubblesort-" + std::to_string(reinterpret_cast<std::size_t>(&counter) >> 4) + "-" + std::to_string(counter++) + ".run")).string();
+#if BUBBLESORT_POSIX_IO
+			fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+			if (fd_ >= 0)
+			{
+				::unlink(path.c_str()); // The open descriptor keeps the data until it is closed
+				return true;
+			}
+#else
+			file_ = std::fopen(path.c_str(), "w+bx");
+			if (file_ != nullptr)
+			{
+				removePath_ = path;
+				return true;
+			}
+#endif
+		}
+		return false;
+	}
+
+	//*****************
+	// Function name: readAt
+	// Purpose: Reads exactly bytes bytes at offset. Returns false on an error or at the end of the file.
+	//*****************
+	bool readAt(void* buffer, std::size_t bytes, std::uint64_t offset) const
+	{
+		char* out = static_cast<char*>(buffer);
+#if BUBBLESORT_POSIX_IO
+		while (bytes > 0)
+		{
+			const ssize_t done = ::pread(fd_, out, bytes, static_cast<off_t>(offset));
+			if (done < 0 && errno == EINTR) continue;
+			if (done <= 0) return false;
+			out += done;
+			bytes -= static_cast<std::size_t>(done);
+			offset += static_cast<std::uint64_t>(done);
+		}
+		return true;
+#else
+		std::lock_guard<std::mutex> lock(*mutex_);
+		return bytes == 0 || (_fseeki64(file_, static_cast<long long>(offset), SEEK_SET) == 0 && std::fread(out, 1, bytes, file_) == bytes);
+#endif
+	}
+
+	//*****************
+	// Function name: writeAt
+	// Purpose: Writes exactly bytes bytes at offset. Returns false on an error.
+	//*****************
+	bool writeAt(const void* buffer, std::size_t bytes, std::uint64_t offset) const
+	{
+		const char* in = static_cast<const char*>(buffer);
+#if BUBBLESORT_POSIX_IO
+		while (bytes > 0)
+		{
+			const ssize_t done = ::pwrite(fd_, in, bytes, static_cast<off_t>(offset));
+			if (done < 0 && errno == EINTR) continue;
+			if (done <= 0) return false;
+			in += done;
+			bytes -= static_cast<std::size_t>(done);
+			offset += static_cast<std::uint64_t>(done);
+		}
+		return true;
+#else
+		std::lock_guard<std::mutex> lock(*mutex_);
+		return bytes == 0 || (_fseeki64(file_, static_cast<long long>(offset), SEEK_SET) == 0 && std::fwrite(in, 1, bytes, file_) == bytes);
+#endif
+	}
+
+	//*****************
+	// Function name: size
+	// Purpose: Returns the size of the file in bytes, or 0 when it cannot be determined.
+	//*****************
+	std::uint64_t size() const
+	{
+#if BUBBLESORT_POSIX_IO
+		struct stat status;
+		return ::fstat(fd_, &status) == 0 ? static_cast<std::uint64_t>(status.st_size) : 0;
+#else
+		std::lock_guard<std::mutex> lock(*mutex_);
+		if (_fseeki64(file_, 0, SEEK_END) != 0) return 0;
+		const long long end = _ftelli64(file_);
+		return end < 0 ? 0 : static_cast<std::uint64_t>(end);
+#endif
+	}
+
+	//*****************
+	// Function name: close
+	// Purpose: Closes the file. Returns false when closing reported an error (e.g. a failed delayed write).
+	//*****************
+	bool close() noexcept
+	{
+		bool ok = true;
+#if BUBBLESORT_POSIX_IO
+		if (fd_ >= 0) ok = ::close(fd_) == 0;
+		fd_ = -1;
+#else
+		if (file_ != nullptr) ok = std::fclose(file_) == 0;
+		file_ = nullptr;
+		if (!removePath_.empty()) std::remove(removePath_.c_str());
+		removePath_.clear();
+#endif
+		return ok;
+	}
+
+	bool isOpen() const noexcept
+	{
+#if BUBBLESORT_POSIX_IO
+		return fd_ >= 0;
+#else
+		return file_ != nullptr;
+#endif
+	}
+
+#if BUBBLESORT_POSIX_IO
+	// The file descriptor, for submitting requests to the kernel
+	int descriptor() const noexcept { return fd_; }
+#endif
+
+private:
+	void swap(IoFile& other) noexcept
+	{
+#if BUBBLESORT_POSIX_IO
+		std::swap(fd_, other.fd_);
+#else
+		std::swap(file_, other.file_);
+		std::swap(mutex_, other.mutex_);
+		std::swap(removePath_, other.removePath_);
+#endif
+	}
+
+#if BUBBLESORT_POSIX_IO
+	int fd_ = -1;
+#else
+	std::FILE* file_ = nullptr;
+	std::unique_ptr<std::mutex> mutex_ = std::make_unique<std::mutex>(); // Serializes seek + transfer
+	std::string removePath_;
+#endif
+};
+
+//*****************
+// Class: MappedFile
+// Purpose: A whole file mapped read-only into memory, unmapped on destruction. Pages are loaded on first
+//          access, so readers that skip parts of the file never read them. Without POSIX mappings the file
+//          is read into a buffer instead.
+//*****************
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile() { close(); }
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	//*****************
+	// Function name: open
+	// Purpose: Maps an existing file. Returns false on failure.
+	//*****************
+	bool open(const std::string& path)
+	{
+		close();
+		IoFile file;
+		if (!file.openRead(path)) return false;
+		const std::uint64_t bytes = file.size();
+		size_ = static_cast<std::size_t>(bytes);
+		if (size_ == 0) return true;
+#if BUBBLESORT_POSIX_IO
+		void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file.descriptor(), 0);
+		if (mapping == MAP_FAILED)
+		{
+			size_ = 0;
+			return false;
+		}
+		data_ = static_cast<const unsigned char*>(mapping);
+		return true;
+#else
+		buffer_.resize(size_);
+		data_ = buffer_.data();
+		if (file.readAt(buffer_.data(), size_, 0)) return true;
+		close();
+		return false;
+#endif
+	}
+
+	void close() noexcept
+	{
+#if BUBBLESORT_POSIX_IO
+		if (data_ != nullptr) ::munmap(const_cast<unsigned char*>(data_), size_);
+#else
+		std::vector<unsigned char>().swap(buffer_);
+#endif
+		data_ = nullptr;
+		size_ = 0;
+	}
+
+	const unsigned char* data() const noexcept { return data_; }
+	std::size_t size() const noexcept { return size_; }
+
+private:
+	const unsigned char* data_ = nullptr;
+	std::size_t size_ = 0;
+#if !BUBBLESORT_POSIX_IO
+	std::vector<unsigned char> buffer_;
+#endif
+};
+
+//*****************
+// Class: AsyncIo
+// Purpose: Runs positional reads and writes of IoFiles in the background, so a caller can sort or merge
+//          while the disk works. On Linux the requests go to an io_uring submission queue set up with raw
+//          system calls; where io_uring is unavailable (old kernels, seccomp filters, other systems, or
+//          BUBBLESORT_ASYNC_IO=threads in the environment) a small pool of worker threads performs them.
+//          Requests are submitted and waited for by one thread; at most kAsyncIoQueueDepth may be in flight.
+//          Errors never escape as exceptions. A request the kernel refuses is reported failed by wait; if
+//          waiting for completions keeps failing, the requests in flight are cancelled (their buffers stay in
+//          use until the kernel reports them finished) and later requests run synchronously.
+//*****************
+class AsyncIo
+{
+public:
+	using Ticket = std::size_t;
+
+	AsyncIo() : requests_(kAsyncIoQueueDepth)
+	{
+		const char* requested = std::getenv("BUBBLESORT_ASYNC_IO");
+		const bool threadsRequested = requested != nullptr && std::strcmp(requested, "threads") == 0;
+#if BUBBLESORT_IO_URING
+		if (!threadsRequested && setupRing(kAsyncIoQueueDepth)) return;
+#else
+		(void)threadsRequested;
+#endif
+		for (unsigned t = 0; t < kAsyncIoThreads; ++t) workers_.emplace_back([this] { workerLoop(); });
+	}
+
+	~AsyncIo()
+	{
+		for (Ticket ticket = 0; ticket < requests_.size(); ++ticket)
+		{
+			if (requests_[ticket].state != State::Free) wait(ticket);
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		workAvailable_.notify_all();
+		for (std::thread& worker : workers_) worker.join();
+#if BUBBLESORT_IO_URING
+		teardownRing();
+#endif
+	}
+
+	AsyncIo(const AsyncIo&) = delete;
+	AsyncIo& operator=(const AsyncIo&) = delete;
+
+	// The backend in use: "io_uring" or "threads"
+	const char* backendName() const noexcept { return workers_.empty() ? "io_uring" : "threads"; }
+
+	//*****************
+	// Function name: read
+	// Purpose: Starts reading bytes bytes at offset of a file into buffer; both must stay valid until waited for.
+	// Returns: The ticket to wait for.
+	//*****************
+	Ticket read(const IoFile& file, void* buffer, std::size_t bytes, std::uint64_t offset)
+	{
+		return submit(file, static_cast<char*>(buffer), bytes, offset, false);
+	}
+
+	//*****************
+	// Function name: write
+	// Purpose: Starts writing bytes bytes from buffer at offset of a file; both must stay valid until waited for.
+	// Returns: The ticket to wait for.
+	//*****************
+	Ticket write(const IoFile& file, const void* buffer, std::size_t bytes, std::uint64_t offset)
+	{
+		return submit(file, const_cast<char*>(static_cast<const char*>(buffer)), bytes, offset, true);
+	}
+
+	//*****************
+	// Function name: wait
+	// Purpose: Blocks until a request has finished and releases its ticket.
+	// Returns: true when every byte was transferred, false on an error or a read past the end of the file.
+	//*****************
+	bool wait(Ticket ticket)
+	{
+		Request& request = requests_[ticket];
+		if (workers_.empty())
+		{
+#if BUBBLESORT_IO_URING
+			while (request.state != State::Done) reapRing(true);
+#endif
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			requestDone_.wait(lock, [&request] { return request.state == State::Done; });
+		}
+		request.state = State::Free;
+		return request.ok;
+	}
+
+private:
+	enum class State { Free, Pending, Done };
+
+	struct Request
+	{
+		const IoFile* file = nullptr;
+		char* buffer = nullptr;
+		std::size_t bytes = 0;
+		std::uint64_t offset = 0;
+		bool write = false;
+		bool ok = false;
+		State state = State::Free;
+#if BUBBLESORT_IO_URING
+		iovec vector{};
+#endif
+	};
+
+	Ticket submit(const IoFile& file, char* buffer, std::size_t bytes, std::uint64_t offset, bool write)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		Ticket ticket = 0;
+		while (ticket < requests_.size() && requests_[ticket].state != State::Free) ++ticket;
+		if (ticket == requests_.size()) throw std::length_error("AsyncIo: too many requests in flight");
+		Request& request = requests_[ticket];
+		request.file = &file;
+		request.buffer = buffer;
+		request.bytes = bytes;
+		request.offset = offset;
+		request.write = write;
+		request.ok = false;
+		request.state = State::Pending;
+		if (!workers_.empty())
+		{
+			queue_.push_back(ticket);
+			lock.unlock();
+			workAvailable_.notify_one();
+			return ticket;
+		}
+#if BUBBLESORT_IO_URING
+		lock.unlock();
+		if (ringFailed_)
+		{
+			request.ok = write ? file.writeAt(buffer, bytes, offset) : file.readAt(buffer, bytes, offset);
+			request.state = State::Done;
+		}
+		else
+		{
+			submitRing(ticket);
+		}
+#endif
+		return ticket;
+	}
+
+	void workerLoop()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		for (;;)
+		{
+			workAvailable_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+			if (queue_.empty()) return;
+			Request& request = requests_[queue_.front()];
+			queue_.pop_front();
+			lock.unlock();
+			const bool ok = request.write ? request.file->writeAt(request.buffer, request.bytes, request.offset)
+				: request.file->readAt(request.buffer, request.bytes, request.offset);
+			lock.lock();
+			request.ok = ok;
+			request.state = State::Done;
+			requestDone_.notify_all();
+		}
+	}
+
+	std::vector<Request> requests_;
+	std::vector<std::thread> workers_;
+	std::deque<Ticket> queue_;
+	std::mutex mutex_;
+	std::condition_variable workAvailable_;
+	std::condition_variable requestDone_;
+	bool stopping_ = false;
+
+#if BUBBLESORT_IO_URING
+	// Maps the submission and completion rings and the submission entries of a new io_uring instance
+	bool setupRing(unsigned entries)
+	{
+		io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+		ringFd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+		if (ringFd_ < 0) return false;
+
+		sqMapSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cqMapSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (singleMap) sqMapSize_ = cqMapSize_ = std::max(sqMapSize_, cqMapSize_);
+		sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+
+		sqMap_ = ::mmap(nullptr, sqMapSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+		cqMap_ = singleMap ? sqMap_ : ::mmap(nullptr, cqMapSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+		void* sqes = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+		if (sqMap_ == MAP_FAILED || cqMap_ == MAP_FAILED || sqes == MAP_FAILED)
+		{
+			if (sqes != MAP_FAILED) ::munmap(sqes, sqesSize_);
+			if (cqMap_ != MAP_FAILED && cqMap_ != sqMap_) ::munmap(cqMap_, cqMapSize_);
+			if (sqMap_ != MAP_FAILED) ::munmap(sqMap_, sqMapSize_);
+			sqMap_ = cqMap_ = nullptr;
+			::close(ringFd_);
+			ringFd_ = -1;
+			return false;
+		}
+		sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+		char* sq = static_cast<char*>(sqMap_);
+		sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+		sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+		sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+		char* cq = static_cast<char*>(cqMap_);
+		cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+		cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+		cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+		cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+		return true;
+	}
+
+	void teardownRing() noexcept
+	{
+		if (ringFd_ < 0) return;
+		::munmap(sqes_, sqesSize_);
+		if (cqMap_ != sqMap_) ::munmap(cqMap_, cqMapSize_);
+		::munmap(sqMap_, sqMapSize_);
+		::close(ringFd_);
+		ringFd_ = -1;
+	}
+
+	// Writes one submission entry at the tail of the queue and publishes it to the kernel
+	// Returns: The tail before the entry, to take it back with if io_uring_enter refuses it
+	unsigned queueEntry(std::uint8_t opcode, int fd, std::uint64_t address, unsigned length, std::uint64_t offset, std::uint64_t userData) noexcept
+	{
+		const unsigned tail = *sqTail_; // Only this thread writes the tail
+		const unsigned index = tail & sqMask_;
+		io_uring_sqe& entry = sqes_[index];
+		std::memset(&entry, 0, sizeof(entry));
+		entry.opcode = opcode;
+		entry.fd = fd;
+		entry.addr = address;
+		entry.len = length;
+		entry.off = offset;
+		entry.user_data = userData;
+		sqArray_[index] = index;
+		__atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+		return tail;
+	}
+
+	// Calls io_uring_enter, returning the number of entries submitted or the negated errno
+	int enterRing(unsigned submit, unsigned minComplete, unsigned flags) noexcept
+	{
+		const long result = ::syscall(__NR_io_uring_enter, ringFd_, submit, minComplete, flags, nullptr, 0);
+		return result < 0 ? -errno : static_cast<int>(result);
+	}
+
+	// Errors after which io_uring_enter is called again: an interrupted call, or the kernel short of resources
+	// or holding completions it could not post yet (EBUSY), which reaping makes room for
+	static bool transientEnterError(int error) noexcept { return error == -EINTR || error == -EAGAIN || error == -EBUSY; }
+
+	// Queues one vectored read or write and tells the kernel about it, retrying transient errors after reaping
+	// completions. An entry the kernel refuses is taken back off the queue and only its request fails
+	void submitRing(Ticket ticket) noexcept
+	{
+		Request& request = requests_[ticket];
+		request.vector.iov_base = request.buffer;
+		request.vector.iov_len = request.bytes;
+		for (unsigned attempt = 0; !ringFailed_; ++attempt)
+		{
+			const unsigned tail = queueEntry(request.write ? IORING_OP_WRITEV : IORING_OP_READV, request.file->descriptor(),
+				reinterpret_cast<std::uint64_t>(&request.vector), 1, request.offset, ticket);
+			int result;
+			do result = enterRing(1, 0, 0); while (result == -EINTR);
+			if (result > 0)
+			{
+				++inFlight_;
+				return;
+			}
+			// A failed enter consumed no entries, and without SQPOLL the kernel reads the queue only during one
+			__atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+			if (!transientEnterError(result) && result != 0) break;
+			if (attempt == kAsyncIoRetries) break;
+			if (inFlight_ > 0) reapRing(true);
+			else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		if (ringFailed_) // The ring was given up while retrying, and the kernel never saw this request
+		{
+			request.ok = request.write ? request.file->writeAt(request.buffer, request.bytes, request.offset)
+				: request.file->readAt(request.buffer, request.bytes, request.offset);
+		}
+		request.state = State::Done;
+	}
+
+	// Gives up on the ring after waiting for completions kept failing. The kernel may still be transferring
+	// to or from the buffers of accepted requests, so they are cancelled and stay pending until their
+	// completions are reaped; requests issued from now on run synchronously
+	void abandonRing() noexcept
+	{
+		ringFailed_ = true;
+		const unsigned tail = *sqTail_;
+		unsigned cancels = 0;
+		for (Ticket ticket = 0; ticket < requests_.size(); ++ticket)
+		{
+			if (requests_[ticket].state != State::Pending) continue;
+			queueEntry(IORING_OP_ASYNC_CANCEL, -1, ticket, 0, 0, kCancelTicket);
+			++cancels;
+		}
+		if (cancels == 0) return;
+		int result;
+		do result = enterRing(cancels, 0, 0); while (result == -EINTR);
+		if (result < 0) __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE); // The requests then finish uncancelled
+	}
+
+	// Completes every finished request, blocking for at least one when block is true. A request is only
+	// reported done once its completion has been reaped, even after the ring was given up
+	void reapRing(bool block) noexcept
+	{
+		unsigned head = *cqHead_;
+		const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+		if (head == tail)
+		{
+			if (!block) return;
+			const int result = enterRing(0, 1, IORING_ENTER_GETEVENTS);
+			if (result >= 0) enterFailures_ = 0;
+			if (result >= 0 || result == -EINTR) return;
+			if (!ringFailed_ && (!transientEnterError(result) || ++enterFailures_ > kAsyncIoRetries))
+			{
+				abandonRing();
+				return;
+			}
+			// Completions are still posted to the mapped queue; sleeping lets the kernel run deferred work
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			return;
+		}
+		for (; head != tail; ++head)
+		{
+			const io_uring_cqe& completion = cqes_[head & cqMask_];
+			if (completion.user_data == kCancelTicket) continue;
+			Request& request = requests_[static_cast<Ticket>(completion.user_data)];
+			const std::size_t done = completion.res < 0 ? 0 : static_cast<std::size_t>(completion.res);
+			request.ok = completion.res >= 0;
+			if (request.ok && done < request.bytes) // Short transfer: finish the rest synchronously
+			{
+				request.ok = request.write ? request.file->writeAt(request.buffer + done, request.bytes - done, request.offset + done)
+					: request.file->readAt(request.buffer + done, request.bytes - done, request.offset + done);
+			}
+			request.state = State::Done;
+			--inFlight_;
+		}
+		__atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+	}
+
+	// user_data of cancellation entries, whose completions carry no request
+	static constexpr std::uint64_t kCancelTicket = ~std::uint64_t(0);
+
+	int ringFd_ = -1;
+	bool ringFailed_ = false;         // Waiting for completions failed; new requests run synchronously
+	std::size_t inFlight_ = 0;        // Requests the kernel accepted whose completions are not reaped yet
+	unsigned enterFailures_ = 0;      // Transient failures of waiting for completions since the last success
+	void* sqMap_ = nullptr;
+	void* cqMap_ = nullptr;
+	std::size_t sqMapSize_ = 0;
+	std::size_t cqMapSize_ = 0;
+	std::size_t sqesSize_ = 0;
+	io_uring_sqe* sqes_ = nullptr;
+	unsigned* sqTail_ = nullptr;
+	unsigned* sqArray_ = nullptr;
+	unsigned sqMask_ = 0;
+	unsigned* cqHead_ = nullptr;
+	unsigned* cqTail_ = nullptr;
+	unsigned cqMask_ = 0;
+	io_uring_cqe* cqes_ = nullptr;
+#endif
+};
@@ -0,0 +1,207 @@
+//*****************
+// bubblesort/block_codec.hpp
+// Delta and frame-of-reference bit-packing of sorted integer blocks, decoded with SIMD shifts and prefix sums.
+//*****************
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>    // for std::memcpy
+#include <limits>
+#include <type_traits>
+
+#include "simd_dispatch.hpp"
+#include "integer_sort.hpp"
+
+// Integers per packed block; the deltas of a block are packed four lanes wide, 32 per lane
+constexpr std::size_t kPackedBlock = 128;
+
+// Width byte of blocks whose deltas do not fit 32 bits; their keys are stored unpacked
+constexpr unsigned char kPackedRawWidth = 0xFF;
+
+//*****************
+// Template Function: packedHeaderBytes
+// Purpose: Returns the size of a packed block's header: the count minus one, the bit width and the first key.
+//*****************
+template <typename T>
+constexpr std::size_t packedHeaderBytes() noexcept
+{
+	return 2 + sizeof(T);
+}
+
+//*****************
+// Template Function: maxPackedBlockBytes
+// Purpose: Returns the largest size a packed block of T can take.
+//*****************
+template <typename T>
+constexpr std::size_t maxPackedBlockBytes() noexcept
+{
+	return packedHeaderBytes<T>() + std::max(kPackedBlock / 8 * 32, (kPackedBlock - 1) * sizeof(T));
+}
+
+//*****************
+// Template Function: packedBlockBytes
+// Purpose: Returns the size of the packed block starting at block, read from its first two header bytes.
+//*****************
+template <typename T>
+constexpr std::size_t packedBlockBytes(const unsigned char* block) noexcept
+{
+	return packedHeaderBytes<T>() + (block[1] == kPackedRawWidth ? block[0] * sizeof(T) : block[1] * (kPackedBlock / 8));
+}
+
+//*****************
+// Template Function: packSortedBlock
+// Purpose: Encodes up to kPackedBlock sorted integers. The first key is stored whole and every later one as its
+//          delta to the one before, bit-packed at the width of the largest delta. Delta i goes to lane i % 4
+//          as entry i / 4, and each lane fills its own column of 32-bit words, so a decoder unpacks four
+//          consecutive deltas per vector step. Blocks whose deltas need more than 32 bits store their keys.
+// Parameters:
+//    - values: The integers, sorted in the order descending selects.
+//    - count: Number of integers (1 to kPackedBlock).
+//    - descending: The integers are in descending order.
+//    - out: Receives the block; needs maxPackedBlockBytes<T>() bytes.
+// Returns: The size of the block.
+//*****************
+template <typename T>
+std::size_t packSortedBlock(const T* values, std::size_t count, bool descending, unsigned char* out) noexcept
+{
+	using Key = typename std::make_unsigned<T>::type;
+	const Key flip = descending ? std::numeric_limits<Key>::max() : 0;
+	Key keys[kPackedBlock];
+	std::uint32_t deltas[kPackedBlock] = {};
+	std::uint64_t widest = 0;
+	keys[0] = static_cast<Key>(radixKey(values[0]) ^ flip);
+	for (std::size_t i = 1; i < count; ++i)
+	{
+		keys[i] = static_cast<Key>(radixKey(values[i]) ^ flip);
+		const std::uint64_t delta = static_cast<Key>(keys[i] - keys[i - 1]);
+		widest |= delta;
+		deltas[i] = static_cast<std::uint32_t>(delta);
+	}
+
+	out[0] = static_cast<unsigned char>(count - 1);
+	std::memcpy(out + 2, &keys[0], sizeof(Key));
+	unsigned char* payload = out + packedHeaderBytes<T>();
+	if (widest > std::numeric_limits<std::uint32_t>::max())
+	{
+		out[1] = kPackedRawWidth;
+		std::memcpy(payload, keys + 1, (count - 1) * sizeof(Key));
+		return packedHeaderBytes<T>() + (count - 1) * sizeof(Key);
+	}
+
+	unsigned width = 0;
+	while (width < 32 && (widest >> width) != 0) ++width;
+	out[1] = static_cast<unsigned char>(width);
+	std::uint32_t words[kPackedBlock / 32 * 32] = {};
+	for (std::size_t i = 0; width > 0 && i < kPackedBlock; ++i)
+	{
+		const std::size_t lane = i % 4, bit = (i / 4) * width;
+		const std::size_t word = bit / 32, shift = bit % 32;
+		words[word * 4 + lane] |= deltas[i] << shift;
+		if (shift + width > 32) words[(word + 1) * 4 + lane] |= deltas[i] >> (32 - shift);
+	}
+	std::memcpy(payload, words, width * (kPackedBlock / 8));
+	return packedHeaderBytes<T>() + width * (kPackedBlock / 8);
+}
+
+//*****************
+// Function name: unpackDeltas
+// Purpose: Unpacks the kPackedBlock deltas of a bit-packed block, four lanes per step. When base is given
+//          the deltas are also prefix summed onto it (wrapping at 32 bits), producing the keys themselves.
+// Parameters:
+//    - words: The packed words (4 * width of them).
+//    - width: The bit width of every delta (1 to 32).
+//    - prefix: Adds every delta to the sum of those before it and base.
+//    - base: The key before the first delta.
+//    - out: Receives kPackedBlock values.
+// Returns: void
+//*****************
+inline void unpackDeltas(const std::uint32_t* words, unsigned width, bool prefix, std::uint32_t base, std::uint32_t* out) noexcept
+{
+#if BUBBLESORT_X86_SIMD
+	const __m128i mask = _mm_set1_epi32(width == 32 ? -1 : static_cast<int>((1u << width) - 1));
+	__m128i carry = _mm_set1_epi32(static_cast<int>(base));
+	for (std::size_t step = 0; step < kPackedBlock / 4; ++step)
+	{
+		const std::size_t bit = step * width, word = bit / 32, shift = bit % 32;
+		__m128i lanes = _mm_srl_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(words + word * 4)), _mm_cvtsi32_si128(static_cast<int>(shift)));
+		if (shift + width > 32)
+		{
+			const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + (word + 1) * 4));
+			lanes = _mm_or_si128(lanes, _mm_sll_epi32(high, _mm_cvtsi32_si128(static_cast<int>(32 - shift))));
+		}
+		lanes = _mm_and_si128(lanes, mask);
+		if (prefix)
+		{
+			// In-register inclusive scan of the four deltas, then the running key of the previous step
+			lanes = _mm_add_epi32(lanes, _mm_slli_si128(lanes, 4));
+			lanes = _mm_add_epi32(lanes, _mm_slli_si128(lanes, 8));
+			lanes = _mm_add_epi32(lanes, carry);
+			carry = _mm_shuffle_epi32(lanes, _MM_SHUFFLE(3, 3, 3, 3));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + step * 4), lanes);
+	}
+#else
+	const std::uint32_t mask = width == 32 ? ~0u : (1u << width) - 1;
+	std::uint32_t key = base;
+	for (std::size_t i = 0; i < kPackedBlock; ++i)
+	{
+		const std::size_t lane = i % 4, bit = (i / 4) * width;
+		const std::size_t word = bit / 32, shift = bit % 32;
+		std::uint32_t delta = words[word * 4 + lane] >> shift;
+		if (shift + width > 32) delta |= words[(word + 1) * 4 + lane] << (32 - shift);
+		delta &= mask;
+		out[i] = prefix ? (key += delta) : delta;
+	}
+#endif
+}
+
+//*****************
+// Template Function: unpackSortedBlock
+// Purpose: Decodes a block written by packSortedBlock. Keys of up to 32 bits are rebuilt by unpackDeltas'
+//          vector prefix sums; 64-bit keys add the unpacked deltas one by one.
+// Parameters:
+//    - block: The packed block.
+//    - descending: The value packSortedBlock was given.
+//    - values: Receives the integers; needs room for kPackedBlock of them.
+// Returns: The number of integers decoded.
+//*****************
+template <typename T>
+std::size_t unpackSortedBlock(const unsigned char* block, bool descending, T* values) noexcept
+{
+	using Key = typename std::make_unsigned<T>::type;
+	const Key flip = descending ? std::numeric_limits<Key>::max() : 0;
+	const std::size_t count = static_cast<std::size_t>(block[0]) + 1;
+	const unsigned width = block[1];
+	Key keys[kPackedBlock];
+	std::memcpy(&keys[0], block + 2, sizeof(Key));
+	const unsigned char* payload = block + packedHeaderBytes<T>();
+
+	if (width == kPackedRawWidth)
+	{
+		std::memcpy(keys + 1, payload, (count - 1) * sizeof(Key));
+	}
+	else if (width == 0)
+	{
+		std::fill(keys + 1, keys + count, keys[0]);
+	}
+	else
+	{
+		std::uint32_t words[kPackedBlock / 32 * 32];
+		std::uint32_t unpacked[kPackedBlock];
+		std::memcpy(words, payload, width * (kPackedBlock / 8));
+		if constexpr (sizeof(Key) <= sizeof(std::uint32_t))
+		{
+			unpackDeltas(words, width, true, keys[0], unpacked);
+			for (std::size_t i = 1; i < count; ++i) keys[i] = static_cast<Key>(unpacked[i]);
+		}
+		else
+		{
+			unpackDeltas(words, width, false, 0, unpacked);
+			for (std::size_t i = 1; i < count; ++i) keys[i] = static_cast<Key>(keys[i - 1] + unpacked[i]);
+		}
+	}
+	for (std::size_t i = 0; i < count; ++i) values[i] = fromRadixKey<T>(static_cast<Key>(keys[i] ^ flip));
+	return count;
+}
@@ -0,0 +1,33 @@
+//*****************
+// bubblesort/bubblesort.hpp
+// Umbrella header: include this to use the whole sort library.
+//*****************
+#pragma once
+
+#include "functors.hpp"
+#include "traits.hpp"
+#include "print.hpp"
+#include "simd_dispatch.hpp"
+#include "simd_kernels.hpp"
+#include "parallel.hpp"
+#include "sort_engine.hpp"
+#include "string_sort.hpp"
+#include "string_table.hpp"
+#include "integer_sort.hpp"
+#include "distinct_sort.hpp"
+#include "group_by.hpp"
+#include "projection.hpp"
+#include "record_sort.hpp"
+#include "collation.hpp"
+#include "natural_sort.hpp"
+#include "class_partition.hpp"
+#include "block_codec.hpp"
+#include "compact_io.hpp"
+#include "async_io.hpp"
+#include "columnar_io.hpp"
+#include "search_tree.hpp"
+#include "fence_index.hpp"
+#include "set_ops.hpp"
+#include "external_sort.hpp"
+#include "sort.hpp"
+#include "generators.hpp"
@@ -0,0 +1,133 @@
+//*****************
+// bubblesort/class_partition.hpp
+// Stable multi-way partition of elements into the classes of a classifier, the first stage of sorting with
+// comparators that order whole classes one after another (OddFirst, EvenFirst, DivisibleBy3First).
+//*****************
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <utility>    // for std::move
+
+#include "functors.hpp"
+#include "traits.hpp"
+#include "parallel.hpp"
+
+// Largest number of classes a partition can have: class ids are stored in one byte per element
+constexpr std::size_t kMaxPartitionClasses = 256;
+
+//*****************
+// Template Function: classifyElements
+// Purpose: Writes the class of every element to ids. The loop has no dependencies between elements, so the
+//          compiler vectorizes it for simple classifiers such as a remainder by a constant.
+// Parameters:
+//    - data: Pointer to the elements.
+//    - n: Number of elements.
+//    - classify: A callable mapping an element to its class.
+//    - ids: Output of n class ids.
+// Returns: void
+//*****************
+template <typename T, typename Classify>
+void classifyElements(const T* data, std::size_t n, Classify& classify, unsigned char* ids)
+{
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		ids[i] = static_cast<unsigned char>(classify(data[i]));
+	}
+}
+
+//*****************
+// Template Function: classifyElements
+// Purpose: Writes the classes of ints under a DivisibilityClass classifier with the classifyDivisible SIMD
+//          kernel, which tests divisibility with a multiply instead of a division per element.
+//*****************
+template <int Divisor, bool DivisibleFirst>
+void classifyElements(const int* data, std::size_t n, DivisibilityClass<Divisor, DivisibleFirst>&, unsigned char* ids)
+{
+	simdKernels().classifyDivisible(data, n, static_cast<unsigned>(Divisor), DivisibleFirst, ids);
+}
+
+//*****************
+// Template Function: partitionClasses
+// Purpose: Stably moves the elements of src into dst grouped by class: every element of class 0 first, in
+//          their original order, then class 1 and so on. Every thread classifies its chunk once, storing the
+//          ids and counting them into a private histogram, and then scatters the same chunk by the stored
+//          ids, so the classifier runs once per element.
+// Parameters:
+//    - src: Pointer to the n elements to be partitioned.
+//    - dst: Pointer to n elements of output storage (must not overlap src).
+//    - n: Number of elements.
+//    - classes: Number of classes, at most kMaxPartitionClasses.
+//    - classify: A callable mapping an element to its class in [0, classes).
+//    - counts: Output of classes counters, the number of elements in each class.
+// Returns: void
+//*****************
+template <typename T, typename Classify>
+void partitionClasses(T* src, T* dst, std::size_t n, std::size_t classes, Classify classify, std::size_t* counts)
+{
+	WorkerPool pool(sortThreadCount(n)); // Started once for both passes
+	const unsigned threads = pool.size();
+	std::vector<unsigned char> ids(n);
+	std::vector<std::size_t> histograms(threads * classes);
+	pool.run([&](unsigned t)
+	{
+		const std::size_t begin = chunkBegin(n, threads, t);
+		const std::size_t end = chunkBegin(n, threads, t + 1);
+		Classify local = classify;
+		classifyElements(src + begin, end - begin, local, ids.data() + begin);
+		std::size_t* histogram = histograms.data() + t * classes;
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			++histogram[ids[i]];
+		}
+	});
+	sumHistograms(histograms.data(), classes, threads, counts);
+
+	std::vector<std::size_t> offsets(threads * classes);
+	scatterOffsets(histograms.data(), classes, threads, offsets.data());
+	pool.run([&](unsigned t)
+	{
+		std::size_t* next = offsets.data() + t * classes;
+		const std::size_t end = chunkBegin(n, threads, t + 1);
+		for (std::size_t i = chunkBegin(n, threads, t); i < end; ++i)
+		{
+			dst[next[ids[i]]++] = std::move(src[i]);
+		}
+	});
+}
+
+//*****************
+// Template Function: partitionScratchBytes
+// Purpose: Returns the heap scratch partitionByClass needs for n elements of type T held contiguously: the
+//          output buffer and one class id per element.
+//*****************
+template <typename T>
+constexpr std::size_t partitionScratchBytes(std::size_t n) noexcept
+{
+	return n * (sizeof(T) + 1);
+}
+
+//*****************
+// Template Function: partitionByClass
+// Purpose: Stably reorders a container so its elements are grouped by class, class 0 first, keeping their
+//          order within each class.
+// Parameters:
+//    - holder: A reference to a container of leaf elements.
+//    - classes: Number of classes, at most kMaxPartitionClasses.
+//    - classify: A callable mapping an element to its class in [0, classes), e.g. ModuloClass<3>().
+// Returns: The number of elements in each class, so class c occupies the positions after the first c counts.
+//*****************
+template <typename Container, typename Classify>
+std::vector<std::size_t> partitionByClass(Container& holder, std::size_t classes, Classify classify)
+{
+	using Value = typename Container::value_type;
+	std::vector<std::size_t> counts(classes);
+	withContiguousStorage(holder, [&](Value* data, std::size_t n)
+	{
+		std::vector<Value> partitioned(n);
+		partitionClasses(data, partitioned.data(), n, classes, classify, counts.data());
+		std::move(partitioned.begin(), partitioned.end(), data);
+	});
+	return counts;
+}
@@ -0,0 +1,269 @@
+//*****************
+// bubblesort/collation.hpp
+// Collated (case- and accent-aware) string sorting with precomputed binary sort keys.
+//*****************
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+#include "projection.hpp"
+
+//*****************
+// Enum: Collation
+// Purpose: Selects how collationKey orders strings. Both orders compare letters first, then accents
+//          (UTF-8 only), then case (lowercase first), and finally the raw bytes, so only identical
+//          strings have equal keys.
+//*****************
+enum class Collation
+{
+	AsciiCaseFold, // ASCII letters compare case-insensitively, other bytes by value
+	Utf8           // UTF-8 code points, case-folded (Latin, Greek, Cyrillic) with Latin accents and ligatures
+	               // folded to their base letters, so precomposed and decomposed accents compare equal
+};
+
+// Latin-1 Supplement (U+00C0..U+00FF) and Latin Extended-A (U+0100..U+017F) decomposed into a base
+// letter and an accent code (see collationMarkWeight); '*' marks code points handled by collationFold itself
+constexpr char kCollationLatinBase[] =
+	"AAAAAA*CEEEEIIIIDNOOOOO*OUUUUY**aaaaaa*ceeeeiiiidnooooo*ouuuuy*y"
+	"AaAaAaCcCcCcCcDdDdEeEeEeEeEeGgGgGgGgHhHhIiIiIiIiIi**JjKkkLlLlLlLlLlNnNnNnnNnOoOoOo**RrRrRrSsSsSsSsTtTtTtUuUuUuUuUuUuWwYyYZzZzZzs";
+constexpr char kCollationLatinMark[] =
+	"gactdr-Cgacdgacdstgactd-sgacda--gactdr-Cgacdgacdstgactd-sgacda-d"
+	"mmbbooaaccDDvvvvssmmbbDDoovvccbbDDCCccssttmmbbooD---ccCC-aaCCvvDDssaaCCvv-ssmmbbhh--aaCCvvaaccCCvvCCvvssttmmbbrrhhooccccdaaDDvv-";
+static_assert(sizeof(kCollationLatinBase) == 193 && sizeof(kCollationLatinMark) == 193, "one entry per code point U+00C0..U+017F");
+
+//*****************
+// Function name: collationMarkWeight
+// Purpose: Returns the secondary (accent) weight of an accent code, or of a combining mark (U+0300..U+036F)
+//          when given its code point. Unaccented letters weigh 1.
+//*****************
+inline unsigned char collationMarkWeight(char32_t mark) noexcept
+{
+	switch (mark)
+	{
+	case U'g': mark = 0x300; break; // grave
+	case U'a': mark = 0x301; break; // acute
+	case U'c': mark = 0x302; break; // circumflex
+	case U't': mark = 0x303; break; // tilde
+	case U'm': mark = 0x304; break; // macron
+	case U'b': mark = 0x306; break; // breve
+	case U'D': mark = 0x307; break; // dot above
+	case U'd': mark = 0x308; break; // diaeresis
+	case U'r': mark = 0x30A; break; // ring above
+	case U'h': mark = 0x30B; break; // double acute
+	case U'v': mark = 0x30C; break; // caron
+	case U's': mark = 0x335; break; // stroke
+	case U'C': mark = 0x327; break; // cedilla
+	case U'o': mark = 0x328; break; // ogonek
+	case U'-': return 1;
+	default: break;
+	}
+	return static_cast<unsigned char>(2 + (mark - 0x300));
+}
+
+//*****************
+// Struct: CollationElement
+// Purpose: The weights of one folded character: its code point after case and accent folding (primary),
+//          its accent (secondary) and whether it was uppercase (tertiary).
+//*****************
+struct CollationElement
+{
+	char32_t primary;
+	unsigned char secondary;
+	unsigned char tertiary;
+};
+
+//*****************
+// Function name: collationFold
+// Purpose: Folds one code point into up to two collation elements (ligatures such as "ß" expand to two).
+// Parameters:
+//    - cp: The code point.
+//    - out: Receives the elements.
+// Returns: The number of elements written.
+//*****************
+inline std::size_t collationFold(char32_t cp, CollationElement* out) noexcept
+{
+	constexpr unsigned char kLower = 1, kUpper = 2;
+	if (cp < 0x80)
+	{
+		const bool upper = cp >= U'A' && cp <= U'Z';
+		out[0] = { upper ? cp + 0x20 : cp, 1, upper ? kUpper : kLower };
+		return 1;
+	}
+	if (cp >= 0xC0 && cp <= 0x17F)
+	{
+		const char base = kCollationLatinBase[cp - 0xC0];
+		if (base != '*')
+		{
+			const bool upper = base >= 'A' && base <= 'Z';
+			out[0] = { static_cast<char32_t>(upper ? base + 0x20 : base), collationMarkWeight(static_cast<char32_t>(kCollationLatinMark[cp - 0xC0])), upper ? kUpper : kLower };
+			return 1;
+		}
+		const unsigned char ligature = collationMarkWeight(0x361); // Combining double inverted breve
+		switch (cp)
+		{
+		case 0xC6: out[0] = { U'a', ligature, kUpper }; out[1] = { U'e', ligature, kUpper }; return 2;   // Æ
+		case 0xE6: out[0] = { U'a', ligature, kLower }; out[1] = { U'e', ligature, kLower }; return 2;   // æ
+		case 0xDF: out[0] = { U's', ligature, kLower }; out[1] = { U's', ligature, kLower }; return 2;   // ß
+		case 0x132: out[0] = { U'i', ligature, kUpper }; out[1] = { U'j', ligature, kUpper }; return 2;  // Ĳ
+		case 0x133: out[0] = { U'i', ligature, kLower }; out[1] = { U'j', ligature, kLower }; return 2;  // ĳ
+		case 0x152: out[0] = { U'o', ligature, kUpper }; out[1] = { U'e', ligature, kUpper }; return 2;  // Œ
+		case 0x153: out[0] = { U'o', ligature, kLower }; out[1] = { U'e', ligature, kLower }; return 2;  // œ
+		case 0xDE: out[0] = { 0xFE, 1, kUpper }; return 1;                                                // Þ
+		default: out[0] = { cp, 1, kLower }; return 1;                                                    // × ÷ þ
+		}
+	}
+	if ((cp >= 0x391 && cp <= 0x3A9) || (cp >= 0x410 && cp <= 0x42F)) // Greek and Cyrillic capitals
+	{
+		out[0] = { cp + 0x20, 1, kUpper };
+		return 1;
+	}
+	if (cp >= 0x400 && cp <= 0x40F) // Cyrillic capitals with marks (Ѐ..Џ)
+	{
+		out[0] = { cp + 0x50, 1, kUpper };
+		return 1;
+	}
+	out[0] = { cp == 0x3C2 ? char32_t(0x3C3) : cp, 1, kLower }; // Final sigma folds to sigma
+	return 1;
+}
+
+//*****************
+// Function name: decodeUtf8
+// Purpose: Decodes the code point starting at str[i] and advances i past it. Malformed bytes decode one at a
+//          time to U+DC80..U+DCFF (as Python's surrogateescape does), so every byte string has a key.
+//*****************
+inline char32_t decodeUtf8(const std::string& str, std::size_t& i) noexcept
+{
+	const auto byte = [&str](std::size_t at) { return static_cast<unsigned char>(str[at]); };
+	const unsigned char lead = byte(i);
+	std::size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+	char32_t cp = length == 2 ? (lead & 0x1F) : length == 3 ? (lead & 0x0F) : (lead & 0x07);
+	if (length == 1)
+	{
+		++i;
+		return lead;
+	}
+	if (length == 0 || i + length > str.size()) length = 0;
+	for (std::size_t k = 1; k < length; ++k)
+	{
+		if ((byte(i + k) & 0xC0) != 0x80) { length = 0; break; }
+		cp = (cp << 6) | (byte(i + k) & 0x3F);
+	}
+	const char32_t smallest[] = { 0, 0, 0x80, 0x800, 0x10000 };
+	if (length == 0 || cp < smallest[length] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) // Malformed, overlong or surrogate
+	{
+		++i;
+		return 0xDC00 + lead;
+	}
+	i += length;
+	return cp;
+}
+
+//*****************
+// Function name: appendCollationKey
+// Purpose: Appends the binary sort key of a string: byte-wise comparison of two keys (std::string's own
+//          comparison) gives the collation order of the strings. The levels are separated by 0x00 bytes:
+//          letters, accents, case, then the escaped raw bytes as the tie breaker.
+// Parameters:
+//    - key: The string the key is appended to.
+//    - str: The string to compute the key of.
+//    - collation: The Collation.
+// Returns: void
+//*****************
+inline void appendCollationKey(std::string& key, const std::string& str, Collation collation)
+{
+	if (collation == Collation::AsciiCaseFold)
+	{
+		for (char c : str) appendEscapedByte(key, static_cast<unsigned char>(c >= 'A' && c <= 'Z' ? c + 0x20 : c));
+		key.push_back('\0');
+		for (char c : str) key.push_back(c >= 'A' && c <= 'Z' ? '\x02' : '\x01');
+	}
+	else
+	{
+		// Primary weights are code points split into three 7-bit digits offset by one, so no byte is 0x00
+		std::string secondary, tertiary;
+		CollationElement elements[2];
+		for (std::size_t i = 0; i < str.size();)
+		{
+			const char32_t cp = decodeUtf8(str, i);
+			if (cp >= 0x300 && cp <= 0x36F && !secondary.empty() && secondary.back() == '\x01')
+			{
+				secondary.back() = static_cast<char>(collationMarkWeight(cp)); // A combining mark accents the previous letter
+				continue;
+			}
+			const std::size_t count = collationFold(cp, elements);
+			for (std::size_t e = 0; e < count; ++e)
+			{
+				key.push_back(static_cast<char>(((elements[e].primary >> 14) & 0x7F) + 1));
+				key.push_back(static_cast<char>(((elements[e].primary >> 7) & 0x7F) + 1));
+				key.push_back(static_cast<char>((elements[e].primary & 0x7F) + 1));
+				secondary.push_back(static_cast<char>(elements[e].secondary));
+				tertiary.push_back(static_cast<char>(elements[e].tertiary));
+			}
+		}
+		key.push_back('\0');
+		key += secondary;
+		key.push_back('\0');
+		key += tertiary;
+	}
+	key.push_back('\0');
+	for (char c : str) appendEscapedByte(key, static_cast<unsigned char>(c));
+	key.push_back('\0');
+}
+
+//*****************
+// Function name: collationKey
+// Purpose: Returns the binary sort key of a string (see appendCollationKey).
+//*****************
+inline std::string collationKey(const std::string& str, Collation collation)
+{
+	std::string key;
+	key.reserve(str.size() * 2 + 4);
+	appendCollationKey(key, str, collation);
+	return key;
+}
+
+//*****************
+// Template Function: collatedSort
+// Purpose: Sorts a container of strings in collation order by their precomputed sort keys (see binaryKeySort).
+// Parameters:
+//    - holder: A reference to a container of strings that needs to be sorted.
+//    - collation: The Collation.
+//    - descending: Sorts in descending order when true (default: false).
+// Returns: void
+//*****************
+template <typename Container>
+void collatedSort(Container& holder, Collation collation, bool descending = false)
+{
+	binaryKeySort(holder, [collation](std::string& key, const std::string& str) { appendCollationKey(key, str, collation); }, descending);
+}
+
+//*****************
+// Template Functor: CollatedOrder
+// Purpose: Sorts strings in collation order (ascending, or descending when descending is true).
+//          recursiveSort sorts with collatedSort, computing each key once; direct calls compare keys.
+//*****************
+template <Collation kind, bool descending = false>
+struct CollatedOrder
+{
+	static constexpr Collation collation = kind;
+	static constexpr bool isDescending = descending;
+
+	bool operator()(const std::string& a, const std::string& b) const
+	{
+		const std::string keyA = collationKey(a, kind), keyB = collationKey(b, kind);
+		return descending ? keyA < keyB : keyA > keyB; // True bubbles up
+	}
+};
+
+using CaseInsensitiveOrder = CollatedOrder<Collation::AsciiCaseFold>;
+using Utf8CollatedOrder = CollatedOrder<Collation::Utf8>;
+
+// Helper type trait to detect CollatedOrder comparators
+template<typename Comparator>
+struct is_collated_order : std::false_type {};
+
+template<Collation kind, bool descending>
+struct is_collated_order<CollatedOrder<kind, descending>> : std::true_type {};
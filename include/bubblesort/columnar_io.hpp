@@ -0,0 +1,477 @@
+//*****************
+// bubblesort/columnar_io.hpp
+// Column-oriented files for sorted 2D and 3D integer containers: a row group per outer element, encoded
+// pages with min/max statistics, and a memory-mapped reader that skips pages by their statistics.
+//*****************
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>    // for std::memcmp
+#include <iterator>   // for std::distance
+#include <type_traits>
+
+#include "traits.hpp"
+#include "integer_sort.hpp"
+#include "compact_io.hpp"
+#include "async_io.hpp"
+
+// A columnar file starts and ends with this magic; the end also holds the footer offset
+constexpr char kColumnarMagic[4] = { 'B', 'S', 'C', 'L' };
+constexpr unsigned char kColumnarVersion = 1;
+
+// Size of the header: the magic, the version, the element size, its signedness and the nesting depth
+constexpr std::size_t kColumnarHeaderBytes = sizeof(kColumnarMagic) + 4;
+
+// Size of the trailer: the 8-byte little-endian footer offset and the magic
+constexpr std::size_t kColumnarTrailerBytes = 8 + sizeof(kColumnarMagic);
+
+// Values per page; every page is encoded on its own and carries its own statistics
+constexpr std::size_t kColumnarPageValues = 4096;
+
+//*****************
+// Enum: ColumnEncoding
+// Purpose: How one page of a column is encoded; the writer keeps whichever is smallest.
+//    - Delta: The page as encodeCompactLeaf writes it (gaps of sorted pages, bit-packed from 128 values on).
+//    - Dictionary: The distinct values, delta encoded, and a bit-packed index into them per value (unsorted
+//      pages only).
+//    - RunLength: Runs of equal values as a length and the zigzag difference to the previous run's value.
+//*****************
+enum class ColumnEncoding : unsigned char
+{
+	Delta,
+	Dictionary,
+	RunLength
+};
+
+//*****************
+// Struct: ColumnPage
+// Purpose: The footer entry of one page: where it is, how it is encoded and the range of its values.
+//*****************
+template <typename T>
+struct ColumnPage
+{
+	std::uint64_t offset;
+	std::size_t bytes;
+	std::size_t count;
+	ColumnEncoding encoding;
+	T min;
+	T max;
+};
+
+//*****************
+// Function name: appendBits
+// Purpose: Appends values of width bits each to a little-endian bit stream, lowest bits first.
+//*****************
+inline void appendBits(std::vector<unsigned char>& out, const std::vector<std::uint32_t>& values, unsigned width)
+{
+	std::uint64_t buffer = 0;
+	unsigned buffered = 0;
+	for (std::uint32_t value : values)
+	{
+		buffer |= static_cast<std::uint64_t>(value) << buffered;
+		for (buffered += width; buffered >= 8; buffered -= 8)
+		{
+			out.push_back(static_cast<unsigned char>(buffer));
+			buffer >>= 8;
+		}
+	}
+	if (buffered > 0) out.push_back(static_cast<unsigned char>(buffer));
+}
+
+//*****************
+// Template Function: encodeColumnPage
+// Purpose: Encodes one page of a column with each ColumnEncoding and keeps the smallest.
+// Parameters:
+//    - values: The values of the page.
+//    - n: Number of values (1 to kColumnarPageValues).
+//    - payload: Receives the encoded page (replacing its contents).
+// Returns: The encoding used.
+//*****************
+template <typename T>
+ColumnEncoding encodeColumnPage(const T* values, std::size_t n, std::vector<unsigned char>& payload)
+{
+	using Key = typename std::make_unsigned<T>::type;
+	std::vector<unsigned char> candidate, leafPayload;
+
+	// Delta: the CompactEncoding, then its payload
+	const CompactEncoding deltaEncoding = encodeCompactLeaf(values, n, leafPayload);
+	payload.assign(1, static_cast<unsigned char>(deltaEncoding));
+	payload.insert(payload.end(), leafPayload.begin(), leafPayload.end());
+	ColumnEncoding best = ColumnEncoding::Delta;
+
+	// Run length: the number of runs, then every run's length and value difference
+	std::size_t runs = 0;
+	for (std::size_t i = 0; i < n; ++i) runs += i == 0 || values[i] != values[i - 1];
+	appendVarint(candidate, runs);
+	std::uint64_t previous = 0;
+	for (std::size_t begin = 0, end = 0; begin < n; begin = end)
+	{
+		for (end = begin + 1; end < n && values[end] == values[begin]; ++end) {}
+		const std::uint64_t key = static_cast<Key>(radixKey(values[begin]));
+		appendVarint(candidate, end - begin);
+		appendVarint(candidate, zigzagEncode(key - previous));
+		previous = key;
+	}
+	if (candidate.size() < payload.size())
+	{
+		payload.swap(candidate);
+		best = ColumnEncoding::RunLength;
+	}
+
+	// Dictionary: the distinct values as a delta encoded leaf, then the bit-packed indices. Sorted pages are
+	// left to the other two, which store their gaps or runs more tightly than indices could
+	if (deltaEncoding != CompactEncoding::ZigzagVarint) return best;
+	std::vector<T> dictionary(values, values + n);
+	std::sort(dictionary.begin(), dictionary.end());
+	dictionary.erase(std::unique(dictionary.begin(), dictionary.end()), dictionary.end());
+	unsigned width = 0;
+	while ((dictionary.size() - 1) >> width) ++width;
+	if (dictionary.size() < n && 1 + width * n / 8 < payload.size())
+	{
+		candidate.clear();
+		appendVarint(candidate, dictionary.size());
+		candidate.push_back(static_cast<unsigned char>(encodeCompactLeaf(dictionary.data(), dictionary.size(), leafPayload)));
+		appendVarint(candidate, leafPayload.size());
+		candidate.insert(candidate.end(), leafPayload.begin(), leafPayload.end());
+		std::vector<std::uint32_t> indices(n);
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			indices[i] = static_cast<std::uint32_t>(std::lower_bound(dictionary.begin(), dictionary.end(), values[i]) - dictionary.begin());
+		}
+		appendBits(candidate, indices, width);
+		if (candidate.size() < payload.size())
+		{
+			payload.swap(candidate);
+			best = ColumnEncoding::Dictionary;
+		}
+	}
+	return best;
+}
+
+//*****************
+// Template Function: decodeColumnPage
+// Purpose: Decodes a page written by encodeColumnPage.
+// Parameters:
+//    - encoding: The encoding encodeColumnPage returned.
+//    - n: Number of values.
+//    - data, bytes: The encoded page.
+//    - values: Receives the values (resized to n).
+// Returns: false if the page is malformed.
+//*****************
+template <typename T>
+bool decodeColumnPage(ColumnEncoding encoding, std::size_t n, const unsigned char* data, std::size_t bytes, std::vector<T>& values)
+{
+	using Key = typename std::make_unsigned<T>::type;
+	const unsigned char* end = data + bytes;
+	if (bytes == 0 || n > kColumnarPageValues) return false;
+
+	if (encoding == ColumnEncoding::Delta)
+	{
+		return decodeCompactLeaf(static_cast<CompactEncoding>(data[0]), n, data + 1, bytes - 1, values);
+	}
+	if (encoding == ColumnEncoding::RunLength)
+	{
+		values.resize(n);
+		std::uint64_t runs = 0, length = 0, difference = 0, key = 0;
+		if (!parseVarint(data, end, runs)) return false;
+		std::size_t done = 0;
+		for (std::uint64_t run = 0; run < runs; ++run)
+		{
+			if (!parseVarint(data, end, length) || !parseVarint(data, end, difference) || length > n - done) return false;
+			key += zigzagDecode(difference);
+			std::fill_n(values.begin() + done, static_cast<std::size_t>(length), fromRadixKey<T>(static_cast<Key>(key)));
+			done += static_cast<std::size_t>(length);
+		}
+		return done == n && data == end;
+	}
+	if (encoding != ColumnEncoding::Dictionary) return false;
+
+	std::uint64_t distinct = 0, dictionaryBytes = 0;
+	if (!parseVarint(data, end, distinct) || distinct == 0 || distinct > n || data == end) return false;
+	const CompactEncoding dictionaryEncoding = static_cast<CompactEncoding>(*data++);
+	if (!parseVarint(data, end, dictionaryBytes) || dictionaryBytes > static_cast<std::uint64_t>(end - data)) return false;
+	std::vector<T> dictionary;
+	if (!decodeCompactLeaf(dictionaryEncoding, static_cast<std::size_t>(distinct), data, static_cast<std::size_t>(dictionaryBytes), dictionary)) return false;
+	data += dictionaryBytes;
+
+	unsigned width = 0;
+	while ((distinct - 1) >> width) ++width;
+	if (static_cast<std::size_t>(end - data) != (width * n + 7) / 8) return false;
+	values.resize(n);
+	std::uint64_t buffer = 0;
+	unsigned buffered = 0;
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		for (; buffered < width; buffered += 8) buffer |= static_cast<std::uint64_t>(*data++) << buffered;
+		const std::uint64_t index = buffer & ((std::uint64_t(1) << width) - 1);
+		buffer >>= width;
+		buffered -= width;
+		if (index >= distinct) return false;
+		values[i] = dictionary[static_cast<std::size_t>(index)];
+	}
+	return true;
+}
+
+//*****************
+// Template Function: writeColumnarFile
+// Purpose: Writes a 2D or 3D container of integers as a columnar file. Every outer element becomes a row
+//          group; its columns are the element itself (2D) or each of its inner containers (3D). Columns are
+//          cut into pages of kColumnarPageValues values, each encoded by encodeColumnPage. The footer lists,
+//          per row group and column, the column's size and for every page its length, encoding, minimum
+//          and maximum, so readers of sorted data can skip pages outside the values they look for.
+// Parameters:
+//    - path: The file to create or replace.
+//    - holder: A const reference to the container to be written.
+// Returns: true on success, false if the file could not be written.
+//*****************
+template <typename Container>
+bool writeColumnarFile(const std::string& path, const Container& holder)
+{
+	using T = innermost_value_t<Container>;
+	using Key = typename std::make_unsigned<T>::type;
+	constexpr std::size_t depth = nesting_depth<Container>::value;
+	static_assert(is_radix_sortable<T>::value, "writeColumnarFile requires a container of integers");
+	static_assert(depth == 2 || depth == 3, "writeColumnarFile requires a 2D or 3D container");
+
+	IoFile file;
+	if (!file.openWrite(path)) return false;
+	std::vector<unsigned char> bytes(kColumnarMagic, kColumnarMagic + sizeof(kColumnarMagic));
+	bytes.push_back(kColumnarVersion);
+	bytes.push_back(static_cast<unsigned char>(sizeof(T)));
+	bytes.push_back(std::is_signed<T>::value ? 1 : 0);
+	bytes.push_back(static_cast<unsigned char>(depth));
+	bool ok = file.writeAt(bytes.data(), bytes.size(), 0);
+	std::uint64_t offset = bytes.size();
+
+	std::vector<unsigned char> footer, payload;
+	std::vector<T> column;
+	const auto writeColumn = [&](const auto& columnHolder)
+	{
+		column.assign(columnHolder.begin(), columnHolder.end());
+		appendVarint(footer, column.size());
+		for (std::size_t begin = 0; begin < column.size(); begin += kColumnarPageValues)
+		{
+			const std::size_t count = std::min(kColumnarPageValues, column.size() - begin);
+			const ColumnEncoding encoding = encodeColumnPage(column.data() + begin, count, payload);
+			const auto bounds = std::minmax_element(column.begin() + begin, column.begin() + begin + count);
+			appendVarint(footer, payload.size());
+			footer.push_back(static_cast<unsigned char>(encoding));
+			appendVarint(footer, static_cast<Key>(radixKey(*bounds.first)));
+			appendVarint(footer, static_cast<Key>(radixKey(*bounds.second)));
+			bytes.insert(bytes.end(), payload.begin(), payload.end());
+		}
+	};
+
+	appendVarint(footer, static_cast<std::uint64_t>(std::distance(holder.begin(), holder.end())));
+	for (const auto& rowGroup : holder)
+	{
+		bytes.clear();
+		if constexpr (depth == 2)
+		{
+			appendVarint(footer, 1);
+			writeColumn(rowGroup);
+		}
+		else
+		{
+			appendVarint(footer, static_cast<std::uint64_t>(std::distance(rowGroup.begin(), rowGroup.end())));
+			for (const auto& columnHolder : rowGroup) writeColumn(columnHolder);
+		}
+		ok = ok && file.writeAt(bytes.data(), bytes.size(), offset);
+		offset += bytes.size();
+	}
+
+	for (unsigned shift = 0; shift < 64; shift += 8) footer.push_back(static_cast<unsigned char>(offset >> shift));
+	footer.insert(footer.end(), kColumnarMagic, kColumnarMagic + sizeof(kColumnarMagic));
+	ok = ok && file.writeAt(footer.data(), footer.size(), offset);
+	return file.close() && ok;
+}
+
+//*****************
+// Class: ColumnarReader
+// Purpose: Reads a file written by writeColumnarFile through a MappedFile. open parses only the footer;
+//          pages are decoded on request, and readRange decodes only the pages whose statistics overlap the
+//          requested values, so the skipped pages are never loaded.
+//*****************
+template <typename T>
+class ColumnarReader
+{
+public:
+	//*****************
+	// Function name: open
+	// Purpose: Maps a columnar file and reads its footer.
+	// Returns: false if the file is missing, malformed or was written for another element type.
+	//*****************
+	bool open(const std::string& path)
+	{
+		using Key = typename std::make_unsigned<T>::type;
+		rowGroups_.assign(1, 0);
+		columns_.clear();
+		pages_.clear();
+		if (!file_.open(path) || file_.size() < kColumnarHeaderBytes + kColumnarTrailerBytes) return false;
+		const unsigned char* data = file_.data();
+		if (std::memcmp(data, kColumnarMagic, sizeof(kColumnarMagic)) != 0 || data[4] != kColumnarVersion) return false;
+		if (data[5] != sizeof(T) || data[6] != (std::is_signed<T>::value ? 1 : 0)) return false;
+		depth_ = data[7];
+
+		const unsigned char* trailer = data + file_.size() - kColumnarTrailerBytes;
+		if (std::memcmp(trailer + 8, kColumnarMagic, sizeof(kColumnarMagic)) != 0) return false;
+		std::uint64_t footerOffset = 0;
+		for (unsigned byte = 0; byte < 8; ++byte) footerOffset |= static_cast<std::uint64_t>(trailer[byte]) << (8 * byte);
+		if (footerOffset < kColumnarHeaderBytes || footerOffset > file_.size() - kColumnarTrailerBytes) return false;
+
+		const unsigned char* footer = data + footerOffset;
+		std::uint64_t groups = 0, columns = 0, size = 0, bytes = 0, low = 0, high = 0;
+		std::uint64_t offset = kColumnarHeaderBytes;
+		if (!parseVarint(footer, trailer, groups)) return false;
+		for (std::uint64_t group = 0; group < groups; ++group)
+		{
+			if (!parseVarint(footer, trailer, columns)) return false;
+			for (std::uint64_t column = 0; column < columns; ++column)
+			{
+				if (!parseVarint(footer, trailer, size)) return false;
+				columns_.push_back({ pages_.size(), static_cast<std::size_t>(size) });
+				for (std::uint64_t begin = 0; begin < size; begin += kColumnarPageValues)
+				{
+					if (!parseVarint(footer, trailer, bytes) || footer == trailer) return false;
+					const ColumnEncoding encoding = static_cast<ColumnEncoding>(*footer++);
+					if (!parseVarint(footer, trailer, low) || !parseVarint(footer, trailer, high)) return false;
+					if (bytes > footerOffset - offset) return false;
+					pages_.push_back({ offset, static_cast<std::size_t>(bytes), static_cast<std::size_t>(std::min<std::uint64_t>(kColumnarPageValues, size - begin)),
+						encoding, fromRadixKey<T>(static_cast<Key>(low)), fromRadixKey<T>(static_cast<Key>(high)) });
+					offset += bytes;
+				}
+			}
+			rowGroups_.push_back(columns_.size());
+		}
+		columns_.push_back({ pages_.size(), 0 });
+		return offset == footerOffset && footer == trailer;
+	}
+
+	std::size_t depth() const noexcept { return depth_; }
+	std::size_t rowGroupCount() const noexcept { return rowGroups_.size() - 1; }
+	std::size_t columnCount(std::size_t rowGroup) const noexcept { return rowGroups_[rowGroup + 1] - rowGroups_[rowGroup]; }
+	std::size_t columnSize(std::size_t rowGroup, std::size_t column) const noexcept { return columns_[rowGroups_[rowGroup] + column].size; }
+
+	// The pages of a column with their statistics, in order
+	std::size_t pageCount(std::size_t rowGroup, std::size_t column) const noexcept
+	{
+		const std::size_t index = rowGroups_[rowGroup] + column;
+		return columns_[index + 1].firstPage - columns_[index].firstPage;
+	}
+	const ColumnPage<T>& page(std::size_t rowGroup, std::size_t column, std::size_t index) const noexcept
+	{
+		return pages_[columns_[rowGroups_[rowGroup] + column].firstPage + index];
+	}
+
+	//*****************
+	// Function name: readPage
+	// Purpose: Decodes one page of a column into values.
+	// Returns: false if the page is malformed.
+	//*****************
+	bool readPage(std::size_t rowGroup, std::size_t column, std::size_t index, std::vector<T>& values) const
+	{
+		const ColumnPage<T>& entry = page(rowGroup, column, index);
+		return decodeColumnPage(entry.encoding, entry.count, file_.data() + entry.offset, entry.bytes, values);
+	}
+
+	//*****************
+	// Function name: readColumn
+	// Purpose: Decodes a whole column into values.
+	// Returns: false if a page is malformed.
+	//*****************
+	bool readColumn(std::size_t rowGroup, std::size_t column, std::vector<T>& values)
+	{
+		values.clear();
+		for (std::size_t index = 0; index < pageCount(rowGroup, column); ++index)
+		{
+			if (!readPage(rowGroup, column, index, page_)) return false;
+			values.insert(values.end(), page_.begin(), page_.end());
+		}
+		return true;
+	}
+
+	//*****************
+	// Function name: readRange
+	// Purpose: Appends the values of a column between low and high (inclusive) to values, in column order,
+	//          decoding only the pages whose minimum and maximum overlap that range.
+	// Parameters:
+	//    - rowGroup, column: The column to read.
+	//    - low, high: The range of values wanted.
+	//    - values: Receives the values in range.
+	//    - pagesRead: Optional; receives the number of pages decoded.
+	// Returns: false if a page is malformed.
+	//*****************
+	bool readRange(std::size_t rowGroup, std::size_t column, T low, T high, std::vector<T>& values, std::size_t* pagesRead = nullptr)
+	{
+		std::size_t decoded = 0;
+		for (std::size_t index = 0; index < pageCount(rowGroup, column); ++index)
+		{
+			const ColumnPage<T>& entry = page(rowGroup, column, index);
+			if (entry.max < low || high < entry.min) continue;
+			if (!readPage(rowGroup, column, index, page_)) return false;
+			++decoded;
+			std::copy_if(page_.begin(), page_.end(), std::back_inserter(values), [low, high](T value) { return !(value < low) && !(high < value); });
+		}
+		if (pagesRead) *pagesRead = decoded;
+		return true;
+	}
+
+private:
+	struct Column
+	{
+		std::size_t firstPage;
+		std::size_t size;
+	};
+
+	MappedFile file_;
+	std::size_t depth_ = 0;
+	std::vector<std::size_t> rowGroups_ = { 0 };  // First column of every row group, then the column count
+	std::vector<Column> columns_;                 // Followed by a sentinel whose firstPage is the page count
+	std::vector<ColumnPage<T>> pages_;
+	std::vector<T> page_;
+};
+
+//*****************
+// Template Function: readColumnarFile
+// Purpose: Reads a whole file written by writeColumnarFile back into a container of the same depth and
+//          element type. Resizable containers take the written sizes, and fixed-size ones must match them.
+// Parameters:
+//    - path: The columnar file.
+//    - holder: A reference to the container receiving the data.
+// Returns: false if the file is missing, malformed or does not match the container.
+//*****************
+template <typename Container>
+bool readColumnarFile(const std::string& path, Container& holder)
+{
+	using T = innermost_value_t<Container>;
+	constexpr std::size_t depth = nesting_depth<Container>::value;
+	static_assert(depth == 2 || depth == 3, "readColumnarFile requires a 2D or 3D container");
+	ColumnarReader<T> reader;
+	if (!reader.open(path) || reader.depth() != depth || !resizeContainer(holder, reader.rowGroupCount())) return false;
+
+	std::vector<T> column;
+	std::size_t rowGroup = 0;
+	for (auto& rowHolder : holder)
+	{
+		if constexpr (depth == 2)
+		{
+			if (reader.columnCount(rowGroup) != 1 || !reader.readColumn(rowGroup, 0, column)) return false;
+			if (!assignRange(rowHolder, column.begin(), column.end())) return false;
+		}
+		else
+		{
+			if (!resizeContainer(rowHolder, reader.columnCount(rowGroup))) return false;
+			std::size_t index = 0;
+			for (auto& columnHolder : rowHolder)
+			{
+				if (!reader.readColumn(rowGroup, index++, column) || !assignRange(columnHolder, column.begin(), column.end())) return false;
+			}
+		}
+		++rowGroup;
+	}
+	return true;
+}
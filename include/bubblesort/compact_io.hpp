@@ -0,0 +1,532 @@
+//*****************
+// bubblesort/compact_io.hpp
+// Compact binary output of sorted integer containers (delta varints or bit-packed blocks per leaf, with a
+// leaf index) and a streaming decoder back into containers.
+//*****************
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>    // for std::memcmp
+#include <iterator>   // for std::distance
+#include <string>     // for std::char_traits
+#include <type_traits>
+
+#include "traits.hpp"
+#include "integer_sort.hpp"
+#include "block_codec.hpp"
+
+// A compact stream starts with this magic and ends with a trailer holding the index offset and kCompactIndexMagic
+constexpr char kCompactMagic[4] = { 'B', 'S', 'C', 'F' };
+constexpr char kCompactIndexMagic[4] = { 'B', 'S', 'C', 'I' };
+constexpr unsigned char kCompactVersion = 1;
+
+// Size of the header: the magic, the version, the element size, its signedness and the nesting depth
+constexpr std::size_t kCompactHeaderBytes = sizeof(kCompactMagic) + 4;
+
+// Size of the trailer: the 8-byte little-endian index offset and the index magic
+constexpr std::size_t kCompactTrailerBytes = 8 + sizeof(kCompactIndexMagic);
+
+// Sizes read from a stream are trusted only as far as its data goes: payloads are read in chunks of this
+// many bytes, and containers of leaf containers start at kCompactInitialLeaves and double as segments arrive
+constexpr std::size_t kCompactReadChunk = 1 << 16;
+constexpr std::size_t kCompactInitialLeaves = 1024;
+
+//*****************
+// Enum: CompactEncoding
+// Purpose: How one leaf container is encoded. Sorted leaves store the first key and then the gaps between
+//          keys, as varints or, from kPackedBlock elements on, as packSortedBlock blocks. Unsorted leaves
+//          store zigzag varints of the signed differences.
+//*****************
+enum class CompactEncoding : unsigned char
+{
+	AscendingVarint,
+	DescendingVarint,
+	ZigzagVarint,
+	AscendingBlocks,
+	DescendingBlocks
+};
+
+//*****************
+// Function name: appendVarint
+// Purpose: Appends an unsigned integer as a LEB128 varint: seven bits per byte, low bits first, the high bit
+//          set on every byte but the last.
+//*****************
+inline void appendVarint(std::vector<unsigned char>& out, std::uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(static_cast<unsigned char>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<unsigned char>(value));
+}
+
+//*****************
+// Function name: parseVarint
+// Purpose: Reads a varint written by appendVarint from [in, end), advancing in past it.
+// Returns: false if the varint is truncated or longer than 64 bits.
+//*****************
+inline bool parseVarint(const unsigned char*& in, const unsigned char* end, std::uint64_t& value) noexcept
+{
+	value = 0;
+	for (unsigned shift = 0; shift < 64 && in != end; shift += 7)
+	{
+		const unsigned char byte = *in++;
+		value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+//*****************
+// Function name: readVarint
+// Purpose: Reads a varint written by appendVarint from a stream.
+// Returns: false if the stream ends or the varint is longer than 64 bits.
+//*****************
+inline bool readVarint(std::istream& in, std::uint64_t& value)
+{
+	value = 0;
+	for (unsigned shift = 0; shift < 64; shift += 7)
+	{
+		const int byte = in.get();
+		if (byte == std::char_traits<char>::eof()) return false;
+		value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+//*****************
+// Function name: readCompactBytes
+// Purpose: Reads bytes bytes from a stream into out in chunks of kCompactReadChunk, so a corrupt length
+//          fails at the end of the stream instead of allocating it.
+// Returns: false if the stream ends early.
+//*****************
+inline bool readCompactBytes(std::istream& in, std::uint64_t bytes, std::vector<unsigned char>& out)
+{
+	out.clear();
+	while (out.size() < bytes)
+	{
+		const std::size_t begin = out.size();
+		const std::size_t take = static_cast<std::size_t>(std::min<std::uint64_t>(bytes - begin, kCompactReadChunk));
+		out.resize(begin + take);
+		if (!in.read(reinterpret_cast<char*>(out.data() + begin), static_cast<std::streamsize>(take))) return false;
+	}
+	return true;
+}
+
+// Number of bytes appendVarint writes for value
+constexpr std::size_t varintLength(std::uint64_t value) noexcept
+{
+	std::size_t length = 1;
+	for (; value >= 0x80; value >>= 7) ++length;
+	return length;
+}
+
+// Zigzag mapping of signed differences to unsigned varints, so small magnitudes of either sign stay short
+constexpr std::uint64_t zigzagEncode(std::uint64_t difference) noexcept
+{
+	return (difference << 1) ^ (0 - (difference >> 63));
+}
+
+constexpr std::uint64_t zigzagDecode(std::uint64_t value) noexcept
+{
+	return (value >> 1) ^ (0 - (value & 1));
+}
+
+//*****************
+// Template Function: encodeCompactLeaf
+// Purpose: Encodes the integers of one leaf container, picking the encoding from their order (see
+//          CompactEncoding).
+// Parameters:
+//    - values: The integers.
+//    - n: Number of integers.
+//    - payload: Receives the encoded bytes (replacing its contents).
+// Returns: The encoding used.
+//*****************
+template <typename T>
+CompactEncoding encodeCompactLeaf(const T* values, std::size_t n, std::vector<unsigned char>& payload)
+{
+	using Key = typename std::make_unsigned<T>::type;
+	payload.clear();
+	if (n == 0) return CompactEncoding::AscendingVarint;
+
+	bool ascending = true, descending = true;
+	for (std::size_t i = 1; i < n && (ascending || descending); ++i)
+	{
+		ascending = ascending && !(values[i] < values[i - 1]);
+		descending = descending && !(values[i - 1] < values[i]);
+	}
+
+	if ((ascending || descending) && n >= kPackedBlock)
+	{
+		payload.resize((n + kPackedBlock - 1) / kPackedBlock * maxPackedBlockBytes<T>());
+		std::size_t bytes = 0;
+		for (std::size_t begin = 0; begin < n; begin += kPackedBlock)
+		{
+			bytes += packSortedBlock(values + begin, std::min(kPackedBlock, n - begin), !ascending, payload.data() + bytes);
+		}
+		payload.resize(bytes);
+		return ascending ? CompactEncoding::AscendingBlocks : CompactEncoding::DescendingBlocks;
+	}
+
+	const CompactEncoding encoding = ascending ? CompactEncoding::AscendingVarint
+		: descending ? CompactEncoding::DescendingVarint : CompactEncoding::ZigzagVarint;
+	std::uint64_t previous = radixKey(values[0]);
+	appendVarint(payload, previous);
+	for (std::size_t i = 1; i < n; ++i)
+	{
+		const std::uint64_t key = static_cast<Key>(radixKey(values[i]));
+		appendVarint(payload, encoding == CompactEncoding::AscendingVarint ? key - previous
+			: encoding == CompactEncoding::DescendingVarint ? previous - key : zigzagEncode(key - previous));
+		previous = key;
+	}
+	return encoding;
+}
+
+//*****************
+// Template Function: decodeCompactLeaf
+// Purpose: Decodes a leaf written by encodeCompactLeaf.
+// Parameters:
+//    - encoding: The encoding encodeCompactLeaf returned.
+//    - n: Number of integers.
+//    - data, bytes: The encoded payload.
+//    - values: Receives the integers (resized to n).
+// Returns: false if the payload is malformed.
+//*****************
+template <typename T>
+bool decodeCompactLeaf(CompactEncoding encoding, std::size_t n, const unsigned char* data, std::size_t bytes, std::vector<T>& values)
+{
+	using Key = typename std::make_unsigned<T>::type;
+	const unsigned char* end = data + bytes;
+	const bool blocks = encoding == CompactEncoding::AscendingBlocks || encoding == CompactEncoding::DescendingBlocks;
+	// Every varint takes a byte and every block header at most kPackedBlock values, so n is bounded by the payload
+	if (n > (blocks ? bytes / packedHeaderBytes<T>() * kPackedBlock : bytes)) return false;
+	values.resize(n);
+
+	if (blocks)
+	{
+		for (std::size_t done = 0; done < n;)
+		{
+			if (end - data < 2 || packedBlockBytes<T>(data) > static_cast<std::size_t>(end - data)) return false;
+			if (static_cast<std::size_t>(data[0]) + 1 > std::min(kPackedBlock, n - done) || (data[1] > 32 && data[1] != kPackedRawWidth)) return false;
+			const std::size_t size = packedBlockBytes<T>(data);
+			done += unpackSortedBlock(data, encoding == CompactEncoding::DescendingBlocks, values.data() + done);
+			data += size;
+		}
+		return data == end;
+	}
+	if (encoding > CompactEncoding::ZigzagVarint) return false;
+
+	std::uint64_t key = 0, delta = 0;
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		if (!parseVarint(data, end, i == 0 ? key : delta)) return false;
+		if (i > 0)
+		{
+			key = encoding == CompactEncoding::AscendingVarint ? key + delta
+				: encoding == CompactEncoding::DescendingVarint ? key - delta : key + zigzagDecode(delta);
+		}
+		values[i] = fromRadixKey<T>(static_cast<Key>(key));
+	}
+	return data == end;
+}
+
+//*****************
+// Template Function: writeCompactShape
+// Purpose: Appends the size of every container above the leaf containers, in pre-order, as varints.
+//*****************
+template <typename Container>
+void writeCompactShape(const Container& holder, std::vector<unsigned char>& shape)
+{
+	if constexpr (is_nested_container<typename Container::value_type>::value)
+	{
+		appendVarint(shape, static_cast<std::uint64_t>(std::distance(holder.begin(), holder.end())));
+		for (const auto& subHolder : holder) writeCompactShape(subHolder, shape);
+	}
+}
+
+//*****************
+// Template Function: writeCompact
+// Purpose: Writes a (possibly nested) container of integers in the compact format. The stream holds a
+//          header, the shape of the containers above the leaf containers (see writeCompactShape), one
+//          segment per leaf container (its size, CompactEncoding, payload size and payload from
+//          encodeCompactLeaf), an index of every segment's size and byte length, and a trailer pointing at
+//          the index, so CompactLeafReader can seek to a single leaf. Sorted leaves, as recursiveSort leaves
+//          them, shrink to their gaps.
+// Parameters:
+//    - out: The binary stream to write to.
+//    - holder: A const reference to the container to be written.
+// Returns: true if the stream is still good after writing.
+//*****************
+template <typename Container>
+bool writeCompact(std::ostream& out, const Container& holder)
+{
+	using T = innermost_value_t<Container>;
+	static_assert(is_radix_sortable<T>::value, "writeCompact requires a container of integers");
+	static_assert(nesting_depth<Container>::value < 256, "writeCompact supports at most 255 levels of nesting");
+
+	std::vector<unsigned char> bytes(kCompactMagic, kCompactMagic + sizeof(kCompactMagic));
+	bytes.push_back(kCompactVersion);
+	bytes.push_back(static_cast<unsigned char>(sizeof(T)));
+	bytes.push_back(std::is_signed<T>::value ? 1 : 0);
+	bytes.push_back(static_cast<unsigned char>(nesting_depth<Container>::value));
+	std::vector<unsigned char> shape;
+	writeCompactShape(holder, shape);
+	appendVarint(bytes, shape.size());
+	bytes.insert(bytes.end(), shape.begin(), shape.end());
+	out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	std::uint64_t written = bytes.size();
+
+	std::vector<unsigned char> index, payload;
+	std::vector<T> leaf;
+	std::uint64_t leaves = 0;
+	const auto writeLeaf = [&](const auto& leafHolder)
+	{
+		leaf.assign(leafHolder.begin(), leafHolder.end());
+		const CompactEncoding encoding = encodeCompactLeaf(leaf.data(), leaf.size(), payload);
+		bytes.clear();
+		appendVarint(bytes, leaf.size());
+		bytes.push_back(static_cast<unsigned char>(encoding));
+		appendVarint(bytes, payload.size());
+		out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+		appendVarint(index, leaf.size());
+		appendVarint(index, bytes.size() + payload.size());
+		written += bytes.size() + payload.size();
+		++leaves;
+	};
+	forEachLeafContainer(holder, writeLeaf);
+
+	bytes.clear();
+	appendVarint(bytes, leaves);
+	bytes.insert(bytes.end(), index.begin(), index.end());
+	for (unsigned shift = 0; shift < 64; shift += 8) bytes.push_back(static_cast<unsigned char>(written >> shift));
+	bytes.insert(bytes.end(), kCompactIndexMagic, kCompactIndexMagic + sizeof(kCompactIndexMagic));
+	out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	return out.good();
+}
+
+//*****************
+// Template Function: readCompactHeader
+// Purpose: Reads the header and shape of a compact stream written for elements of type T.
+// Parameters:
+//    - in: The binary stream, positioned at the start of the compact data.
+//    - depth: Receives the nesting depth the data was written with.
+//    - shape: Receives the container sizes written by writeCompactShape.
+//    - consumed: Receives the number of bytes read, if not null (default: nullptr).
+// Returns: false if the header is malformed or was written for another element type.
+//*****************
+template <typename T>
+bool readCompactHeader(std::istream& in, std::size_t& depth, std::vector<std::uint64_t>& shape, std::uint64_t* consumed = nullptr)
+{
+	unsigned char header[kCompactHeaderBytes];
+	if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+	if (std::memcmp(header, kCompactMagic, sizeof(kCompactMagic)) != 0 || header[4] != kCompactVersion) return false;
+	if (header[5] != sizeof(T) || header[6] != (std::is_signed<T>::value ? 1 : 0)) return false;
+	depth = header[7];
+
+	std::uint64_t shapeBytes = 0;
+	if (!readVarint(in, shapeBytes)) return false;
+	std::vector<unsigned char> bytes;
+	if (!readCompactBytes(in, shapeBytes, bytes)) return false;
+	shape.clear();
+	const unsigned char* data = bytes.data();
+	for (std::uint64_t size = 0; data != bytes.data() + bytes.size();)
+	{
+		if (!parseVarint(data, bytes.data() + bytes.size(), size)) return false;
+		shape.push_back(size);
+	}
+	if (consumed) *consumed = kCompactHeaderBytes + varintLength(shapeBytes) + shapeBytes;
+	return true;
+}
+
+//*****************
+// Template Function: readCompactSegment
+// Purpose: Reads and decodes the next leaf segment of a compact stream.
+// Parameters:
+//    - in: The binary stream, positioned at a segment.
+//    - values: Receives the integers of the leaf.
+//    - payload: Scratch for the encoded bytes, reused across calls.
+//    - consumed: Receives the byte length of the segment, if not null (default: nullptr).
+// Returns: false if the stream ends early or the segment is malformed.
+//*****************
+template <typename T>
+bool readCompactSegment(std::istream& in, std::vector<T>& values, std::vector<unsigned char>& payload, std::uint64_t* consumed = nullptr)
+{
+	std::uint64_t n = 0, bytes = 0;
+	if (!readVarint(in, n)) return false;
+	const int encoding = in.get();
+	if (encoding == std::char_traits<char>::eof() || !readVarint(in, bytes)) return false;
+	if (!readCompactBytes(in, bytes, payload)) return false;
+	if (consumed) *consumed = varintLength(n) + 1 + varintLength(bytes) + bytes;
+	return decodeCompactLeaf(static_cast<CompactEncoding>(encoding), static_cast<std::size_t>(n), payload.data(), payload.size(), values);
+}
+
+//*****************
+// Template Function: readCompactLevel
+// Purpose: Rebuilds one level of a container from the shape and the leaf segments that follow it, appending
+//          the size and byte length of every segment read to index, as the stream's index lists them. A size
+//          from the shape is checked before it is allocated: containers of containers need one more shape
+//          entry per element, and containers of leaf containers grow as their segments are read.
+//*****************
+template <typename Container, typename T>
+bool readCompactLevel(std::istream& in, Container& holder, const std::vector<std::uint64_t>& shape, std::size_t& next,
+	std::vector<T>& leaf, std::vector<unsigned char>& payload, std::vector<std::uint64_t>& index)
+{
+	using Child = typename Container::value_type;
+	if constexpr (is_nested_container<Child>::value)
+	{
+		if (next == shape.size()) return false;
+		const std::uint64_t size = shape[next++];
+		if constexpr (!is_nested_container<typename Child::value_type>::value && has_resize<Container>::value)
+		{
+			std::size_t allocated = static_cast<std::size_t>(std::min<std::uint64_t>(size, kCompactInitialLeaves));
+			holder.resize(allocated);
+			auto subHolder = holder.begin();
+			for (std::size_t child = 0; child < size; ++child, ++subHolder)
+			{
+				if (child == allocated)
+				{
+					allocated = static_cast<std::size_t>(std::min<std::uint64_t>(size, 2 * static_cast<std::uint64_t>(allocated)));
+					holder.resize(allocated);
+					subHolder = std::next(holder.begin(), static_cast<std::ptrdiff_t>(child));
+				}
+				if (!readCompactLevel(in, *subHolder, shape, next, leaf, payload, index)) return false;
+			}
+			return true;
+		}
+		else
+		{
+			if (is_nested_container<typename Child::value_type>::value && size > shape.size() - next) return false;
+			if (!resizeContainer(holder, static_cast<std::size_t>(size))) return false;
+			for (auto& subHolder : holder)
+			{
+				if (!readCompactLevel(in, subHolder, shape, next, leaf, payload, index)) return false;
+			}
+			return true;
+		}
+	}
+	else
+	{
+		std::uint64_t bytes = 0;
+		if (!readCompactSegment(in, leaf, payload, &bytes)) return false;
+		index.push_back(leaf.size());
+		index.push_back(bytes);
+		return assignRange(holder, leaf.begin(), leaf.end());
+	}
+}
+
+//*****************
+// Template Function: readCompact
+// Purpose: Decodes a stream written by writeCompact into a container of the same nesting depth and element
+//          type, streaming one leaf segment at a time. The index and trailer that follow the segments are
+//          read too and checked against them, so the stream is left just past the record and further
+//          records written after it can be read in turn. Resizable containers take the written sizes, and
+//          fixed-size ones (std::array) must match them.
+// Parameters:
+//    - in: The binary stream, positioned at the start of the compact data; left after its trailer.
+//    - holder: A reference to the container receiving the data.
+// Returns: false if the stream is malformed or does not match the container.
+//*****************
+template <typename Container>
+bool readCompact(std::istream& in, Container& holder)
+{
+	using T = innermost_value_t<Container>;
+	static_assert(is_radix_sortable<T>::value, "readCompact requires a container of integers");
+	std::size_t depth = 0;
+	std::uint64_t offset = 0;
+	std::vector<std::uint64_t> shape;
+	if (!readCompactHeader<T>(in, depth, shape, &offset) || depth != nesting_depth<Container>::value) return false;
+
+	std::size_t next = 0;
+	std::vector<T> leaf;
+	std::vector<unsigned char> payload;
+	std::vector<std::uint64_t> index;
+	if (!readCompactLevel(in, holder, shape, next, leaf, payload, index) || next != shape.size()) return false;
+
+	// The index must list the segments just read, and the trailer must point at the index
+	std::uint64_t leaves = 0, value = 0;
+	if (!readVarint(in, leaves) || leaves != index.size() / 2) return false;
+	for (std::uint64_t entry : index)
+	{
+		if (!readVarint(in, value) || value != entry) return false;
+	}
+	for (std::size_t i = 1; i < index.size(); i += 2) offset += index[i];
+	unsigned char trailer[kCompactTrailerBytes];
+	if (!in.read(reinterpret_cast<char*>(trailer), sizeof(trailer))) return false;
+	std::uint64_t indexOffset = 0;
+	for (unsigned byte = 0; byte < 8; ++byte) indexOffset |= static_cast<std::uint64_t>(trailer[byte]) << (8 * byte);
+	return indexOffset == offset && std::memcmp(trailer + 8, kCompactIndexMagic, sizeof(kCompactIndexMagic)) == 0;
+}
+
+//*****************
+// Class: CompactLeafReader
+// Purpose: Random access to the leaf containers of a seekable compact stream through its index: open reads
+//          the header, the trailer and the index, and readLeaf seeks to one segment and decodes only it.
+//          The compact data must run to the end of the stream.
+//*****************
+template <typename T>
+class CompactLeafReader
+{
+public:
+	//*****************
+	// Function name: open
+	// Purpose: Reads the index of the compact data starting at the current position of in.
+	// Returns: false if the data is malformed or was written for another element type.
+	//*****************
+	bool open(std::istream& in)
+	{
+		in_ = &in;
+		offsets_.clear();
+		sizes_.clear();
+		const std::streampos base = in.tellg();
+		std::size_t depth = 0;
+		std::vector<std::uint64_t> shape;
+		if (base == std::streampos(-1) || !readCompactHeader<T>(in, depth, shape)) return false;
+		std::uint64_t offset = static_cast<std::uint64_t>(in.tellg() - base);
+
+		unsigned char trailer[kCompactTrailerBytes];
+		if (!in.seekg(-static_cast<std::streamoff>(sizeof(trailer)), std::ios::end) || !in.read(reinterpret_cast<char*>(trailer), sizeof(trailer))) return false;
+		if (std::memcmp(trailer + 8, kCompactIndexMagic, sizeof(kCompactIndexMagic)) != 0) return false;
+		std::uint64_t indexOffset = 0;
+		for (unsigned byte = 0; byte < 8; ++byte) indexOffset |= static_cast<std::uint64_t>(trailer[byte]) << (8 * byte);
+		if (!in.seekg(base + static_cast<std::streamoff>(indexOffset))) return false;
+
+		std::uint64_t leaves = 0, size = 0, bytes = 0;
+		if (!readVarint(in, leaves)) return false;
+		for (std::uint64_t leaf = 0; leaf < leaves; ++leaf)
+		{
+			if (!readVarint(in, size) || !readVarint(in, bytes)) return false;
+			offsets_.push_back(base + static_cast<std::streamoff>(offset));
+			sizes_.push_back(static_cast<std::size_t>(size));
+			offset += bytes;
+		}
+		return offset == indexOffset;
+	}
+
+	std::size_t leafCount() const noexcept { return sizes_.size(); }
+	std::size_t leafSize(std::size_t leaf) const noexcept { return sizes_[leaf]; }
+
+	//*****************
+	// Function name: readLeaf
+	// Purpose: Decodes one leaf container, reading only its segment.
+	// Returns: false if the segment could not be read or is malformed.
+	//*****************
+	bool readLeaf(std::size_t leaf, std::vector<T>& values)
+	{
+		in_->clear();
+		return in_->seekg(offsets_[leaf]) && readCompactSegment(*in_, values, payload_) && values.size() == sizes_[leaf];
+	}
+
+private:
+	std::istream* in_ = nullptr;
+	std::vector<std::streampos> offsets_;
+	std::vector<std::size_t> sizes_;
+	std::vector<unsigned char> payload_;
+};
@@ -0,0 +1,317 @@
+//*****************
+// bubblesort/distinct_sort.hpp
+// Sorts that keep one element of every value, and optionally count the duplicates, as part of the sort's
+// last pass instead of a unique or counting pass after it.
+//*****************
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <functional> // for std::less and std::greater
+#include <iterator>   // for std::distance and std::next
+#include <type_traits>
+
+#include "traits.hpp"
+#include "parallel.hpp"
+#include "sort_engine.hpp"
+#include "integer_sort.hpp"
+
+//*****************
+// Template Function: emitSortedRuns
+// Purpose: Calls emit(value, count) for every run of equal values in a sorted range, in order.
+//*****************
+template <typename T, typename Emit>
+void emitSortedRuns(const T* data, std::size_t n, Emit& emit)
+{
+	for (std::size_t i = 0; i < n;)
+	{
+		std::size_t end = i + 1;
+		while (end < n && data[end] == data[i]) ++end;
+		emit(data[i], end - i);
+		i = end;
+	}
+}
+
+//*****************
+// Template Function: lsdRadixRuns
+// Purpose: lsdRadixSort that reports runs instead of finishing the sort: every run of equal integers goes
+//          to emit(value, count) in ascending order. The last pass (the highest byte where low and high
+//          differ) scatters each value once per thread and bucket and counts its repeats instead of writing
+//          them, so data with many duplicates writes almost nothing in it; the kept values are then reported
+//          bucket by bucket, merging repeats that two threads both kept. emit may overwrite data up to the
+//          number of runs reported so far.
+// Parameters:
+//    - data: Pointer to the integers; left in unspecified order.
+//    - n: Number of integers.
+//    - low, high: The smallest and largest value present.
+//    - emit: Called as emit(value, count) for every run.
+// Returns: void
+//*****************
+template <typename T, typename Emit>
+void lsdRadixRuns(T* data, std::size_t n, T low, T high, Emit& emit)
+{
+	static_assert(is_radix_sortable<T>::value, "lsdRadixRuns requires an integer type");
+	const auto spread = radixKey(high) ^ radixKey(low);
+	if (spread == 0)
+	{
+		if (n > 0) emit(data[0], n);
+		return;
+	}
+	unsigned lastShift = 0;
+	while (lastShift + 8 < sizeof(T) * 8 && (spread >> (lastShift + 8)) != 0) lastShift += 8;
+
+	WorkerPool pool(sortThreadCount(n)); // Started once for every pass
+	const unsigned threads = pool.size();
+	std::vector<T> buffer(n);
+	std::vector<std::size_t> histograms(threads * kRadixBuckets);
+	std::vector<std::size_t> total(kRadixBuckets);
+	T* src = data;
+	T* dst = buffer.data();
+	for (unsigned shift = 0; shift < lastShift; shift += 8)
+	{
+		const auto digitOf = [shift](const T& value) { return static_cast<std::size_t>((radixKey(value) >> shift) & 0xFF); };
+		parallelHistogram(src, n, digitOf, kRadixBuckets, pool, histograms.data());
+		sumHistograms(histograms.data(), kRadixBuckets, threads, total.data());
+		if (std::find(total.begin(), total.end(), n) != total.end()) continue; // All elements share this digit
+
+		scatterOffsets(histograms.data(), kRadixBuckets, threads, histograms.data());
+		parallelScatter(src, dst, n, digitOf, kRadixBuckets, pool, histograms.data());
+		std::swap(src, dst);
+	}
+
+	// Last pass: each thread keeps the first of every run of equal values in its part of a bucket
+	const auto digitOf = [lastShift](const T& value) { return static_cast<std::size_t>((radixKey(value) >> lastShift) & 0xFF); };
+	parallelHistogram(src, n, digitOf, kRadixBuckets, pool, histograms.data());
+	scatterOffsets(histograms.data(), kRadixBuckets, threads, histograms.data());
+	const std::vector<std::size_t> starts(histograms);
+	std::vector<std::vector<std::size_t>> runCounts(threads * kRadixBuckets);
+	pool.run([&](unsigned t)
+	{
+		std::size_t* next = histograms.data() + t * kRadixBuckets;
+		const std::size_t* start = starts.data() + t * kRadixBuckets;
+		std::vector<std::size_t>* counts = runCounts.data() + t * kRadixBuckets;
+		const std::size_t end = chunkBegin(n, threads, t + 1);
+		for (std::size_t i = chunkBegin(n, threads, t); i < end; ++i)
+		{
+			const T value = src[i];
+			const std::size_t b = digitOf(value);
+			if (next[b] != start[b] && dst[next[b] - 1] == value)
+			{
+				++counts[b].back();
+			}
+			else
+			{
+				dst[next[b]++] = value;
+				counts[b].push_back(1);
+			}
+		}
+	});
+
+	bool pending = false;
+	T value = T();
+	std::size_t count = 0;
+	for (std::size_t b = 0; b < kRadixBuckets; ++b)
+	{
+		for (unsigned t = 0; t < threads; ++t)
+		{
+			const std::size_t region = t * kRadixBuckets + b;
+			for (std::size_t i = 0; i < runCounts[region].size(); ++i)
+			{
+				const T kept = dst[starts[region] + i];
+				if (pending && kept == value)
+				{
+					count += runCounts[region][i];
+					continue;
+				}
+				if (pending) emit(value, count);
+				pending = true;
+				value = kept;
+				count = runCounts[region][i];
+			}
+		}
+	}
+	if (pending) emit(value, count);
+}
+
+//*****************
+// Template Function: americanFlagRuns
+// Purpose: americanFlagSort that reports runs instead of finishing the sort: every run of equal integers
+//          goes to emit(value, count) in ascending order. The last byte is never permuted, since its counts
+//          are already the run lengths, and buckets whose elements are all equal are reported as one run,
+//          so data with many duplicates skips most of the final pass. emit may overwrite data up to the
+//          number of runs reported so far (e.g. to compact the distinct values to the front).
+// Parameters:
+//    - data: Pointer to the integers; left in unspecified order.
+//    - n: Number of integers.
+//    - emit: Called as emit(value, count) for every run.
+//    - shift: Bit position of the byte to distribute on (default: the most significant byte).
+//    - lsdThreshold: Buckets up to this size are sorted by americanFlagSort and scanned for their runs
+//                    (default: kAmericanFlagLsdThreshold).
+// Returns: void
+//*****************
+template <typename T, typename Emit>
+void americanFlagRuns(T* data, std::size_t n, Emit& emit, unsigned shift = sizeof(T) * 8 - 8, std::size_t lsdThreshold = kAmericanFlagLsdThreshold)
+{
+	static_assert(is_radix_sortable<T>::value, "americanFlagRuns requires an integer type");
+	using Key = typename std::make_unsigned<T>::type;
+	if (n <= std::max(kAmericanFlagInsertionThreshold, lsdThreshold))
+	{
+		americanFlagSort(data, n, shift, lsdThreshold);
+		emitSortedRuns(data, n, emit);
+		return;
+	}
+
+	std::size_t counts[kRadixBuckets];
+	std::size_t heads[kRadixBuckets];
+	std::size_t tails[kRadixBuckets];
+	for (;;)
+	{
+		const auto digitOf = [shift](const T& value) { return static_cast<std::size_t>((radixKey(value) >> shift) & 0xFF); };
+		std::fill(counts, counts + kRadixBuckets, std::size_t(0));
+		for (std::size_t i = 0; i < n; ++i) ++counts[digitOf(data[i])];
+		if (std::find(counts, counts + kRadixBuckets, n) == counts + kRadixBuckets) break;
+		if (shift == 0) // Every element is equal
+		{
+			emit(data[0], n);
+			return;
+		}
+		shift -= 8;
+	}
+	if (shift == 0)
+	{
+		const Key prefix = static_cast<Key>(radixKey(data[0]) & ~static_cast<Key>(0xFF));
+		for (std::size_t b = 0; b < kRadixBuckets; ++b)
+		{
+			if (counts[b] != 0) emit(fromRadixKey<T>(static_cast<Key>(prefix | b)), counts[b]);
+		}
+		return;
+	}
+
+	exclusiveScan(counts, heads, kRadixBuckets);
+	for (std::size_t b = 0; b < kRadixBuckets; ++b) tails[b] = heads[b] + counts[b];
+	const auto digitOf = [shift](const T& value) { return static_cast<std::size_t>((radixKey(value) >> shift) & 0xFF); };
+	for (std::size_t b = 0; b < kRadixBuckets; ++b)
+	{
+		while (heads[b] < tails[b])
+		{
+			T value = data[heads[b]];
+			for (std::size_t digit = digitOf(value); digit != b; digit = digitOf(value))
+			{
+				std::swap(value, data[heads[digit]++]);
+			}
+			data[heads[b]++] = value;
+		}
+	}
+
+	std::size_t begin = 0;
+	for (std::size_t b = 0; b < kRadixBuckets; ++b)
+	{
+		if (counts[b] == 1) emit(data[begin], 1);
+		else if (counts[b] > 1) americanFlagRuns(data + begin, counts[b], emit, shift - 8, lsdThreshold);
+		begin += counts[b];
+	}
+}
+
+//*****************
+// Template Function: sortDistinct
+// Purpose: Sorts a container and keeps one element of every value, optionally counting how many there
+//          were. Integers are reported run by run from the sort itself: straight from the histogram when
+//          their values span a small range (countingSort's counts), otherwise from lsdRadixRuns, or from
+//          americanFlagRuns when its buffer does not fit the budget or InPlaceRadix is requested, and
+//          the distinct values are compacted to the front as they are reported, so neither the sorted
+//          duplicates nor a second pass over them is ever written. Other elements are sorted with
+//          comparisonSort and compacted in one pass.
+// Parameters:
+//    - holder: A reference to the container; needs erase (std::vector, std::deque, std::list).
+//    - descending: Sorts in descending order when true (default: false).
+//    - options: The SortOptions; the report records the engine used (default: SortOptions()).
+//    - counts: When given, receives the number of occurrences of every value kept, in the same order
+//              (default: nullptr).
+// Returns: The number of distinct values, now the size of holder.
+//*****************
+template <typename Container>
+std::size_t sortDistinct(Container& holder, bool descending = false, const SortOptions& options = SortOptions(), std::vector<std::size_t>* counts = nullptr)
+{
+	using Value = typename Container::value_type;
+	const std::size_t n = static_cast<std::size_t>(std::distance(holder.begin(), holder.end()));
+	if (counts) counts->clear();
+	std::size_t distinct = 0;
+
+	if constexpr (is_radix_sortable<Value>::value)
+	{
+		const std::size_t copyBytes = is_contiguous_container<Container>::value ? 0 : n * sizeof(Value);
+		if (n > 0 && options.fits(copyBytes))
+		{
+			const std::size_t budget = options.scratchBudget - copyBytes;
+			SortAlgorithm algorithm = SortAlgorithm::AmericanFlag;
+			std::size_t scratchBytes = 0;
+			withContiguousStorage(holder, [&](Value* data, std::size_t count)
+			{
+				auto emit = [&](Value value, std::size_t occurrences)
+				{
+					data[distinct++] = value;
+					if (counts) counts->push_back(occurrences);
+				};
+				const auto bounds = std::minmax_element(data, data + count);
+				const Value low = *bounds.first;
+				const std::size_t range = static_cast<std::size_t>(radixKey(*bounds.second) - radixKey(low));
+				if (range < kCountingSortMaxRange && range <= count && countingSortScratchBytes(count, range + 1) <= budget)
+				{
+					const auto key = radixKey(low);
+					const auto bucketOf = [key](const Value& value) { return static_cast<std::size_t>(radixKey(value) - key); };
+					WorkerPool pool(sortThreadCount(count));
+					const unsigned threads = pool.size();
+					std::vector<std::size_t> histograms(threads * (range + 1));
+					std::vector<std::size_t> totals(range + 1);
+					parallelHistogram(data, count, bucketOf, range + 1, pool, histograms.data());
+					sumHistograms(histograms.data(), range + 1, threads, totals.data());
+					for (std::size_t b = 0; b <= range; ++b)
+					{
+						if (totals[b] != 0) emit(static_cast<Value>(low + static_cast<Value>(b)), totals[b]);
+					}
+					algorithm = SortAlgorithm::Counting;
+					scratchBytes = countingSortScratchBytes(count, range + 1);
+					return;
+				}
+				if (options.engine != SortEngine::InPlaceRadix && lsdRadixScratchBytes<Value>(count) <= budget)
+				{
+					lsdRadixRuns(data, count, low, *bounds.second, emit);
+					algorithm = SortAlgorithm::LsdRadix;
+					scratchBytes = lsdRadixScratchBytes<Value>(count);
+					return;
+				}
+				const std::size_t lsdThreshold = lsdRadixScratchBytes<Value>(kAmericanFlagLsdThreshold) <= budget ? kAmericanFlagLsdThreshold : 0;
+				americanFlagRuns(data, count, emit, sizeof(Value) * 8 - 8, lsdThreshold);
+				scratchBytes = lsdThreshold ? lsdRadixScratchBytes<Value>(lsdThreshold) : 0;
+			});
+			holder.erase(std::next(holder.begin(), static_cast<std::ptrdiff_t>(distinct)), holder.end());
+			// The runs come out ascending; only the distinct values need reversing
+			if (descending)
+			{
+				std::reverse(holder.begin(), holder.end());
+				if (counts) std::reverse(counts->begin(), counts->end());
+			}
+			recordSortChoice(options, algorithm, n, copyBytes + scratchBytes);
+			return distinct;
+		}
+	}
+
+	if (descending) comparisonSort(holder, std::greater<Value>());
+	else comparisonSort(holder, std::less<Value>());
+	auto out = holder.begin();
+	for (auto it = holder.begin(); it != holder.end();)
+	{
+		auto end = std::next(it);
+		std::size_t occurrences = 1;
+		for (; end != holder.end() && *end == *it; ++end) ++occurrences;
+		if (out != it) *out = std::move(*it);
+		++out;
+		if (counts) counts->push_back(occurrences);
+		it = end;
+	}
+	distinct = static_cast<std::size_t>(std::distance(holder.begin(), out));
+	holder.erase(out, holder.end());
+	recordSortChoice(options, SortAlgorithm::Comparison, n, 0);
+	return distinct;
+}
@@ -0,0 +1,501 @@
+//*****************
+// bubblesort/external_sort.hpp
+// External sorting of binary integer files larger than the scratch budget: sorted runs spilled to files as
+// delta bit-packed blocks and merged, with reads, sorting and writes overlapped through AsyncIo.
+//*****************
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>    // for std::memcpy
+#include <functional> // for std::greater and std::less
+#include <utility>    // for std::move and std::swap
+
+#include "sort_engine.hpp"
+#include "integer_sort.hpp"
+#include "async_io.hpp"
+#include "block_codec.hpp"
+#include "fence_index.hpp"
+
+// Budgets below this are raised to it for external sorts: runs and merge buffers need some memory
+constexpr std::size_t kExternalSortMinBudget = 1 << 16;
+
+// Most runs merged at once; more runs are merged in several passes. Every run has at most one read in
+// flight and the output one write, so a merge stays within the AsyncIo queue
+constexpr std::size_t kExternalMergeFanIn = kAsyncIoQueueDepth - 2;
+
+// Fewest elements buffered per run while merging
+constexpr std::size_t kExternalMergeMinBuffer = 256;
+
+//*****************
+// Struct: SpillRun
+// Purpose: One sorted run of a spill file: where it starts, its packed size and how many elements it holds.
+//*****************
+struct SpillRun
+{
+	std::uint64_t offset;
+	std::uint64_t bytes;
+	std::size_t count;
+};
+
+//*****************
+// Template Function: mergeBufferBytes
+// Purpose: Returns the size of each of the two buffers every run and the output get when k runs share a
+//          merge budget.
+//*****************
+template <typename T>
+constexpr std::size_t mergeBufferBytes(std::size_t budget, std::size_t k) noexcept
+{
+	return std::max(kExternalMergeMinBuffer * sizeof(T), budget / (2 * (k + 1)));
+}
+
+//*****************
+// Class: RunWriter
+// Purpose: Writes sorted runs to a file through two buffers, so one fills while the other is being written.
+//          Packed writers encode every kPackedBlock elements with packSortedBlock (blocks never span runs);
+//          others write the elements as they are.
+//*****************
+template <typename T>
+class RunWriter
+{
+public:
+	RunWriter(AsyncIo& io, const IoFile& file, std::uint64_t offset, std::size_t bufferBytes, bool packed, bool descending)
+		: io_(io), file_(file), offset_(offset), packed_(packed), descending_(descending)
+	{
+		buffers_[0].resize(std::max(bufferBytes, maxPackedBlockBytes<T>()));
+		buffers_[1].resize(buffers_[0].size());
+	}
+	~RunWriter()
+	{
+		if (writing_) io_.wait(ticket_);
+	}
+	RunWriter(const RunWriter&) = delete;
+	RunWriter& operator=(const RunWriter&) = delete;
+
+	void push(const T& value)
+	{
+		if (fences_ && fenceCountdown_-- == 0)
+		{
+			fences_->push_back(value);
+			fenceCountdown_ = fenceStride_ - 1;
+		}
+		block_[count_] = value;
+		if (++count_ == kPackedBlock) emit();
+	}
+
+	void append(const T* values, std::size_t n)
+	{
+		while (n > 0)
+		{
+			const std::size_t take = std::min(n, kPackedBlock - count_);
+			std::copy(values, values + take, block_ + count_);
+			count_ += take;
+			values += take;
+			n -= take;
+			if (count_ == kPackedBlock) emit();
+		}
+	}
+
+	//*****************
+	// Function name: collectFences
+	// Purpose: Makes push append every stride-th element it receives, starting with the next, to fences.
+	//*****************
+	void collectFences(std::vector<T>& fences, std::size_t stride)
+	{
+		fences_ = &fences;
+		fenceStride_ = stride;
+		fenceCountdown_ = 0;
+	}
+
+	//*****************
+	// Function name: endRun
+	// Purpose: Ends the current run, packing its last partial block.
+	// Returns: The file offset where the next run starts.
+	//*****************
+	std::uint64_t endRun()
+	{
+		emit();
+		return offset_ + used_;
+	}
+
+	//*****************
+	// Function name: finish
+	// Purpose: Ends the current run, writes out the buffered blocks and waits for every write.
+	// Returns: true if every write succeeded.
+	//*****************
+	bool finish()
+	{
+		emit();
+		flush();
+		if (writing_) ok_ = io_.wait(ticket_) && ok_;
+		writing_ = false;
+		return ok_;
+	}
+
+private:
+	void emit()
+	{
+		if (count_ == 0) return;
+		if (used_ + maxPackedBlockBytes<T>() > buffers_[filling_].size()) flush();
+		unsigned char* out = buffers_[filling_].data() + used_;
+		if (packed_)
+		{
+			used_ += packSortedBlock(block_, count_, descending_, out);
+		}
+		else
+		{
+			std::memcpy(out, block_, count_ * sizeof(T));
+			used_ += count_ * sizeof(T);
+		}
+		count_ = 0;
+	}
+
+	// Waits for the previous buffer, then starts writing the one just filled and switches buffers
+	void flush()
+	{
+		if (writing_) ok_ = io_.wait(ticket_) && ok_;
+		writing_ = used_ > 0;
+		if (writing_) ticket_ = io_.write(file_, buffers_[filling_].data(), used_, offset_);
+		offset_ += used_;
+		used_ = 0;
+		filling_ = 1 - filling_;
+	}
+
+	AsyncIo& io_;
+	const IoFile& file_;
+	std::uint64_t offset_;
+	bool packed_;
+	bool descending_;
+	std::vector<unsigned char> buffers_[2];
+	int filling_ = 0;
+	std::size_t used_ = 0;
+	bool writing_ = false;
+	bool ok_ = true;
+	AsyncIo::Ticket ticket_ = 0;
+	T block_[kPackedBlock];
+	std::size_t count_ = 0;
+	std::vector<T>* fences_ = nullptr;
+	std::size_t fenceStride_ = 0;
+	std::size_t fenceCountdown_ = 0;
+};
+
+//*****************
+// Class: RunReader
+// Purpose: Reads a packed run back one block at a time. The run is read in chunks through two buffers, so
+//          the next chunk is in flight while blocks of the current one are decoded; a block cut off at the
+//          end of a chunk is copied into the slack in front of the next one.
+//*****************
+template <typename T>
+class RunReader
+{
+public:
+	RunReader(AsyncIo& io, const IoFile& file, const SpillRun& run, std::size_t bufferBytes, bool descending)
+		: io_(io), file_(file), nextOffset_(run.offset), remaining_(run.bytes), descending_(descending)
+	{
+		chunk_ = static_cast<std::size_t>(std::min<std::uint64_t>(std::max(bufferBytes, 2 * kSlack) - kSlack, run.bytes));
+		buffers_[0].resize(kSlack + chunk_);
+		buffers_[1].resize(kSlack + chunk_);
+		prefetch();
+	}
+	~RunReader()
+	{
+		if (pending_) io_.wait(ticket_); // Only left behind after an error
+	}
+	RunReader(const RunReader&) = delete;
+	RunReader& operator=(const RunReader&) = delete;
+
+	//*****************
+	// Function name: next
+	// Purpose: Decodes the next block of the run into values().
+	// Returns: false once the run is exhausted or a read failed (see ok()).
+	//*****************
+	bool next()
+	{
+		for (;;)
+		{
+			const std::size_t available = end_ - position_;
+			const unsigned char* data = buffers_[current_].data() + position_;
+			if (available >= 2 && packedBlockBytes<T>(data) <= available)
+			{
+				position_ += packedBlockBytes<T>(data);
+				count_ = unpackSortedBlock(data, descending_, values_);
+				return true;
+			}
+			if (!pending_)
+			{
+				ok_ = available == 0 && ok_; // A truncated block means the run is damaged
+				return false;
+			}
+			ok_ = io_.wait(ticket_) && ok_;
+			pending_ = false;
+			if (!ok_) return false;
+			const int next = 1 - current_;
+			std::memcpy(buffers_[next].data() + kSlack - available, data, available);
+			current_ = next;
+			position_ = kSlack - available;
+			end_ = kSlack + requested_;
+			prefetch();
+		}
+	}
+
+	const T* values() const noexcept { return values_; }
+	std::size_t count() const noexcept { return count_; }
+	bool ok() const noexcept { return ok_; }
+
+private:
+	static constexpr std::size_t kSlack = maxPackedBlockBytes<T>();
+
+	// Starts reading the next chunk of the run behind the slack of the buffer not being decoded
+	void prefetch()
+	{
+		requested_ = static_cast<std::size_t>(std::min<std::uint64_t>(chunk_, remaining_));
+		pending_ = requested_ > 0;
+		if (!pending_) return;
+		ticket_ = io_.read(file_, buffers_[1 - current_].data() + kSlack, requested_, nextOffset_);
+		nextOffset_ += requested_;
+		remaining_ -= requested_;
+	}
+
+	AsyncIo& io_;
+	const IoFile& file_;
+	std::uint64_t nextOffset_;
+	std::uint64_t remaining_;      // Bytes of the run not yet requested
+	bool descending_;
+	std::size_t chunk_ = 0;
+	std::vector<unsigned char> buffers_[2];
+	int current_ = 1;              // The buffer being decoded; the other one is being read
+	std::size_t position_ = kSlack;
+	std::size_t end_ = kSlack;
+	std::size_t requested_ = 0;
+	bool pending_ = false;
+	bool ok_ = true;
+	AsyncIo::Ticket ticket_ = 0;
+	T values_[kPackedBlock];
+	std::size_t count_ = 0;
+};
+
+//*****************
+// Template Function: mergeRuns
+// Purpose: Merges packed sorted runs of a spill file into a RunWriter with a k-way tournament (loser tree)
+//          merge. Every run is read and decoded by a RunReader, so while the merge consumes one block of a
+//          run its next chunk is being read, and the writer writes one buffer while the merge fills the other.
+// Parameters:
+//    - io: The AsyncIo running the reads and writes.
+//    - input: The spill file holding the runs.
+//    - runs: The runs to merge (at most kExternalMergeFanIn).
+//    - output: The writer receiving the merged elements as one run.
+//    - bufferBytes: The size of each of a run's two read buffers (see mergeBufferBytes).
+//    - descending: The runs are sorted in descending order.
+// Returns: true on success, false on a read error.
+//*****************
+template <typename T>
+bool mergeRuns(AsyncIo& io, const IoFile& input, const std::vector<SpillRun>& runs, RunWriter<T>& output,
+	std::size_t bufferBytes, bool descending)
+{
+	const std::size_t k = runs.size();
+	std::deque<RunReader<T>> sources;
+	for (const SpillRun& run : runs) sources.emplace_back(io, input, run, bufferBytes, descending);
+
+	// The current element of every run is kept in one array, so the matches below touch little memory
+	std::vector<T> heads(k);
+	std::vector<std::size_t> positions(k);
+	std::vector<unsigned char> exhausted(k);
+	for (std::size_t run = 0; run < k; ++run)
+	{
+		exhausted[run] = !sources[run].next();
+		if (!exhausted[run]) heads[run] = sources[run].values()[0];
+	}
+
+	// Loser tree: tree[0] holds the run whose current element is written next, every inner node the run that
+	// lost the match played there, so replacing the winner replays one leaf-to-root path of log2(k) matches.
+	// Exhausted runs lose every match and ties go to the earlier run.
+	const auto beats = [&heads, &exhausted, descending](std::size_t a, std::size_t b)
+	{
+		if (exhausted[a] || exhausted[b]) return !exhausted[a] && exhausted[b];
+		if (heads[a] != heads[b]) return descending ? heads[a] > heads[b] : heads[a] < heads[b];
+		return a < b;
+	};
+	constexpr std::size_t kNone = ~std::size_t(0);
+	std::vector<std::size_t> tree(std::max<std::size_t>(k, 1), kNone);
+	for (std::size_t run = 0; run < k; ++run)
+	{
+		// Each inner node keeps the first subtree winner to arrive and sends the better of the two on
+		std::size_t winner = run;
+		for (std::size_t node = (run + k) / 2; node > 0 && winner != kNone; node /= 2)
+		{
+			if (tree[node] == kNone || beats(tree[node], winner)) std::swap(tree[node], winner);
+		}
+		if (winner != kNone) tree[0] = winner;
+	}
+
+	while (k > 0 && !exhausted[tree[0]])
+	{
+		const std::size_t run = tree[0];
+		RunReader<T>& source = sources[run];
+		output.push(heads[run]);
+		if (++positions[run] == source.count())
+		{
+			exhausted[run] = !source.next();
+			positions[run] = 0;
+		}
+		if (!exhausted[run]) heads[run] = source.values()[positions[run]];
+
+		std::size_t winner = run;
+		for (std::size_t node = (run + k) / 2; node > 0; node /= 2)
+		{
+			if (beats(tree[node], winner)) std::swap(tree[node], winner);
+		}
+		tree[0] = winner;
+	}
+	return std::all_of(sources.begin(), sources.end(), [](const RunReader<T>& source) { return source.ok(); });
+}
+
+//*****************
+// Template Function: externalSortFile
+// Purpose: Sorts a binary file of native-endian integers into another file within the scratch budget of
+//          options. A file that fits the budget is loaded and sorted in memory with integerSort, using the
+//          rest of the budget as its scratch. A larger file is sorted in runs of three eighths of the budget
+//          through two buffers, so reading the next run overlaps sorting the current one, and every run is
+//          delta bit-packed (packSortedBlock) into a temporary spill file by a RunWriter holding the last
+//          quarter. The runs are then merged with mergeRuns (in several passes, spilling packed again, when
+//          there are more than kExternalMergeFanIn), and the report records SortAlgorithm::External, the
+//          spilled runs and the packed bytes spilled. Budgets below kExternalSortMinBudget are raised to it
+//          for external sorts.
+// Parameters:
+//    - inputPath: The file to be sorted; its size must be a multiple of sizeof(T).
+//    - outputPath: The file receiving the sorted integers (may be inputPath).
+//    - options: The SortOptions (default: SortOptions()).
+//    - descending: Sorts in descending order when true (default: false).
+//    - spillDirectory: The directory for the spill files (default: the system temporary directory).
+//    - indexPath: When not empty, a fence index over the output is written there (see SortedFileReader),
+//      collected while the output is written (default: empty).
+// Returns: true on success, false if a file could not be read or written.
+//*****************
+template <typename T>
+bool externalSortFile(const std::string& inputPath, const std::string& outputPath, const SortOptions& options = SortOptions(),
+	bool descending = false, const std::string& spillDirectory = std::string(), const std::string& indexPath = std::string())
+{
+	static_assert(is_radix_sortable<T>::value, "externalSortFile requires an integer type");
+	IoFile input;
+	if (!input.openRead(inputPath)) return false;
+	const std::uint64_t fileBytes = input.size();
+	if (fileBytes % sizeof(T) != 0) return false;
+	const std::size_t n = static_cast<std::size_t>(fileBytes / sizeof(T));
+
+	if (options.fits(static_cast<std::size_t>(fileBytes)))
+	{
+		std::vector<T> data(n);
+		if (!input.readAt(data.data(), n * sizeof(T), 0)) return false;
+		input.close();
+		integerSort(data, descending, SortOptions(options.engine, options.scratchBudget - n * sizeof(T), options.report));
+		IoFile output;
+		if (!output.openWrite(outputPath)) return false;
+		const bool written = output.writeAt(data.data(), n * sizeof(T), 0);
+		if (!output.close() || !written) return false;
+		if (indexPath.empty()) return true;
+		std::vector<T> fences;
+		for (std::size_t position = 0; position < n; position += kFenceIndexStride) fences.push_back(data[position]);
+		return writeFenceIndex(indexPath, fences, n, kFenceIndexStride, descending);
+	}
+
+	// Two run buffers alternate between reading and sorting and the spill writer's two buffers take the rest
+	// of the budget, so runs are sorted in place (americanFlagSort) with whatever is left as scratch
+	const std::size_t budget = std::max(options.scratchBudget, kExternalSortMinBudget);
+	const std::size_t runElements = std::max<std::size_t>(1, budget * 3 / (8 * sizeof(T)));
+	const std::size_t writerBytes = budget / 8;
+	const SortOptions runOptions(options.engine, budget - std::min(budget, 2 * (runElements * sizeof(T) + writerBytes)));
+	std::vector<T> buffers[2];
+	for (std::vector<T>& buffer : buffers) buffer.resize(std::min(runElements, n));
+
+	IoFile spill;
+	if (!spill.openTemporary(spillDirectory)) return false;
+	AsyncIo io; // Destroyed before the buffers, so no request outlives them
+
+	const std::size_t chunks = (n + runElements - 1) / runElements;
+	const auto chunkSize = [n, runElements](std::size_t chunk) { return std::min(runElements, n - chunk * runElements); };
+	std::vector<SpillRun> runs;
+	std::uint64_t spillBytes = 0;
+	bool ok = true;
+	{
+		RunWriter<T> writer(io, spill, 0, writerBytes, true, descending);
+		AsyncIo::Ticket readTicket = io.read(input, buffers[0].data(), chunkSize(0) * sizeof(T), 0);
+		bool reading = true;
+		for (std::size_t chunk = 0; ok && chunk < chunks; ++chunk)
+		{
+			std::vector<T>& current = buffers[chunk % 2];
+			ok = io.wait(readTicket);
+			reading = false;
+			if (!ok) break;
+			if (chunk + 1 < chunks)
+			{
+				// The other buffer was packed into the writer before this chunk, so it is free
+				std::vector<T>& next = buffers[(chunk + 1) % 2];
+				next.resize(chunkSize(chunk + 1));
+				readTicket = io.read(input, next.data(), next.size() * sizeof(T), static_cast<std::uint64_t>(chunk + 1) * runElements * sizeof(T));
+				reading = true;
+			}
+
+			integerSort(current, descending, runOptions);
+			writer.append(current.data(), current.size());
+			const std::uint64_t end = writer.endRun();
+			runs.push_back({ spillBytes, end - spillBytes, current.size() });
+			spillBytes = end;
+		}
+		if (reading) io.wait(readTicket);
+		ok = writer.finish() && ok;
+	}
+	for (std::vector<T>& buffer : buffers) std::vector<T>().swap(buffer);
+	input.close();
+	const std::size_t spilledRuns = runs.size();
+
+	// Merge passes until one final merge can take every run
+	while (ok && runs.size() > kExternalMergeFanIn)
+	{
+		IoFile merged;
+		if (!merged.openTemporary(spillDirectory)) { ok = false; break; }
+		const std::size_t bufferBytes = mergeBufferBytes<T>(budget, kExternalMergeFanIn);
+		RunWriter<T> writer(io, merged, 0, bufferBytes, true, descending);
+		std::vector<SpillRun> mergedRuns;
+		std::uint64_t offset = 0;
+		for (std::size_t begin = 0; ok && begin < runs.size(); begin += kExternalMergeFanIn)
+		{
+			const std::vector<SpillRun> group(runs.begin() + begin, runs.begin() + std::min(runs.size(), begin + kExternalMergeFanIn));
+			std::size_t count = 0;
+			for (const SpillRun& run : group) count += run.count;
+			ok = mergeRuns<T>(io, spill, group, writer, bufferBytes, descending);
+			const std::uint64_t end = writer.endRun();
+			mergedRuns.push_back({ offset, end - offset, count });
+			offset = end;
+		}
+		ok = writer.finish() && ok;
+		spillBytes += offset;
+		spill = std::move(merged);
+		runs.swap(mergedRuns);
+	}
+
+	if (ok)
+	{
+		IoFile output;
+		const std::size_t bufferBytes = mergeBufferBytes<T>(budget, runs.size());
+		RunWriter<T> writer(io, output, 0, bufferBytes, false, descending);
+		std::vector<T> fences;
+		if (!indexPath.empty()) writer.collectFences(fences, kFenceIndexStride);
+		ok = output.openWrite(outputPath) && mergeRuns<T>(io, spill, runs, writer, bufferBytes, descending);
+		ok = writer.finish() && ok;
+		ok = output.close() && ok;
+		ok = ok && (indexPath.empty() || writeFenceIndex(indexPath, fences, n, kFenceIndexStride, descending));
+	}
+	if (!ok) return false;
+
+	if (options.report)
+	{
+		options.report->spilledRuns += spilledRuns;
+		options.report->spilledBytes += static_cast<std::size_t>(spillBytes);
+	}
+	recordSortChoice(options, SortAlgorithm::External, n, budget);
+	return true;
+}
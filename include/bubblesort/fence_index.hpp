@@ -0,0 +1,233 @@
+//*****************
+// bubblesort/fence_index.hpp
+// Sparse fence-pointer indexes over sorted binary integer files, and a reader answering lower_bound and
+// range queries by loading only the blocks the fences point at.
+//*****************
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>    // for std::memcmp and std::memcpy
+#include <limits>
+#include <type_traits>
+
+#include "integer_sort.hpp"
+#include "async_io.hpp"
+#include "search_tree.hpp"
+
+// A fence index file starts with this magic
+constexpr char kFenceIndexMagic[4] = { 'B', 'S', 'F', 'X' };
+constexpr unsigned char kFenceIndexVersion = 1;
+
+// Size of the header: the magic, the version, the element size, its signedness, the order, then the
+// stride, the element count and the fence count as native-endian 64-bit integers
+constexpr std::size_t kFenceIndexHeaderBytes = sizeof(kFenceIndexMagic) + 4 + 3 * sizeof(std::uint64_t);
+
+// Elements per block: the index keeps the first element of every block
+constexpr std::size_t kFenceIndexStride = 1024;
+
+// Elements buildFenceIndex reads at once
+constexpr std::size_t kFenceIndexScanChunk = 1 << 16;
+
+//*****************
+// Template Function: writeFenceIndex
+// Purpose: Writes a fence index for a sorted file of count elements: fences[i] is its element at position
+//          i * stride, so block i spans positions [i * stride, (i + 1) * stride).
+// Parameters:
+//    - path: The index file to create or replace.
+//    - fences: The first element of every block.
+//    - count: Number of elements in the sorted file.
+//    - stride: Elements per block.
+//    - descending: The file is sorted in descending order.
+// Returns: true on success, false if the file could not be written.
+//*****************
+template <typename T>
+bool writeFenceIndex(const std::string& path, const std::vector<T>& fences, std::uint64_t count, std::size_t stride, bool descending)
+{
+	unsigned char header[kFenceIndexHeaderBytes];
+	std::memcpy(header, kFenceIndexMagic, sizeof(kFenceIndexMagic));
+	header[4] = kFenceIndexVersion;
+	header[5] = static_cast<unsigned char>(sizeof(T));
+	header[6] = std::is_signed<T>::value ? 1 : 0;
+	header[7] = descending ? 1 : 0;
+	const std::uint64_t fields[3] = { stride, count, fences.size() };
+	std::memcpy(header + 8, fields, sizeof(fields));
+
+	IoFile file;
+	if (!file.openWrite(path)) return false;
+	const bool written = file.writeAt(header, sizeof(header), 0) && file.writeAt(fences.data(), fences.size() * sizeof(T), sizeof(header));
+	return file.close() && written;
+}
+
+//*****************
+// Template Function: buildFenceIndex
+// Purpose: Writes a fence index for an existing sorted file with one sequential pass over it.
+// Parameters:
+//    - sortedPath: The sorted binary file of native-endian integers.
+//    - indexPath: The index file to create or replace.
+//    - descending: The file is sorted in descending order (default: false).
+//    - stride: Elements per block (default: kFenceIndexStride).
+// Returns: true on success, false if a file could not be read or written.
+//*****************
+template <typename T>
+bool buildFenceIndex(const std::string& sortedPath, const std::string& indexPath, bool descending = false, std::size_t stride = kFenceIndexStride)
+{
+	static_assert(is_radix_sortable<T>::value, "buildFenceIndex requires an integer type");
+	IoFile file;
+	if (stride == 0 || !file.openRead(sortedPath) || file.size() % sizeof(T) != 0) return false;
+	const std::uint64_t count = file.size() / sizeof(T);
+
+	std::vector<T> fences, chunk;
+	for (std::uint64_t begin = 0; begin < count; begin += chunk.size())
+	{
+		chunk.resize(static_cast<std::size_t>(std::min<std::uint64_t>(kFenceIndexScanChunk, count - begin)));
+		if (!file.readAt(chunk.data(), chunk.size() * sizeof(T), begin * sizeof(T))) return false;
+		for (std::uint64_t position = (begin + stride - 1) / stride * stride; position < begin + chunk.size(); position += stride)
+		{
+			fences.push_back(chunk[static_cast<std::size_t>(position - begin)]);
+		}
+	}
+	return writeFenceIndex(indexPath, fences, count, stride, descending);
+}
+
+//*****************
+// Class: SortedFileReader
+// Purpose: Point and range lookups on a sorted binary file through its fence index. open loads only the
+//          index and lays its fences out as an EytzingerIndex; every lookup then finds the one block that
+//          can hold the answer among the fences and reads just that block from the file (the last block read
+//          is kept, so nearby lookups reuse it). Positions follow the file's own order, ascending or
+//          descending, as std::lower_bound with the file's ordering would return them.
+//*****************
+template <typename T>
+class SortedFileReader
+{
+public:
+	using Key = typename std::make_unsigned<T>::type;
+
+	//*****************
+	// Function name: open
+	// Purpose: Opens a sorted file and loads its fence index.
+	// Returns: false if a file is missing or the index is malformed, written for another element type or
+	//          for a file of another size.
+	//*****************
+	bool open(const std::string& dataPath, const std::string& indexPath)
+	{
+		IoFile index;
+		unsigned char header[kFenceIndexHeaderBytes];
+		if (!index.openRead(indexPath) || !index.readAt(header, sizeof(header), 0)) return false;
+		if (std::memcmp(header, kFenceIndexMagic, sizeof(kFenceIndexMagic)) != 0 || header[4] != kFenceIndexVersion) return false;
+		if (header[5] != sizeof(T) || header[6] != (std::is_signed<T>::value ? 1 : 0)) return false;
+		std::uint64_t fields[3];
+		std::memcpy(fields, header + 8, sizeof(fields));
+		descending_ = header[7] != 0;
+		stride_ = static_cast<std::size_t>(fields[0]);
+		count_ = fields[1];
+		if (stride_ == 0 || fields[2] != (count_ + stride_ - 1) / stride_ || index.size() != sizeof(header) + fields[2] * sizeof(T)) return false;
+
+		std::vector<T> fences(static_cast<std::size_t>(fields[2]));
+		if (!index.readAt(fences.data(), fences.size() * sizeof(T), sizeof(header))) return false;
+		std::vector<Key> keys(fences.size());
+		std::transform(fences.begin(), fences.end(), keys.begin(), [this](T value) { return orderKey(value); });
+		if (!std::is_sorted(keys.begin(), keys.end())) return false;
+		fences_.build(keys.data(), keys.size());
+
+		block_.clear();
+		blockIndex_ = std::numeric_limits<std::size_t>::max();
+		blocksRead_ = 0;
+		ok_ = true;
+		return data_.openRead(dataPath) && data_.size() == count_ * sizeof(T);
+	}
+
+	std::uint64_t size() const noexcept { return count_; }
+	bool descending() const noexcept { return descending_; }
+
+	// Blocks read from the sorted file since open, to see how much a workload loads
+	std::size_t blocksRead() const noexcept { return blocksRead_; }
+
+	//*****************
+	// Function name: lowerBound
+	// Purpose: Returns the position of the first element not ordered before value, reading one block.
+	//*****************
+	std::uint64_t lowerBound(T value) { return bound(orderKey(value), false); }
+
+	//*****************
+	// Function name: upperBound
+	// Purpose: Returns the position of the first element ordered after value, reading one block.
+	//*****************
+	std::uint64_t upperBound(T value) { return bound(orderKey(value), true); }
+
+	//*****************
+	// Function name: contains
+	// Purpose: Tells whether the file holds value.
+	//*****************
+	bool contains(T value)
+	{
+		const std::uint64_t position = lowerBound(value);
+		// The answer is in the block just read, or is the first element of the next one
+		return position < count_ && loadBlock(static_cast<std::size_t>(position / stride_)) && block_[static_cast<std::size_t>(position % stride_)] == value;
+	}
+
+	//*****************
+	// Function name: readRange
+	// Purpose: Reads the elements between low and high (inclusive, in either order) into values, in file
+	//          order: two block lookups find the range and one read loads exactly its elements.
+	// Returns: false if the file could not be read.
+	//*****************
+	bool readRange(T low, T high, std::vector<T>& values)
+	{
+		const Key first = std::min(orderKey(low), orderKey(high));
+		const Key last = std::max(orderKey(low), orderKey(high));
+		const std::uint64_t begin = bound(first, false);
+		const std::uint64_t end = bound(last, true);
+		values.resize(static_cast<std::size_t>(end - begin));
+		return ok_ && data_.readAt(values.data(), values.size() * sizeof(T), begin * sizeof(T));
+	}
+
+	// False once a read of the sorted file has failed
+	bool ok() const noexcept { return ok_; }
+
+private:
+	// Maps values to keys that increase along the file, so one ascending search serves both orders
+	Key orderKey(T value) const noexcept
+	{
+		return static_cast<Key>(radixKey(value) ^ (descending_ ? std::numeric_limits<Key>::max() : 0));
+	}
+
+	// The first position whose key is not below key (or, for upper, above it). The fences narrow the answer
+	// to one block: the block before the first fence past key
+	std::uint64_t bound(Key key, bool upper)
+	{
+		const std::size_t fence = upper ? fences_.upperBound(key) : fences_.lowerBound(key);
+		if (fence == 0) return 0;
+		const std::size_t block = fence - 1;
+		if (!loadBlock(block)) return count_;
+		const auto inBlock = upper
+			? std::upper_bound(block_.begin(), block_.end(), key, [this](Key wanted, T value) { return wanted < orderKey(value); })
+			: std::lower_bound(block_.begin(), block_.end(), key, [this](T value, Key wanted) { return orderKey(value) < wanted; });
+		return static_cast<std::uint64_t>(block) * stride_ + static_cast<std::uint64_t>(inBlock - block_.begin());
+	}
+
+	bool loadBlock(std::size_t block)
+	{
+		if (block == blockIndex_) return true;
+		const std::uint64_t begin = static_cast<std::uint64_t>(block) * stride_;
+		block_.resize(static_cast<std::size_t>(std::min<std::uint64_t>(stride_, count_ - begin)));
+		ok_ = data_.readAt(block_.data(), block_.size() * sizeof(T), begin * sizeof(T)) && ok_;
+		blockIndex_ = ok_ ? block : std::numeric_limits<std::size_t>::max();
+		++blocksRead_;
+		return ok_;
+	}
+
+	IoFile data_;
+	EytzingerIndex<Key> fences_;
+	std::uint64_t count_ = 0;
+	std::size_t stride_ = kFenceIndexStride;
+	bool descending_ = false;
+	bool ok_ = true;
+	std::vector<T> block_;
+	std::size_t blockIndex_ = std::numeric_limits<std::size_t>::max();
+	std::size_t blocksRead_ = 0;
+};
@@ -0,0 +1,198 @@
+//*****************
+// bubblesort/functors.hpp
+// Comparator and projection functors for custom sorting orders.
+//*****************
+#pragma once
+
+#include <cstddef>
+#include <functional> // for std::less
+#include <string>
+#include <utility>    // for std::forward
+
+// Classifiers map an element to a class in [0, classes). Comparators that order whole classes one after
+// another declare the classifier and the order within a class as member types (classifier, class_compare),
+// so sortLeaf partitions the elements into their classes once (see partitionClasses) and sorts each class
+// with the engine for class_compare instead of bubbling every pair through the comparator.
+
+//*****************
+// Functor: DivisibilityClass
+// Purpose: Classifies integers by divisibility: with DivisibleFirst, multiples of Divisor are class 0 and
+//          the rest class 1; otherwise the other way round.
+//*****************
+template <int Divisor, bool DivisibleFirst>
+struct DivisibilityClass
+{
+	static_assert(Divisor > 0, "DivisibilityClass requires a positive divisor");
+	static constexpr std::size_t classes = 2;
+	static constexpr int divisor = Divisor;
+	static constexpr bool divisibleFirst = DivisibleFirst;
+
+	std::size_t operator()(int value) const noexcept
+	{
+		return static_cast<std::size_t>((value % Divisor == 0) != DivisibleFirst);
+	}
+};
+
+//*****************
+// Functor: ModuloClass
+// Purpose: Classifies integers by their remainder modulo Divisor, in [0, Divisor) for negative values too.
+//*****************
+template <int Divisor>
+struct ModuloClass
+{
+	static_assert(Divisor > 0 && Divisor <= 256, "ModuloClass requires a divisor between 1 and 256");
+	static constexpr std::size_t classes = Divisor;
+
+	std::size_t operator()(int value) const noexcept
+	{
+		const int remainder = value % Divisor;
+		return static_cast<std::size_t>(remainder < 0 ? remainder + Divisor : remainder);
+	}
+};
+
+// Functors for custom sorting based on different criteria
+
+//*****************
+// Functor: OddFirst
+// Purpose: Sorts integers such that odd numbers come before even numbers,
+//          and within the same group, sorts in ascending order.
+//*****************
+struct OddFirst
+{
+	using classifier = DivisibilityClass<2, false>;
+	using class_compare = std::less<int>;
+
+	bool operator()(const int& a, const int& b) const
+	{
+		if ((a % 2 != 0) && (b % 2 == 0)) return false; // Odd numbers first
+		if ((a % 2 == 0) && (b % 2 != 0)) return true;  // Even numbers after
+		return a < b;  // Sort within the same group (odd or even) in ascending order
+	}
+};
+
+//*****************
+// Functor: DivisibleBy3First
+// Purpose: Sorts integers such that numbers divisible by 3 come first,
+//          and within the same group, sorts in ascending order.
+//*****************
+struct DivisibleBy3First
+{
+	using classifier = DivisibilityClass<3, true>;
+	using class_compare = std::less<int>;
+
+	bool operator()(const int& a, const int& b) const
+	{
+		if ((a % 3 == 0) && (b % 3 != 0)) return false; // Divisible by 3 come first
+		if ((a % 3 != 0) && (b % 3 == 0)) return true;
+		return a < b;  // Sort within the same group (divisible by 3 or not)
+	}
+};
+
+//*****************
+// Functor: EvenFirst
+// Purpose: Sorts integers such that even numbers come before odd numbers,
+//          and within the same group, sorts in ascending order.
+//*****************
+struct EvenFirst
+{
+	using classifier = DivisibilityClass<2, true>;
+	using class_compare = std::less<int>;
+
+	bool operator()(const int& a, const int& b) const
+	{
+		if ((a % 2 == 0) && (b % 2 != 0)) return false; // Even numbers first
+		if ((a % 2 != 0) && (b % 2 == 0)) return true;  // Odd numbers after
+		return a < b;  // Sort within same group (even or odd)
+	}
+};
+
+// Projections map an element to the key it is ordered by, for recursiveSort(container, compare, projection).
+// Comparators that are a projection composed with std::less or std::greater declare both as member types
+// (projection, key_compare), so recursiveSort computes each key once instead of on every comparison.
+
+//*****************
+// Functor: Identity
+// Purpose: Projection that returns the element itself (ordering by the element, as without a projection).
+//*****************
+struct Identity
+{
+	template <typename T>
+	constexpr T&& operator()(T&& value) const noexcept
+	{
+		return std::forward<T>(value);
+	}
+};
+
+//*****************
+// Functor: DigitSum
+// Purpose: Projects an integer to the sum of its decimal digits (0 for values below 1).
+//*****************
+struct DigitSum
+{
+	int operator()(int n) const
+	{
+		int sum = 0;
+		while (n > 0)
+		{
+			sum += n % 10;
+			n /= 10;
+		}
+		return sum;
+	}
+};
+
+//*****************
+// Functor: AlphabeticalSum
+// Purpose: Projects a string to the sum of its alphabetical positions (e.g., 'a' = 1, 'b' = 2, ..., 'z' = 26).
+//*****************
+struct AlphabeticalSum
+{
+	int operator()(const std::string& s) const
+	{
+		int sum = 0;
+		for (char c : s) sum += c - 'a' + 1;
+		return sum;
+	}
+};
+
+//*****************
+// Functor: SumOfDigits
+// Purpose: Sorts integers based on the sum of their digits in ascending order.
+//*****************
+struct SumOfDigits
+{
+	using projection = DigitSum;
+	using key_compare = std::less<int>;
+
+	//*****************
+	// Helper Function: sumDigits
+	// Purpose: Returns the sum of the digits of a given integer.
+	//*****************
+	int sumDigits(int n) const
+	{
+		return DigitSum()(n);
+	}
+
+	// Overloaded operator() to compare numbers based on the sum of their digits.
+	bool operator()(const int& a, const int& b) const
+	{
+		return sumDigits(a) < sumDigits(b); // Sort by sum of digits
+	}
+};
+
+//*****************
+// Functor: AlphabeticalPosition
+// Purpose: Sorts strings based on the sum of their alphabetical positions
+//          (e.g., 'a' = 1, 'b' = 2, ..., 'z' = 26).
+//*****************
+struct AlphabeticalPosition
+{
+	using projection = AlphabeticalSum;
+	using key_compare = std::less<int>;
+
+	bool operator()(const std::string& a, const std::string& b) const
+	{
+		const AlphabeticalSum position;
+		return position(a) < position(b);  // Compare positions
+	}
+};
@@ -0,0 +1,392 @@
+//*****************
+// bubblesort/generators.hpp
+// Reproducible synthetic data for benchmarks and tests.
+//*****************
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>     // for std::numeric_limits
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "parallel.hpp"
+
+//*****************
+// Synthetic data generators
+// Reproducible inputs for benchmarks and tests. Random words come from four interleaved xoshiro256**
+// streams (laid out so the compiler vectorizes the update) and every block of kGeneratorBlock values is
+// seeded from its index, so the output depends only on the seed, never on the number of threads.
+//*****************
+
+//*****************
+// Enum: Distribution
+// Purpose: The shape of the values produced by generateData.
+//*****************
+enum class Distribution
+{
+	Uniform,       // Uniform over [low, high]
+	Zipf,          // Zipf-distributed ranks over [low, high]; low values are the most frequent
+	Gaussian,      // Normal around the middle of [low, high], clamped to the range
+	Sorted,        // Ascending over [low, high]
+	Reverse,       // Descending over [low, high]
+	SortedRuns,    // Uniform values in ascending runs of runLength elements
+	OrganPipe,     // Ascending first half, descending second half
+	AllEqual,      // Every value equals low
+	AntiQuicksort  // Median-of-3 killer permutation (Musser), worst case for naive quicksort pivots
+};
+
+//*****************
+// Struct: GeneratorOptions
+// Purpose: Parameters of generateData and the nested generators.
+//*****************
+struct GeneratorOptions
+{
+	Distribution distribution = Distribution::Uniform;
+	std::uint64_t seed = 42;
+	double low = 0;                // Smallest value produced
+	double high = 1000000;         // Largest value produced
+	double zipfExponent = 1.1;     // Skew of Distribution::Zipf
+	std::size_t runLength = 1024;  // Run length of Distribution::SortedRuns
+};
+
+// Number of values generated from one seed; blocks are the unit of parallel work
+constexpr std::size_t kGeneratorBlock = 1 << 14;
+
+//*****************
+// Function name: splitMix64
+// Purpose: Returns the next value of the SplitMix64 sequence, used to expand seeds into generator states.
+// Parameters:
+//    - state: The sequence state, advanced in place.
+//*****************
+inline std::uint64_t splitMix64(std::uint64_t& state) noexcept
+{
+	std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+//*****************
+// Struct: Xoshiro256x4
+// Purpose: Four independent xoshiro256** generators stepped together. Each state word is stored as an
+//          array over the four lanes, so every update is a plain loop the compiler turns into SIMD code.
+//*****************
+struct Xoshiro256x4
+{
+	static constexpr std::size_t kLanes = 4;
+	std::uint64_t s0[kLanes], s1[kLanes], s2[kLanes], s3[kLanes];
+
+	explicit Xoshiro256x4(std::uint64_t seed) noexcept
+	{
+		for (std::size_t lane = 0; lane < kLanes; ++lane)
+		{
+			s0[lane] = splitMix64(seed);
+			s1[lane] = splitMix64(seed);
+			s2[lane] = splitMix64(seed);
+			s3[lane] = splitMix64(seed);
+		}
+	}
+
+	// Writes the next random word of every lane to out
+	void next(std::uint64_t* out) noexcept
+	{
+		for (std::size_t lane = 0; lane < kLanes; ++lane)
+		{
+			const std::uint64_t x = s1[lane] * 5;
+			out[lane] = ((x << 7) | (x >> 57)) * 9;
+			const std::uint64_t t = s1[lane] << 17;
+			s2[lane] ^= s0[lane];
+			s3[lane] ^= s1[lane];
+			s1[lane] ^= s2[lane];
+			s0[lane] ^= s3[lane];
+			s2[lane] ^= t;
+			s3[lane] = (s3[lane] << 45) | (s3[lane] >> 19);
+		}
+	}
+};
+
+//*****************
+// Function name: fillRandomWords
+// Purpose: Fills out with reproducible random 64-bit words, generating blocks in parallel.
+// Parameters:
+//    - out: Pointer to n words of output.
+//    - n: Number of words.
+//    - seed: The seed; block b is generated from seed and b only.
+// Returns: void
+//*****************
+inline void fillRandomWords(std::uint64_t* out, std::size_t n, std::uint64_t seed)
+{
+	const std::size_t blocks = (n + kGeneratorBlock - 1) / kGeneratorBlock;
+	const unsigned threads = static_cast<unsigned>(std::min<std::size_t>(sortThreadCount(n), std::max<std::size_t>(blocks, 1)));
+	parallelFor(threads, [&](unsigned t)
+	{
+		for (std::size_t block = t; block < blocks; block += threads)
+		{
+			std::uint64_t blockSeed = seed ^ (block * 0xD1B54A32D192ED03ull);
+			Xoshiro256x4 rng(splitMix64(blockSeed));
+			const std::size_t begin = block * kGeneratorBlock;
+			const std::size_t end = std::min(n, begin + kGeneratorBlock);
+			std::size_t i = begin;
+			for (; end - i >= Xoshiro256x4::kLanes; i += Xoshiro256x4::kLanes) rng.next(out + i);
+			if (i < end)
+			{
+				std::uint64_t tail[Xoshiro256x4::kLanes];
+				rng.next(tail);
+				std::copy(tail, tail + (end - i), out + i);
+			}
+		}
+	});
+}
+
+// Maps a random word to a double in [0, 1)
+inline double unitInterval(std::uint64_t word) noexcept
+{
+	return static_cast<double>(word >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//*****************
+// Template Function: castGenerated
+// Purpose: Converts a generated value to the element type, clamping to its range and rounding for integers.
+//*****************
+template <typename T>
+T castGenerated(double value) noexcept
+{
+	if constexpr (std::is_integral<T>::value)
+	{
+		const double lowest = static_cast<double>(std::numeric_limits<T>::lowest());
+		const double highest = static_cast<double>(std::numeric_limits<T>::max());
+		return static_cast<T>(std::min(std::max(std::floor(value), lowest), highest));
+	}
+	else
+	{
+		return static_cast<T>(value);
+	}
+}
+
+//*****************
+// Template Function: generateData
+// Purpose: Generates n values of an arithmetic type with the requested distribution.
+// Parameters:
+//    - n: Number of values.
+//    - options: Distribution, seed, value range and shape parameters (default: uniform over [0, 1000000]).
+// Returns: The generated values.
+//*****************
+template <typename T>
+std::vector<T> generateData(std::size_t n, const GeneratorOptions& options = GeneratorOptions())
+{
+	static_assert(std::is_arithmetic<T>::value, "generateData requires an arithmetic type");
+	std::vector<T> values(n);
+	if (n == 0) return values;
+
+	const double low = options.low;
+	const double span = options.high - options.low;
+	const double integral = std::is_integral<T>::value ? 1.0 : 0.0; // Integers cover high itself after flooring
+	const auto step = [&](std::size_t i) { return n > 1 ? span * static_cast<double>(i) / static_cast<double>(n - 1) : 0.0; };
+
+	switch (options.distribution)
+	{
+	case Distribution::Sorted:
+		for (std::size_t i = 0; i < n; ++i) values[i] = castGenerated<T>(low + step(i));
+		return values;
+	case Distribution::Reverse:
+		for (std::size_t i = 0; i < n; ++i) values[i] = castGenerated<T>(low + step(n - 1 - i));
+		return values;
+	case Distribution::OrganPipe:
+		for (std::size_t i = 0; i < n; ++i) values[i] = castGenerated<T>(low + step(2 * std::min(i, n - 1 - i)));
+		return values;
+	case Distribution::AllEqual:
+		std::fill(values.begin(), values.end(), castGenerated<T>(low));
+		return values;
+	case Distribution::AntiQuicksort:
+	{
+		// Musser's median-of-3 killer over ranks 1..m for the largest m = 2k divisible by 4
+		// (1-based: a[i] = i and a[i + 1] = k + i for odd i, a[k + i] = 2i); leftover ranks follow in order
+		std::vector<std::size_t> ranks(n);
+		const std::size_t k = n / 4 * 2;
+		for (std::size_t i = 1; i <= k; ++i)
+		{
+			if (i % 2 == 1)
+			{
+				ranks[i - 1] = i;
+				ranks[i] = k + i;
+			}
+			ranks[k + i - 1] = 2 * i;
+		}
+		for (std::size_t i = 2 * k; i < n; ++i) ranks[i] = i + 1;
+		const double scale = n > 1 ? span / static_cast<double>(n - 1) : 0.0;
+		for (std::size_t i = 0; i < n; ++i) values[i] = castGenerated<T>(low + scale * static_cast<double>(ranks[i] - 1));
+		return values;
+	}
+	default:
+		break;
+	}
+
+	// Random distributions: draw words in parallel, then map each word to a value in parallel
+	std::vector<std::uint64_t> words(n + (n & 1));
+	fillRandomWords(words.data(), words.size(), options.seed);
+	const double zipfPower = 1.0 - options.zipfExponent;
+	const double universe = std::floor(span) + 1;
+	const double zipfTop = std::abs(zipfPower) < 1e-9 ? std::log(universe + 1) : (std::pow(universe + 1, zipfPower) - 1) / zipfPower;
+	const unsigned threads = sortThreadCount(n);
+	parallelFor(threads, [&](unsigned t)
+	{
+		const std::size_t end = chunkBegin(n, threads, t + 1);
+		for (std::size_t i = chunkBegin(n, threads, t); i < end; ++i)
+		{
+			const double u = unitInterval(words[i]);
+			double value;
+			switch (options.distribution)
+			{
+			case Distribution::Zipf:
+			{
+				// Inverse CDF of the continuous power law over [1, universe + 1), floored to a rank
+				const double x = std::abs(zipfPower) < 1e-9 ? std::exp(u * zipfTop) : std::pow(u * zipfTop * zipfPower + 1, 1 / zipfPower);
+				value = low + std::min(std::floor(x) - 1, universe - 1);
+				break;
+			}
+			case Distribution::Gaussian:
+			{
+				// Box-Muller on the word pair this element belongs to (cosine for even, sine for odd indices)
+				const std::size_t pair = i & ~std::size_t(1);
+				const double radius = std::sqrt(-2 * std::log(1 - unitInterval(words[pair])));
+				const double angle = 6.283185307179586 * unitInterval(words[pair + 1]);
+				const double normal = radius * (i & 1 ? std::sin(angle) : std::cos(angle));
+				value = std::min(std::max(low + span / 2 + normal * span / 6, low), options.high);
+				break;
+			}
+			default: // Uniform and SortedRuns
+				value = low + u * (span + integral);
+				break;
+			}
+			values[i] = castGenerated<T>(std::min(value, options.high));
+		}
+	});
+
+	if (options.distribution == Distribution::SortedRuns)
+	{
+		const std::size_t run = std::max<std::size_t>(options.runLength, 1);
+		const std::size_t runs = (n + run - 1) / run;
+		const unsigned runThreads = static_cast<unsigned>(std::min<std::size_t>(threads, runs));
+		parallelFor(runThreads, [&](unsigned t)
+		{
+			for (std::size_t r = t; r < runs; r += runThreads)
+			{
+				std::sort(values.begin() + r * run, values.begin() + std::min(n, (r + 1) * run));
+			}
+		});
+	}
+	return values;
+}
+
+//*****************
+// Function name: generateStrings
+// Purpose: Generates n random strings with lengths uniform in [minLength, maxLength], drawing characters
+//          uniformly from alphabet.
+// Parameters:
+//    - n: Number of strings.
+//    - minLength, maxLength: Length range of the strings.
+//    - seed: The seed (default: 42).
+//    - alphabet: Characters to draw from (default: lowercase ASCII letters).
+// Returns: The generated strings.
+//*****************
+inline std::vector<std::string> generateStrings(std::size_t n, std::size_t minLength, std::size_t maxLength, std::uint64_t seed = 42,
+	const std::string& alphabet = "abcdefghijklmnopqrstuvwxyz")
+{
+	std::vector<std::string> strings(n);
+	if (n == 0 || alphabet.empty()) return strings;
+	maxLength = std::max(minLength, maxLength);
+
+	const unsigned threads = sortThreadCount(n * std::max<std::size_t>(minLength, 1));
+	parallelFor(threads, [&](unsigned t)
+	{
+		const std::size_t end = chunkBegin(n, threads, t + 1);
+		for (std::size_t begin = chunkBegin(n, threads, t); begin < end;)
+		{
+			// One generator per block of strings keeps the output independent of the thread count
+			const std::size_t block = begin / kGeneratorBlock;
+			const std::size_t blockEnd = std::min(end, (block + 1) * kGeneratorBlock);
+			std::uint64_t blockSeed = seed ^ (block * 0xD1B54A32D192ED03ull);
+			Xoshiro256x4 rng(splitMix64(blockSeed));
+			std::uint64_t words[Xoshiro256x4::kLanes];
+			std::size_t used = Xoshiro256x4::kLanes;
+			const auto draw = [&]() { if (used == Xoshiro256x4::kLanes) { rng.next(words); used = 0; } return words[used++]; };
+
+			// Skip the strings of this block that belong to the previous thread
+			for (std::size_t i = block * kGeneratorBlock; i < blockEnd; ++i)
+			{
+				const std::size_t length = minLength + static_cast<std::size_t>(draw() % (maxLength - minLength + 1));
+				std::string text(length, ' ');
+				for (std::size_t c = 0; c < length; c += 8)
+				{
+					std::uint64_t word = draw();
+					for (std::size_t k = c; k < std::min(length, c + 8); ++k, word >>= 8)
+					{
+						text[k] = alphabet[(word & 0xFF) * alphabet.size() >> 8];
+					}
+				}
+				if (i >= begin) strings[i] = std::move(text);
+			}
+			begin = blockEnd;
+		}
+	});
+	return strings;
+}
+
+//*****************
+// Template Function: generateRagged2D
+// Purpose: Generates a ragged 2D container: rows of lengths uniform in [minColumns, maxColumns], each row
+//          filled by generateData with its own derived seed.
+// Parameters:
+//    - rows: Number of rows.
+//    - minColumns, maxColumns: Length range of the rows.
+//    - options: Value options passed to generateData.
+// Returns: The generated rows.
+//*****************
+template <typename T>
+std::vector<std::vector<T>> generateRagged2D(std::size_t rows, std::size_t minColumns, std::size_t maxColumns,
+	const GeneratorOptions& options = GeneratorOptions())
+{
+	maxColumns = std::max(minColumns, maxColumns);
+	std::vector<std::uint64_t> lengths(rows);
+	fillRandomWords(lengths.data(), rows, options.seed ^ 0x5DEECE66Dull);
+
+	std::vector<std::vector<T>> result(rows);
+	for (std::size_t r = 0; r < rows; ++r)
+	{
+		GeneratorOptions rowOptions = options;
+		rowOptions.seed = options.seed + r + 1;
+		result[r] = generateData<T>(minColumns + static_cast<std::size_t>(lengths[r] % (maxColumns - minColumns + 1)), rowOptions);
+	}
+	return result;
+}
+
+//*****************
+// Template Function: generateRagged3D
+// Purpose: Generates a ragged 3D container of planes, each a ragged 2D container from generateRagged2D.
+// Parameters:
+//    - planes: Number of planes.
+//    - minRows, maxRows: Row count range of the planes.
+//    - minColumns, maxColumns: Length range of the rows.
+//    - options: Value options passed to generateData.
+// Returns: The generated planes.
+//*****************
+template <typename T>
+std::vector<std::vector<std::vector<T>>> generateRagged3D(std::size_t planes, std::size_t minRows, std::size_t maxRows,
+	std::size_t minColumns, std::size_t maxColumns, const GeneratorOptions& options = GeneratorOptions())
+{
+	maxRows = std::max(minRows, maxRows);
+	std::vector<std::uint64_t> counts(planes);
+	fillRandomWords(counts.data(), planes, options.seed ^ 0x2545F4914F6CDD1Dull);
+
+	std::vector<std::vector<std::vector<T>>> result(planes);
+	for (std::size_t p = 0; p < planes; ++p)
+	{
+		GeneratorOptions planeOptions = options;
+		planeOptions.seed = options.seed * 0x9E3779B97F4A7C15ull + p + 1;
+		result[p] = generateRagged2D<T>(minRows + static_cast<std::size_t>(counts[p] % (maxRows - minRows + 1)), minColumns, maxColumns, planeOptions);
+	}
+	return result;
+}
@@ -0,0 +1,399 @@
+//*****************
+// bubblesort/group_by.hpp
+// Group-by aggregation (count, sum, min and max per integer key) with hash and sort strategies built on
+// the parallel histogram and scatter primitives, chosen from a sampled estimate of the group count.
+//*****************
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>    // for std::declval
+
+#include "parallel.hpp"
+#include "integer_sort.hpp"
+
+//*****************
+// Enum: GroupByStrategy
+// Purpose: How groupByKeys aggregates. Automatic estimates the number of groups from a sample and hashes
+//          when the group tables stay small, sorting otherwise.
+//*****************
+enum class GroupByStrategy
+{
+	Automatic,
+	Hash,  // Per-thread hash tables, or radix partitions by hash with one table each
+	Sort   // LSD radix sort of the key/value pairs, then one aggregating scan
+};
+
+// Keys sampled for the group count estimate
+constexpr std::size_t kGroupBySample = 4096;
+
+// Automatic hashes up to this many estimated groups per input element (as a divisor: n / 4 groups)
+constexpr std::size_t kGroupByHashGroupDivisor = 4;
+
+// Groups one hash table should hold so it stays in cache; more groups are radix partitioned first
+constexpr std::size_t kGroupByPartitionGroups = 1 << 12;
+
+// Helper type trait naming the type values are summed in: double, long long or unsigned long long
+template <typename Value>
+using group_sum_t = std::conditional_t<std::is_floating_point<Value>::value, double,
+	std::conditional_t<std::is_signed<Value>::value, long long, unsigned long long>>;
+
+//*****************
+// Struct: GroupByResult
+// Purpose: The groups found by groupByKeys, one entry per key in ascending key order in every vector.
+//*****************
+template <typename Key, typename Value>
+struct GroupByResult
+{
+	std::vector<Key> keys;
+	std::vector<std::size_t> counts;
+	std::vector<group_sum_t<Value>> sums;
+	std::vector<Value> mins;
+	std::vector<Value> maxs;
+	GroupByStrategy strategy = GroupByStrategy::Automatic; // The strategy that ran
+
+	std::size_t size() const noexcept { return keys.size(); }
+};
+
+//*****************
+// Struct: GroupSlot
+// Purpose: The running aggregates of one group; a count of 0 marks an empty hash table slot.
+//*****************
+template <typename Key, typename Value>
+struct GroupSlot
+{
+	Key key;
+	std::size_t count;
+	group_sum_t<Value> sum;
+	Value min;
+	Value max;
+
+	void add(const Value& value)
+	{
+		if (count == 0 || value < min) min = value;
+		if (count == 0 || max < value) max = value;
+		sum += static_cast<group_sum_t<Value>>(value);
+		++count;
+	}
+
+	void merge(const GroupSlot& other)
+	{
+		if (count == 0 || other.min < min) min = other.min;
+		if (count == 0 || max < other.max) max = other.max;
+		sum += other.sum;
+		count += other.count;
+	}
+};
+
+//*****************
+// Struct: KeyValue
+// Purpose: A key and its value, the element the partitioning and sort strategies move around.
+//*****************
+template <typename Key, typename Value>
+struct KeyValue
+{
+	Key key;
+	Value value;
+};
+
+//*****************
+// Template Function: groupHash
+// Purpose: Fibonacci hash of an integer key; its high bits are well mixed, so partitions and table slots
+//          take their bits from the top.
+//*****************
+template <typename Key>
+std::uint64_t groupHash(Key key) noexcept
+{
+	return static_cast<std::uint64_t>(radixKey(key)) * 0x9E3779B97F4A7C15ull;
+}
+
+//*****************
+// Class: GroupTable
+// Purpose: Open-addressing hash table of GroupSlots with linear probing, doubling when half full. Slots
+//          are found from the hash bits below the skip top bits (those already used to pick a partition).
+//*****************
+template <typename Key, typename Value>
+class GroupTable
+{
+public:
+	using Slot = GroupSlot<Key, Value>;
+
+	GroupTable(std::size_t expectedGroups, unsigned skipBits) : skipBits_(skipBits)
+	{
+		unsigned bits = 4;
+		while ((std::size_t(1) << bits) < 2 * expectedGroups && bits + skipBits_ < 62) ++bits;
+		resize(bits);
+	}
+
+	// Adds value to the group of key
+	void add(Key key, const Value& value) { find(key).add(value); }
+
+	// Adds the aggregates of another table's group
+	void merge(const Slot& slot) { find(slot.key).merge(slot); }
+
+	// Appends every group to out
+	void collect(std::vector<Slot>& out) const
+	{
+		for (const Slot& slot : slots_)
+		{
+			if (slot.count != 0) out.push_back(slot);
+		}
+	}
+
+	const std::vector<Slot>& slots() const noexcept { return slots_; }
+
+private:
+	std::size_t index(Key key) const noexcept
+	{
+		return static_cast<std::size_t>((groupHash(key) << skipBits_) >> (64 - bits_));
+	}
+
+	void resize(unsigned bits)
+	{
+		std::vector<Slot> old(std::size_t(1) << bits, Slot{ Key(), 0, 0, Value(), Value() });
+		old.swap(slots_);
+		bits_ = bits;
+		groups_ = 0;
+		for (const Slot& slot : old)
+		{
+			if (slot.count != 0) find(slot.key) = slot;
+		}
+	}
+
+	Slot& find(Key key)
+	{
+		const std::size_t mask = slots_.size() - 1;
+		for (std::size_t i = index(key);; i = (i + 1) & mask)
+		{
+			Slot& slot = slots_[i];
+			if (slot.count != 0 && slot.key == key) return slot;
+			if (slot.count == 0)
+			{
+				if (2 * (groups_ + 1) > slots_.size())
+				{
+					resize(bits_ + 1);
+					return find(key);
+				}
+				++groups_;
+				slot.key = key;
+				return slot;
+			}
+		}
+	}
+
+	std::vector<Slot> slots_;
+	unsigned bits_ = 0;
+	unsigned skipBits_ = 0;
+	std::size_t groups_ = 0;
+};
+
+//*****************
+// Template Function: estimateGroupCount
+// Purpose: Estimates the number of distinct keys from kGroupBySample evenly spaced ones with the
+//          bias-corrected Chao1 estimator: the distinct keys in the sample plus f1 (f1 - 1) / (2 (f2 + 1)),
+//          f1 and f2 counting the keys seen once and twice. A sample of mostly single keys therefore
+//          estimates many groups, and one whose keys all repeat estimates about as many as it saw.
+// Parameters:
+//    - keys: Pointer to the keys.
+//    - n: Number of keys.
+// Returns: The estimate, between 1 and n (0 for no keys).
+//*****************
+template <typename Key>
+std::size_t estimateGroupCount(const Key* keys, std::size_t n)
+{
+	if (n <= kGroupBySample)
+	{
+		std::vector<Key> all(keys, keys + n);
+		std::sort(all.begin(), all.end());
+		return static_cast<std::size_t>(std::unique(all.begin(), all.end()) - all.begin());
+	}
+	std::vector<Key> sample(kGroupBySample);
+	for (std::size_t i = 0; i < kGroupBySample; ++i) sample[i] = keys[i * (n / kGroupBySample)];
+	std::sort(sample.begin(), sample.end());
+	double distinct = 0, once = 0, twice = 0;
+	for (std::size_t i = 0; i < kGroupBySample;)
+	{
+		std::size_t end = i + 1;
+		while (end < kGroupBySample && sample[end] == sample[i]) ++end;
+		distinct += 1;
+		once += end - i == 1 ? 1 : 0;
+		twice += end - i == 2 ? 1 : 0;
+		i = end;
+	}
+	const double estimate = distinct + once * (once - 1) / (2 * (twice + 1));
+	return estimate >= static_cast<double>(n) ? n : std::max<std::size_t>(1, static_cast<std::size_t>(estimate));
+}
+
+//*****************
+// Template Function: finishGroups
+// Purpose: Sorts the groups by key and stores them in result.
+//*****************
+template <typename Key, typename Value>
+void finishGroups(std::vector<GroupSlot<Key, Value>>& groups, GroupByResult<Key, Value>& result)
+{
+	std::sort(groups.begin(), groups.end(), [](const GroupSlot<Key, Value>& a, const GroupSlot<Key, Value>& b) { return a.key < b.key; });
+	for (const GroupSlot<Key, Value>& group : groups)
+	{
+		result.keys.push_back(group.key);
+		result.counts.push_back(group.count);
+		result.sums.push_back(group.sum);
+		result.mins.push_back(group.min);
+		result.maxs.push_back(group.max);
+	}
+}
+
+//*****************
+// Template Function: hashGroupBy
+// Purpose: Hash strategy of groupByKeys. Up to kGroupByPartitionGroups estimated groups, every thread
+//          aggregates its chunk into its own table and the tables are merged. More groups are radix
+//          partitioned on the top bits of their hash (parallelHistogram and parallelScatter) into partitions
+//          of about kGroupByPartitionGroups groups, and the partitions are aggregated in parallel.
+//*****************
+template <typename Key, typename Value>
+void hashGroupBy(const Key* keys, const Value* values, std::size_t n, std::size_t estimatedGroups, GroupByResult<Key, Value>& result)
+{
+	using Table = GroupTable<Key, Value>;
+	using Slot = GroupSlot<Key, Value>;
+	WorkerPool pool(sortThreadCount(n)); // Started once for every pass
+	const unsigned threads = pool.size();
+	std::vector<Slot> groups;
+	if (estimatedGroups <= kGroupByPartitionGroups)
+	{
+		std::vector<Table> tables(threads, Table(estimatedGroups, 0));
+		pool.run([&](unsigned t)
+		{
+			const std::size_t end = chunkBegin(n, threads, t + 1);
+			for (std::size_t i = chunkBegin(n, threads, t); i < end; ++i) tables[t].add(keys[i], values[i]);
+		});
+		for (unsigned t = 1; t < threads; ++t)
+		{
+			for (const Slot& slot : tables[t].slots())
+			{
+				if (slot.count != 0) tables[0].merge(slot);
+			}
+		}
+		tables[0].collect(groups);
+		finishGroups(groups, result);
+		return;
+	}
+
+	unsigned bits = 1;
+	while (bits < 8 && (estimatedGroups >> bits) > kGroupByPartitionGroups) ++bits;
+	const std::size_t partitions = std::size_t(1) << bits;
+	std::vector<KeyValue<Key, Value>> pairs(n), partitioned(n);
+	for (std::size_t i = 0; i < n; ++i) pairs[i] = { keys[i], values[i] };
+	const auto partitionOf = [bits](const KeyValue<Key, Value>& pair) { return static_cast<std::size_t>(groupHash(pair.key) >> (64 - bits)); };
+	std::vector<std::size_t> histograms(threads * partitions), offsets(threads * partitions), totals(partitions);
+	parallelHistogram(pairs.data(), n, partitionOf, partitions, pool, histograms.data());
+	sumHistograms(histograms.data(), partitions, threads, totals.data());
+	scatterOffsets(histograms.data(), partitions, threads, offsets.data());
+	parallelScatter(pairs.data(), partitioned.data(), n, partitionOf, partitions, pool, offsets.data());
+	std::vector<std::size_t> begins(partitions);
+	exclusiveScan(totals.data(), begins.data(), partitions);
+
+	std::vector<std::vector<Slot>> partitionGroups(partitions);
+	pool.run([&](unsigned t)
+	{
+		for (std::size_t p = t; p < partitions; p += threads)
+		{
+			Table table(estimatedGroups >> bits, bits);
+			for (std::size_t i = begins[p]; i < begins[p] + totals[p]; ++i) table.add(partitioned[i].key, partitioned[i].value);
+			table.collect(partitionGroups[p]);
+		}
+	});
+	for (const std::vector<Slot>& part : partitionGroups) groups.insert(groups.end(), part.begin(), part.end());
+	finishGroups(groups, result);
+}
+
+//*****************
+// Template Function: sortGroupBy
+// Purpose: Sort strategy of groupByKeys: LSD radix sorts the key/value pairs by key with the parallel
+//          primitives (skipping bytes all keys share) and aggregates each run of equal keys in one scan.
+//*****************
+template <typename Key, typename Value>
+void sortGroupBy(const Key* keys, const Value* values, std::size_t n, GroupByResult<Key, Value>& result)
+{
+	WorkerPool pool(sortThreadCount(n)); // Started once for every pass
+	const unsigned threads = pool.size();
+	std::vector<KeyValue<Key, Value>> pairs(n), buffer(n);
+	for (std::size_t i = 0; i < n; ++i) pairs[i] = { keys[i], values[i] };
+	std::vector<std::size_t> histograms(threads * kRadixBuckets), total(kRadixBuckets);
+	KeyValue<Key, Value>* src = pairs.data();
+	KeyValue<Key, Value>* dst = buffer.data();
+	for (unsigned shift = 0; shift < sizeof(Key) * 8; shift += 8)
+	{
+		const auto digitOf = [shift](const KeyValue<Key, Value>& pair) { return static_cast<std::size_t>((radixKey(pair.key) >> shift) & 0xFF); };
+		parallelHistogram(src, n, digitOf, kRadixBuckets, pool, histograms.data());
+		sumHistograms(histograms.data(), kRadixBuckets, threads, total.data());
+		if (std::find(total.begin(), total.end(), n) != total.end()) continue; // All keys share this digit
+
+		scatterOffsets(histograms.data(), kRadixBuckets, threads, histograms.data());
+		parallelScatter(src, dst, n, digitOf, kRadixBuckets, pool, histograms.data());
+		std::swap(src, dst);
+	}
+
+	for (std::size_t i = 0; i < n;)
+	{
+		GroupSlot<Key, Value> group{ src[i].key, 0, 0, Value(), Value() };
+		for (; i < n && src[i].key == group.key; ++i) group.add(src[i].value);
+		result.keys.push_back(group.key);
+		result.counts.push_back(group.count);
+		result.sums.push_back(group.sum);
+		result.mins.push_back(group.min);
+		result.maxs.push_back(group.max);
+	}
+}
+
+//*****************
+// Template Function: groupByKeys
+// Purpose: Groups values by their keys and returns the count, sum, minimum and maximum of every group in
+//          ascending key order. Automatic estimates the group count (estimateGroupCount) and hashes when it
+//          is at most a quarter of n, where the tables stay much smaller than the data; otherwise it sorts.
+// Parameters:
+//    - keys: Pointer to the integer keys.
+//    - values: Pointer to the values, values[i] belonging to keys[i].
+//    - n: Number of keys and values.
+//    - strategy: The GroupByStrategy (default: GroupByStrategy::Automatic).
+// Returns: The groups, with the strategy that ran.
+//*****************
+template <typename Key, typename Value>
+GroupByResult<Key, Value> groupByKeys(const Key* keys, const Value* values, std::size_t n, GroupByStrategy strategy = GroupByStrategy::Automatic)
+{
+	static_assert(is_radix_sortable<Key>::value, "groupByKeys requires integer keys");
+	static_assert(std::is_arithmetic<Value>::value, "groupByKeys requires arithmetic values");
+	GroupByResult<Key, Value> result;
+	const std::size_t estimatedGroups = strategy == GroupByStrategy::Sort ? 0 : estimateGroupCount(keys, n);
+	if (strategy == GroupByStrategy::Automatic)
+	{
+		strategy = estimatedGroups <= n / kGroupByHashGroupDivisor ? GroupByStrategy::Hash : GroupByStrategy::Sort;
+	}
+	result.strategy = strategy;
+	if (n == 0) return result;
+	if (strategy == GroupByStrategy::Hash) hashGroupBy(keys, values, n, estimatedGroups, result);
+	else sortGroupBy(keys, values, n, result);
+	return result;
+}
+
+//*****************
+// Template Function: groupBy
+// Purpose: Groups the elements of a container by the key keyOf maps them to (an integer, e.g. the value
+//          modulo 2 instead of sorting with OddFirst) and aggregates the elements of every group.
+// Parameters:
+//    - holder: A const reference to a container of arithmetic values.
+//    - keyOf: A callable mapping an element to its integer group key.
+//    - strategy: The GroupByStrategy (default: GroupByStrategy::Automatic).
+// Returns: The groups in ascending key order (see groupByKeys).
+//*****************
+template <typename Container, typename KeyOf>
+auto groupBy(const Container& holder, KeyOf keyOf, GroupByStrategy strategy = GroupByStrategy::Automatic)
+{
+	using Value = typename Container::value_type;
+	using Key = std::decay_t<decltype(keyOf(std::declval<const Value&>()))>;
+	const std::vector<Value> values(holder.begin(), holder.end());
+	std::vector<Key> keys(values.size());
+	std::transform(values.begin(), values.end(), keys.begin(), keyOf);
+	return groupByKeys(keys.data(), values.data(), values.size(), strategy);
+}
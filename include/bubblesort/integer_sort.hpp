@@ -0,0 +1,313 @@
+//*****************
+// bubblesort/integer_sort.hpp
+// Radix, counting and American flag sort engines for integers.
+//*****************
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>   // for std::distance
+#include <type_traits>
+#include <utility>
+
+#include "traits.hpp"
+#include "parallel.hpp"
+#include "simd_kernels.hpp"
+#include "sort_engine.hpp"
+
+//*****************
+// Integer sort engines built on the parallel primitives
+//*****************
+
+// Helper type trait for element types the radix engines can sort: integers other than bool
+template<typename T>
+struct is_radix_sortable : std::bool_constant<std::is_integral<T>::value && !std::is_same<T, bool>::value> {};
+
+//*****************
+// Template Function: radixKey
+// Purpose: Maps an integer to an unsigned key with the same ordering (flips the sign bit of signed types).
+//*****************
+template <typename T>
+constexpr typename std::make_unsigned<T>::type radixKey(T value) noexcept
+{
+	using Key = typename std::make_unsigned<T>::type;
+	if constexpr (std::is_signed<T>::value)
+	{
+		return static_cast<Key>(static_cast<Key>(value) ^ (Key(1) << (sizeof(T) * 8 - 1)));
+	}
+	else
+	{
+		return static_cast<Key>(value);
+	}
+}
+
+//*****************
+// Template Function: fromRadixKey
+// Purpose: Maps a key produced by radixKey back to the integer it was made from.
+//*****************
+template <typename T>
+constexpr T fromRadixKey(typename std::make_unsigned<T>::type key) noexcept
+{
+	using Key = typename std::make_unsigned<T>::type;
+	if constexpr (std::is_signed<T>::value)
+	{
+		return static_cast<T>(static_cast<Key>(key ^ (Key(1) << (sizeof(T) * 8 - 1))));
+	}
+	else
+	{
+		return static_cast<T>(key);
+	}
+}
+
+// Radix engines use one byte per pass
+constexpr std::size_t kRadixBuckets = 256;
+
+//*****************
+// Template Function: lsdRadixSort
+// Purpose: Sorts integers in ascending order with a stable least-significant-digit radix sort,
+//          one byte per pass. Passes where every element shares the same digit are skipped.
+// Parameters:
+//    - data: Pointer to the integers to be sorted.
+//    - n: Number of integers.
+// Returns: void
+//*****************
+template <typename T>
+void lsdRadixSort(T* data, std::size_t n)
+{
+	static_assert(is_radix_sortable<T>::value, "lsdRadixSort requires an integer type");
+	if (n < 2) return;
+
+	WorkerPool pool(sortThreadCount(n)); // Started once for every pass
+	const unsigned threads = pool.size();
+	std::vector<T> buffer(n);
+	std::vector<std::size_t> histograms(threads * kRadixBuckets);
+	std::vector<std::size_t> total(kRadixBuckets);
+	T* src = data;
+	T* dst = buffer.data();
+
+	for (unsigned shift = 0; shift < sizeof(T) * 8; shift += 8)
+	{
+		const auto digitOf = [shift](const T& value) { return static_cast<std::size_t>((radixKey(value) >> shift) & 0xFF); };
+		parallelHistogram(src, n, digitOf, kRadixBuckets, pool, histograms.data());
+		sumHistograms(histograms.data(), kRadixBuckets, threads, total.data());
+		if (std::find(total.begin(), total.end(), n) != total.end()) continue; // All elements share this digit
+
+		scatterOffsets(histograms.data(), kRadixBuckets, threads, histograms.data());
+		parallelScatter(src, dst, n, digitOf, kRadixBuckets, pool, histograms.data());
+		std::swap(src, dst);
+	}
+
+	if (src != data) std::copy(src, src + n, data);
+}
+
+// Largest value range (max - min + 1) handled by countingSort
+constexpr std::size_t kCountingSortMaxRange = 1 << 16;
+
+//*****************
+// Template Function: countingSort
+// Purpose: Sorts integers whose values span a small range in ascending order by counting each
+//          value and rewriting the range from the counts. No scratch copy of the data is needed.
+// Parameters:
+//    - data: Pointer to the integers to be sorted.
+//    - n: Number of integers.
+//    - low, high: The smallest and largest value present; high - low must be below kCountingSortMaxRange.
+// Returns: void
+//*****************
+template <typename T>
+void countingSort(T* data, std::size_t n, T low, T high)
+{
+	static_assert(is_radix_sortable<T>::value, "countingSort requires an integer type");
+	const std::size_t range = static_cast<std::size_t>(radixKey(high) - radixKey(low)) + 1;
+	const auto key = radixKey(low);
+	const auto bucketOf = [key](const T& value) { return static_cast<std::size_t>(radixKey(value) - key); };
+
+	WorkerPool pool(sortThreadCount(n));
+	const unsigned threads = pool.size();
+	std::vector<std::size_t> histograms(threads * range);
+	std::vector<std::size_t> counts(range);
+	parallelHistogram(data, n, bucketOf, range, pool, histograms.data());
+	sumHistograms(histograms.data(), range, threads, counts.data());
+
+	T* out = data;
+	for (std::size_t b = 0; b < range; ++b)
+	{
+		out = std::fill_n(out, counts[b], static_cast<T>(low + static_cast<T>(b)));
+	}
+}
+
+//*****************
+// Template Function: lsdRadixScratchBytes
+// Purpose: Returns the heap scratch lsdRadixSort allocates for n elements: the buffer and the histograms.
+//*****************
+template <typename T>
+std::size_t lsdRadixScratchBytes(std::size_t n) noexcept
+{
+	return n * sizeof(T) + (sortThreadCount(n) + 1) * kRadixBuckets * sizeof(std::size_t);
+}
+
+//*****************
+// Function name: countingSortScratchBytes
+// Purpose: Returns the heap scratch countingSort allocates for n elements spanning range values: the histograms.
+//*****************
+inline std::size_t countingSortScratchBytes(std::size_t n, std::size_t range) noexcept
+{
+	return (sortThreadCount(n) + 1) * range * sizeof(std::size_t);
+}
+
+// Buckets at or below this size are finished with insertion sort by americanFlagSort
+constexpr std::size_t kAmericanFlagInsertionThreshold = 32;
+
+// Buckets at or below this size are finished with lsdRadixSort by americanFlagSort; its scratch buffer
+// is bounded by this size rather than by the whole input
+constexpr std::size_t kAmericanFlagLsdThreshold = 1 << 12;
+
+//*****************
+// Template Function: americanFlagSort
+// Purpose: Sorts integers in ascending order in place with a most-significant-digit radix sort
+//          (American flag sort). Each pass counts one byte, then permutes elements directly into their
+//          buckets by following swap cycles, and recurses into every bucket on the next byte.
+//          Small buckets switch to lsdRadixSort or insertion sort. No n-sized scratch buffer is used.
+// Parameters:
+//    - data: Pointer to the integers to be sorted.
+//    - n: Number of integers.
+//    - shift: Bit position of the byte to distribute on (default: the most significant byte).
+//    - lsdThreshold: Buckets up to this size use lsdRadixSort; 0 keeps the sort strictly in place
+//                    (default: kAmericanFlagLsdThreshold).
+// Returns: void
+//*****************
+template <typename T>
+void americanFlagSort(T* data, std::size_t n, unsigned shift = sizeof(T) * 8 - 8, std::size_t lsdThreshold = kAmericanFlagLsdThreshold)
+{
+	static_assert(is_radix_sortable<T>::value, "americanFlagSort requires an integer type");
+
+	if (n <= kAmericanFlagInsertionThreshold)
+	{
+		for (std::size_t i = 1; i < n; ++i)
+		{
+			const T value = data[i];
+			std::size_t j = i;
+			for (; j > 0 && radixKey(value) < radixKey(data[j - 1]); --j) data[j] = data[j - 1];
+			data[j] = value;
+		}
+		return;
+	}
+	if (n <= lsdThreshold)
+	{
+		lsdRadixSort(data, n); // Passes over the bytes already distributed on are skipped as trivial
+		return;
+	}
+
+	std::size_t counts[kRadixBuckets];
+	std::size_t heads[kRadixBuckets];
+	std::size_t tails[kRadixBuckets];
+	for (;;)
+	{
+		const auto digitOf = [shift](const T& value) { return static_cast<std::size_t>((radixKey(value) >> shift) & 0xFF); };
+		std::fill(counts, counts + kRadixBuckets, std::size_t(0));
+		for (std::size_t i = 0; i < n; ++i) ++counts[digitOf(data[i])];
+		if (std::find(counts, counts + kRadixBuckets, n) == counts + kRadixBuckets) break;
+		if (shift == 0) return; // Every element is equal
+		shift -= 8; // All elements share this byte, distribute on the next one
+	}
+
+	exclusiveScan(counts, heads, kRadixBuckets);
+	for (std::size_t b = 0; b < kRadixBuckets; ++b) tails[b] = heads[b] + counts[b];
+
+	// Permute in place: carry each misplaced element to the next free slot of its bucket until the cycle closes
+	const auto digitOf = [shift](const T& value) { return static_cast<std::size_t>((radixKey(value) >> shift) & 0xFF); };
+	for (std::size_t b = 0; b < kRadixBuckets; ++b)
+	{
+		while (heads[b] < tails[b])
+		{
+			T value = data[heads[b]];
+			for (std::size_t digit = digitOf(value); digit != b; digit = digitOf(value))
+			{
+				std::swap(value, data[heads[digit]++]);
+			}
+			data[heads[b]++] = value;
+		}
+	}
+
+	if (shift == 0) return;
+	std::size_t begin = 0;
+	for (std::size_t b = 0; b < kRadixBuckets; ++b)
+	{
+		if (counts[b] > 1) americanFlagSort(data + begin, counts[b], shift - 8, lsdThreshold);
+		begin += counts[b];
+	}
+}
+
+// int containers below this size are sorted by the sortInts SIMD kernel instead of the radix engines
+constexpr std::size_t kSimdSortThreshold = 512;
+
+//*****************
+// Template Function: integerSort
+// Purpose: Sorts a container of integers with the fastest engine whose heap scratch fits the budget of
+//          options: the sortInts SIMD kernel for small int containers, countingSort when the values span a
+//          small range, lsdRadixSort otherwise, and americanFlagSort when those buffers do not fit or an
+//          in-place engine is requested. Containers that are not contiguous are only gathered into a vector
+//          when the copy fits as well; otherwise they are sorted where they are with comparisonSort.
+// Parameters:
+//    - holder: A reference to a container of integers that needs to be sorted.
+//    - descending: Sorts in descending order when true (default: false).
+//    - options: The SortOptions; SortEngine::InPlaceRadix selects americanFlagSort (default: SortOptions()).
+// Returns: void
+//*****************
+template <typename Container>
+void integerSort(Container& holder, bool descending = false, const SortOptions& options = SortOptions())
+{
+	using Value = typename Container::value_type;
+	const std::size_t n = static_cast<std::size_t>(std::distance(holder.begin(), holder.end()));
+	if (n < 2) return;
+
+	const std::size_t copyBytes = is_contiguous_container<Container>::value ? 0 : n * sizeof(Value);
+	if (!options.fits(copyBytes))
+	{
+		comparisonSort(holder, [descending](const Value& a, const Value& b) { return descending ? b < a : a < b; });
+		recordSortChoice(options, SortAlgorithm::Comparison, n, 0);
+		return;
+	}
+
+	const std::size_t budget = options.scratchBudget - copyBytes;
+	SortAlgorithm algorithm = SortAlgorithm::AmericanFlag;
+	std::size_t scratchBytes = 0;
+	withContiguousStorage(holder, [&](Value* data, std::size_t count)
+	{
+		if (options.engine != SortEngine::InPlaceRadix)
+		{
+			if constexpr (std::is_same<Value, int>::value)
+			{
+				if (count < kSimdSortThreshold)
+				{
+					simdKernels().sortInts(data, count); // Radix setup costs more than it saves on small inputs
+					algorithm = SortAlgorithm::SimdNetwork;
+					return;
+				}
+			}
+			const auto bounds = std::minmax_element(data, data + count);
+			const std::size_t range = static_cast<std::size_t>(radixKey(*bounds.second) - radixKey(*bounds.first));
+			if (range < kCountingSortMaxRange && range <= count && countingSortScratchBytes(count, range + 1) <= budget)
+			{
+				countingSort(data, count, *bounds.first, *bounds.second);
+				algorithm = SortAlgorithm::Counting;
+				scratchBytes = countingSortScratchBytes(count, range + 1);
+				return;
+			}
+			if (lsdRadixScratchBytes<Value>(count) <= budget)
+			{
+				lsdRadixSort(data, count);
+				algorithm = SortAlgorithm::LsdRadix;
+				scratchBytes = lsdRadixScratchBytes<Value>(count);
+				return;
+			}
+		}
+		// Small buckets only go to lsdRadixSort when its buffer fits the budget
+		const std::size_t lsdThreshold = lsdRadixScratchBytes<Value>(kAmericanFlagLsdThreshold) <= budget ? kAmericanFlagLsdThreshold : 0;
+		americanFlagSort(data, count, sizeof(Value) * 8 - 8, lsdThreshold);
+		scratchBytes = lsdThreshold ? lsdRadixScratchBytes<Value>(lsdThreshold) : 0;
+	});
+	// Equal integers are indistinguishable, so reversing keeps the result identical to a stable sort
+	if (descending) std::reverse(holder.begin(), holder.end());
+	recordSortChoice(options, algorithm, n, copyBytes + scratchBytes);
+}
@@ -0,0 +1,126 @@
+//*****************
+// bubblesort/natural_sort.hpp
+// Natural ("human") string ordering, e.g. "item9" before "item10", with each string tokenized once.
+//*****************
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "projection.hpp"
+
+//*****************
+// Function name: appendNaturalKey
+// Purpose: Appends the natural sort key of a string: byte-wise comparison of two keys gives the natural
+//          order. The string is tokenized into text runs, kept as (escaped) bytes, and digit runs, stored as
+//          a marker, their significant digit count and the significant digits, so longer numbers sort after
+//          shorter ones and equal lengths compare digit by digit. Ties are broken by the leading zero counts
+//          of the digit runs (fewer first), then by case when caseInsensitive (lowercase first), then by the
+//          raw bytes, so only identical strings have equal keys.
+// Parameters:
+//    - key: The string the key is appended to.
+//    - str: The string to compute the key of.
+//    - caseInsensitive: Compares ASCII letters case-insensitively.
+// Returns: void
+//*****************
+inline void appendNaturalKey(std::string& key, const std::string& str, bool caseInsensitive)
+{
+	const auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+	std::string leadingZeros;
+	for (std::size_t i = 0; i < str.size();)
+	{
+		if (!isDigit(str[i]))
+		{
+			const char c = str[i++];
+			appendEscapedByte(key, static_cast<unsigned char>(caseInsensitive && c >= 'A' && c <= 'Z' ? c + 0x20 : c));
+			continue;
+		}
+
+		// Digit run: '0' never appears in text runs, so it marks the number unambiguously
+		std::size_t zeros = 0;
+		for (; i < str.size() && str[i] == '0'; ++i) ++zeros;
+		std::size_t end = i;
+		while (end < str.size() && isDigit(str[end])) ++end;
+		const std::size_t digits = end - i;
+		key.push_back('0');
+		if (digits < 0xFE)
+		{
+			key.push_back(static_cast<char>(digits + 1));
+		}
+		else
+		{
+			key.push_back('\xFF');
+			for (int shift = 24; shift >= 0; shift -= 8) key.push_back(static_cast<char>(static_cast<std::uint32_t>(digits) >> shift));
+		}
+		key.append(str, i, digits);
+		leadingZeros.push_back(static_cast<char>(zeros < 0xFE ? zeros + 1 : 0xFF));
+		i = end;
+	}
+	key.push_back('\0');
+	key += leadingZeros;
+	if (caseInsensitive)
+	{
+		key.push_back('\0');
+		for (char c : str) key.push_back(c >= 'A' && c <= 'Z' ? '\x02' : '\x01');
+	}
+	key.push_back('\0');
+	for (char c : str) appendEscapedByte(key, static_cast<unsigned char>(c));
+	key.push_back('\0');
+}
+
+//*****************
+// Function name: naturalKey
+// Purpose: Returns the natural sort key of a string (see appendNaturalKey).
+//*****************
+inline std::string naturalKey(const std::string& str, bool caseInsensitive = false)
+{
+	std::string key;
+	key.reserve(str.size() * 2 + 4);
+	appendNaturalKey(key, str, caseInsensitive);
+	return key;
+}
+
+//*****************
+// Template Function: naturalSort
+// Purpose: Sorts a container of strings in natural order by their precomputed keys (see binaryKeySort).
+// Parameters:
+//    - holder: A reference to a container of strings that needs to be sorted.
+//    - caseInsensitive: Compares ASCII letters case-insensitively (default: false).
+//    - descending: Sorts in descending order when true (default: false).
+// Returns: void
+//*****************
+template <typename Container>
+void naturalSort(Container& holder, bool caseInsensitive = false, bool descending = false)
+{
+	binaryKeySort(holder, [caseInsensitive](std::string& key, const std::string& str) { appendNaturalKey(key, str, caseInsensitive); }, descending);
+}
+
+//*****************
+// Template Functor: NaturalOrder
+// Purpose: Sorts strings in natural order, e.g. "file2" before "file10" and "1.9" before "1.10" (ascending,
+//          or descending when descending is true). recursiveSort sorts with naturalSort, tokenizing each
+//          string once; direct calls compare keys.
+//*****************
+template <bool caseInsensitive = false, bool descending = false>
+struct NaturalOrder
+{
+	static constexpr bool isCaseInsensitive = caseInsensitive;
+	static constexpr bool isDescending = descending;
+
+	bool operator()(const std::string& a, const std::string& b) const
+	{
+		const std::string keyA = naturalKey(a, caseInsensitive), keyB = naturalKey(b, caseInsensitive);
+		return descending ? keyA < keyB : keyA > keyB; // True bubbles up
+	}
+};
+
+using NaturalCaseInsensitiveOrder = NaturalOrder<true>;
+
+// Helper type trait to detect NaturalOrder comparators
+template<typename Comparator>
+struct is_natural_order : std::false_type {};
+
+template<bool caseInsensitive, bool descending>
+struct is_natural_order<NaturalOrder<caseInsensitive, descending>> : std::true_type {};
@@ -0,0 +1,314 @@
+//*****************
+// bubblesort/parallel.hpp
+// Multi-threaded and SIMD histogram, scan and scatter primitives.
+//*****************
+#pragma once
+
+#include <vector>
+#include <thread>     // for std::thread
+#include <mutex>
+#include <condition_variable>
+#include <exception>  // for std::exception_ptr
+#include <algorithm>
+#include <cstddef>
+#include <type_traits> // for std::remove_reference_t
+#include <utility>
+
+#include "simd_kernels.hpp"
+
+//*****************
+// Parallel primitives: histogram, exclusive scan and scatter
+// These are the building blocks of the radix and counting sort engines. Each one is exposed on its
+// own so it can be reused and benchmarked separately (see benchRadixPhases).
+//*****************
+
+// Minimum number of elements each worker thread should receive before another thread is started
+constexpr std::size_t kParallelGrain = 1 << 16;
+
+//*****************
+// Function name: sortThreadCount
+// Purpose: Returns how many threads the parallel primitives should use for n elements.
+// Parameters:
+//    - n: Number of elements to be processed.
+// Returns: The thread count, between 1 and the hardware concurrency.
+//*****************
+inline unsigned sortThreadCount(std::size_t n) noexcept
+{
+	const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+	return static_cast<unsigned>(std::max<std::size_t>(1, std::min(hardware, n / kParallelGrain)));
+}
+
+//*****************
+// Class: WorkerPool
+// Purpose: A fixed set of threads running the parallel primitives. A sort owns one pool for all of its
+//          passes, so the threads are started once rather than for every histogram and scatter. run calls
+//          fn(t) for every t in [0, size()), using the calling thread for t == 0, and returns when every call
+//          has finished; an exception thrown by any call is rethrown then (the first one if several throw).
+//          If a thread cannot be started the pool runs with the threads it has.
+//*****************
+class WorkerPool
+{
+public:
+	explicit WorkerPool(unsigned threads)
+	{
+		try
+		{
+			for (unsigned t = 1; t < threads; ++t) workers_.emplace_back([this, t] { workerLoop(t); });
+		}
+		catch (...)
+		{
+		}
+	}
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		start_.notify_all();
+		for (std::thread& worker : workers_) worker.join();
+	}
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	// Number of calls run makes: the workers and the calling thread
+	unsigned size() const noexcept { return static_cast<unsigned>(workers_.size()) + 1; }
+
+	//*****************
+	// Template Function: run
+	// Purpose: Runs fn(t) for every t in [0, size()) and waits for all of them, rethrowing an exception.
+	//*****************
+	template <typename Fn>
+	void run(Fn&& fn)
+	{
+		if (workers_.empty())
+		{
+			fn(0u);
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			task_ = &fn;
+			invoke_ = [](void* task, unsigned t) { (*static_cast<std::remove_reference_t<Fn>*>(task))(t); };
+			running_ = workers_.size();
+			error_ = nullptr;
+			++generation_;
+		}
+		start_.notify_all();
+		std::exception_ptr error;
+		try
+		{
+			fn(0u);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+		std::unique_lock<std::mutex> lock(mutex_);
+		finished_.wait(lock, [this] { return running_ == 0; });
+		if (!error) error = error_;
+		lock.unlock();
+		if (error) std::rethrow_exception(error);
+	}
+
+private:
+	void workerLoop(unsigned t)
+	{
+		std::size_t seen = 0;
+		std::unique_lock<std::mutex> lock(mutex_);
+		for (;;)
+		{
+			start_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+			if (stopping_) return;
+			seen = generation_;
+			lock.unlock();
+			std::exception_ptr error;
+			try
+			{
+				invoke_(task_, t);
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+			lock.lock();
+			if (error && !error_) error_ = error;
+			if (--running_ == 0) finished_.notify_one();
+		}
+	}
+
+	std::vector<std::thread> workers_;
+	std::mutex mutex_;
+	std::condition_variable start_;
+	std::condition_variable finished_;
+	void* task_ = nullptr;
+	void (*invoke_)(void*, unsigned) = nullptr;
+	std::size_t generation_ = 0;   // Incremented by every run, so each worker takes every task once
+	std::size_t running_ = 0;      // Workers still running the current task
+	std::exception_ptr error_;     // The first exception a worker threw in the current task
+	bool stopping_ = false;
+};
+
+//*****************
+// Template Function: parallelFor
+// Purpose: Runs fn(t) for every t in [0, threads) on a WorkerPool of its own, using the calling thread for
+//          t == 0, for code running a single parallel step; sorts with several passes share one WorkerPool.
+//          An exception thrown by fn is rethrown once every call has finished.
+// Parameters:
+//    - threads: Number of workers to run.
+//    - fn: A callable taking the worker index.
+// Returns: void
+//*****************
+template <typename Fn>
+void parallelFor(unsigned threads, Fn fn)
+{
+	if (threads <= 1)
+	{
+		fn(0u);
+		return;
+	}
+	WorkerPool pool(threads);
+	if (pool.size() == threads)
+	{
+		pool.run(fn);
+		return;
+	}
+	for (unsigned t = 0; t < threads; ++t) fn(t); // Not every thread started: run the missing calls here
+}
+
+// Returns where chunk t of n elements split across threads begins (chunk t ends where chunk t + 1 begins)
+inline std::size_t chunkBegin(std::size_t n, unsigned threads, unsigned t) noexcept
+{
+	return n / threads * t + std::min<std::size_t>(n % threads, t);
+}
+
+//*****************
+// Template Function: parallelHistogram
+// Purpose: Counts how many elements fall into each bucket. Every thread counts its own chunk into a
+//          private histogram, so there is no sharing or atomics in the hot loop.
+// Parameters:
+//    - data: Pointer to the elements to be counted.
+//    - n: Number of elements.
+//    - bucketOf: A callable mapping an element to its bucket in [0, buckets).
+//    - buckets: Number of buckets.
+//    - pool: The WorkerPool running the threads (see sortThreadCount for its size).
+//    - perThread: Output of pool.size() * buckets counters; thread t's histogram starts at perThread + t * buckets.
+// Returns: void
+//*****************
+template <typename T, typename BucketFn>
+void parallelHistogram(const T* data, std::size_t n, BucketFn bucketOf, std::size_t buckets, WorkerPool& pool, std::size_t* perThread)
+{
+	const unsigned threads = pool.size();
+	pool.run([&](unsigned t)
+	{
+		std::size_t* counts = perThread + t * buckets;
+		std::fill(counts, counts + buckets, std::size_t(0));
+		const std::size_t end = chunkBegin(n, threads, t + 1);
+		for (std::size_t i = chunkBegin(n, threads, t); i < end; ++i)
+		{
+			++counts[bucketOf(data[i])];
+		}
+	});
+}
+
+//*****************
+// Function name: sumHistograms
+// Purpose: Adds the private per-thread histograms of parallelHistogram into one total histogram.
+// Parameters:
+//    - perThread: threads * buckets counters as produced by parallelHistogram.
+//    - buckets: Number of buckets.
+//    - threads: Number of per-thread histograms.
+//    - total: Output of buckets counters.
+// Returns: void
+//*****************
+inline void sumHistograms(const std::size_t* perThread, std::size_t buckets, unsigned threads, std::size_t* total) noexcept
+{
+	std::copy(perThread, perThread + buckets, total);
+	for (unsigned t = 1; t < threads; ++t)
+	{
+		const std::size_t* counts = perThread + t * buckets;
+		for (std::size_t b = 0; b < buckets; ++b) // Independent lanes, vectorized by the compiler
+		{
+			total[b] += counts[b];
+		}
+	}
+}
+
+//*****************
+// Function name: exclusiveScan
+// Purpose: Writes the exclusive prefix sum of in to out (out[i] = init + in[0] + ... + in[i - 1]).
+//          Runs the AVX2 or SSE2 in-register scan selected by simdKernels(). in and out may alias.
+// Parameters:
+//    - in: Pointer to the counts to be scanned.
+//    - out: Pointer to the n output offsets.
+//    - n: Number of counts.
+//    - init: Value of the first offset (default: 0).
+// Returns: The sum of init and all counts.
+//*****************
+inline std::size_t exclusiveScan(const std::size_t* in, std::size_t* out, std::size_t n, std::size_t init = 0) noexcept
+{
+	return simdKernels().exclusiveScan(in, out, n, init);
+}
+
+//*****************
+// Function name: scatterOffsets
+// Purpose: Turns per-thread histograms into per-thread write offsets for a stable parallel scatter:
+//          bucket b of thread t starts after all smaller buckets and after bucket b of threads before t.
+// Parameters:
+//    - perThread: threads * buckets counters as produced by parallelHistogram.
+//    - buckets: Number of buckets.
+//    - threads: Number of per-thread histograms.
+//    - offsets: Output of threads * buckets offsets, laid out like perThread.
+// Returns: void
+//*****************
+inline void scatterOffsets(const std::size_t* perThread, std::size_t buckets, unsigned threads, std::size_t* offsets)
+{
+	// Scan in bucket-major order, which needs the thread-major histograms transposed
+	std::vector<std::size_t> column(buckets * threads);
+	for (unsigned t = 0; t < threads; ++t)
+	{
+		for (std::size_t b = 0; b < buckets; ++b)
+		{
+			column[b * threads + t] = perThread[t * buckets + b];
+		}
+	}
+	exclusiveScan(column.data(), column.data(), column.size());
+	for (unsigned t = 0; t < threads; ++t)
+	{
+		for (std::size_t b = 0; b < buckets; ++b)
+		{
+			offsets[t * buckets + b] = column[b * threads + t];
+		}
+	}
+}
+
+//*****************
+// Template Function: parallelScatter
+// Purpose: Stably moves every element of src to its bucket's next slot in dst. Each thread scatters
+//          the same chunk it counted in parallelHistogram, using its own offsets from scatterOffsets.
+// Parameters:
+//    - src: Pointer to the n elements to be scattered.
+//    - dst: Pointer to n elements of output storage (must not overlap src).
+//    - n: Number of elements.
+//    - bucketOf: The same bucket mapping used for the histogram.
+//    - buckets: Number of buckets.
+//    - pool: The WorkerPool that ran the histogram.
+//    - offsets: pool.size() * buckets offsets from scatterOffsets, advanced in place.
+// Returns: void
+//*****************
+template <typename T, typename BucketFn>
+void parallelScatter(T* src, T* dst, std::size_t n, BucketFn bucketOf, std::size_t buckets, WorkerPool& pool, std::size_t* offsets)
+{
+	const unsigned threads = pool.size();
+	pool.run([&](unsigned t)
+	{
+		std::size_t* next = offsets + t * buckets;
+		const std::size_t end = chunkBegin(n, threads, t + 1);
+		for (std::size_t i = chunkBegin(n, threads, t); i < end; ++i)
+		{
+			dst[next[bucketOf(src[i])]++] = std::move(src[i]);
+		}
+	});
+}
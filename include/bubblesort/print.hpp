@@ -0,0 +1,71 @@
+//*****************
+// bubblesort/print.hpp
+// Printing of flat and N-dimensional containers.
+//*****************
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include "traits.hpp"
+
+//*****************
+// Function name: printContainer
+// Purpose: Prints the contents of any container that supports iteration.
+// Parameters:
+//    - holder: A const reference to a container that holds elements to be printed.
+// Returns: void
+// Return type: void
+//*****************
+template <typename Container>
+void printContainer(const Container& holder) noexcept
+{
+	// Loop through the container and print each item, separated by spaces.
+	for (const auto& item : holder)
+	{
+		std::cout << item << " ";
+	}
+	// Using newline escape sequence to avoid buffer flush
+	std::cout << "\n";
+}
+
+//*****************
+// Template Function: printNDVector (for non-containers)
+// Purpose: Prints nested vectors (N-dimensional containers) with indentation based on depth.
+//          Leaf types such as std::string are printed whole.
+// Parameters:
+//    - holder: A const reference to a potentially multi-dimensional container.
+//    - depth: An optional integer specifying the level of depth for indentation (default: 0).
+// Returns: void
+//*****************
+template <typename T>
+typename std::enable_if<(!is_container<T>::value and std::is_arithmetic<T>::value) or is_leaf<T>::value>::type
+printNDVector(const T& holder, int depth = 0)
+{
+	// Indent based on depth to visually show nesting
+	std::cout << std::string(depth * 4, ' ') << holder;  // Increase indentation per depth level
+}
+
+//*****************
+// Template Function: printNDVector (for containers)
+// Purpose: Prints higher-dimensional containers (e.g., vectors of vectors) recursively.
+// Parameters:
+//    - holder: A const reference to a container that may hold other containers (multi-dimensional).
+//    - depth: An integer specifying the level of depth for indentation.
+// Returns: void
+//*****************
+template <typename T>
+typename std::enable_if<is_nested_container<T>::value>::type
+printNDVector(const T& holder, int depth = 0)
+{
+	std::cout << std::string(depth * 4, ' ') << "\n{";  // Opening bracket to denote dimension
+
+	for (const auto& subHolder : holder)
+	{
+		printNDVector(subHolder, depth + 1);  // Recursive call for nested elements
+		;  // Newline for better readability after each element
+	}
+
+	std::cout << std::string(depth * 4, ' ') << "}\n";  // Closing bracket for this dimension
+}
@@ -0,0 +1,282 @@
+//*****************
+// bubblesort/projection.hpp
+// Sort-by-projection engine: projects every element once and orders the elements by the cached keys.
+//*****************
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <numeric>    // for std::iota
+#include <cstddef>
+#include <cstdint>
+#include <functional> // for std::invoke
+#include <iterator>   // for std::distance and std::make_move_iterator
+#include <type_traits>
+#include <utility>
+
+#include "functors.hpp"
+#include "traits.hpp"
+#include "parallel.hpp"
+#include "simd_kernels.hpp"
+#include "integer_sort.hpp"
+#include "string_sort.hpp"
+
+// Helper alias for the key type a projection yields for an element type
+template<typename Projection, typename Value>
+using projected_key_t = std::decay_t<std::invoke_result_t<Projection&, const Value&>>;
+
+//*****************
+// Template Function: projectKeys
+// Purpose: Projects every element of a container once. DigitSum over ints runs the digitSums SIMD kernel.
+// Parameters:
+//    - holder: A reference to the container.
+//    - project: The projection (any callable, including pointers to members).
+// Returns: The keys, in element order.
+//*****************
+template <typename Container, typename Projection>
+std::vector<projected_key_t<Projection, typename Container::value_type>> projectKeys(const Container& holder, Projection project)
+{
+	using Value = typename Container::value_type;
+	std::vector<projected_key_t<Projection, Value>> keys;
+	if constexpr (std::is_same<Projection, DigitSum>::value && std::is_same<Value, int>::value)
+	{
+		keys.assign(holder.begin(), holder.end());
+		simdKernels().digitSums(keys.data(), keys.data(), keys.size()); // Element-wise, so in place is safe
+	}
+	else
+	{
+		keys.reserve(std::distance(holder.begin(), holder.end()));
+		for (const Value& value : holder) keys.push_back(std::invoke(project, value));
+	}
+	return keys;
+}
+
+//*****************
+// Template Function: radixKeyOrder
+// Purpose: Orders element indices stably by integer keys with the histogram and scatter primitives:
+//          one counting pass when the keys span less than kCountingSortMaxRange values, otherwise one
+//          LSD radix pass per key byte (skipping bytes every key shares).
+// Parameters:
+//    - keys: The keys, one per element.
+//    - descending: Orders larger keys first. Equal keys keep their original order either way.
+// Returns: The element indices in sorted order.
+//*****************
+template <typename Key>
+std::vector<std::size_t> radixKeyOrder(const std::vector<Key>& keys, bool descending)
+{
+	static_assert(is_radix_sortable<Key>::value, "radixKeyOrder requires integer keys");
+	using Unsigned = typename std::make_unsigned<Key>::type;
+
+	const std::size_t n = keys.size();
+	std::vector<std::size_t> order(n);
+	std::iota(order.begin(), order.end(), std::size_t(0));
+	if (n < 2) return order;
+
+	WorkerPool pool(sortThreadCount(n)); // Started once for every pass
+	const unsigned threads = pool.size();
+	std::vector<std::size_t> buffer(n);
+	const auto bounds = std::minmax_element(keys.begin(), keys.end());
+	const Unsigned low = radixKey(*bounds.first);
+	const Unsigned high = radixKey(*bounds.second);
+
+	if (static_cast<std::size_t>(high - low) < kCountingSortMaxRange)
+	{
+		const std::size_t range = static_cast<std::size_t>(high - low) + 1;
+		const auto bucketOf = [&keys, low, high, descending](std::size_t index)
+		{
+			const Unsigned key = radixKey(keys[index]);
+			return static_cast<std::size_t>(descending ? high - key : key - low);
+		};
+		std::vector<std::size_t> histograms(threads * range);
+		parallelHistogram(order.data(), n, bucketOf, range, pool, histograms.data());
+		scatterOffsets(histograms.data(), range, threads, histograms.data());
+		parallelScatter(order.data(), buffer.data(), n, bucketOf, range, pool, histograms.data());
+		return buffer;
+	}
+
+	const Unsigned flip = descending ? static_cast<Unsigned>(~Unsigned(0)) : Unsigned(0);
+	std::vector<std::size_t> histograms(threads * kRadixBuckets);
+	std::vector<std::size_t> total(kRadixBuckets);
+	std::size_t* src = order.data();
+	std::size_t* dst = buffer.data();
+	for (unsigned shift = 0; shift < sizeof(Key) * 8; shift += 8)
+	{
+		const auto digitOf = [&keys, shift, flip](std::size_t index)
+		{
+			return static_cast<std::size_t>((static_cast<Unsigned>(radixKey(keys[index]) ^ flip) >> shift) & 0xFF);
+		};
+		parallelHistogram(src, n, digitOf, kRadixBuckets, pool, histograms.data());
+		sumHistograms(histograms.data(), kRadixBuckets, threads, total.data());
+		if (std::find(total.begin(), total.end(), n) != total.end()) continue; // All keys share this digit
+
+		scatterOffsets(histograms.data(), kRadixBuckets, threads, histograms.data());
+		parallelScatter(src, dst, n, digitOf, kRadixBuckets, pool, histograms.data());
+		std::swap(src, dst);
+	}
+	if (src != order.data()) order.swap(buffer);
+	return order;
+}
+
+//*****************
+// Template Function: comparatorKeyOrder
+// Purpose: Orders element indices stably by keys with a comparison sort on the cached keys.
+// Parameters:
+//    - keys: The keys, one per element.
+//    - compare: A comparator on keys, true bubbles up; it must be a strict weak ordering.
+// Returns: The element indices in sorted order.
+//*****************
+template <typename Key, typename Comparator>
+std::vector<std::size_t> comparatorKeyOrder(const std::vector<Key>& keys, Comparator compare)
+{
+	std::vector<std::size_t> order(keys.size());
+	std::iota(order.begin(), order.end(), std::size_t(0));
+	// compare(a, b) is true when a belongs after b
+	std::stable_sort(order.begin(), order.end(), [&keys, &compare](std::size_t a, std::size_t b) { return compare(keys[b], keys[a]); });
+	return order;
+}
+
+//*****************
+// Template Function: applyOrder
+// Purpose: Moves the elements of a container into the given order.
+// Parameters:
+//    - holder: A reference to the container.
+//    - order: The original index of the element that belongs at each position.
+// Returns: void
+//*****************
+template <typename Container>
+void applyOrder(Container& holder, const std::vector<std::size_t>& order)
+{
+	using Value = typename Container::value_type;
+	std::vector<Value> values(std::make_move_iterator(holder.begin()), std::make_move_iterator(holder.end()));
+	auto it = holder.begin();
+	for (std::size_t index : order) *it++ = std::move(values[index]);
+}
+
+//*****************
+// Template Function: projectedSort
+// Purpose: Sorts a container by projected keys. Every element is projected once, the element indices are
+//          ordered by the cached keys and the elements are moved into that order. Integer keys compared
+//          with std::greater or std::less are ordered with counting or radix passes, other keys with a
+//          stable comparison sort. Equal keys keep their order, as in bubbleSort(holder, compare, project).
+// Parameters:
+//    - holder: A reference to a container of leaf elements that needs to be sorted.
+//    - compare: A comparator on the keys, true bubbles up.
+//    - project: The projection (any callable, including pointers to members).
+// Returns: void
+//*****************
+template <typename Container, typename Comparator, typename Projection>
+void projectedSort(Container& holder, Comparator compare, Projection project)
+{
+	using Key = projected_key_t<Projection, typename Container::value_type>;
+	const auto keys = projectKeys(holder, project);
+	if (keys.size() < 2) return;
+
+	if constexpr (is_radix_sortable<Key>::value && (is_ascending_comparator<Comparator, Key>::value || is_descending_comparator<Comparator, Key>::value))
+	{
+		applyOrder(holder, radixKeyOrder(keys, is_descending_comparator<Comparator, Key>::value));
+	}
+	else
+	{
+		applyOrder(holder, comparatorKeyOrder(keys, compare));
+	}
+}
+
+//*****************
+// Template Function: projectedSortScratchBytes
+// Purpose: Returns an upper estimate of the heap scratch projectedSort allocates for n elements: the keys, the
+//          index order and its buffer, the moved elements and, for integer keys, the counting histograms.
+//*****************
+template <typename Value, typename Projection>
+std::size_t projectedSortScratchBytes(std::size_t n) noexcept
+{
+	using Key = projected_key_t<Projection, Value>;
+	std::size_t bytes = n * (sizeof(Key) + 2 * sizeof(std::size_t) + sizeof(Value));
+	if constexpr (is_radix_sortable<Key>::value) bytes += (sortThreadCount(n) + 1) * kCountingSortMaxRange * sizeof(std::size_t);
+	return bytes;
+}
+
+//*****************
+// Function name: appendEscapedByte
+// Purpose: Appends a byte so that escaped strings still compare in the same order when followed by a 0x00 terminator:
+//          0x00 becomes 0x01 0x01 and 0x01 becomes 0x01 0x02.
+//*****************
+inline void appendEscapedByte(std::string& key, unsigned char byte)
+{
+	if (byte <= 1)
+	{
+		key.push_back('\x01');
+		key.push_back(static_cast<char>(byte + 1));
+	}
+	else
+	{
+		key.push_back(static_cast<char>(byte));
+	}
+}
+
+//*****************
+// Template Function: binaryKeySort
+// Purpose: Sorts a container by binary sort keys: keys that compare byte-wise (as std::string does) in the
+//          order the elements should take. The key of every element is computed once (in parallel for large
+//          inputs) with the element index appended, the keys are sorted with stringRadixSort, and the
+//          elements are moved into the order of their keys.
+// Parameters:
+//    - holder: A reference to a container of leaf elements that needs to be sorted.
+//    - appendKey: A callable appendKey(std::string& key, const value_type& element) appending the key of an
+//                 element. Keys must end in a terminator that no other key continues past (e.g. 0x00 after
+//                 escaped bytes), and only elements that are interchangeable may share a key.
+//    - descending: Sorts in descending order when true (default: false).
+// Returns: void
+//*****************
+template <typename Container, typename AppendKey>
+void binaryKeySort(Container& holder, AppendKey appendKey, bool descending = false)
+{
+	using Value = typename Container::value_type;
+	std::vector<const Value*> elements;
+	for (const Value& element : holder) elements.push_back(&element);
+	const std::size_t n = elements.size();
+	if (n < 2) return;
+
+	std::vector<std::string> keys(n);
+	const unsigned threads = sortThreadCount(n * 16);
+	parallelFor(threads, [&](unsigned t)
+	{
+		const std::size_t end = chunkBegin(n, threads, t + 1);
+		for (std::size_t i = chunkBegin(n, threads, t); i < end; ++i)
+		{
+			if constexpr (std::is_same<Value, std::string>::value) keys[i].reserve(elements[i]->size() * 2 + 16);
+			appendKey(keys[i], *elements[i]);
+			for (int shift = 56; shift >= 0; shift -= 8) keys[i].push_back(static_cast<char>(static_cast<std::uint64_t>(i) >> shift));
+		}
+	});
+	stringRadixSort(keys.begin(), keys.end());
+
+	std::vector<std::size_t> order(n);
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		std::uint64_t index = 0;
+		for (std::size_t b = keys[i].size() - sizeof(std::uint64_t); b < keys[i].size(); ++b) index = (index << 8) | static_cast<unsigned char>(keys[i][b]);
+		order[i] = static_cast<std::size_t>(index);
+	}
+	// Only interchangeable elements share a key, so reversing keeps the result identical to a stable sort
+	if (descending) std::reverse(order.begin(), order.end());
+	applyOrder(holder, order);
+}
+
+//*****************
+// Template Function: binaryKeySortScratchBytes
+// Purpose: Returns an estimate of the heap scratch binaryKeySort allocates for a container: per element a
+//          pointer, a key (twice the string length plus the index for strings), an index and the moved element.
+//*****************
+template <typename Container>
+std::size_t binaryKeySortScratchBytes(const Container& holder)
+{
+	using Value = typename Container::value_type;
+	std::size_t bytes = 0;
+	for (const Value& element : holder)
+	{
+		bytes += sizeof(const Value*) + sizeof(std::string) + sizeof(std::size_t) + sizeof(Value);
+		if constexpr (std::is_same<Value, std::string>::value) bytes += element.size() * 2 + 16;
+	}
+	return bytes;
+}
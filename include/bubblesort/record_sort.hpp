@@ -0,0 +1,154 @@
+//*****************
+// bubblesort/record_sort.hpp
+// Sorting of large records by an integer member through compact key/index pairs and one gather pass.
+//*****************
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>    // for std::move and std::swap
+
+#include "traits.hpp"
+#include "parallel.hpp"
+#include "simd_dispatch.hpp"
+#include "integer_sort.hpp"
+#include "projection.hpp"
+
+// Records are gathered this many positions ahead of the prefetch that loads them
+constexpr std::size_t kRecordPrefetchDistance = 8;
+
+// Helper type trait for projections recordSort handles: a pointer to an integer member of at most 32 bits,
+// compared with std::greater or std::less, on records that can be default constructed and move assigned
+template<typename Value, typename Comparator, typename Projection, typename _ = void>
+struct is_record_key_projection : std::false_type {};
+
+template<typename Value, typename Comparator, typename Projection>
+struct is_record_key_projection<Value, Comparator, Projection, std::enable_if_t<
+	std::is_member_object_pointer<Projection>::value && std::is_invocable<Projection, const Value&>::value>>
+	: std::bool_constant<
+		is_radix_sortable<projected_key_t<Projection, Value>>::value && sizeof(projected_key_t<Projection, Value>) <= 4 &&
+		(is_ascending_comparator<Comparator, projected_key_t<Projection, Value>>::value ||
+			is_descending_comparator<Comparator, projected_key_t<Projection, Value>>::value) &&
+		std::is_default_constructible<Value>::value && std::is_move_assignable<Value>::value> {};
+
+//*****************
+// Template Function: recordSortInto
+// Purpose: Sorts records by an integer member without moving a record more than once. One pass extracts
+//          64-bit pairs holding the member's radix key in the upper half and the record index in the lower
+//          half; the pairs are sorted on the key half (one counting pass for small key ranges, otherwise LSD
+//          radix passes skipping shared bytes); and one streaming pass gathers the records into out in pair
+//          order, prefetching ahead. Equal keys keep their order.
+// Parameters:
+//    - in: Pointer to the records to be sorted; they are moved from.
+//    - n: Number of records (below 2^32).
+//    - member: Pointer to the integer member to sort by (at most 32 bits).
+//    - descending: Orders larger keys first.
+//    - out: Pointer to n constructed records receiving the sorted records; must not overlap in.
+// Returns: void
+//*****************
+template <typename Value, typename Key>
+void recordSortInto(Value* in, std::size_t n, Key Value::* member, bool descending, Value* out)
+{
+	static_assert(is_radix_sortable<Key>::value && sizeof(Key) <= 4, "recordSortInto requires an integer member of at most 32 bits");
+	using Unsigned = typename std::make_unsigned<Key>::type;
+	const std::uint64_t flip = descending ? std::numeric_limits<Unsigned>::max() : 0;
+	WorkerPool pool(sortThreadCount(n)); // Started once for every pass
+	const unsigned threads = pool.size();
+
+	std::vector<std::uint64_t> pairs(n), buffer(n);
+	pool.run([&](unsigned t)
+	{
+		const std::size_t end = chunkBegin(n, threads, t + 1);
+		for (std::size_t i = chunkBegin(n, threads, t); i < end; ++i)
+		{
+			pairs[i] = ((static_cast<std::uint64_t>(radixKey(in[i].*member)) ^ flip) << 32) | i;
+		}
+	});
+
+	std::uint64_t low = std::numeric_limits<std::uint64_t>::max(), high = 0;
+	for (std::uint64_t pair : pairs)
+	{
+		low = std::min(low, pair >> 32);
+		high = std::max(high, pair >> 32);
+	}
+
+	std::uint64_t* src = pairs.data();
+	std::uint64_t* dst = buffer.data();
+	if (n > 1 && high - low < kCountingSortMaxRange)
+	{
+		const std::size_t range = static_cast<std::size_t>(high - low) + 1;
+		const auto bucketOf = [low](std::uint64_t pair) { return static_cast<std::size_t>((pair >> 32) - low); };
+		std::vector<std::size_t> histograms(threads * range);
+		parallelHistogram(src, n, bucketOf, range, pool, histograms.data());
+		scatterOffsets(histograms.data(), range, threads, histograms.data());
+		parallelScatter(src, dst, n, bucketOf, range, pool, histograms.data());
+		std::swap(src, dst);
+	}
+	else if (n > 1)
+	{
+		std::vector<std::size_t> histograms(threads * kRadixBuckets);
+		std::vector<std::size_t> total(kRadixBuckets);
+		for (unsigned shift = 32; shift < 32 + sizeof(Key) * 8; shift += 8)
+		{
+			const auto digitOf = [shift](std::uint64_t pair) { return static_cast<std::size_t>((pair >> shift) & 0xFF); };
+			parallelHistogram(src, n, digitOf, kRadixBuckets, pool, histograms.data());
+			sumHistograms(histograms.data(), kRadixBuckets, threads, total.data());
+			if (std::find(total.begin(), total.end(), n) != total.end()) continue; // All keys share this digit
+
+			scatterOffsets(histograms.data(), kRadixBuckets, threads, histograms.data());
+			parallelScatter(src, dst, n, digitOf, kRadixBuckets, pool, histograms.data());
+			std::swap(src, dst);
+		}
+	}
+
+	// Gather: out is written sequentially, the reads from in are prefetched a few records ahead
+	pool.run([&](unsigned t)
+	{
+		const std::size_t end = chunkBegin(n, threads, t + 1);
+		for (std::size_t i = chunkBegin(n, threads, t); i < end; ++i)
+		{
+			if (i + kRecordPrefetchDistance < end) BUBBLESORT_PREFETCH(in + (src[i + kRecordPrefetchDistance] & 0xFFFFFFFFu));
+			out[i] = std::move(in[src[i] & 0xFFFFFFFFu]);
+		}
+	});
+}
+
+//*****************
+// Template Function: recordSort
+// Purpose: Sorts a container of records by an integer member with recordSortInto, gathering into a scratch
+//          buffer and moving the records back in one sequential pass.
+// Parameters:
+//    - holder: A reference to a container of records that needs to be sorted.
+//    - member: Pointer to the integer member to sort by (at most 32 bits).
+//    - descending: Orders larger keys first (default: false).
+// Returns: void
+//*****************
+template <typename Container, typename Key>
+void recordSort(Container& holder, Key Container::value_type::* member, bool descending = false)
+{
+	using Value = typename Container::value_type;
+	withContiguousStorage(holder, [member, descending](Value* data, std::size_t n)
+	{
+		if (n < 2) return;
+		std::vector<Value> sorted(n);
+		recordSortInto(data, n, member, descending, sorted.data());
+		std::move(sorted.begin(), sorted.end(), data);
+	});
+}
+
+//*****************
+// Template Function: recordSortScratchBytes
+// Purpose: Returns an upper estimate of the heap scratch recordSort allocates for n records: the pairs and
+//          their buffer, the gathered records, the copy of containers that are not contiguous and the histograms.
+//*****************
+template <typename Container>
+std::size_t recordSortScratchBytes(std::size_t n) noexcept
+{
+	using Value = typename Container::value_type;
+	const std::size_t copyBytes = is_contiguous_container<Container>::value ? 0 : n * sizeof(Value);
+	return copyBytes + n * (2 * sizeof(std::uint64_t) + sizeof(Value)) + (sortThreadCount(n) + 1) * kCountingSortMaxRange * sizeof(std::size_t);
+}
@@ -0,0 +1,278 @@
+//*****************
+// bubblesort/search_tree.hpp
+// Cache-friendly search layouts over sorted keys for lower_bound and upper_bound lookups.
+//*****************
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "traits.hpp"
+#include "simd_dispatch.hpp"
+
+//*****************
+// Function name: stripTrailingOnes
+// Purpose: Shifts out the trailing one bits of a value and the zero above them, which turns the last node an
+//          Eytzinger descent visited into the last node where it went left.
+//*****************
+inline std::size_t stripTrailingOnes(std::size_t node) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return node >> (__builtin_ctzll(~static_cast<unsigned long long>(node)) + 1);
+#else
+	while (node & 1) node >>= 1;
+	return node >> 1;
+#endif
+}
+
+//*****************
+// Function name: countTrailingOnes
+// Purpose: Returns the number of consecutive one bits at the bottom of mask.
+//*****************
+inline unsigned countTrailingOnes(std::uint32_t mask) noexcept
+{
+	if (mask == ~std::uint32_t(0)) return 32;
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<unsigned>(__builtin_ctz(~mask));
+#else
+	unsigned count = 0;
+	while (mask & 1) { mask >>= 1; ++count; }
+	return count;
+#endif
+}
+
+//*****************
+// Class: EytzingerIndex
+// Purpose: Sorted keys stored in Eytzinger (breadth-first binary heap) order: node k has children 2k and
+//          2k + 1, so every search walks down from the front of one array, the top levels stay cached and
+//          the descent is branchless. Each node also remembers its position in the sorted order, so lookups
+//          return the same positions std::lower_bound and std::upper_bound do.
+//*****************
+template <typename Key>
+class EytzingerIndex
+{
+public:
+	EytzingerIndex() = default;
+	explicit EytzingerIndex(const std::vector<Key>& sorted) { build(sorted.data(), sorted.size()); }
+
+	//*****************
+	// Function name: build
+	// Purpose: Lays out n keys sorted in ascending order.
+	//*****************
+	void build(const Key* sorted, std::size_t n)
+	{
+		keys_.assign(n + 1, Key());
+		ranks_.assign(n + 1, 0);
+		std::size_t next = 0;
+		fill(sorted, next, 1);
+	}
+
+	std::size_t size() const noexcept { return keys_.empty() ? 0 : keys_.size() - 1; }
+
+	//*****************
+	// Function name: lowerBound
+	// Purpose: Returns the sorted position of the first key not less than key, or size() if there is none.
+	//*****************
+	std::size_t lowerBound(const Key& key) const noexcept
+	{
+		return search(key, [](const Key& node, const Key& wanted) { return node < wanted; });
+	}
+
+	//*****************
+	// Function name: upperBound
+	// Purpose: Returns the sorted position of the first key greater than key, or size() if there is none.
+	//*****************
+	std::size_t upperBound(const Key& key) const noexcept
+	{
+		return search(key, [](const Key& node, const Key& wanted) { return !(wanted < node); });
+	}
+
+private:
+	// Keys sharing a cache line with the node a descent reaches four levels (for 4-byte keys) below
+	static constexpr std::size_t kPrefetchStride = sizeof(Key) >= 64 ? 1 : 64 / sizeof(Key);
+
+	// In-order walk of the implicit tree, handing out the sorted keys
+	void fill(const Key* sorted, std::size_t& next, std::size_t node)
+	{
+		if (node >= keys_.size()) return;
+		fill(sorted, next, 2 * node);
+		keys_[node] = sorted[next];
+		ranks_[node] = next++;
+		fill(sorted, next, 2 * node + 1);
+	}
+
+	// Descends while goRight(node key) says the answer lies to the right, then backs up to the last left turn
+	template <typename GoRight>
+	std::size_t search(const Key& key, GoRight goRight) const noexcept
+	{
+		const std::size_t n = size();
+		std::size_t node = 1;
+		while (node <= n)
+		{
+			BUBBLESORT_PREFETCH(keys_.data() + std::min(node * kPrefetchStride, n));
+			node = 2 * node + static_cast<std::size_t>(goRight(keys_[node], key));
+		}
+		node = stripTrailingOnes(node);
+		return node == 0 ? n : ranks_[node];
+	}
+
+	std::vector<Key> keys_;           // keys_[0] is unused
+	std::vector<std::size_t> ranks_;  // Sorted position of every node's key
+};
+
+// Keys per S-tree node: 16 four-byte keys fill one 64-byte cache line
+constexpr std::size_t kSTreeNodeKeys = 16;
+
+//*****************
+// Class: STreeIndex
+// Purpose: Sorted keys stored as a static B-tree (S-tree) of kSTreeNodeKeys-key nodes with implicit
+//          children: node k's child i is node k * (kSTreeNodeKeys + 1) + i + 1, so a search touches one cache
+//          line per level, log17(n) of them instead of log2(n). Within a node the keys are ranked against the
+//          wanted key with SIMD compares for 32-bit integer keys (a compare mask whose trailing ones count the
+//          smaller keys) and with a branch-free count otherwise. Each slot remembers its position in the
+//          sorted order, so lookups return the same positions std::lower_bound and std::upper_bound do.
+//*****************
+template <typename Key>
+class STreeIndex
+{
+	static_assert(std::is_arithmetic<Key>::value, "STreeIndex requires arithmetic keys");
+
+public:
+	STreeIndex() = default;
+	explicit STreeIndex(const std::vector<Key>& sorted) { build(sorted.data(), sorted.size()); }
+
+	//*****************
+	// Function name: build
+	// Purpose: Lays out n keys sorted in ascending order. The last node is padded with the largest key,
+	//          which sorts after every real key, so it needs no special case in the search.
+	//*****************
+	void build(const Key* sorted, std::size_t n)
+	{
+		size_ = n;
+		nodes_ = (n + kSTreeNodeKeys - 1) / kSTreeNodeKeys;
+		keys_.assign(nodes_ * kSTreeNodeKeys, std::numeric_limits<Key>::max());
+		ranks_.assign(nodes_ * kSTreeNodeKeys, n);
+		std::size_t next = 0;
+		fill(sorted, next, 0);
+	}
+
+	std::size_t size() const noexcept { return size_; }
+
+	//*****************
+	// Function name: lowerBound
+	// Purpose: Returns the sorted position of the first key not less than key, or size() if there is none.
+	//*****************
+	std::size_t lowerBound(Key key) const noexcept { return search<false>(key); }
+
+	//*****************
+	// Function name: upperBound
+	// Purpose: Returns the sorted position of the first key greater than key, or size() if there is none.
+	//*****************
+	std::size_t upperBound(Key key) const noexcept { return search<true>(key); }
+
+private:
+	static constexpr bool kSimdKeys = BUBBLESORT_X86_SIMD && std::is_integral<Key>::value && sizeof(Key) == 4;
+
+	std::size_t child(std::size_t node, std::size_t slot) const noexcept { return node * (kSTreeNodeKeys + 1) + slot + 1; }
+
+	// In-order walk of the implicit tree, handing out the sorted keys; slots past the last key keep the padding
+	void fill(const Key* sorted, std::size_t& next, std::size_t node)
+	{
+		if (node >= nodes_) return;
+		for (std::size_t slot = 0; slot < kSTreeNodeKeys; ++slot)
+		{
+			fill(sorted, next, child(node, slot));
+			if (next < size_)
+			{
+				keys_[node * kSTreeNodeKeys + slot] = sorted[next];
+				ranks_[node * kSTreeNodeKeys + slot] = next++;
+			}
+		}
+		fill(sorted, next, child(node, kSTreeNodeKeys));
+	}
+
+	// Number of keys in a node that come before key: those less than it, or for Upper not greater
+	template <bool Upper>
+	static unsigned rankInNode(const Key* node, Key key) noexcept
+	{
+#if BUBBLESORT_X86_SIMD
+		if constexpr (kSimdKeys)
+		{
+			// Unsigned keys compare as signed ones once their sign bits are flipped
+			const int bias = std::is_signed<Key>::value ? 0 : std::numeric_limits<int>::min();
+			const __m128i flip = _mm_set1_epi32(bias);
+			const __m128i wanted = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(key)), flip);
+			__m128i lanes[4];
+			for (int i = 0; i < 4; ++i)
+			{
+				const __m128i keys = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(node) + i), flip);
+				// Lower counts keys < wanted; Upper counts keys <= wanted, i.e. not keys > wanted
+				lanes[i] = Upper ? _mm_cmpgt_epi32(keys, wanted) : _mm_cmpgt_epi32(wanted, keys);
+			}
+			const __m128i bytes = _mm_packs_epi16(_mm_packs_epi32(lanes[0], lanes[1]), _mm_packs_epi32(lanes[2], lanes[3]));
+			std::uint32_t mask = static_cast<std::uint32_t>(_mm_movemask_epi8(bytes));
+			if (Upper) mask ^= 0xFFFF;
+			return countTrailingOnes(mask);
+		}
+#endif
+		unsigned count = 0;
+		for (std::size_t slot = 0; slot < kSTreeNodeKeys; ++slot)
+		{
+			count += static_cast<unsigned>(Upper ? !(key < node[slot]) : node[slot] < key);
+		}
+		return count;
+	}
+
+	// Every node narrows the answer to the first of its slots past key; deeper slots come earlier in sorted
+	// order, so the last one found is the answer
+	template <bool Upper>
+	std::size_t search(Key key) const noexcept
+	{
+		std::size_t answer = size_;
+		for (std::size_t node = 0; node < nodes_;)
+		{
+			const unsigned slot = rankInNode<Upper>(keys_.data() + node * kSTreeNodeKeys, key);
+			if (slot < kSTreeNodeKeys) answer = ranks_[node * kSTreeNodeKeys + slot];
+			node = child(node, slot);
+		}
+		return answer;
+	}
+
+	std::vector<Key> keys_;
+	std::vector<std::size_t> ranks_;  // Sorted position of every slot's key; padding slots hold size()
+	std::size_t size_ = 0;
+	std::size_t nodes_ = 0;
+};
+
+//*****************
+// Template Function: buildSearchIndexes
+// Purpose: Builds a search index (EytzingerIndex or STreeIndex) over every leaf container of a sorted,
+//          possibly nested container, in the order the leaves appear, so the lookups that follow a
+//          recursiveSort run on cache-friendly layouts instead of binary searches over the leaves.
+// Parameters:
+//    - holder: The container; every leaf must be sorted in ascending order, as recursiveSort with
+//              std::greater leaves it.
+//    - indexes: Receives one index per leaf container.
+// Returns: false, leaving indexes empty, if a leaf is not sorted in ascending order.
+//*****************
+template <typename Index, typename Container>
+bool buildSearchIndexes(const Container& holder, std::vector<Index>& indexes)
+{
+	indexes.clear();
+	bool sorted = true;
+	std::vector<innermost_value_t<Container>> keys;
+	auto buildLeaf = [&](const auto& leaf)
+	{
+		keys.assign(leaf.begin(), leaf.end());
+		sorted = sorted && std::is_sorted(keys.begin(), keys.end());
+		indexes.emplace_back();
+		indexes.back().build(keys.data(), keys.size());
+	};
+	forEachLeafContainer(holder, buildLeaf);
+	if (!sorted) indexes.clear();
+	return sorted;
+}
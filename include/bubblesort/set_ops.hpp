@@ -0,0 +1,403 @@
+//*****************
+// bubblesort/set_ops.hpp
+// Merge, union, intersection and difference of sorted runs, of the leaves of sorted containers and of
+// sorted binary files, with galloping for runs of very different sizes and SIMD intersection for ints.
+//*****************
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "traits.hpp"
+#include "simd_kernels.hpp"
+#include "integer_sort.hpp"
+#include "async_io.hpp"
+
+//*****************
+// Enum: SetOperation
+// Purpose: The operations on two sorted runs. Merge keeps every element of both; the others treat the runs
+//          as sets and write each resulting value once, in ascending order.
+//*****************
+enum class SetOperation
+{
+	Merge,         // Every element of both runs
+	Union,         // Values in either run
+	Intersection,  // Values in both runs
+	Difference     // Values in the first run and not in the second
+};
+
+// One run is galloped through when the other is at least this many times shorter
+constexpr std::size_t kSetGallopRatio = 32;
+
+// Elements the file operations read or write at once
+constexpr std::size_t kSetFileChunk = 1 << 16;
+
+//*****************
+// Template Function: gallop
+// Purpose: Returns the first position from begin on whose element fails before, probing 1, 2, 4, ...
+//          elements ahead and then binary searching the last step, so a search that ends d elements on
+//          costs O(log d) instead of O(log n).
+// Parameters:
+//    - data: The sorted run.
+//    - begin: Where the search starts.
+//    - n: Number of elements in the run.
+//    - before: True for the elements ahead of the answer (e.g. those less than a key).
+//*****************
+template <typename T, typename Before>
+std::size_t gallop(const T* data, std::size_t begin, std::size_t n, Before before)
+{
+	std::size_t step = 1, low = begin, high = begin;
+	while (high < n && before(data[high]))
+	{
+		low = high + 1;
+		high = begin + step;
+		step *= 2;
+	}
+	return static_cast<std::size_t>(std::partition_point(data + low, data + std::min(high, n), before) - data);
+}
+
+//*****************
+// Template Function: appendDistinct
+// Purpose: Appends value to an ascending output unless it is already the last value there.
+//*****************
+template <typename T>
+void appendDistinct(T* out, std::size_t& count, const T& value)
+{
+	if (count == 0 || out[count - 1] < value) out[count++] = value;
+}
+
+//*****************
+// Template Function: intersectSorted
+// Purpose: Writes the values found in both a and b. A run 32 times shorter than the other is galloped
+//          through the longer one; ints of similar sizes go to the intersectInts SIMD kernel.
+// Parameters:
+//    - a, na: The first run, sorted in ascending order.
+//    - b, nb: The second run, sorted in ascending order.
+//    - out: Receives the result; needs room for min(na, nb) elements.
+// Returns: The number of elements written.
+//*****************
+template <typename T>
+std::size_t intersectSorted(const T* a, std::size_t na, const T* b, std::size_t nb, T* out)
+{
+	if (na > nb) return intersectSorted(b, nb, a, na, out);
+	std::size_t count = 0;
+	if (na * kSetGallopRatio <= nb)
+	{
+		for (std::size_t i = 0, j = 0; i < na && j < nb; ++i)
+		{
+			j = gallop(b, j, nb, [&](const T& value) { return value < a[i]; });
+			if (j < nb && !(a[i] < b[j])) appendDistinct(out, count, a[i]);
+		}
+		return count;
+	}
+	if constexpr (std::is_same<T, int>::value)
+	{
+		return simdKernels().intersectInts(a, na, b, nb, out);
+	}
+	else
+	{
+		std::size_t i = 0, j = 0;
+		while (i < na && j < nb)
+		{
+			if (a[i] < b[j]) ++i;
+			else if (b[j] < a[i]) ++j;
+			else
+			{
+				appendDistinct(out, count, a[i]);
+				++i;
+				++j;
+			}
+		}
+		return count;
+	}
+}
+
+//*****************
+// Template Function: unionSorted
+// Purpose: Writes the values found in a or b. When one run is 32 times shorter, the longer one is copied
+//          in stretches found by galloping to each of the shorter run's values.
+// Parameters:
+//    - a, na: The first run, sorted in ascending order.
+//    - b, nb: The second run, sorted in ascending order.
+//    - out: Receives the result; needs room for na + nb elements.
+// Returns: The number of elements written.
+//*****************
+template <typename T>
+std::size_t unionSorted(const T* a, std::size_t na, const T* b, std::size_t nb, T* out)
+{
+	if (na > nb) return unionSorted(b, nb, a, na, out);
+	std::size_t count = 0, i = 0, j = 0;
+	if (na * kSetGallopRatio <= nb)
+	{
+		for (; i < na; ++i)
+		{
+			const std::size_t stretch = gallop(b, j, nb, [&](const T& value) { return value < a[i]; });
+			for (; j < stretch; ++j) appendDistinct(out, count, b[j]);
+			appendDistinct(out, count, a[i]);
+		}
+	}
+	while (i < na && j < nb)
+	{
+		if (b[j] < a[i]) appendDistinct(out, count, b[j++]);
+		else appendDistinct(out, count, a[i++]);
+	}
+	for (; i < na; ++i) appendDistinct(out, count, a[i]);
+	for (; j < nb; ++j) appendDistinct(out, count, b[j]);
+	return count;
+}
+
+//*****************
+// Template Function: differenceSorted
+// Purpose: Writes the values found in a and not in b, galloping through whichever run is 32 times longer.
+// Parameters:
+//    - a, na: The first run, sorted in ascending order.
+//    - b, nb: The second run, sorted in ascending order.
+//    - out: Receives the result; needs room for na elements.
+// Returns: The number of elements written.
+//*****************
+template <typename T>
+std::size_t differenceSorted(const T* a, std::size_t na, const T* b, std::size_t nb, T* out)
+{
+	std::size_t count = 0, i = 0, j = 0;
+	if (na * kSetGallopRatio <= nb)
+	{
+		for (; i < na; ++i)
+		{
+			j = gallop(b, j, nb, [&](const T& value) { return value < a[i]; });
+			if (j == nb || a[i] < b[j]) appendDistinct(out, count, a[i]);
+		}
+		return count;
+	}
+	if (nb * kSetGallopRatio <= na)
+	{
+		for (; j < nb; ++j)
+		{
+			const std::size_t stretch = gallop(a, i, na, [&](const T& value) { return value < b[j]; });
+			for (; i < stretch; ++i) appendDistinct(out, count, a[i]);
+			i = gallop(a, i, na, [&](const T& value) { return !(b[j] < value); });
+		}
+		for (; i < na; ++i) appendDistinct(out, count, a[i]);
+		return count;
+	}
+	while (i < na && j < nb)
+	{
+		if (a[i] < b[j]) appendDistinct(out, count, a[i++]);
+		else if (b[j] < a[i]) ++j;
+		else ++i;
+	}
+	for (; i < na; ++i) appendDistinct(out, count, a[i]);
+	return count;
+}
+
+//*****************
+// Template Function: setOperation
+// Purpose: Applies a SetOperation to two runs sorted in ascending order; merges of ints use the mergeInts
+//          SIMD kernel.
+// Parameters:
+//    - operation: The operation.
+//    - a, na: The first run.
+//    - b, nb: The second run.
+//    - out: Receives the result; room for na + nb elements is always enough.
+// Returns: The number of elements written.
+//*****************
+template <typename T>
+std::size_t setOperation(SetOperation operation, const T* a, std::size_t na, const T* b, std::size_t nb, T* out)
+{
+	switch (operation)
+	{
+	case SetOperation::Union: return unionSorted(a, na, b, nb, out);
+	case SetOperation::Intersection: return intersectSorted(a, na, b, nb, out);
+	case SetOperation::Difference: return differenceSorted(a, na, b, nb, out);
+	default:
+		if constexpr (std::is_same<T, int>::value) simdKernels().mergeInts(a, na, b, nb, out);
+		else std::merge(a, a + na, b, b + nb, out);
+		return na + nb;
+	}
+}
+
+//*****************
+// Template Function: applySetOperation
+// Purpose: Applies a SetOperation leaf by leaf: result gets the shape of a, and each of its leaf containers
+//          holds the operation on the matching leaf containers of a and b (paired in order), so rows sorted
+//          by recursiveSort can be combined row by row.
+// Parameters:
+//    - operation: The operation.
+//    - a, b: Containers of the same type and number of leaf containers, every leaf sorted in ascending
+//            order (as recursiveSort with std::greater leaves them).
+//    - result: Receives the result; may not be a or b.
+// Returns: false if the containers have different numbers of leaves, a leaf is not sorted or a result leaf
+//          has a fixed size (std::array) the result does not fit.
+//*****************
+template <typename Container>
+bool applySetOperation(SetOperation operation, const Container& a, const Container& b, Container& result)
+{
+	using T = innermost_value_t<Container>;
+	using Leaf = leaf_container_t<Container>;
+	std::vector<const Leaf*> rightLeaves;
+	auto collect = [&](const Leaf& leaf) { rightLeaves.push_back(&leaf); };
+	forEachLeafContainer(b, collect);
+
+	result = a;
+	std::size_t next = 0;
+	bool ok = true;
+	std::vector<T> left, right, combined;
+	auto apply = [&](Leaf& leaf)
+	{
+		if (!ok || next == rightLeaves.size())
+		{
+			ok = false;
+			return;
+		}
+		const Leaf& other = *rightLeaves[next++];
+		left.assign(leaf.begin(), leaf.end());
+		const T* rightData;
+		std::size_t rightSize;
+		if constexpr (is_contiguous_container<Leaf>::value)
+		{
+			rightData = other.data();
+			rightSize = other.size();
+		}
+		else
+		{
+			right.assign(other.begin(), other.end());
+			rightData = right.data();
+			rightSize = right.size();
+		}
+		ok = std::is_sorted(left.begin(), left.end()) && std::is_sorted(rightData, rightData + rightSize);
+		if (!ok) return;
+		combined.resize(left.size() + rightSize);
+		combined.resize(setOperation(operation, left.data(), left.size(), rightData, rightSize, combined.data()));
+		ok = assignRange(leaf, combined.begin(), combined.end());
+	};
+	forEachLeafContainer(result, apply);
+	return ok && next == rightLeaves.size();
+}
+
+//*****************
+// Class: SortedFileCursor
+// Purpose: Sequential reader of a sorted binary file of native-endian integers, a chunk at a time, for the
+//          streaming set operations.
+//*****************
+template <typename T>
+class SortedFileCursor
+{
+public:
+	using Key = typename std::make_unsigned<T>::type;
+
+	//*****************
+	// Function name: open
+	// Purpose: Opens a file and reads its first chunk; a descending file has its keys flipped so they
+	//          ascend along the file.
+	// Returns: false if the file cannot be read or its size is not a whole number of elements.
+	//*****************
+	bool open(const std::string& path, bool descending)
+	{
+		flip_ = descending ? std::numeric_limits<Key>::max() : 0;
+		ok_ = file_.openRead(path) && file_.size() % sizeof(T) == 0;
+		count_ = ok_ ? file_.size() / sizeof(T) : 0;
+		begin_ = 0;
+		chunk_.clear();
+		position_ = 0;
+		return ok_ && (count_ == 0 || load());
+	}
+
+	bool valid() const noexcept { return position_ < chunk_.size(); }
+	T value() const noexcept { return chunk_[position_]; }
+	Key key() const noexcept { return static_cast<Key>(radixKey(chunk_[position_]) ^ flip_); }
+
+	// Moves to the next element, reading the next chunk at the end of this one
+	void advance()
+	{
+		if (++position_ == chunk_.size() && begin_ < count_) load();
+	}
+
+	// False once a read has failed
+	bool ok() const noexcept { return ok_; }
+
+private:
+	bool load()
+	{
+		chunk_.resize(static_cast<std::size_t>(std::min<std::uint64_t>(kSetFileChunk, count_ - begin_)));
+		ok_ = ok_ && file_.readAt(chunk_.data(), chunk_.size() * sizeof(T), begin_ * sizeof(T));
+		if (!ok_) chunk_.clear();
+		begin_ += chunk_.size();
+		position_ = 0;
+		return ok_;
+	}
+
+	IoFile file_;
+	std::uint64_t count_ = 0;
+	std::uint64_t begin_ = 0;  // Position in the file after the loaded chunk
+	std::vector<T> chunk_;
+	std::size_t position_ = 0;
+	Key flip_ = 0;
+	bool ok_ = false;
+};
+
+//*****************
+// Template Function: setOperationFiles
+// Purpose: Applies a SetOperation to two sorted binary files (as externalSortFile writes them) and writes
+//          the result as a third one in the same order, streaming all three a chunk at a time.
+// Parameters:
+//    - operation: The operation.
+//    - pathA, pathB: The sorted input files.
+//    - outPath: The file to create or replace; may not be an input.
+//    - descending: The inputs are sorted in descending order, and so will the output be (default: false).
+// Returns: true on success, false if a file could not be read or written.
+//*****************
+template <typename T>
+bool setOperationFiles(SetOperation operation, const std::string& pathA, const std::string& pathB, const std::string& outPath, bool descending = false)
+{
+	static_assert(is_radix_sortable<T>::value, "setOperationFiles requires an integer type");
+	using Key = typename SortedFileCursor<T>::Key;
+	SortedFileCursor<T> a, b;
+	IoFile out;
+	if (!a.open(pathA, descending) || !b.open(pathB, descending) || !out.openWrite(outPath)) return false;
+
+	std::vector<T> buffer;
+	buffer.reserve(kSetFileChunk);
+	std::uint64_t offset = 0;
+	bool written = true, any = false;
+	Key last = 0;
+	const auto flush = [&]
+	{
+		written = written && out.writeAt(buffer.data(), buffer.size() * sizeof(T), offset);
+		offset += buffer.size() * sizeof(T);
+		buffer.clear();
+	};
+	const auto emit = [&](const SortedFileCursor<T>& from)
+	{
+		const Key key = from.key();
+		if (operation != SetOperation::Merge && any && key == last) return;
+		any = true;
+		last = key;
+		buffer.push_back(from.value());
+		if (buffer.size() == kSetFileChunk) flush();
+	};
+
+	const bool keepA = operation != SetOperation::Intersection;
+	const bool keepB = operation == SetOperation::Merge || operation == SetOperation::Union;
+	while (a.valid() && b.valid())
+	{
+		if (b.key() < a.key())
+		{
+			if (keepB) emit(b);
+			b.advance();
+		}
+		else
+		{
+			// Equal keys take a's element; b's equal ones follow for Merge or are dropped as repeats
+			if (b.key() == a.key() ? operation != SetOperation::Difference : keepA) emit(a);
+			a.advance();
+		}
+	}
+	for (; keepA && a.valid(); a.advance()) emit(a);
+	for (; keepB && b.valid(); b.advance()) emit(b);
+	flush();
+	return out.close() && written && a.ok() && b.ok();
+}
@@ -0,0 +1,120 @@
+//*****************
+// bubblesort/simd_dispatch.hpp
+// Runtime selection of the instruction set used by the SIMD kernels.
+//*****************
+#pragma once
+
+#include <cstdlib>    // for std::getenv
+#include <cstring>    // for std::strcmp
+
+// Multiversioning compiles each kernel once per instruction set with target attributes and picks one
+// at runtime. It needs GCC or Clang on x86; define BUBBLESORT_MULTIVERSION=0 to build only the baseline
+// kernels (those follow whatever -m/arch flags the whole program is compiled with).
+#ifndef BUBBLESORT_MULTIVERSION
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BUBBLESORT_MULTIVERSION 1
+#else
+#define BUBBLESORT_MULTIVERSION 0
+#endif
+#endif
+
+#if BUBBLESORT_MULTIVERSION
+#define BUBBLESORT_TARGET(isa) __attribute__((target(isa)))
+#define BUBBLESORT_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define BUBBLESORT_TARGET(isa)
+#define BUBBLESORT_ALWAYS_INLINE inline
+#endif
+
+// Software prefetch for reads whose address is known well ahead (e.g. gathers through an index array)
+#if defined(__GNUC__) || defined(__clang__)
+#define BUBBLESORT_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define BUBBLESORT_PREFETCH(address) ((void)0)
+#endif
+
+// x86 SIMD intrinsics are available (SSE2 is part of every x86-64 target)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BUBBLESORT_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define BUBBLESORT_X86_SIMD 0
+#endif
+
+// 64-bit x86, where std::size_t counters fill 64-bit SIMD lanes; 32-bit x86 scans them in 32-bit lanes
+#if defined(__x86_64__) || defined(_M_X64)
+#define BUBBLESORT_X86_64 1
+#else
+#define BUBBLESORT_X86_64 0
+#endif
+
+// Target attribute strings of the kernel variants
+#define BUBBLESORT_TARGET_SSE42 "sse4.2,popcnt"
+#define BUBBLESORT_TARGET_AVX2 "avx2,bmi2,fma,sse4.2,popcnt"
+#define BUBBLESORT_TARGET_AVX512 "avx512f,avx512bw,avx512dq,avx512vl,avx2,bmi2,fma,sse4.2,popcnt"
+
+//*****************
+// Enum: SimdIsa
+// Purpose: The instruction set a kernel variant is compiled for, from least to most capable.
+//          Baseline is the program's own compile flags and always runs.
+//*****************
+enum class SimdIsa
+{
+	Baseline,
+	Sse42,
+	Avx2,
+	Avx512
+};
+
+//*****************
+// Function name: simdIsaName
+// Purpose: Returns the name of an instruction set as accepted by the BUBBLESORT_ISA environment variable.
+//*****************
+inline const char* simdIsaName(SimdIsa isa) noexcept
+{
+	switch (isa)
+	{
+	case SimdIsa::Sse42: return "sse42";
+	case SimdIsa::Avx2: return "avx2";
+	case SimdIsa::Avx512: return "avx512";
+	default: return "baseline";
+	}
+}
+
+//*****************
+// Function name: detectSimdIsa
+// Purpose: Returns the most capable instruction set the CPU (and OS) supports, using cpuid.
+//*****************
+inline SimdIsa detectSimdIsa() noexcept
+{
+#if BUBBLESORT_MULTIVERSION
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+		__builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")) return SimdIsa::Avx512;
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("fma")) return SimdIsa::Avx2;
+	if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) return SimdIsa::Sse42;
+#endif
+	return SimdIsa::Baseline;
+}
+
+//*****************
+// Function name: selectSimdIsa
+// Purpose: Returns the instruction set the kernels run with: the detected one, or the one named by the
+//          BUBBLESORT_ISA environment variable (baseline, sse42, avx2, avx512) when the CPU supports it.
+//          Evaluated once; later changes to the environment have no effect.
+//*****************
+inline SimdIsa selectSimdIsa() noexcept
+{
+	static const SimdIsa selected = []
+	{
+		const SimdIsa detected = detectSimdIsa();
+		const char* requested = std::getenv("BUBBLESORT_ISA");
+		if (requested == nullptr) return detected;
+		for (SimdIsa isa : { SimdIsa::Baseline, SimdIsa::Sse42, SimdIsa::Avx2, SimdIsa::Avx512 })
+		{
+			if (std::strcmp(requested, simdIsaName(isa)) == 0 && isa <= detected) return isa;
+		}
+		return detected; // Unknown or unsupported names fall back to detection
+	}();
+	return selected;
+}
@@ -0,0 +1,579 @@
+//*****************
+// bubblesort/simd_kernels.hpp
+// SIMD scan, digit-sum, merge, sort, intersection and divisibility kernels, built per instruction set
+// and dispatched at runtime.
+//*****************
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>    // for std::swap
+#include <vector>
+
+#include "simd_dispatch.hpp"
+
+//*****************
+// Kernel bodies
+// Each body is written once, as plain loops the compiler vectorizes, and force-inlined into one wrapper
+// per instruction set so every wrapper is vectorized for its own target.
+//*****************
+
+//*****************
+// Function name: exclusiveScanTail
+// Purpose: Scalar exclusive scan of in[i, n) starting at init; the remainder loop of every scan variant.
+// Returns: The sum of init and the scanned counts.
+//*****************
+BUBBLESORT_ALWAYS_INLINE std::size_t exclusiveScanTail(const std::size_t* in, std::size_t* out, std::size_t i, std::size_t n, std::size_t init) noexcept
+{
+	for (; i < n; ++i)
+	{
+		const std::size_t count = in[i];
+		out[i] = init;
+		init += count;
+	}
+	return init;
+}
+
+#if BUBBLESORT_X86_SIMD && BUBBLESORT_X86_64
+//*****************
+// Function name: exclusiveScanSse2
+// Purpose: Exclusive scan two 64-bit counters per step (in-register shift-and-add plus a carried total).
+//*****************
+inline std::size_t exclusiveScanSse2(const std::size_t* in, std::size_t* out, std::size_t n, std::size_t init) noexcept
+{
+	std::size_t i = 0;
+	__m128i carry = _mm_set1_epi64x(static_cast<long long>(init));
+	for (const std::size_t vectorEnd = n - n % 2; i < vectorEnd; i += 2)
+	{
+		const __m128i counts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		const __m128i inclusive = _mm_add_epi64(_mm_add_epi64(counts, _mm_slli_si128(counts, 8)), carry);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi64(inclusive, counts));
+		carry = _mm_unpackhi_epi64(inclusive, inclusive);
+	}
+	return exclusiveScanTail(in, out, i, n, static_cast<std::size_t>(_mm_cvtsi128_si64(carry)));
+}
+#endif
+
+#if BUBBLESORT_X86_SIMD && BUBBLESORT_X86_64 && (BUBBLESORT_MULTIVERSION || defined(__AVX2__))
+//*****************
+// Function name: exclusiveScanAvx2
+// Purpose: Exclusive scan four 64-bit counters per step (in-lane shift-and-add, then a cross-lane add).
+//*****************
+BUBBLESORT_TARGET(BUBBLESORT_TARGET_AVX2) inline std::size_t exclusiveScanAvx2(const std::size_t* in, std::size_t* out, std::size_t n, std::size_t init) noexcept
+{
+	std::size_t i = 0;
+	__m256i carry = _mm256_set1_epi64x(static_cast<long long>(init));
+	for (const std::size_t vectorEnd = n - n % 4; i < vectorEnd; i += 4)
+	{
+		const __m256i counts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+		// In-lane step: [a, a + b | c, c + d]
+		__m256i sums = _mm256_add_epi64(counts, _mm256_slli_si256(counts, 8));
+		// Cross-lane step: add a + b to the upper lane
+		sums = _mm256_add_epi64(sums, _mm256_blend_epi32(_mm256_setzero_si256(), _mm256_permute4x64_epi64(sums, 0x55), 0xF0));
+		const __m256i inclusive = _mm256_add_epi64(sums, carry);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi64(inclusive, counts));
+		carry = _mm256_permute4x64_epi64(inclusive, 0xFF);
+	}
+	return exclusiveScanTail(in, out, i, n, static_cast<std::size_t>(_mm256_extract_epi64(carry, 0)));
+}
+#endif
+
+#if BUBBLESORT_X86_SIMD && !BUBBLESORT_X86_64
+//*****************
+// Function name: exclusiveScanSse2
+// Purpose: Exclusive scan four 32-bit counters per step, for 32-bit x86 where std::size_t has 32 bits.
+//*****************
+inline std::size_t exclusiveScanSse2(const std::size_t* in, std::size_t* out, std::size_t n, std::size_t init) noexcept
+{
+	std::size_t i = 0;
+	__m128i carry = _mm_set1_epi32(static_cast<int>(init));
+	for (const std::size_t vectorEnd = n - n % 4; i < vectorEnd; i += 4)
+	{
+		const __m128i counts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		__m128i sums = _mm_add_epi32(counts, _mm_slli_si128(counts, 4));
+		sums = _mm_add_epi32(sums, _mm_slli_si128(sums, 8));
+		const __m128i inclusive = _mm_add_epi32(sums, carry);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi32(inclusive, counts));
+		carry = _mm_shuffle_epi32(inclusive, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+	return exclusiveScanTail(in, out, i, n, static_cast<std::size_t>(_mm_cvtsi128_si32(carry)));
+}
+#endif
+
+#if BUBBLESORT_X86_SIMD && !BUBBLESORT_X86_64 && (BUBBLESORT_MULTIVERSION || defined(__AVX2__))
+//*****************
+// Function name: exclusiveScanAvx2
+// Purpose: Exclusive scan eight 32-bit counters per step (in-lane shift-and-add, then the low lane's total
+//          added to the upper lane), for 32-bit x86 where std::size_t has 32 bits.
+//*****************
+BUBBLESORT_TARGET(BUBBLESORT_TARGET_AVX2) inline std::size_t exclusiveScanAvx2(const std::size_t* in, std::size_t* out, std::size_t n, std::size_t init) noexcept
+{
+	std::size_t i = 0;
+	__m256i carry = _mm256_set1_epi32(static_cast<int>(init));
+	for (const std::size_t vectorEnd = n - n % 8; i < vectorEnd; i += 8)
+	{
+		const __m256i counts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+		__m256i sums = _mm256_add_epi32(counts, _mm256_slli_si256(counts, 4));
+		sums = _mm256_add_epi32(sums, _mm256_slli_si256(sums, 8));
+		sums = _mm256_add_epi32(sums, _mm256_blend_epi32(_mm256_setzero_si256(), _mm256_permutevar8x32_epi32(sums, _mm256_set1_epi32(3)), 0xF0));
+		const __m256i inclusive = _mm256_add_epi32(sums, carry);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi32(inclusive, counts));
+		carry = _mm256_permutevar8x32_epi32(inclusive, _mm256_set1_epi32(7));
+	}
+	return exclusiveScanTail(in, out, i, n, static_cast<std::size_t>(_mm256_extract_epi32(carry, 0)));
+}
+#endif
+
+//*****************
+// Function name: intersectIntsTail
+// Purpose: Scalar merge intersection of a[i, na) and b[j, nb), appending values that are not already the last
+//          one in out; the remainder loop of every intersection variant.
+// Returns: The number of values in out.
+//*****************
+BUBBLESORT_ALWAYS_INLINE std::size_t intersectIntsTail(const int* a, std::size_t i, std::size_t na, const int* b, std::size_t j, std::size_t nb, int* out, std::size_t count) noexcept
+{
+	while (i < na && j < nb)
+	{
+		if (a[i] < b[j]) ++i;
+		else if (b[j] < a[i]) ++j;
+		else
+		{
+			if (count == 0 || out[count - 1] < a[i]) out[count++] = a[i];
+			++i;
+			++j;
+		}
+	}
+	return count;
+}
+
+#if BUBBLESORT_X86_SIMD
+//*****************
+// Function name: intersectIntsSse2
+// Purpose: Block intersection four values at a time: a block of a is compared with all four rotations of a
+//          block of b, the lanes of a that matched are appended, and whichever block ends lower (or both)
+//          moves on. Matches come out in ascending order, so repeats are dropped against the last one.
+//*****************
+inline std::size_t intersectIntsSse2(const int* a, std::size_t na, const int* b, std::size_t nb, int* out) noexcept
+{
+	std::size_t i = 0, j = 0, count = 0;
+	while (i + 4 <= na && j + 4 <= nb)
+	{
+		const __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		const __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+		__m128i equal = _mm_cmpeq_epi32(left, right);
+		equal = _mm_or_si128(equal, _mm_cmpeq_epi32(left, _mm_shuffle_epi32(right, _MM_SHUFFLE(0, 3, 2, 1))));
+		equal = _mm_or_si128(equal, _mm_cmpeq_epi32(left, _mm_shuffle_epi32(right, _MM_SHUFFLE(1, 0, 3, 2))));
+		equal = _mm_or_si128(equal, _mm_cmpeq_epi32(left, _mm_shuffle_epi32(right, _MM_SHUFFLE(2, 1, 0, 3))));
+		const int mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+		for (int lane = 0; mask >> lane; ++lane)
+		{
+			if ((mask >> lane & 1) && (count == 0 || out[count - 1] < a[i + lane])) out[count++] = a[i + lane];
+		}
+		const int lastA = a[i + 3], lastB = b[j + 3];
+		i += lastA <= lastB ? 4 : 0;
+		j += lastB <= lastA ? 4 : 0;
+	}
+	return intersectIntsTail(a, i, na, b, j, nb, out, count);
+}
+#endif
+
+#if BUBBLESORT_X86_SIMD && (BUBBLESORT_MULTIVERSION || defined(__AVX2__))
+//*****************
+// Function name: intersectIntsAvx2
+// Purpose: Block intersection eight values at a time, comparing a block of a with all eight rotations of a
+//          block of b (cross-lane permutes); otherwise as intersectIntsSse2.
+//*****************
+BUBBLESORT_TARGET(BUBBLESORT_TARGET_AVX2) inline std::size_t intersectIntsAvx2(const int* a, std::size_t na, const int* b, std::size_t nb, int* out) noexcept
+{
+	const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+	std::size_t i = 0, j = 0, count = 0;
+	while (i + 8 <= na && j + 8 <= nb)
+	{
+		const __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		__m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+		__m256i equal = _mm256_cmpeq_epi32(left, right);
+		for (int turn = 1; turn < 8; ++turn)
+		{
+			right = _mm256_permutevar8x32_epi32(right, rotate);
+			equal = _mm256_or_si256(equal, _mm256_cmpeq_epi32(left, right));
+		}
+		const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+		for (int lane = 0; mask >> lane; ++lane)
+		{
+			if ((mask >> lane & 1) && (count == 0 || out[count - 1] < a[i + lane])) out[count++] = a[i + lane];
+		}
+		const int lastA = a[i + 7], lastB = b[j + 7];
+		i += lastA <= lastB ? 8 : 0;
+		j += lastB <= lastA ? 8 : 0;
+	}
+	return intersectIntsTail(a, i, na, b, j, nb, out, count);
+}
+#endif
+
+//*****************
+// Struct: DivisibilityTest
+// Purpose: Constants of the multiply-and-rotate divisibility test (Granlund and Montgomery) for a divisor
+//          d = odd * 2^shift: an unsigned u is a multiple of d exactly when (u * inverse) rotated right by
+//          shift is at most threshold, where inverse is the inverse of odd modulo 2^32 and threshold is
+//          (2^32 - 1) / d. One multiply replaces the division of u % d.
+//*****************
+struct DivisibilityTest
+{
+	std::uint32_t inverse = 1;
+	std::uint32_t threshold = ~std::uint32_t(0);
+	unsigned shift = 0;
+};
+
+//*****************
+// Function name: divisibilityTest
+// Purpose: Returns the DivisibilityTest constants of a divisor (at least 1).
+//*****************
+constexpr DivisibilityTest divisibilityTest(std::uint32_t divisor) noexcept
+{
+	DivisibilityTest test;
+	test.threshold = ~std::uint32_t(0) / divisor;
+	while ((divisor & 1) == 0)
+	{
+		divisor >>= 1;
+		++test.shift;
+	}
+	// Newton's iteration doubles the correct low bits of the inverse every step, from 3 (odd * odd == 1 mod 8)
+	std::uint32_t inverse = divisor;
+	for (int step = 0; step < 4; ++step) inverse *= 2 - divisor * inverse;
+	test.inverse = inverse;
+	return test;
+}
+
+//*****************
+// Function name: classifyDivisibleTail
+// Purpose: Scalar divisibility classes of in[i, n): 0 for multiples of divisor when divisibleFirst, 1 for the
+//          rest, and the other way round otherwise; the remainder loop of every classification variant. A
+//          value is a multiple exactly when its magnitude is, so the test runs on unsigned magnitudes.
+//*****************
+BUBBLESORT_ALWAYS_INLINE void classifyDivisibleTail(const int* in, std::size_t i, std::size_t n, const DivisibilityTest& test, bool divisibleFirst, unsigned char* out) noexcept
+{
+	for (; i < n; ++i)
+	{
+		const std::uint32_t value = static_cast<std::uint32_t>(in[i]);
+		const std::uint32_t product = (in[i] < 0 ? 0u - value : value) * test.inverse;
+		const std::uint32_t rotated = (product >> test.shift) | (product << ((32 - test.shift) & 31));
+		out[i] = static_cast<unsigned char>((rotated <= test.threshold) != divisibleFirst);
+	}
+}
+
+#if BUBBLESORT_X86_SIMD
+//*****************
+// Function name: notDivisibleSse2
+// Purpose: Marks the four values at in that are not multiples of the divisor. The 32-bit products come
+//          from two widening multiplies of the even and odd lanes (SSE2 has no 32-bit mullo) and the unsigned
+//          compare from a signed one on lanes whose sign bits were flipped by bias.
+//*****************
+inline __m128i notDivisibleSse2(const int* in, __m128i inverse, __m128i right, __m128i left, __m128i bias, __m128i threshold) noexcept
+{
+	const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+	const __m128i sign = _mm_srai_epi32(values, 31);
+	const __m128i magnitude = _mm_sub_epi32(_mm_xor_si128(values, sign), sign);
+	const __m128i even = _mm_mul_epu32(magnitude, inverse);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(magnitude, 32), inverse);
+	const __m128i product = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	const __m128i rotated = _mm_or_si128(_mm_srl_epi32(product, right), _mm_sll_epi32(product, left));
+	return _mm_cmpgt_epi32(_mm_xor_si128(rotated, bias), threshold);
+}
+
+//*****************
+// Function name: classifyDivisibleSse2
+// Purpose: Divisibility classes sixteen values at a time: four notDivisibleSse2 masks are packed into
+//          sixteen class bytes.
+//*****************
+inline void classifyDivisibleSse2(const int* in, std::size_t n, unsigned divisor, bool divisibleFirst, unsigned char* out) noexcept
+{
+	const DivisibilityTest test = divisibilityTest(divisor);
+	const __m128i inverse = _mm_set1_epi32(static_cast<int>(test.inverse));
+	const __m128i right = _mm_cvtsi32_si128(static_cast<int>(test.shift));
+	const __m128i left = _mm_cvtsi32_si128(static_cast<int>(32 - test.shift)); // A count of 32 shifts out every bit
+	const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+	const __m128i threshold = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(test.threshold)), bias);
+	// The masks mark values that are not multiples, class 1 when divisibleFirst
+	const __m128i flip = _mm_set1_epi8(divisibleFirst ? 0 : 1);
+	const __m128i one = _mm_set1_epi8(1);
+	std::size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		const __m128i low = _mm_packs_epi32(notDivisibleSse2(in + i, inverse, right, left, bias, threshold), notDivisibleSse2(in + i + 4, inverse, right, left, bias, threshold));
+		const __m128i high = _mm_packs_epi32(notDivisibleSse2(in + i + 8, inverse, right, left, bias, threshold), notDivisibleSse2(in + i + 12, inverse, right, left, bias, threshold));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(_mm_and_si128(_mm_packs_epi16(low, high), one), flip));
+	}
+	classifyDivisibleTail(in, i, n, test, divisibleFirst, out);
+}
+#endif
+
+#if BUBBLESORT_X86_SIMD && (BUBBLESORT_MULTIVERSION || defined(__AVX2__))
+//*****************
+// Function name: divisibleAvx2
+// Purpose: Marks the eight values at in that are multiples of the divisor, with 32-bit mullo, abs and an
+//          unsigned max for the compare.
+//*****************
+BUBBLESORT_TARGET(BUBBLESORT_TARGET_AVX2) inline __m256i divisibleAvx2(const int* in, __m256i inverse, __m128i right, __m128i left, __m256i threshold) noexcept
+{
+	const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+	const __m256i product = _mm256_mullo_epi32(_mm256_abs_epi32(values), inverse);
+	const __m256i rotated = _mm256_or_si256(_mm256_srl_epi32(product, right), _mm256_sll_epi32(product, left));
+	return _mm256_cmpeq_epi32(_mm256_max_epu32(rotated, threshold), threshold);
+}
+
+//*****************
+// Function name: classifyDivisibleAvx2
+// Purpose: Divisibility classes thirty-two values at a time: four divisibleAvx2 masks are packed into
+//          thirty-two class bytes and their four-byte groups put back in order.
+//*****************
+BUBBLESORT_TARGET(BUBBLESORT_TARGET_AVX2) inline void classifyDivisibleAvx2(const int* in, std::size_t n, unsigned divisor, bool divisibleFirst, unsigned char* out) noexcept
+{
+	const DivisibilityTest test = divisibilityTest(divisor);
+	const __m256i inverse = _mm256_set1_epi32(static_cast<int>(test.inverse));
+	const __m128i right = _mm_cvtsi32_si128(static_cast<int>(test.shift));
+	const __m128i left = _mm_cvtsi32_si128(static_cast<int>(32 - test.shift));
+	const __m256i threshold = _mm256_set1_epi32(static_cast<int>(test.threshold));
+	// The masks mark multiples, class 1 when divisibleFirst is false
+	const __m256i flip = _mm256_set1_epi8(divisibleFirst ? 1 : 0);
+	const __m256i one = _mm256_set1_epi8(1);
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	std::size_t i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		// The packs work within 128-bit lanes, leaving the four-byte groups of the inputs interleaved
+		const __m256i low = _mm256_packs_epi32(divisibleAvx2(in + i, inverse, right, left, threshold), divisibleAvx2(in + i + 8, inverse, right, left, threshold));
+		const __m256i high = _mm256_packs_epi32(divisibleAvx2(in + i + 16, inverse, right, left, threshold), divisibleAvx2(in + i + 24, inverse, right, left, threshold));
+		const __m256i masks = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(low, high), order);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(_mm256_and_si256(masks, one), flip));
+	}
+	classifyDivisibleTail(in, i, n, test, divisibleFirst, out);
+}
+#endif
+
+//*****************
+// Function name: digitSumsBody
+// Purpose: Writes the decimal digit sum of every value (0 for values below 1, as SumOfDigits does).
+//          A fixed ten-step loop over unsigned values replaces the data-dependent loop so it vectorizes.
+//*****************
+BUBBLESORT_ALWAYS_INLINE void digitSumsBody(const int* in, int* out, std::size_t n) noexcept
+{
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		unsigned value = in[i] > 0 ? static_cast<unsigned>(in[i]) : 0u;
+		unsigned sum = 0;
+		for (int digit = 0; digit < 10; ++digit) // An int has at most ten decimal digits
+		{
+			sum += value % 10;
+			value /= 10;
+		}
+		out[i] = static_cast<int>(sum);
+	}
+}
+
+//*****************
+// Function name: mergeIntsBody
+// Purpose: Stable branchless merge of two ascending arrays into out (ties take the element of a first).
+//*****************
+BUBBLESORT_ALWAYS_INLINE void mergeIntsBody(const int* a, std::size_t na, const int* b, std::size_t nb, int* out) noexcept
+{
+	std::size_t i = 0, j = 0, k = 0;
+	while (i < na && j < nb)
+	{
+		const int x = a[i], y = b[j];
+		const bool takeB = y < x;
+		out[k++] = takeB ? y : x;
+		j += takeB;
+		i += !takeB;
+	}
+	std::copy(a + i, a + na, out + k);
+	std::copy(b + j, b + nb, out + k + (na - i));
+}
+
+// Rows and columns of the blocks sortIntsBody sorts with a sorting network before merging
+constexpr std::size_t kSimdSortBlockSide = 8;
+
+// Inputs up to this size merge through a stack buffer instead of a heap allocation
+constexpr std::size_t kSimdSortStackBuffer = 1024;
+
+//*****************
+// Function name: sortIntsBody
+// Purpose: Sorts ints in ascending order. Blocks of 8 x 8 values are sorted column-wise by an 8-input
+//          sorting network applied to whole rows (min/max across 8 lanes at a time) and transposed
+//          into 8 sorted runs; runs are then combined by branchless bottom-up merging.
+//*****************
+BUBBLESORT_ALWAYS_INLINE void sortIntsBody(int* data, std::size_t n) noexcept
+{
+	constexpr std::size_t side = kSimdSortBlockSide;
+	constexpr std::size_t block = side * side;
+	// Batcher's odd-even merge sorting network for 8 inputs (19 comparators)
+	static constexpr unsigned char network[19][2] = { {0, 1}, {2, 3}, {4, 5}, {6, 7}, {0, 2}, {1, 3}, {4, 6}, {5, 7},
+		{1, 2}, {5, 6}, {0, 4}, {1, 5}, {2, 6}, {3, 7}, {2, 4}, {3, 5}, {1, 2}, {3, 4}, {5, 6} };
+
+	std::size_t begin = 0;
+	for (; n - begin >= block; begin += block)
+	{
+		int rows[side][side];
+		for (std::size_t r = 0; r < side; ++r)
+		{
+			for (std::size_t lane = 0; lane < side; ++lane) rows[r][lane] = data[begin + r * side + lane];
+		}
+		for (const auto& pair : network)
+		{
+			int* low = rows[pair[0]];
+			int* high = rows[pair[1]];
+			int a[side], b[side]; // Copies tell the compiler the rows do not alias
+			std::copy(low, low + side, a);
+			std::copy(high, high + side, b);
+			for (std::size_t lane = 0; lane < side; ++lane) // One vector min and max per comparator
+			{
+				low[lane] = std::min(a[lane], b[lane]);
+				high[lane] = std::max(a[lane], b[lane]);
+			}
+		}
+		for (std::size_t r = 0; r < side; ++r) // Transpose: sorted column lane becomes run lane
+		{
+			for (std::size_t lane = 0; lane < side; ++lane) data[begin + lane * side + r] = rows[r][lane];
+		}
+	}
+	for (std::size_t run = begin; run < n; run += side) // Leftover values form runs of up to 8 by insertion sort
+	{
+		const std::size_t end = std::min(n, run + side);
+		for (std::size_t i = run + 1; i < end; ++i)
+		{
+			const int value = data[i];
+			std::size_t j = i;
+			for (; j > run && value < data[j - 1]; --j) data[j] = data[j - 1];
+			data[j] = value;
+		}
+	}
+
+	if (n <= side) return;
+	int stackBuffer[kSimdSortStackBuffer];
+	std::vector<int> heapBuffer(n > kSimdSortStackBuffer ? n : 0);
+	int* src = data;
+	int* dst = n > kSimdSortStackBuffer ? heapBuffer.data() : stackBuffer;
+	for (std::size_t width = side; width < n; width *= 2)
+	{
+		for (std::size_t left = 0; left < n; left += 2 * width)
+		{
+			const std::size_t middle = std::min(n, left + width);
+			const std::size_t right = std::min(n, left + 2 * width);
+			mergeIntsBody(src + left, middle - left, src + middle, right - middle, dst + left);
+		}
+		std::swap(src, dst);
+	}
+	if (src != data) std::copy(src, src + n, data);
+}
+
+//*****************
+// Struct: SimdKernels
+// Purpose: One instruction set's variants of every kernel. simdKernels() returns the table picked at
+//          startup; simdKernelsFor() returns any variant, e.g. to benchmark them side by side.
+//*****************
+struct SimdKernels
+{
+	SimdIsa isa;
+	std::size_t (*exclusiveScan)(const std::size_t* in, std::size_t* out, std::size_t n, std::size_t init);
+	void (*digitSums)(const int* in, int* out, std::size_t n);
+	void (*mergeInts)(const int* a, std::size_t na, const int* b, std::size_t nb, int* out);
+	void (*sortInts)(int* data, std::size_t n);
+	std::size_t (*intersectInts)(const int* a, std::size_t na, const int* b, std::size_t nb, int* out);
+	void (*classifyDivisible)(const int* in, std::size_t n, unsigned divisor, bool divisibleFirst, unsigned char* out);
+};
+
+// Defines the wrappers of the generic kernel bodies for one instruction set
+#define BUBBLESORT_DEFINE_KERNELS(suffix, target) \
+	target inline void digitSums##suffix(const int* in, int* out, std::size_t n) noexcept { digitSumsBody(in, out, n); } \
+	target inline void mergeInts##suffix(const int* a, std::size_t na, const int* b, std::size_t nb, int* out) noexcept { mergeIntsBody(a, na, b, nb, out); } \
+	target inline void sortInts##suffix(int* data, std::size_t n) noexcept { sortIntsBody(data, n); }
+
+BUBBLESORT_DEFINE_KERNELS(Baseline, )
+
+//*****************
+// Function name: exclusiveScanBaseline
+// Purpose: Exclusive scan with the best SIMD path the program's compile flags allow.
+//*****************
+inline std::size_t exclusiveScanBaseline(const std::size_t* in, std::size_t* out, std::size_t n, std::size_t init) noexcept
+{
+#if BUBBLESORT_X86_SIMD && defined(__AVX2__)
+	return exclusiveScanAvx2(in, out, n, init);
+#elif BUBBLESORT_X86_SIMD
+	return exclusiveScanSse2(in, out, n, init);
+#else
+	return exclusiveScanTail(in, out, 0, n, init);
+#endif
+}
+
+//*****************
+// Function name: intersectIntsBaseline
+// Purpose: Intersection of two ascending runs with the best SIMD path the program's compile flags allow;
+//          values found in both are written once each.
+// Returns: The number of values written to out.
+//*****************
+inline std::size_t intersectIntsBaseline(const int* a, std::size_t na, const int* b, std::size_t nb, int* out) noexcept
+{
+#if BUBBLESORT_X86_SIMD && defined(__AVX2__)
+	return intersectIntsAvx2(a, na, b, nb, out);
+#elif BUBBLESORT_X86_SIMD
+	return intersectIntsSse2(a, na, b, nb, out);
+#else
+	return intersectIntsTail(a, 0, na, b, 0, nb, out, 0);
+#endif
+}
+
+//*****************
+// Function name: classifyDivisibleBaseline
+// Purpose: Divisibility classes with the best SIMD path the program's compile flags allow.
+//*****************
+inline void classifyDivisibleBaseline(const int* in, std::size_t n, unsigned divisor, bool divisibleFirst, unsigned char* out) noexcept
+{
+#if BUBBLESORT_X86_SIMD && defined(__AVX2__)
+	classifyDivisibleAvx2(in, n, divisor, divisibleFirst, out);
+#elif BUBBLESORT_X86_SIMD
+	classifyDivisibleSse2(in, n, divisor, divisibleFirst, out);
+#else
+	classifyDivisibleTail(in, 0, n, divisibilityTest(divisor), divisibleFirst, out);
+#endif
+}
+
+#if BUBBLESORT_MULTIVERSION
+BUBBLESORT_DEFINE_KERNELS(Sse42, BUBBLESORT_TARGET(BUBBLESORT_TARGET_SSE42))
+BUBBLESORT_DEFINE_KERNELS(Avx2, BUBBLESORT_TARGET(BUBBLESORT_TARGET_AVX2))
+BUBBLESORT_DEFINE_KERNELS(Avx512, BUBBLESORT_TARGET(BUBBLESORT_TARGET_AVX512))
+#endif
+
+//*****************
+// Function name: simdKernelsFor
+// Purpose: Returns the kernel table of an instruction set (the baseline table when multiversioning is off).
+//          The caller must make sure the CPU supports the instruction set.
+//*****************
+inline const SimdKernels& simdKernelsFor(SimdIsa isa) noexcept
+{
+	static const SimdKernels baseline = { SimdIsa::Baseline, exclusiveScanBaseline, digitSumsBaseline, mergeIntsBaseline, sortIntsBaseline, intersectIntsBaseline, classifyDivisibleBaseline };
+#if BUBBLESORT_MULTIVERSION
+	static const SimdKernels sse42 = { SimdIsa::Sse42, exclusiveScanSse2, digitSumsSse42, mergeIntsSse42, sortIntsSse42, intersectIntsSse2, classifyDivisibleSse2 };
+	static const SimdKernels avx2 = { SimdIsa::Avx2, exclusiveScanAvx2, digitSumsAvx2, mergeIntsAvx2, sortIntsAvx2, intersectIntsAvx2, classifyDivisibleAvx2 };
+	static const SimdKernels avx512 = { SimdIsa::Avx512, exclusiveScanAvx2, digitSumsAvx512, mergeIntsAvx512, sortIntsAvx512, intersectIntsAvx2, classifyDivisibleAvx2 };
+	switch (isa)
+	{
+	case SimdIsa::Sse42: return sse42;
+	case SimdIsa::Avx2: return avx2;
+	case SimdIsa::Avx512: return avx512;
+	default: break;
+	}
+#else
+	(void)isa;
+#endif
+	return baseline;
+}
+
+//*****************
+// Function name: simdKernels
+// Purpose: Returns the kernel table for the instruction set chosen once by selectSimdIsa.
+//*****************
+inline const SimdKernels& simdKernels() noexcept
+{
+	static const SimdKernels& selected = simdKernelsFor(selectSimdIsa());
+	return selected;
+}
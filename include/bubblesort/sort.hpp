@@ -0,0 +1,370 @@
+//*****************
+// bubblesort/sort.hpp
+// bubbleSort and recursiveSort, dispatching leaf containers to the engines.
+//*****************
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional> // for std::greater and std::invoke
+#include <iterator>   // for std::distance and std::next
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>    // for std::swap
+
+#include "traits.hpp"
+#include "sort_engine.hpp"
+#include "string_sort.hpp"
+#include "string_table.hpp"
+#include "integer_sort.hpp"
+#include "projection.hpp"
+#include "record_sort.hpp"
+#include "collation.hpp"
+#include "natural_sort.hpp"
+#include "class_partition.hpp"
+
+//*****************
+// Template Function: bubbleSort
+// Purpose: Performs a Bubble Sort on a given container using a specified comparator.
+// Parameters:
+//    - holder: A reference to a container that needs to be sorted.
+//    - compare: A comparator function or functor for custom sorting true bubbles up (default: greater).
+// Returns: void
+//*****************
+template <typename Container, typename Comparator = std::greater<typename Container::value_type>>
+void bubbleSort(Container& holder, Comparator compare = Comparator()) noexcept
+{
+	bool swapped;
+	const std::size_t n = std::distance(holder.begin(), holder.end());
+	if (n < 2) return;
+
+	// Perform bubble sort with a comparator to define sorting order
+	for (std::size_t i = 0; i < n - 1; ++i)
+	{
+		swapped = false;
+		auto it = holder.begin();
+		for (std::size_t j = 0; j < n - i - 1; ++j)
+		{
+			auto next = std::next(it);
+			if (compare(*it, *next))
+			{
+				std::swap(*it, *next);
+				swapped = true;
+			}
+			it = next;
+		}
+		if (!swapped) break;
+	}
+}
+
+//*****************
+// Template Function: bubbleSort
+// Purpose: Performs a Bubble Sort that compares projected elements: compare(project(a), project(b)).
+//          Keys are recomputed on every comparison; recursiveSort with a projection caches them.
+// Parameters:
+//    - holder: A reference to a container that needs to be sorted.
+//    - compare: A comparator on the projected keys, true bubbles up.
+//    - project: The projection (any callable, including pointers to members).
+// Returns: void
+//*****************
+template <typename Container, typename Comparator, typename Projection>
+void bubbleSort(Container& holder, Comparator compare, Projection project) noexcept
+{
+	using Value = typename Container::value_type;
+	bubbleSort(holder, [&compare, &project](const Value& a, const Value& b)
+	{
+		return compare(std::invoke(project, a), std::invoke(project, b));
+	});
+}
+
+// Containers below this size are left to bubbleSort, where engine setup would cost more than it saves
+constexpr std::size_t kIntegerEngineThreshold = 64;
+
+// Defined below; sortLeaf hands comparators that declare a projection to it
+template <typename Container, typename Comparator, typename Projection>
+void sortProjectedLeaf(Container& holder, Comparator compare, Projection project, const SortOptions& options);
+
+// Defined below; sortLeaf hands comparators that declare a classifier to it
+template <typename Container, typename Comparator>
+void sortClassifiedLeaf(Container& holder, Comparator compare, const SortOptions& options);
+
+//*****************
+// Template Function: sortByBinaryKeys
+// Purpose: Sorts strings with a binary key engine (sort) when its keys fit the scratch budget, and in place
+//          with comparisonSort, comparing the strings with compare itself, otherwise.
+// Parameters:
+//    - holder: A reference to a container of strings that needs to be sorted.
+//    - compare: The CollatedOrder or NaturalOrder comparator, true bubbles up.
+//    - options: The SortOptions.
+//    - sort: A callable running the binary key engine on holder.
+// Returns: void
+//*****************
+template <typename Container, typename Comparator, typename SortFn>
+void sortByBinaryKeys(Container& holder, Comparator compare, const SortOptions& options, SortFn sort)
+{
+	using Value = typename Container::value_type;
+	const std::size_t n = static_cast<std::size_t>(std::distance(holder.begin(), holder.end()));
+	const std::size_t bytes = options.scratchBudget == kUnlimitedScratch && !options.report ? 0 : binaryKeySortScratchBytes(holder);
+	if (options.fits(bytes))
+	{
+		sort();
+		recordSortChoice(options, SortAlgorithm::BinaryKeys, n, bytes);
+	}
+	else
+	{
+		// Only identical strings compare equal, so an unstable sort gives the same result
+		comparisonSort(holder, [&compare](const Value& a, const Value& b) { return compare(b, a); });
+		recordSortChoice(options, SortAlgorithm::Comparison, n, 0);
+	}
+}
+
+//*****************
+// Template Function: sortLeaf
+// Purpose: Sorts a container whose elements are leaves, picking the fastest dedicated engine the element
+//          type, comparator and scratch budget allow and falling back to bubbleSort otherwise.
+//          Comparators that declare a projection (see has_projection) are sorted by cached keys.
+//          Comparators that declare a classifier (see has_classifier) are partitioned into classes first.
+// Parameters:
+//    - holder: A reference to a container of leaf elements that needs to be sorted.
+//    - compare: A comparator function or functor for custom sorting true bubbles up.
+//    - options: The requested SortEngine, the scratch budget and the report (see SortOptions).
+// Returns: void
+//*****************
+template <typename Container, typename Comparator>
+void sortLeaf(Container& holder, Comparator compare, const SortOptions& options)
+{
+	using Value = typename Container::value_type;
+	const std::size_t n = static_cast<std::size_t>(std::distance(holder.begin(), holder.end()));
+
+	if (options.engine == SortEngine::Bubble)
+	{
+		bubbleSort(holder, compare);
+		recordSortChoice(options, SortAlgorithm::Bubble, n, 0);
+	}
+	else if constexpr (has_projection<Comparator>::value)
+	{
+		sortProjectedLeaf(holder, typename Comparator::key_compare(), typename Comparator::projection(), options);
+	}
+	else if constexpr (has_classifier<Comparator>::value)
+	{
+		sortClassifiedLeaf(holder, compare, options);
+	}
+	else if constexpr (std::is_same<Value, std::string>::value && is_collated_order<Comparator>::value)
+	{
+		sortByBinaryKeys(holder, compare, options, [&holder] { collatedSort(holder, Comparator::collation, Comparator::isDescending); });
+	}
+	else if constexpr (std::is_same<Value, std::string>::value && is_natural_order<Comparator>::value)
+	{
+		sortByBinaryKeys(holder, compare, options, [&holder] { naturalSort(holder, Comparator::isCaseInsensitive, Comparator::isDescending); });
+	}
+	else if constexpr (is_string_like<Value>::value && (is_ascending_comparator<Comparator, Value>::value || is_descending_comparator<Comparator, Value>::value))
+	{
+		constexpr bool descending = is_descending_comparator<Comparator, Value>::value;
+		if constexpr (is_random_access_container<Container>::value)
+		{
+			stringSort(holder, descending);
+			recordSortChoice(options, SortAlgorithm::StringRadix, n, 0);
+		}
+		else if (options.fits(n * sizeof(Value)))
+		{
+			stringSort(holder, descending); // Sorts a moved copy in a vector
+			recordSortChoice(options, SortAlgorithm::StringRadix, n, n * sizeof(Value));
+		}
+		else
+		{
+			comparisonSort(holder, [](const Value& a, const Value& b) { return descending ? b < a : a < b; });
+			recordSortChoice(options, SortAlgorithm::Comparison, n, 0);
+		}
+	}
+	else if constexpr (is_radix_sortable<Value>::value && (is_ascending_comparator<Comparator, Value>::value || is_descending_comparator<Comparator, Value>::value))
+	{
+		if (n < kIntegerEngineThreshold)
+		{
+			bubbleSort(holder, compare);
+			recordSortChoice(options, SortAlgorithm::Bubble, n, 0);
+		}
+		else
+		{
+			integerSort(holder, is_descending_comparator<Comparator, Value>::value, options);
+		}
+	}
+	else
+	{
+		bubbleSort(holder, compare);
+		recordSortChoice(options, SortAlgorithm::Bubble, n, 0);
+	}
+}
+
+//*****************
+// Template Function: sortProjectedLeaf
+// Purpose: Sorts a container of leaf elements by projected keys. Apart from SortEngine::Bubble and small
+//          containers, which use bubbleSort with the projection, the keys are computed once: records keyed by
+//          a small integer member are sorted through key/index pairs (see recordSort), everything else with
+//          projectedSort. When neither fits the scratch budget the elements are sorted with stableInPlaceSort.
+// Parameters:
+//    - holder: A reference to a container of leaf elements that needs to be sorted.
+//    - compare: A comparator on the projected keys, true bubbles up.
+//    - project: The projection.
+//    - options: The requested SortEngine, the scratch budget and the report (see SortOptions).
+// Returns: void
+//*****************
+template <typename Container, typename Comparator, typename Projection>
+void sortProjectedLeaf(Container& holder, Comparator compare, Projection project, const SortOptions& options)
+{
+	using Value = typename Container::value_type;
+	if constexpr (std::is_same<Projection, Identity>::value)
+	{
+		sortLeaf(holder, compare, options);
+	}
+	else
+	{
+		const std::size_t n = static_cast<std::size_t>(std::distance(holder.begin(), holder.end()));
+		if (options.engine == SortEngine::Bubble || n < kIntegerEngineThreshold)
+		{
+			bubbleSort(holder, compare, project);
+			recordSortChoice(options, SortAlgorithm::Bubble, n, 0);
+			return;
+		}
+		if constexpr (is_record_key_projection<Value, Comparator, Projection>::value)
+		{
+			using Key = projected_key_t<Projection, Value>;
+			if (n <= std::numeric_limits<std::uint32_t>::max() && options.fits(recordSortScratchBytes<Container>(n)))
+			{
+				recordSort(holder, project, is_descending_comparator<Comparator, Key>::value);
+				recordSortChoice(options, SortAlgorithm::RecordPairs, n, recordSortScratchBytes<Container>(n));
+				return;
+			}
+		}
+		if (options.fits(projectedSortScratchBytes<Value, Projection>(n)))
+		{
+			projectedSort(holder, compare, project);
+			recordSortChoice(options, SortAlgorithm::ProjectedKeys, n, projectedSortScratchBytes<Value, Projection>(n));
+		}
+		else
+		{
+			stableInPlaceSort(holder, [&compare, &project](const Value& a, const Value& b)
+			{
+				return compare(std::invoke(project, b), std::invoke(project, a));
+			});
+			recordSortChoice(options, SortAlgorithm::Comparison, n, 0);
+		}
+	}
+}
+
+//*****************
+// Template Function: sortClassifiedLeaf
+// Purpose: Sorts a container of leaf elements with a comparator that declares a classifier and the order
+//          within a class. Apart from small containers, which use bubbleSort, the elements are stably
+//          partitioned into their classes with partitionClasses and every class is then sorted by sortLeaf
+//          with class_compare, so integers reach the radix engines. When the partition does not fit the
+//          scratch budget the elements are sorted with stableInPlaceSort.
+// Parameters:
+//    - holder: A reference to a container of leaf elements that needs to be sorted.
+//    - compare: The comparator, true bubbles up; its classifier puts class 0 first.
+//    - options: The requested SortEngine, the scratch budget and the report (see SortOptions).
+// Returns: void
+//*****************
+template <typename Container, typename Comparator>
+void sortClassifiedLeaf(Container& holder, Comparator compare, const SortOptions& options)
+{
+	using Value = typename Container::value_type;
+	using Classifier = typename Comparator::classifier;
+	static_assert(Classifier::classes <= kMaxPartitionClasses, "A classifier may have at most kMaxPartitionClasses classes");
+
+	const std::size_t n = static_cast<std::size_t>(std::distance(holder.begin(), holder.end()));
+	if (n < kIntegerEngineThreshold)
+	{
+		bubbleSort(holder, compare);
+		recordSortChoice(options, SortAlgorithm::Bubble, n, 0);
+		return;
+	}
+	const std::size_t copyBytes = is_contiguous_container<Container>::value ? 0 : n * sizeof(Value);
+	const std::size_t bytes = copyBytes + partitionScratchBytes<Value>(n);
+	if (!options.fits(bytes))
+	{
+		stableInPlaceSort(holder, [&compare](const Value& a, const Value& b) { return compare(b, a); });
+		recordSortChoice(options, SortAlgorithm::Comparison, n, 0);
+		return;
+	}
+
+	// The classes are sorted once the partition buffers are freed, within what is left of the budget, and
+	// reported as leaves of their own
+	const SortOptions classOptions(options.engine, options.scratchBudget - copyBytes, options.report);
+	withContiguousStorage(holder, [&](Value* data, std::size_t count)
+	{
+		std::size_t counts[Classifier::classes];
+		{
+			std::vector<Value> partitioned(count);
+			partitionClasses(data, partitioned.data(), count, Classifier::classes, Classifier(), counts);
+			std::move(partitioned.begin(), partitioned.end(), data);
+		}
+		std::size_t begin = 0;
+		for (std::size_t c = 0; c < Classifier::classes; ++c)
+		{
+			ContiguousRange<Value> range{ data + begin, counts[c] };
+			sortLeaf(range, typename Comparator::class_compare(), classOptions);
+			begin += counts[c];
+		}
+	});
+	recordSortChoice(options, SortAlgorithm::ClassPartition, n, bytes);
+}
+
+//*****************
+// Template Function: recursiveSort
+// Purpose: Recursively sorts a container and its nested containers (if any) using the provided comparator.
+//          Recursion stops at leaf types (see is_leaf), so a container of strings sorts the strings themselves.
+// Parameters:
+//    - container: A reference to a container that may contain nested containers to be sorted.
+//    - compare: A comparator function or functor for custom sorting (default: greater).
+//    - options: The engine used for leaf containers, or SortOptions adding a scratch budget and a report
+//               (default: SortEngine::Automatic with no budget).
+// Returns: void
+//*****************
+template <typename Container, typename Comparator = std::greater<typename Container::value_type>>
+void recursiveSort(Container& container, Comparator compare = Comparator(), const SortOptions& options = SortOptions())
+{
+	// If elements of the container are themselves containers, sort them recursively
+	if constexpr (is_nested_container<typename Container::value_type>::value) // If subContainer is a container
+	{
+		for (auto& subContainer : container)
+		{
+			recursiveSort(subContainer, compare, options); // Recursively sort nested containers
+		}
+	}
+	else // Base case: Sort if it's not a nested container
+	{
+		sortLeaf(container, compare, options);
+	}
+}
+
+//*****************
+// Template Function: recursiveSort
+// Purpose: Recursively sorts a container and its nested containers by projected keys, in the style of
+//          std::ranges::sort(range, compare, projection): leaf elements are ordered by compare(project(a), project(b)).
+//          Each key is computed once per sort, and integer keys compared with std::greater or std::less
+//          are ordered with counting or radix passes.
+// Parameters:
+//    - container: A reference to a container that may contain nested containers to be sorted.
+//    - compare: A comparator on the projected keys, true bubbles up (e.g. std::greater<int>() for ascending keys).
+//    - project: The projection (any callable, including pointers to members; Identity sorts the elements themselves).
+//    - options: The engine used for leaf containers, or SortOptions adding a scratch budget and a report
+//               (default: SortEngine::Automatic with no budget).
+// Returns: void
+//*****************
+template <typename Container, typename Comparator, typename Projection,
+	typename = std::enable_if_t<!std::is_same<Projection, SortEngine>::value && !std::is_same<Projection, SortOptions>::value>>
+void recursiveSort(Container& container, Comparator compare, Projection project, const SortOptions& options = SortOptions())
+{
+	if constexpr (is_nested_container<typename Container::value_type>::value)
+	{
+		for (auto& subContainer : container)
+		{
+			recursiveSort(subContainer, compare, project, options);
+		}
+	}
+	else
+	{
+		sortProjectedLeaf(container, compare, project, options);
+	}
+}
@@ -0,0 +1,120 @@
+//*****************
+// bubblesort/sort_engine.hpp
+// Engine selection, scratch budgets and instrumentation shared by recursiveSort and the engines.
+//*****************
+#pragma once
+
+#include <algorithm>  // for std::max
+#include <cstddef>
+#include <limits>
+
+//*****************
+// Enum: SortEngine
+// Purpose: Selects the engine recursiveSort uses for leaf containers. Engines other than Bubble only
+//          apply where the element type and comparator allow them (integers or strings sorted with
+//          std::greater or std::less); everything else is sorted with bubbleSort.
+//*****************
+enum class SortEngine
+{
+	Automatic,    // Fastest engine for the element type and comparator
+	Bubble,       // Always bubbleSort
+	Radix,        // Out-of-place LSD radix or counting sort (needs an n-sized scratch buffer)
+	InPlaceRadix  // In-place MSD radix (American flag sort), no n-sized scratch buffer
+};
+
+// Scratch budget meaning "no limit" (the default of SortOptions)
+constexpr std::size_t kUnlimitedScratch = std::numeric_limits<std::size_t>::max();
+
+//*****************
+// Enum: SortAlgorithm
+// Purpose: The algorithm that actually sorted a leaf container, as reported through SortReport.
+//*****************
+enum class SortAlgorithm
+{
+	Bubble,        // bubbleSort (also the fallback for comparators no engine understands)
+	SimdNetwork,   // sortInts SIMD kernel for small int containers
+	Counting,      // countingSort over a small value range
+	LsdRadix,      // Out-of-place LSD radix sort
+	AmericanFlag,  // In-place MSD radix sort
+	Comparison,    // In-place comparison sort (std::sort, or the member sort of lists) when scratch is short
+	StringRadix,   // Multikey string radix sort
+	ProjectedKeys, // Cached projected keys (projectedSort)
+	RecordPairs,   // Key/index pairs and one gather pass (recordSort)
+	BinaryKeys,    // Precomputed binary sort keys (collated and natural orders)
+	External,      // Sorted runs spilled to files and merged (externalSortFile)
+	ClassPartition // Stable partition into classes, then a sort per class (comparators declaring a classifier)
+};
+
+constexpr std::size_t kSortAlgorithmCount = static_cast<std::size_t>(SortAlgorithm::ClassPartition) + 1;
+
+//*****************
+// Function name: sortAlgorithmName
+// Purpose: Returns the short name of a SortAlgorithm used by reports and the benchmark.
+//*****************
+inline const char* sortAlgorithmName(SortAlgorithm algorithm) noexcept
+{
+	static const char* const names[kSortAlgorithmCount] = {
+		"bubble", "simd_network", "counting", "lsd_radix", "american_flag", "comparison",
+		"string_radix", "projected", "record_pairs", "binary_keys", "external", "class_partition" };
+	return names[static_cast<std::size_t>(algorithm)];
+}
+
+//*****************
+// Struct: SortReport
+// Purpose: Instrumentation filled in by a sort given a SortOptions::report: which algorithm sorted each
+//          leaf container and the largest heap scratch (in bytes) a single leaf sort asked for.
+//*****************
+struct SortReport
+{
+	std::size_t leaves = 0;                          // Leaf containers sorted
+	std::size_t elements = 0;                        // Elements in those leaves
+	std::size_t peakScratchBytes = 0;                // Largest scratch estimate of one leaf sort
+	std::size_t spilledRuns = 0;                     // Sorted runs written to files by externalSortFile
+	std::size_t spilledBytes = 0;                    // Bytes written to spill files by externalSortFile
+	std::size_t algorithmLeaves[kSortAlgorithmCount] = {}; // Leaves sorted by each SortAlgorithm
+	SortAlgorithm last = SortAlgorithm::Bubble;      // Algorithm of the most recent leaf
+};
+
+//*****************
+// Struct: SortOptions
+// Purpose: Parameters of a sort: the requested engine, a budget for the heap scratch memory the engines may
+//          allocate (0 means strictly in place), and an optional report receiving the choices made. Converts
+//          implicitly from a SortEngine, so existing calls passing an engine keep working.
+//          Within the budget the fastest fitting engine is chosen: out-of-place radix or counting sorts when
+//          their buffers fit, in-place MSD radix or comparison sorts otherwise. Fixed-size stack buffers and
+//          the per-comparison keys of CollatedOrder and NaturalOrder are not counted.
+//*****************
+struct SortOptions
+{
+	SortEngine engine = SortEngine::Automatic;
+	std::size_t scratchBudget = kUnlimitedScratch;
+	SortReport* report = nullptr;
+
+	SortOptions() = default;
+	SortOptions(SortEngine engine, std::size_t scratchBudget = kUnlimitedScratch, SortReport* report = nullptr) noexcept
+		: engine(engine), scratchBudget(scratchBudget), report(report) {}
+
+	// Whether a sort needing the given scratch bytes fits the budget
+	bool fits(std::size_t bytes) const noexcept { return bytes <= scratchBudget; }
+};
+
+//*****************
+// Function name: recordSortChoice
+// Purpose: Records the algorithm that sorted a leaf container in the options' report, if any.
+// Parameters:
+//    - options: The SortOptions of the sort.
+//    - algorithm: The SortAlgorithm used.
+//    - n: Number of elements sorted.
+//    - scratchBytes: The heap scratch the algorithm was estimated to need.
+// Returns: void
+//*****************
+inline void recordSortChoice(const SortOptions& options, SortAlgorithm algorithm, std::size_t n, std::size_t scratchBytes) noexcept
+{
+	if (!options.report) return;
+	SortReport& report = *options.report;
+	++report.leaves;
+	report.elements += n;
+	report.peakScratchBytes = std::max(report.peakScratchBytes, scratchBytes);
+	++report.algorithmLeaves[static_cast<std::size_t>(algorithm)];
+	report.last = algorithm;
+}
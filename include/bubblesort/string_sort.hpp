@@ -0,0 +1,131 @@
+//*****************
+// bubblesort/string_sort.hpp
+// Multikey radix quicksort engine for strings and string views.
+//*****************
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>  // for std::reverse and std::move
+#include <cstddef>
+#include <iterator>
+#include <utility>    // for std::swap
+
+#include "traits.hpp"
+
+//*****************
+// Function name: stringCharAt
+// Purpose: Returns the character of a string at the given depth as an unsigned value,
+//          or -1 once the string has ended (shorter strings sort first).
+//*****************
+template <typename String>
+int stringCharAt(const String& str, std::size_t depth) noexcept
+{
+	return depth < str.size() ? static_cast<int>(static_cast<unsigned char>(str[depth])) : -1;
+}
+
+// Ranges at or below this size are finished with insertion sort by multikeyRadixSort
+constexpr std::ptrdiff_t kStringInsertionThreshold = 16;
+
+//*****************
+// Template Function: multikeyRadixSort
+// Purpose: Sorts a range of string-like elements in ascending byte order using multikey (three-way radix)
+//          quicksort. Each character is examined once per partition level instead of once per comparison,
+//          and only the elements are swapped, so no characters are copied.
+// Parameters:
+//    - first, last: Random access iterators delimiting the elements to be sorted.
+//    - depth: Number of leading characters all elements in the range are known to share.
+//    - charAt: A callable charAt(element, depth) returning the character at depth as an unsigned value,
+//              or -1 once the element has ended (see stringCharAt).
+//    - compareFrom: A callable compareFrom(a, b, depth) comparing two elements from depth on, returning
+//                   a negative, zero or positive value like std::string::compare.
+// Returns: void
+//*****************
+template <typename RandomIt, typename CharAt, typename CompareFrom>
+void multikeyRadixSort(RandomIt first, RandomIt last, std::size_t depth, CharAt charAt, CompareFrom compareFrom)
+{
+	while (last - first > kStringInsertionThreshold)
+	{
+		// Median of three characters as the partition pivot
+		int a = charAt(*first, depth);
+		int b = charAt(first[(last - first) / 2], depth);
+		int c = charAt(*(last - 1), depth);
+		if (a > b) std::swap(a, b);
+		if (b > c) std::swap(b, c);
+		if (a > b) std::swap(a, b);
+		const int pivot = b;
+
+		// Three-way partition on the character at depth: [first, lt) < pivot, [lt, gt) == pivot, [gt, last) > pivot
+		RandomIt lt = first, it = first, gt = last;
+		while (it < gt)
+		{
+			const int ch = charAt(*it, depth);
+			if (ch < pivot) std::swap(*lt++, *it++);
+			else if (ch > pivot) std::swap(*it, *--gt);
+			else ++it;
+		}
+
+		multikeyRadixSort(first, lt, depth, charAt, compareFrom);
+		multikeyRadixSort(gt, last, depth, charAt, compareFrom);
+
+		if (pivot < 0) return; // Every element in the middle ended here, so they are all equal
+
+		// Continue with the next character of the middle partition without recursing
+		first = lt;
+		last = gt;
+		++depth;
+	}
+
+	// Insertion sort for small ranges, comparing only past the shared prefix
+	for (RandomIt i = first; i != last; ++i)
+	{
+		for (RandomIt j = i; j != first && compareFrom(*(j - 1), *j, depth) > 0; --j)
+		{
+			std::swap(*(j - 1), *j);
+		}
+	}
+}
+
+//*****************
+// Template Function: stringRadixSort
+// Purpose: Sorts a range of strings (std::string or std::string_view) in ascending byte order with multikeyRadixSort.
+// Parameters:
+//    - first, last: Random access iterators delimiting the strings to be sorted.
+//    - depth: Number of leading characters all strings in the range are known to share (default: 0).
+// Returns: void
+//*****************
+template <typename RandomIt>
+void stringRadixSort(RandomIt first, RandomIt last, std::size_t depth = 0)
+{
+	using String = typename std::iterator_traits<RandomIt>::value_type;
+	multikeyRadixSort(first, last, depth,
+		[](const String& str, std::size_t at) { return stringCharAt(str, at); },
+		[](const String& a, const String& b, std::size_t at) { return a.compare(at, String::npos, b, at, String::npos); });
+}
+
+//*****************
+// Template Function: stringSort
+// Purpose: Sorts a container of strings with stringRadixSort. Containers without random access
+//          (e.g. std::list) are moved into a temporary vector, sorted and moved back.
+// Parameters:
+//    - holder: A reference to a container of strings that needs to be sorted.
+//    - descending: Sorts in descending order when true (default: false).
+// Returns: void
+//*****************
+template <typename Container>
+void stringSort(Container& holder, bool descending = false)
+{
+	if constexpr (is_random_access_container<Container>::value)
+	{
+		stringRadixSort(holder.begin(), holder.end());
+		// Equal strings are indistinguishable, so reversing keeps the result identical to a stable sort
+		if (descending) std::reverse(holder.begin(), holder.end());
+	}
+	else
+	{
+		std::vector<typename Container::value_type> scratch(std::make_move_iterator(holder.begin()), std::make_move_iterator(holder.end()));
+		stringSort(scratch, descending);
+		std::move(scratch.begin(), scratch.end(), holder.begin());
+	}
+}
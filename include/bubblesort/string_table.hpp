@@ -0,0 +1,250 @@
+//*****************
+// bubblesort/string_table.hpp
+// Arena-backed string table whose sorts permute compact records instead of heap-owning strings.
+//*****************
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>  // for std::reverse and std::min
+#include <cstddef>
+#include <cstdint>
+#include <functional> // for std::greater
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <stdexcept>  // for std::length_error
+#include <utility>    // for std::swap
+
+#include "string_sort.hpp"
+
+//*****************
+// Struct: StringRecord
+// Purpose: One string of a StringTable: its position in the character arena and its first eight bytes packed
+//          big-endian (zero padded), so comparing prefixes as integers compares the strings' first eight bytes.
+//*****************
+struct StringRecord
+{
+	std::uint64_t prefix;
+	std::uint32_t offset;
+	std::uint32_t length;
+};
+
+//*****************
+// Class: StringTable
+// Purpose: A sequence of strings stored in one contiguous character arena and addressed through 16-byte
+//          StringRecords. Elements are read as std::string_view; sorting permutes the records only, and the
+//          inline prefix lets the first eight levels of the string engine run without touching the arena.
+//          The arena holds at most 4 GiB of characters.
+//*****************
+class StringTable
+{
+public:
+	using value_type = std::string_view;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+
+	//*****************
+	// Class: const_iterator
+	// Purpose: Random access iterator yielding the strings of the table as std::string_view values.
+	//*****************
+	class const_iterator
+	{
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::string_view;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = std::string_view;
+
+		const_iterator() = default;
+		const_iterator(const StringTable* table, std::size_t index) noexcept : table_(table), index_(index) {}
+
+		std::string_view operator*() const noexcept { return (*table_)[index_]; }
+		std::string_view operator[](difference_type offset) const noexcept { return (*table_)[index_ + offset]; }
+		const_iterator& operator++() noexcept { ++index_; return *this; }
+		const_iterator operator++(int) noexcept { const_iterator old = *this; ++index_; return old; }
+		const_iterator& operator--() noexcept { --index_; return *this; }
+		const_iterator operator--(int) noexcept { const_iterator old = *this; --index_; return old; }
+		const_iterator& operator+=(difference_type offset) noexcept { index_ += offset; return *this; }
+		const_iterator& operator-=(difference_type offset) noexcept { index_ -= offset; return *this; }
+		const_iterator operator+(difference_type offset) const noexcept { return const_iterator(table_, index_ + offset); }
+		const_iterator operator-(difference_type offset) const noexcept { return const_iterator(table_, index_ - offset); }
+		difference_type operator-(const const_iterator& other) const noexcept { return static_cast<difference_type>(index_ - other.index_); }
+		bool operator==(const const_iterator& other) const noexcept { return index_ == other.index_; }
+		bool operator!=(const const_iterator& other) const noexcept { return index_ != other.index_; }
+		bool operator<(const const_iterator& other) const noexcept { return index_ < other.index_; }
+
+	private:
+		const StringTable* table_ = nullptr;
+		std::size_t index_ = 0;
+	};
+	using iterator = const_iterator;
+
+	StringTable() = default;
+
+	template <typename InputIt>
+	StringTable(InputIt first, InputIt last)
+	{
+		for (; first != last; ++first) push_back(*first);
+	}
+
+	StringTable(std::initializer_list<std::string_view> strings) : StringTable(strings.begin(), strings.end()) {}
+
+	//*****************
+	// Function name: reserve
+	// Purpose: Reserves room for a number of strings and characters.
+	//*****************
+	void reserve(std::size_t strings, std::size_t characters)
+	{
+		records_.reserve(strings);
+		arena_.reserve(characters);
+	}
+
+	//*****************
+	// Function name: push_back
+	// Purpose: Appends a copy of a string to the arena and a record for it.
+	//*****************
+	void push_back(std::string_view str)
+	{
+		if (arena_.size() + str.size() > std::numeric_limits<std::uint32_t>::max()) throw std::length_error("StringTable arena exceeds 4 GiB");
+		records_.push_back({ packPrefix(str), static_cast<std::uint32_t>(arena_.size()), static_cast<std::uint32_t>(str.size()) });
+		arena_.append(str.data(), str.size());
+	}
+
+	void clear() noexcept
+	{
+		records_.clear();
+		arena_.clear();
+	}
+
+	std::string_view operator[](std::size_t index) const noexcept { return view(records_[index]); }
+	std::size_t size() const noexcept { return records_.size(); }
+	bool empty() const noexcept { return records_.empty(); }
+	const_iterator begin() const noexcept { return const_iterator(this, 0); }
+	const_iterator end() const noexcept { return const_iterator(this, records_.size()); }
+
+	// The records in table order; sorts permute them directly
+	std::vector<StringRecord>& records() noexcept { return records_; }
+	const std::vector<StringRecord>& records() const noexcept { return records_; }
+
+	//*****************
+	// Function name: view
+	// Purpose: Returns the string a record of this table refers to.
+	//*****************
+	std::string_view view(const StringRecord& record) const noexcept
+	{
+		return std::string_view(arena_.data() + record.offset, record.length);
+	}
+
+	//*****************
+	// Function name: charAt
+	// Purpose: Returns the character of a record's string at the given depth as an unsigned value, or -1 once
+	//          the string has ended (see stringCharAt). The first eight characters come from the inline prefix.
+	//*****************
+	int charAt(const StringRecord& record, std::size_t depth) const noexcept
+	{
+		if (depth >= record.length) return -1;
+		if (depth < sizeof(record.prefix)) return static_cast<int>((record.prefix >> (56 - 8 * depth)) & 0xFF);
+		return static_cast<int>(static_cast<unsigned char>(arena_[record.offset + depth]));
+	}
+
+	//*****************
+	// Function name: packPrefix
+	// Purpose: Packs the first eight bytes of a string big-endian into an integer, padding with zeros.
+	//*****************
+	static std::uint64_t packPrefix(std::string_view str) noexcept
+	{
+		std::uint64_t prefix = 0;
+		const std::size_t count = std::min<std::size_t>(str.size(), sizeof(prefix));
+		for (std::size_t i = 0; i < sizeof(prefix); ++i)
+		{
+			prefix = (prefix << 8) | (i < count ? static_cast<unsigned char>(str[i]) : 0u);
+		}
+		return prefix;
+	}
+
+private:
+	std::vector<StringRecord> records_;
+	std::string arena_;
+};
+
+//*****************
+// Function name: stringSort
+// Purpose: Sorts a StringTable with multikeyRadixSort over its records. The first eight levels read the
+//          inline prefixes, and no characters are moved.
+// Parameters:
+//    - table: A reference to the StringTable that needs to be sorted.
+//    - descending: Sorts in descending order when true (default: false).
+// Returns: void
+//*****************
+inline void stringSort(StringTable& table, bool descending = false)
+{
+	std::vector<StringRecord>& records = table.records();
+	multikeyRadixSort(records.begin(), records.end(), 0,
+		[&table](const StringRecord& record, std::size_t depth) { return table.charAt(record, depth); },
+		[&table](const StringRecord& a, const StringRecord& b, std::size_t depth)
+		{
+			return table.view(a).compare(std::min<std::size_t>(depth, a.length), std::string_view::npos,
+				table.view(b), std::min<std::size_t>(depth, b.length), std::string_view::npos);
+		});
+	// Equal strings are indistinguishable, so reversing keeps the result identical to a stable sort
+	if (descending) std::reverse(records.begin(), records.end());
+}
+
+//*****************
+// Template Function: bubbleSort
+// Purpose: Performs a Bubble Sort on a StringTable, swapping records. compare receives std::string_views.
+// Parameters:
+//    - table: A reference to the StringTable that needs to be sorted.
+//    - compare: A comparator function or functor for custom sorting true bubbles up (default: greater).
+// Returns: void
+//*****************
+template <typename Comparator = std::greater<std::string_view>>
+void bubbleSort(StringTable& table, Comparator compare = Comparator()) noexcept
+{
+	std::vector<StringRecord>& records = table.records();
+	const std::size_t n = records.size();
+	for (std::size_t i = 0; n > 1 && i < n - 1; ++i)
+	{
+		bool swapped = false;
+		for (std::size_t j = 0; j < n - i - 1; ++j)
+		{
+			if (compare(table.view(records[j]), table.view(records[j + 1])))
+			{
+				std::swap(records[j], records[j + 1]);
+				swapped = true;
+			}
+		}
+		if (!swapped) break;
+	}
+}
+
+//*****************
+// Template Function: stableInPlaceSort
+// Purpose: Sorts the records of a StringTable stably without heap scratch (see stableInPlaceSort in
+//          traits.hpp). lessThan receives std::string_views.
+//*****************
+template <typename LessThan>
+void stableInPlaceSort(StringTable& table, LessThan lessThan)
+{
+	std::vector<StringRecord>& records = table.records();
+	stableInPlaceSort(records, [&table, &lessThan](const StringRecord& a, const StringRecord& b)
+	{
+		return lessThan(table.view(a), table.view(b));
+	});
+}
+
+//*****************
+// Function name: applyOrder
+// Purpose: Moves the records of a StringTable into the given order (see applyOrder in projection.hpp).
+//*****************
+inline void applyOrder(StringTable& table, const std::vector<std::size_t>& order)
+{
+	std::vector<StringRecord>& records = table.records();
+	std::vector<StringRecord> permuted;
+	permuted.reserve(records.size());
+	for (std::size_t index : order) permuted.push_back(records[index]);
+	records.swap(permuted);
+}
@@ -0,0 +1,355 @@
+//*****************
+// bubblesort/traits.hpp
+// Type traits telling containers, leaf types and standard comparators apart, and in-place container helpers.
+//*****************
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <iterator>   // for std::distance, std::iterator_traits and std::make_move_iterator
+#include <functional> // for std::greater and std::less
+#include <algorithm>  // for std::copy, std::move, std::sort, std::rotate and std::upper_bound
+#include <utility>    // for std::declval
+#include <type_traits> // for std::enable_if and std::is_same C++ 17
+
+// Helper type trait to detect if a type is a container
+template<typename T, typename _ = void>
+struct is_container : std::false_type {};
+
+// This helper struct checks for the presence of typical container types and iterators
+template<typename... Ts>
+struct is_container_helper {};
+
+// Specialization for containers that have value_type, iterators, and a size method
+template<typename T>
+struct is_container<T, std::conditional_t<false, is_container_helper<
+	typename T::value_type,
+	typename T::iterator,
+	typename T::const_iterator,
+	decltype(std::declval<T>().size())
+>, void>> : std::true_type {};
+
+// Helper type trait to mark types that recursiveSort and printNDVector treat as single values.
+// std::string and std::string_view satisfy is_container, but sorting them means ordering whole strings, not their characters.
+// Specialize is_leaf for your own container-like types to stop recursion at them:
+//    template<> struct is_leaf<MyType> : std::true_type {};
+template<typename T>
+struct is_leaf : std::false_type {};
+
+template<typename CharT, typename Traits, typename Alloc>
+struct is_leaf<std::basic_string<CharT, Traits, Alloc>> : std::true_type {};
+
+template<typename CharT, typename Traits>
+struct is_leaf<std::basic_string_view<CharT, Traits>> : std::true_type {};
+
+// Helper type trait for the element types the string engines sort: std::string and std::string_view
+template<typename T>
+struct is_string_like : std::bool_constant<std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value> {};
+
+// A nested container is a container that recursion descends into (i.e. not a leaf)
+template<typename T>
+struct is_nested_container : std::bool_constant<is_container<T>::value && !is_leaf<T>::value> {};
+
+// Helper type traits to recognise the standard comparators that describe plain ascending or descending order.
+// bubbleSort swaps when compare(a, b) is true, so std::greater yields ascending order and std::less descending.
+template<typename Comparator, typename T>
+struct is_ascending_comparator : std::bool_constant<
+	std::is_same<Comparator, std::greater<T>>::value || std::is_same<Comparator, std::greater<>>::value> {};
+
+template<typename Comparator, typename T>
+struct is_descending_comparator : std::bool_constant<
+	std::is_same<Comparator, std::less<T>>::value || std::is_same<Comparator, std::less<>>::value> {};
+
+// Helper type trait to detect comparators that declare themselves a projection composed with a key
+// comparator (member types projection and key_compare, see SumOfDigits)
+template<typename Comparator, typename _ = void>
+struct has_projection : std::false_type {};
+
+template<typename Comparator>
+struct has_projection<Comparator, std::void_t<typename Comparator::projection, typename Comparator::key_compare>> : std::true_type {};
+
+// Helper type trait to detect comparators that declare themselves a partition into classes followed by an
+// order within each class (member types classifier and class_compare, see OddFirst)
+template<typename Comparator, typename _ = void>
+struct has_classifier : std::false_type {};
+
+template<typename Comparator>
+struct has_classifier<Comparator, std::void_t<typename Comparator::classifier, typename Comparator::class_compare>> : std::true_type {};
+
+// Helper type traits for the nesting of a container: nesting_depth counts the container levels above the
+// leaf elements (0 for a leaf, 1 for std::vector<int>), innermost_value_t names the leaf element type and
+// leaf_container_t the innermost container type, the one holding the leaf elements
+template<typename T, typename _ = void>
+struct nesting_depth : std::integral_constant<std::size_t, 0> {};
+
+template<typename T>
+struct nesting_depth<T, std::enable_if_t<is_nested_container<T>::value>>
+	: std::integral_constant<std::size_t, 1 + nesting_depth<typename T::value_type>::value> {};
+
+template<typename T, typename _ = void>
+struct innermost_value { using type = T; };
+
+template<typename T>
+struct innermost_value<T, std::enable_if_t<is_nested_container<T>::value>> : innermost_value<typename T::value_type> {};
+
+template<typename T>
+using innermost_value_t = typename innermost_value<T>::type;
+
+template<typename T, typename _ = void>
+struct leaf_container { using type = T; };
+
+template<typename T>
+struct leaf_container<T, std::enable_if_t<is_nested_container<typename T::value_type>::value>> : leaf_container<typename T::value_type> {};
+
+template<typename T>
+using leaf_container_t = typename leaf_container<T>::type;
+
+// Helper type trait to detect containers with random access iterators
+template<typename Container>
+struct is_random_access_container : std::is_base_of<std::random_access_iterator_tag,
+	typename std::iterator_traits<typename Container::iterator>::iterator_category> {};
+
+// Helper type trait to detect containers storing their elements contiguously (data() returns a pointer)
+template<typename Container, typename _ = void>
+struct is_contiguous_container : std::false_type {};
+
+template<typename Container>
+struct is_contiguous_container<Container, std::enable_if_t<std::is_same<
+	decltype(std::declval<Container&>().data()), typename Container::value_type*>::value>> : std::true_type {};
+
+// Helper type trait to detect containers with a member sort taking a comparator (std::list, std::forward_list)
+template<typename Container, typename Compare, typename _ = void>
+struct has_member_sort : std::false_type {};
+
+template<typename Container, typename Compare>
+struct has_member_sort<Container, Compare, std::void_t<decltype(std::declval<Container&>().sort(std::declval<Compare>()))>> : std::true_type {};
+
+// Helper type traits to detect containers that can be resized and assigned a range (std::vector, std::list
+// and std::deque, unlike std::array)
+template<typename Container, typename _ = void>
+struct has_resize : std::false_type {};
+
+template<typename Container>
+struct has_resize<Container, std::void_t<decltype(std::declval<Container&>().resize(std::size_t()))>> : std::true_type {};
+
+template<typename Container, typename _ = void>
+struct has_range_assign : std::false_type {};
+
+template<typename Container>
+struct has_range_assign<Container, std::void_t<decltype(std::declval<Container&>().assign(
+	std::declval<const typename Container::value_type*>(), std::declval<const typename Container::value_type*>()))>> : std::true_type {};
+
+//*****************
+// Struct: ContiguousRange
+// Purpose: A container view of count elements starting at first, so the leaf engines can sort part of an
+//          array in place (as sortLeaf does for every class of a partitioned leaf).
+//*****************
+template <typename T>
+struct ContiguousRange
+{
+	using value_type = T;
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	T* first = nullptr;
+	std::size_t count = 0;
+
+	T* begin() const noexcept { return first; }
+	T* end() const noexcept { return first + count; }
+	T* data() const noexcept { return first; }
+	std::size_t size() const noexcept { return count; }
+};
+
+//*****************
+// Template Function: assignRange
+// Purpose: Replaces the elements of a container with those of [first, last). Containers of fixed size
+//          (std::array) are only overwritten when the sizes match.
+// Parameters:
+//    - holder: A reference to the container.
+//    - first, last: The elements to copy.
+// Returns: false if the container has a fixed size that differs from the range's.
+//*****************
+template <typename Container, typename InputIt>
+bool assignRange(Container& holder, InputIt first, InputIt last)
+{
+	if constexpr (has_range_assign<Container>::value)
+	{
+		holder.assign(first, last);
+		return true;
+	}
+	else
+	{
+		if (static_cast<std::size_t>(std::distance(first, last)) != static_cast<std::size_t>(holder.size())) return false;
+		std::copy(first, last, holder.begin());
+		return true;
+	}
+}
+
+//*****************
+// Template Function: resizeContainer
+// Purpose: Resizes a container, or checks the size of one with a fixed size (std::array).
+// Returns: false if the container has a fixed size other than size.
+//*****************
+template <typename Container>
+bool resizeContainer(Container& holder, std::size_t size)
+{
+	if constexpr (has_resize<Container>::value)
+	{
+		holder.resize(size);
+		return true;
+	}
+	else
+	{
+		return static_cast<std::size_t>(holder.size()) == size;
+	}
+}
+
+//*****************
+// Template Function: forEachLeafContainer
+// Purpose: Calls fn on every container whose elements are leaves, in order.
+//*****************
+template <typename Container, typename Fn>
+void forEachLeafContainer(Container& holder, Fn& fn)
+{
+	if constexpr (is_nested_container<typename Container::value_type>::value)
+	{
+		for (auto& subHolder : holder) forEachLeafContainer(subHolder, fn);
+	}
+	else
+	{
+		fn(holder);
+	}
+}
+
+//*****************
+// Template Function: withContiguousStorage
+// Purpose: Calls fn(pointer, size) on the elements of a container. Containers that are not contiguous
+//          (e.g. std::list, std::deque) are moved into a temporary vector and moved back afterwards.
+// Parameters:
+//    - holder: A reference to the container.
+//    - fn: A callable taking a pointer to the elements and their count.
+// Returns: void
+//*****************
+template <typename Container, typename Fn>
+void withContiguousStorage(Container& holder, Fn fn)
+{
+	if constexpr (is_contiguous_container<Container>::value)
+	{
+		fn(holder.data(), static_cast<std::size_t>(holder.size()));
+	}
+	else
+	{
+		std::vector<typename Container::value_type> scratch(std::make_move_iterator(holder.begin()), std::make_move_iterator(holder.end()));
+		fn(scratch.data(), scratch.size());
+		std::move(scratch.begin(), scratch.end(), holder.begin());
+	}
+}
+
+//*****************
+// Template Function: comparisonSort
+// Purpose: Sorts a container in place without heap scratch proportional to its size: std::sort for random
+//          access containers, the member sort of lists, and selection sort for anything else. Not stable, so
+//          it is only used where equal elements are interchangeable.
+// Parameters:
+//    - holder: A reference to the container.
+//    - lessThan: A strict weak ordering, true when the first element belongs before the second.
+// Returns: void
+//*****************
+template <typename Container, typename LessThan>
+void comparisonSort(Container& holder, LessThan lessThan)
+{
+	if constexpr (is_random_access_container<Container>::value)
+	{
+		std::sort(holder.begin(), holder.end(), lessThan);
+	}
+	else if constexpr (has_member_sort<Container, LessThan>::value)
+	{
+		holder.sort(lessThan);
+	}
+	else
+	{
+		for (auto it = holder.begin(); it != holder.end(); ++it) std::iter_swap(it, std::min_element(it, holder.end(), lessThan));
+	}
+}
+
+// Runs of this many elements are insertion sorted before stableInPlaceSort starts merging
+constexpr std::size_t kStableInPlaceRun = 16;
+
+//*****************
+// Template Function: mergeInPlace
+// Purpose: Stably merges the sorted ranges [first, middle) and [middle, last) without a buffer, splitting
+//          the larger range in half, rotating the matching part of the other one past it and recursing.
+// Parameters:
+//    - first, middle, last: The two adjacent sorted ranges.
+//    - lessThan: A strict weak ordering, true when the first element belongs before the second.
+// Returns: void
+//*****************
+template <typename RandomIt, typename LessThan>
+void mergeInPlace(RandomIt first, RandomIt middle, RandomIt last, LessThan lessThan)
+{
+	const auto leftLength = middle - first;
+	const auto rightLength = last - middle;
+	if (leftLength == 0 || rightLength == 0) return;
+	if (leftLength + rightLength == 2)
+	{
+		if (lessThan(*middle, *first)) std::iter_swap(first, middle);
+		return;
+	}
+
+	RandomIt leftCut, rightCut;
+	if (leftLength > rightLength)
+	{
+		leftCut = first + leftLength / 2;
+		rightCut = std::lower_bound(middle, last, *leftCut, lessThan);
+	}
+	else
+	{
+		rightCut = middle + rightLength / 2;
+		leftCut = std::upper_bound(first, middle, *rightCut, lessThan);
+	}
+	const RandomIt newMiddle = std::rotate(leftCut, middle, rightCut);
+	mergeInPlace(first, leftCut, newMiddle, lessThan);
+	mergeInPlace(newMiddle, rightCut, last, lessThan);
+}
+
+//*****************
+// Template Function: stableInPlaceSort
+// Purpose: Sorts a container stably without heap scratch: random access containers insertion sort short
+//          runs and merge them pairwise with mergeInPlace (O(n log^2 n)), lists use their member sort and
+//          anything else is insertion sorted by rotations.
+// Parameters:
+//    - holder: A reference to the container.
+//    - lessThan: A strict weak ordering, true when the first element belongs before the second.
+// Returns: void
+//*****************
+template <typename Container, typename LessThan>
+void stableInPlaceSort(Container& holder, LessThan lessThan)
+{
+	if constexpr (is_random_access_container<Container>::value)
+	{
+		const auto first = holder.begin();
+		const std::size_t n = static_cast<std::size_t>(holder.end() - first);
+		for (std::size_t begin = 0; begin < n; begin += kStableInPlaceRun)
+		{
+			const auto runEnd = first + std::min(n, begin + kStableInPlaceRun);
+			for (auto it = first + begin; it != runEnd; ++it) std::rotate(std::upper_bound(first + begin, it, *it, lessThan), it, std::next(it));
+		}
+		for (std::size_t width = kStableInPlaceRun; width < n; width *= 2)
+		{
+			for (std::size_t begin = 0; begin + width < n; begin += 2 * width)
+			{
+				mergeInPlace(first + begin, first + begin + width, first + std::min(n, begin + 2 * width), lessThan);
+			}
+		}
+	}
+	else if constexpr (has_member_sort<Container, LessThan>::value)
+	{
+		holder.sort(lessThan);
+	}
+	else
+	{
+		for (auto it = holder.begin(); it != holder.end(); ++it) std::rotate(std::upper_bound(holder.begin(), it, *it, lessThan), it, std::next(it));
+	}
+}
@@ -0,0 +1,91 @@
+//*****************
+// tests/american_flag_tests.cpp
+// The in-place MSD radix engine: americanFlagSort and recursiveSort with SortEngine::InPlaceRadix checked
+// against std::sort on inputs that exercise its bucket permutation, skipped bytes and recursion.
+//*****************
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Template Function: checkAmericanFlag
+// Purpose: Sorts copies of values with americanFlagSort, strictly in place and with LSD buckets, and compares
+//          them with std::sort.
+//*****************
+template <typename T>
+static void checkAmericanFlag(const std::vector<T>& values, const std::string& name)
+{
+	std::vector<T> expected(values);
+	std::sort(expected.begin(), expected.end());
+	for (std::size_t lsdThreshold : { std::size_t(0), kAmericanFlagLsdThreshold })
+	{
+		std::vector<T> result(values);
+		americanFlagSort(result.data(), result.size(), sizeof(T) * 8 - 8, lsdThreshold);
+		check(result == expected, "americanFlagSort of " + name + (lsdThreshold ? "" : " in place"));
+	}
+}
+
+//*****************
+// Function name: testAmericanFlagSort
+// Purpose: Checks americanFlagSort on uniform, skewed, presorted and equal values and on values sharing
+//          their high bytes, for several integer widths.
+//*****************
+BUBBLESORT_TEST(american_flag, testAmericanFlagSort)
+{
+	const Distribution distributions[] = { Distribution::Uniform, Distribution::Zipf, Distribution::Sorted,
+		Distribution::Reverse, Distribution::SortedRuns, Distribution::OrganPipe, Distribution::AllEqual };
+	for (Distribution distribution : distributions)
+	{
+		GeneratorOptions options;
+		options.distribution = distribution;
+		options.low = -2000000000.0;
+		options.high = 2000000000.0;
+		checkAmericanFlag(generateData<int>(200000, options), "ints, distribution " + std::to_string(static_cast<int>(distribution)));
+	}
+	checkAmericanFlag(randomInts(100000, 1000000, 1000255, 50), "ints sharing their high bytes");
+	checkAmericanFlag(randomInts(33, -5, 5, 51), "a few ints just above the insertion threshold");
+
+	GeneratorOptions wide;
+	wide.low = -9e18;
+	wide.high = 9e18;
+	checkAmericanFlag(generateData<std::int64_t>(100000, wide), "64-bit ints");
+	GeneratorOptions narrow;
+	narrow.high = 65535;
+	checkAmericanFlag(generateData<std::uint16_t>(100000, narrow), "16-bit unsigned ints");
+}
+
+//*****************
+// Function name: testInPlaceRadixEngine
+// Purpose: Sorts vectors, deques and lists with SortEngine::InPlaceRadix in both orders, checks them against
+//          std::sort and checks that the report names the American flag sort.
+//*****************
+BUBBLESORT_TEST(american_flag, testInPlaceRadixEngine)
+{
+	const std::vector<int> values = randomInts(100000, -2000000000.0, 2000000000.0, 52);
+	std::vector<int> expected(values);
+	std::sort(expected.begin(), expected.end());
+
+	SortReport report;
+	std::vector<int> vec(values);
+	recursiveSort(vec, std::greater<int>(), SortOptions(SortEngine::InPlaceRadix, kUnlimitedScratch, &report));
+	check(vec == expected && report.last == SortAlgorithm::AmericanFlag, "InPlaceRadix vector, ascending");
+
+	std::deque<int> deq(values.begin(), values.end());
+	recursiveSort(deq, std::less<int>(), SortEngine::InPlaceRadix);
+	check(std::equal(deq.rbegin(), deq.rend(), expected.begin(), expected.end()), "InPlaceRadix deque, descending");
+
+	std::list<int> lst(values.begin(), values.end());
+	recursiveSort(lst, std::greater<int>(), SortEngine::InPlaceRadix);
+	check(std::equal(lst.begin(), lst.end(), expected.begin(), expected.end()), "InPlaceRadix list, ascending");
+
+	std::vector<std::vector<int>> nested = { randomInts(5000, -10, 10, 53), randomInts(70000, 0, 4e9 / 2, 54) };
+	std::vector<std::vector<int>> expectedNested(nested);
+	for (std::vector<int>& row : expectedNested) std::sort(row.begin(), row.end());
+	recursiveSort(nested, std::greater<int>(), SortEngine::InPlaceRadix);
+	check(nested == expectedNested, "InPlaceRadix nested vectors");
+}
@@ -0,0 +1,82 @@
+//*****************
+// tests/bench_regression_tests.cpp
+// The benchmark history: sample statistics against values worked out by hand, the CSV round trip keeping the
+// last run, and the verdicts of the baseline comparison.
+//*****************
+#include <cmath>
+#include <cstdio>     // for std::remove
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+#include "../bench/bench_regression.hpp"
+
+// A summary of one case with the given mean and standard deviation over ten repetitions
+static BenchSummary benchCase(const std::string& engine, double meanMs, double stddevMs)
+{
+	BenchSummary summary;
+	summary.engine = engine;
+	summary.container = "vector";
+	summary.distribution = "uniform";
+	summary.n = 1000;
+	summary.repetitions = 10;
+	summary.meanMs = meanMs;
+	summary.stddevMs = stddevMs;
+	summary.minMs = meanMs - stddevMs;
+	summary.ciLowMs = meanMs - stddevMs;
+	summary.ciHighMs = meanMs + stddevMs;
+	return summary;
+}
+
+//*****************
+// Function name: testSummarizeSamples
+// Purpose: Compares summarizeSamples with the mean, sample standard deviation, minimum and t-interval of a
+//          small sample worked out by hand.
+//*****************
+BUBBLESORT_TEST(bench_regression, testSummarizeSamples)
+{
+	BenchSummary summary;
+	summarizeSamples({ 2, 4, 4, 4, 5, 5, 7, 9 }, summary);
+	const double stddev = std::sqrt(32.0 / 7.0);
+	const double margin = 2.365 * stddev / std::sqrt(8.0);
+	check(summary.repetitions == 8 && summary.meanMs == 5 && std::abs(summary.stddevMs - stddev) < 1e-12 && summary.minMs == 2,
+		"summarizeSamples mean, standard deviation and minimum");
+	check(std::abs(summary.ciLowMs - (5 - margin)) < 1e-12 && std::abs(summary.ciHighMs - (5 + margin)) < 1e-12,
+		"summarizeSamples 95% confidence interval");
+	check(studentT95(1) == 12.706 && studentT95(20) == 2.086 && studentT95(1000) == 1.960, "studentT95 table values");
+}
+
+//*****************
+// Function name: testBenchCsv
+// Purpose: Writes two runs to a history file and checks that readBenchCsv returns the rows of the last one.
+//*****************
+BUBBLESORT_TEST(bench_regression, testBenchCsv)
+{
+	const std::string path = (std::filesystem::temp_directory_path() / "bubblesort_test_history.csv").string();
+	const std::vector<BenchSummary> first = { benchCase("bubble", 10, 0.1), benchCase("lsd_radix", 1, 0.01) };
+	const std::vector<BenchSummary> second = { benchCase("lsd_radix", 1.25, 0.0125) };
+	check(writeBenchCsv(path, "run1", first, false) && writeBenchCsv(path, "run2", second, true), "write two benchmark runs");
+
+	std::vector<BenchSummary> read;
+	check(readBenchCsv(path, read) && read.size() == 1 && read[0].engine == "lsd_radix" && read[0].meanMs == 1.25
+		&& read[0].n == 1000 && read[0].repetitions == 10 && read[0].ciHighMs == 1.2625, "readBenchCsv returns the last run");
+	check(writeBenchCsv(path, "run3", first, false) && readBenchCsv(path, read) && read.size() == 2 && read[0].meanMs == 10,
+		"writeBenchCsv replaces the history when not appending");
+	std::remove(path.c_str());
+	check(!readBenchCsv(path, read), "readBenchCsv of a missing file fails");
+}
+
+//*****************
+// Function name: testCompareToBaseline
+// Purpose: Checks that only a significant slowdown of a quiet case counts as a regression, and that noisy,
+//          faster, unchanged and new cases do not.
+//*****************
+BUBBLESORT_TEST(bench_regression, testCompareToBaseline)
+{
+	const std::vector<BenchSummary> baseline = { benchCase("a", 10, 0.1), benchCase("b", 10, 0.1), benchCase("c", 10, 3), benchCase("d", 10, 0.1) };
+	check(compareToBaseline({ benchCase("a", 15, 0.1) }, baseline) == 1, "a significant slowdown is a regression");
+	check(compareToBaseline({ benchCase("b", 10.1, 0.1) }, baseline) == 0, "a change below kBenchMinimumChange is not a regression");
+	check(compareToBaseline({ benchCase("c", 15, 3) }, baseline) == 0, "a noisy case is not a regression");
+	check(compareToBaseline({ benchCase("d", 5, 0.1), benchCase("e", 50, 0.1) }, baseline) == 0, "faster and new cases are not regressions");
+}
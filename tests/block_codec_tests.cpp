@@ -0,0 +1,106 @@
+//*****************
+// tests/block_codec_tests.cpp
+// Bit-packed sorted blocks: a block encoded by hand checked byte for byte, and packSortedBlock and
+// unpackSortedBlock round trips over every delta width, block length, order and integer type.
+//*****************
+#include <algorithm>
+#include <climits>    // for INT_MIN and INT_MAX
+#include <cstdint>
+#include <cstring>    // for std::memcpy
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: testReferenceBlock
+// Purpose: Packs a short ascending block and compares it with the bytes the format specifies: count minus
+//          one, the width of the widest delta, the first radix key and the deltas in four 32-bit lanes.
+//          Also checks a block of equal keys (width 0) and a block stored raw.
+//*****************
+BUBBLESORT_TEST(block_codec, testReferenceBlock)
+{
+	const int values[] = { 10, 11, 13, 20, 20, 21 };
+	std::vector<unsigned char> block(maxPackedBlockBytes<int>());
+	const std::size_t bytes = packSortedBlock(values, 6, false, block.data());
+
+	// Deltas 1, 2, 7, 0, 1 need 3 bits; delta i sits in lane i % 4 at bit (i / 4) * 3 of that lane's column
+	std::vector<unsigned char> expected(2 + 4 + 3 * 16, 0);
+	expected[0] = 5;
+	expected[1] = 3;
+	const std::uint32_t firstKey = 0x8000000Au, words[4] = { 0, 1 | (1u << 3), 2, 7 };
+	std::memcpy(expected.data() + 2, &firstKey, sizeof(firstKey));
+	std::memcpy(expected.data() + 6, words, sizeof(words));
+	check(bytes == expected.size() && std::equal(expected.begin(), expected.end(), block.begin()), "packSortedBlock matches the reference encoding");
+	check(packedBlockBytes<int>(block.data()) == bytes, "packedBlockBytes reads the size from the header");
+
+	int decoded[kPackedBlock] = {};
+	check(unpackSortedBlock(block.data(), false, decoded) == 6 && std::equal(values, values + 6, decoded), "unpackSortedBlock decodes the reference block");
+
+	const long long same[] = { -5, -5, -5 };
+	check(packSortedBlock(same, 3, false, block.data()) == packedHeaderBytes<long long>() && block[1] == 0, "equal keys pack to a bare header");
+
+	const long long spread[] = { LLONG_MIN, 0, LLONG_MAX };
+	const std::size_t rawBytes = packSortedBlock(spread, 3, false, block.data());
+	long long spreadOut[kPackedBlock] = {};
+	check(block[1] == kPackedRawWidth && rawBytes == packedHeaderBytes<long long>() + 2 * sizeof(long long)
+		&& unpackSortedBlock(block.data(), false, spreadOut) == 3 && std::equal(spread, spread + 3, spreadOut), "deltas above 32 bits are stored raw");
+}
+
+//*****************
+// Function name: checkRoundTrips
+// Purpose: Packs sorted blocks of T whose deltas fit each width from 0 to 32 bits (and wider, for 64-bit
+//          types), for several lengths and both orders, and checks that they decode to the same values.
+//*****************
+template <typename T>
+static void checkRoundTrips(const std::string& type)
+{
+	using Key = typename std::make_unsigned<T>::type;
+	std::vector<unsigned char> block(maxPackedBlockBytes<T>());
+	for (unsigned width = 0; width <= 8 * sizeof(T); ++width)
+	{
+		for (std::size_t count : { std::size_t(1), std::size_t(2), std::size_t(5), std::size_t(127), kPackedBlock })
+		{
+			// Random deltas up to 2^width - 1, the first one the widest, capped so the keys cannot wrap
+			const Key widest = width >= 8 * sizeof(Key) ? std::numeric_limits<Key>::max() : static_cast<Key>((Key(1) << width) - 1);
+			const std::vector<int> steps = randomInts(2 * count, 0, INT_MAX, width * 1000 + count);
+			std::vector<Key> keys(count);
+			for (std::size_t i = 1; i < count; ++i)
+			{
+				const std::uint64_t random = (static_cast<std::uint64_t>(steps[2 * i]) << 31) ^ static_cast<std::uint64_t>(steps[2 * i + 1]);
+				const Key delta = i == 1 ? widest : widest == std::numeric_limits<Key>::max() ? static_cast<Key>(random) : static_cast<Key>(random % (static_cast<std::uint64_t>(widest) + 1));
+				const Key room = static_cast<Key>((std::numeric_limits<Key>::max() - keys[i - 1]) / (count - i));
+				keys[i] = static_cast<Key>(keys[i - 1] + std::min(delta, room));
+			}
+
+			for (bool descending : { false, true })
+			{
+				std::vector<T> values(count);
+				for (std::size_t i = 0; i < count; ++i) values[i] = fromRadixKey<T>(keys[i]);
+				if (descending) std::reverse(values.begin(), values.end());
+				const std::size_t bytes = packSortedBlock(values.data(), count, descending, block.data());
+				std::vector<T> decoded(kPackedBlock);
+				const std::size_t decodedCount = unpackSortedBlock(block.data(), descending, decoded.data());
+				const std::string name = type + " block of " + std::to_string(count) + " with " + std::to_string(width) + "-bit deltas" + (descending ? ", descending" : "");
+				check(bytes <= maxPackedBlockBytes<T>() && packedBlockBytes<T>(block.data()) == bytes, "packed size of a " + name);
+				check(decodedCount == count && std::equal(values.begin(), values.end(), decoded.begin()), "round trip of a " + name);
+			}
+		}
+	}
+}
+
+//*****************
+// Function name: testRoundTrips
+// Purpose: Runs the round trips for signed and unsigned integers of 16, 32 and 64 bits.
+//*****************
+BUBBLESORT_TEST(block_codec, testRoundTrips)
+{
+	checkRoundTrips<short>("short");
+	checkRoundTrips<unsigned short>("unsigned short");
+	checkRoundTrips<int>("int");
+	checkRoundTrips<unsigned>("unsigned");
+	checkRoundTrips<long long>("long long");
+	checkRoundTrips<unsigned long long>("unsigned long long");
+}
@@ -0,0 +1,112 @@
+//*****************
+// tests/class_partition_tests.cpp
+// Class partitions: recursiveSort with the grouping comparators checked against bubbleSort and
+// std::stable_sort in several containers and budgets, partitionByClass against std::stable_partition
+// and std::stable_sort by class, and the leaves the partition reports.
+//*****************
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Template Function: checkClassifiedSort
+// Purpose: Compares recursiveSort with a comparator that declares a classifier against bubbleSort on small
+//          inputs and std::stable_sort on large ones (the parallel partition), in vectors, deques and lists,
+//          under unlimited and zero budgets, and checks the engine it reports.
+//*****************
+template <typename Comparator>
+static void checkClassifiedSort(const std::string& name)
+{
+	const Comparator compare;
+	const auto lessThan = [&compare](int a, int b) { return compare(b, a); };
+	for (std::size_t n : { std::size_t(10), std::size_t(64), std::size_t(3000), std::size_t(300000) })
+	{
+		const std::vector<int> values = randomInts(n, -1000000, 1000000, n);
+		std::vector<int> expected(values);
+		if (n <= 3000) bubbleSort(expected, compare);
+		else std::stable_sort(expected.begin(), expected.end(), lessThan);
+
+		for (std::size_t budget : { kUnlimitedScratch, std::size_t(0) })
+		{
+			const std::string suffix = " of " + std::to_string(n) + (budget ? "" : " without scratch");
+			SortReport report;
+			std::vector<int> vec(values);
+			recursiveSort(vec, compare, SortOptions(SortEngine::Automatic, budget, &report));
+			check(vec == expected, name + " vector" + suffix);
+			const SortAlgorithm engineUsed = n < kIntegerEngineThreshold ? SortAlgorithm::Bubble
+				: budget == 0 ? SortAlgorithm::Comparison : SortAlgorithm::ClassPartition;
+			const std::size_t leaves = engineUsed == SortAlgorithm::ClassPartition ? Comparator::classifier::classes + 1 : 1;
+			check(report.last == engineUsed && report.leaves == leaves && report.peakScratchBytes <= budget, name + " engine" + suffix);
+
+			std::deque<int> deq(values.begin(), values.end());
+			recursiveSort(deq, compare, SortOptions(SortEngine::Automatic, budget));
+			check(std::equal(deq.begin(), deq.end(), expected.begin(), expected.end()), name + " deque" + suffix);
+		}
+		std::list<int> lst(values.begin(), values.end());
+		recursiveSort(lst, compare);
+		check(std::equal(lst.begin(), lst.end(), expected.begin(), expected.end()), name + " list of " + std::to_string(n));
+	}
+}
+
+//*****************
+// Function name: testClassifiedSort
+// Purpose: Checks every grouping comparator, and nested vectors sorted leaf by leaf with one of them.
+//*****************
+BUBBLESORT_TEST(class_partition, testClassifiedSort)
+{
+	checkClassifiedSort<OddFirst>("OddFirst");
+	checkClassifiedSort<EvenFirst>("EvenFirst");
+	checkClassifiedSort<DivisibleBy3First>("DivisibleBy3First");
+
+	std::vector<std::vector<int>> nested = { randomInts(5000, -100, 100, 120), {}, randomInts(30, -100, 100, 121) };
+	std::vector<std::vector<int>> expected(nested);
+	recursiveSort(nested, DivisibleBy3First());
+	for (std::vector<int>& leaf : expected) bubbleSort(leaf, DivisibleBy3First());
+	check(nested == expected, "DivisibleBy3First nested vectors");
+}
+
+//*****************
+// Function name: testPartitionByClass
+// Purpose: Compares partitionByClass with std::stable_sort by class for ModuloClass (negative values
+//          included), with std::stable_partition for DivisibilityClass, and with a classifier on strings,
+//          in vectors, deques and lists.
+//*****************
+BUBBLESORT_TEST(class_partition, testPartitionByClass)
+{
+	const std::vector<int> values = randomInts(100000, -1000000, 1000000, 122);
+	const ModuloClass<7> modulo7;
+	std::vector<int> expected(values);
+	std::stable_sort(expected.begin(), expected.end(), [&modulo7](int a, int b) { return modulo7(a) < modulo7(b); });
+	std::vector<std::size_t> expectedCounts(7);
+	for (int value : values) ++expectedCounts[modulo7(value)];
+
+	std::vector<int> vec(values);
+	check(partitionByClass(vec, 7, modulo7) == expectedCounts && vec == expected, "partitionByClass ModuloClass<7> of a vector");
+	std::deque<int> deq(values.begin(), values.end());
+	check(partitionByClass(deq, 7, modulo7) == expectedCounts && std::equal(deq.begin(), deq.end(), expected.begin(), expected.end()),
+		"partitionByClass ModuloClass<7> of a deque");
+	std::list<int> lst(values.begin(), values.end());
+	check(partitionByClass(lst, 7, modulo7) == expectedCounts && std::equal(lst.begin(), lst.end(), expected.begin(), expected.end()),
+		"partitionByClass ModuloClass<7> of a list");
+
+	vec = values;
+	expected = values;
+	const auto divisible = std::stable_partition(expected.begin(), expected.end(), [](int value) { return value % 5 == 0; });
+	const std::vector<std::size_t> counts = partitionByClass(vec, 2, DivisibilityClass<5, true>());
+	check(vec == expected && counts == std::vector<std::size_t>({ static_cast<std::size_t>(divisible - expected.begin()),
+		static_cast<std::size_t>(expected.end() - divisible) }), "partitionByClass DivisibilityClass<5, true> matches std::stable_partition");
+
+	std::vector<std::string> words = generateStrings(3000, 0, 9, 123, "abc"), expectedWords(words);
+	const auto byLength = [](const std::string& word) { return word.size() % 4; };
+	std::stable_sort(expectedWords.begin(), expectedWords.end(), [&byLength](const std::string& a, const std::string& b) { return byLength(a) < byLength(b); });
+	const std::vector<std::size_t> wordCounts = partitionByClass(words, 4, byLength);
+	check(words == expectedWords && wordCounts.size() == 4 && wordCounts[0] + wordCounts[1] + wordCounts[2] + wordCounts[3] == 3000,
+		"partitionByClass of strings by length");
+
+	std::vector<int> empty;
+	check(partitionByClass(empty, 3, ModuloClass<3>()) == std::vector<std::size_t>(3) && empty.empty(), "partitionByClass of nothing");
+}
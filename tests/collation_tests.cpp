@@ -0,0 +1,95 @@
+//*****************
+// tests/collation_tests.cpp
+// Collated string sorting: hand-written reference orders for both collations (letters, then accents, then
+// case, then bytes), and the sort engines against a stable sort on the collation keys.
+//*****************
+#include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: testReferenceOrders
+// Purpose: Sorts shuffled words whose collation order is known and compares the result with that order:
+//          case-insensitive ASCII, and UTF-8 with accents, ligatures, Greek and combining marks.
+//*****************
+BUBBLESORT_TEST(collation, testReferenceOrders)
+{
+	const std::vector<std::string> ascii = { "", "a", "A", "apple", "Apple", "APPLE", "apples", "banana", "Banana", "cherry" };
+	std::vector<std::string> sortedAscii = { "banana", "APPLE", "cherry", "", "Apple", "A", "apples", "Banana", "apple", "a" };
+	recursiveSort(sortedAscii, CaseInsensitiveOrder());
+	check(sortedAscii == ascii, "CaseInsensitiveOrder reference order");
+
+	const std::vector<std::string> utf8 = { "aeon", "\xC3\x86on", "ecla", "eclair", "Eclair", "\xC3\xA9" "clair", "\xC3\x89" "clair",
+		"\xC3\xA9" "cole", "strasse", "Strasse", "Stra\xC3\x9F" "e", "zebra", "z\xC3\xA8" "bre", "\xCE\xB1\xCE\xB2", "\xCE\x91\xCE\x92" };
+	std::vector<std::string> sortedUtf8(utf8.rbegin(), utf8.rend());
+	std::rotate(sortedUtf8.begin(), sortedUtf8.begin() + 5, sortedUtf8.end());
+	recursiveSort(sortedUtf8, Utf8CollatedOrder());
+	check(sortedUtf8 == utf8, "Utf8CollatedOrder reference order");
+
+	std::vector<std::string> descending(utf8);
+	recursiveSort(descending, CollatedOrder<Collation::Utf8, true>());
+	check(std::equal(descending.rbegin(), descending.rend(), utf8.begin(), utf8.end()), "descending Utf8CollatedOrder reverses the reference order");
+
+	// A combining acute and the precomposed letter differ only in the final byte level, so they sort together
+	std::vector<std::string> marks = { "ecole", "e\xCC\x81" "cola", "\xC3\xA9" "cole", "e\xCC\x81" "cole", "ecolf" };
+	recursiveSort(marks, Utf8CollatedOrder());
+	check(marks == std::vector<std::string>({ "e\xCC\x81" "cola", "ecole", "e\xCC\x81" "cole", "\xC3\xA9" "cole", "ecolf" }),
+		"decomposed and precomposed accents collate together");
+	check(collationKey("\xCF\x83", Collation::Utf8).substr(0, 3) == collationKey("\xCF\x82", Collation::Utf8).substr(0, 3),
+		"final sigma has the primary weight of sigma");
+}
+
+//*****************
+// Function name: testCollationEngines
+// Purpose: Sorts random strings over letters, accented letters and malformed bytes through recursiveSort,
+//          in vectors and lists, in both orders, with and without scratch for the keys, and compares them
+//          with std::sort on the collation keys.
+//*****************
+BUBBLESORT_TEST(collation, testCollationEngines)
+{
+	// Mixed-case ASCII plus the UTF-8 bytes of accented Latin letters; random picks also form malformed sequences
+	const std::string alphabet = "aAbBeEzZ \xC3\xA9\x89\x9F\xCC\x81";
+	const std::vector<std::string> words = generateStrings(3000, 0, 8, 70, alphabet);
+	for (Collation collation : { Collation::AsciiCaseFold, Collation::Utf8 })
+	{
+		std::vector<std::string> expected(words);
+		std::sort(expected.begin(), expected.end(), [collation](const std::string& a, const std::string& b)
+		{
+			return collationKey(a, collation) < collationKey(b, collation);
+		});
+		const std::string name = collation == Collation::Utf8 ? "Utf8" : "AsciiCaseFold";
+		for (std::size_t budget : { kUnlimitedScratch, std::size_t(0) })
+		{
+			SortReport report;
+			const SortOptions options(SortEngine::Automatic, budget, &report);
+			std::vector<std::string> ascending(words), descending(words);
+			std::list<std::string> listed(words.begin(), words.end());
+			if (collation == Collation::Utf8)
+			{
+				recursiveSort(ascending, CollatedOrder<Collation::Utf8>(), options);
+				recursiveSort(descending, CollatedOrder<Collation::Utf8, true>(), options);
+				recursiveSort(listed, CollatedOrder<Collation::Utf8>(), options);
+			}
+			else
+			{
+				recursiveSort(ascending, CollatedOrder<Collation::AsciiCaseFold>(), options);
+				recursiveSort(descending, CollatedOrder<Collation::AsciiCaseFold, true>(), options);
+				recursiveSort(listed, CollatedOrder<Collation::AsciiCaseFold>(), options);
+			}
+			const std::string how = budget ? " with binary keys" : " by comparison";
+			check(ascending == expected, name + " collated sort" + how);
+			check(std::equal(descending.rbegin(), descending.rend(), expected.begin(), expected.end()), name + " descending collated sort" + how);
+			check(std::equal(listed.begin(), listed.end(), expected.begin(), expected.end()), name + " collated list sort" + how);
+			check(report.last == (budget ? SortAlgorithm::BinaryKeys : SortAlgorithm::Comparison), name + " collated sort engine" + how);
+		}
+
+		std::vector<std::string> small(words.begin(), words.begin() + 200), bubbled(small);
+		collatedSort(small, collation);
+		if (collation == Collation::Utf8) bubbleSort(bubbled, Utf8CollatedOrder());
+		else bubbleSort(bubbled, CaseInsensitiveOrder());
+		check(small == bubbled, name + " collatedSort matches bubbleSort with the comparator");
+	}
+}
@@ -0,0 +1,120 @@
+//*****************
+// tests/columnar_io_tests.cpp
+// Columnar files: page encodings checked against reference bytes, sorted 2D and 3D containers written and
+// read back against std::sort, page statistics, and range reads against a filtered reference.
+//*****************
+#include <algorithm>
+#include <cstdio>     // for std::remove
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: testPageEncodings
+// Purpose: Checks that runs of equal values and unsorted pages over few values pick the run-length and
+//          dictionary encodings with their reference bytes, that sorted pages keep the delta encoding, and
+//          that every kind of page decodes back to itself.
+//*****************
+BUBBLESORT_TEST(columnar_io, testPageEncodings)
+{
+	std::vector<unsigned char> payload;
+	std::vector<unsigned> runs(20, 5u);
+	runs.insert(runs.end(), 20, 9u);
+	check(encodeColumnPage(runs.data(), runs.size(), payload) == ColumnEncoding::RunLength
+		&& payload == std::vector<unsigned char>({ 2, 20, 10, 20, 8 }), "runs encode as (length, zigzag difference) pairs");
+
+	// Indices 2, 0, 1, 1 repeated pack into 0x52 bytes, two bits each, lowest first
+	const unsigned dictionary[] = { 100, 2000, 30000 }, pattern[] = { 2, 0, 1, 1 };
+	std::vector<unsigned> mixed(64);
+	for (std::size_t i = 0; i < mixed.size(); ++i) mixed[i] = dictionary[pattern[i % 4]];
+	std::vector<unsigned char> expected = { 3, static_cast<unsigned char>(CompactEncoding::AscendingVarint), 6, 0x64, 0xEC, 0x0E, 0xE0, 0xDA, 0x01 };
+	expected.insert(expected.end(), 16, 0x52);
+	check(encodeColumnPage(mixed.data(), mixed.size(), payload) == ColumnEncoding::Dictionary && payload == expected,
+		"few distinct unsorted values encode as a dictionary and bit-packed indices");
+
+	std::vector<int> sorted = randomInts(kColumnarPageValues, -1000000, 1000000, 95);
+	std::sort(sorted.begin(), sorted.end());
+	check(encodeColumnPage(sorted.data(), sorted.size(), payload) == ColumnEncoding::Delta
+		&& payload[0] == static_cast<unsigned char>(CompactEncoding::AscendingBlocks), "sorted pages keep the bit-packed gaps");
+
+	for (const std::vector<int>& page : { sorted, randomInts(3000, -5, 5, 96), randomInts(1, 0, 0, 97), randomInts(500, -2000000000.0, 2000000000.0, 98) })
+	{
+		std::vector<int> decoded;
+		const ColumnEncoding encoding = encodeColumnPage(page.data(), page.size(), payload);
+		check(decodeColumnPage(encoding, page.size(), payload.data(), payload.size(), decoded) && decoded == page,
+			"round trip of a page of " + std::to_string(page.size()) + " with encoding " + std::to_string(static_cast<int>(encoding)));
+	}
+	std::vector<unsigned> decodedRuns;
+	check(!decodeColumnPage(ColumnEncoding::RunLength, runs.size() - 1, payload.data(), 0, decodedRuns), "an empty page is malformed");
+}
+
+//*****************
+// Function name: testColumnarFiles
+// Purpose: Sorts 2D and 3D containers with columns around the page size, writes them as columnar files and
+//          reads them back whole, by column and by value range, comparing with std::sort, the page minimum
+//          and maximum, and a filtered copy of the reference.
+//*****************
+BUBBLESORT_TEST(columnar_io, testColumnarFiles)
+{
+	const std::string path = (std::filesystem::temp_directory_path() / "bubblesort_test_columnar.bin").string();
+	std::vector<std::vector<int>> table;
+	for (std::size_t n : { std::size_t(0), std::size_t(1), kColumnarPageValues, kColumnarPageValues + 1, std::size_t(20000) })
+	{
+		table.push_back(randomInts(n, -1000000, 1000000, n + 99));
+	}
+	std::vector<std::vector<int>> expected(table);
+	for (std::vector<int>& row : expected) std::sort(row.begin(), row.end());
+	recursiveSort(table, std::greater<int>());
+
+	check(writeColumnarFile(path, table), "write a 2D columnar file");
+	std::vector<std::vector<int>> readBack;
+	check(readColumnarFile(path, readBack) && readBack == expected, "read back a sorted 2D columnar file");
+	std::vector<std::vector<std::vector<int>>> wrongDepth;
+	check(!readColumnarFile(path, wrongDepth), "readColumnarFile rejects another depth");
+
+	ColumnarReader<int> reader;
+	check(reader.open(path) && reader.depth() == 2 && reader.rowGroupCount() == table.size(), "ColumnarReader opens the footer");
+	for (std::size_t group = 0; group < expected.size(); ++group)
+	{
+		const std::vector<int>& column = expected[group];
+		const std::string name = " of row group " + std::to_string(group);
+		std::vector<int> values;
+		check(reader.columnCount(group) == 1 && reader.columnSize(group, 0) == column.size()
+			&& reader.readColumn(group, 0, values) && values == column, "readColumn" + name);
+
+		bool statistics = reader.pageCount(group, 0) == (column.size() + kColumnarPageValues - 1) / kColumnarPageValues;
+		for (std::size_t index = 0; statistics && index < reader.pageCount(group, 0); ++index)
+		{
+			const ColumnPage<int>& page = reader.page(group, 0, index);
+			statistics = page.count == std::min(kColumnarPageValues, column.size() - index * kColumnarPageValues)
+				&& page.min == column[index * kColumnarPageValues] && page.max == column[index * kColumnarPageValues + page.count - 1];
+		}
+		check(statistics, "page statistics" + name);
+
+		for (int low : { -2000000, -1000, 999000 })
+		{
+			std::vector<int> inRange, expectedRange;
+			std::size_t pagesRead = 0;
+			std::copy_if(column.begin(), column.end(), std::back_inserter(expectedRange), [low](int v) { return v >= low && v <= low + 5000; });
+			check(reader.readRange(group, 0, low, low + 5000, inRange, &pagesRead) && inRange == expectedRange && pagesRead <= 2,
+				"readRange from " + std::to_string(low) + name + " decodes only the overlapping pages");
+		}
+	}
+	ColumnarReader<long long> wrongType;
+	check(!wrongType.open(path), "ColumnarReader rejects another element type");
+
+	std::vector<std::vector<std::vector<int>>> cube = { { randomInts(5000, 0, 9, 100), {}, randomInts(9000, -50, 50, 101) }, {}, { randomInts(3, 0, 1, 102) } };
+	std::vector<std::vector<std::vector<int>>> expectedCube(cube), readCube;
+	for (auto& group : expectedCube)
+	{
+		for (std::vector<int>& column : group) std::sort(column.begin(), column.end());
+	}
+	recursiveSort(cube, std::greater<int>());
+	check(writeColumnarFile(path, cube) && readColumnarFile(path, readCube) && readCube == expectedCube, "round trip of a sorted 3D columnar file");
+	std::remove(path.c_str());
+	check(!readColumnarFile(path, readCube), "readColumnarFile fails on a missing file");
+}
@@ -0,0 +1,151 @@
+//*****************
+// tests/compact_io_tests.cpp
+// The compact binary format: varint and leaf encodings checked against reference bytes, nested containers
+// written and read back, random access through the leaf index, and malformed or truncated streams
+// rejected without throwing.
+//*****************
+#include <algorithm>
+#include <climits>    // for INT_MIN and INT_MAX
+#include <functional>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: testLeafEncodings
+// Purpose: Checks varints and zigzag codes against their reference bytes, the encoding picked for every kind
+//          of leaf, and that each leaf decodes back to itself.
+//*****************
+BUBBLESORT_TEST(compact_io, testLeafEncodings)
+{
+	std::vector<unsigned char> bytes;
+	appendVarint(bytes, 0);
+	appendVarint(bytes, 127);
+	appendVarint(bytes, 300);
+	check(bytes == std::vector<unsigned char>({ 0x00, 0x7F, 0xAC, 0x02 }), "appendVarint writes LEB128");
+	check(zigzagEncode(0) == 0 && zigzagEncode(~std::uint64_t(0)) == 1 && zigzagEncode(1) == 2 && zigzagDecode(3) == ~std::uint64_t(1),
+		"zigzag maps 0, -1, 1, -2 to 0, 1, 2, 3");
+	std::uint64_t value = 0;
+	const unsigned char* in = bytes.data() + 2;
+	check(parseVarint(in, bytes.data() + bytes.size(), value) && value == 300 && in == bytes.data() + 4, "parseVarint reads LEB128");
+	const unsigned char overlong[11] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+	in = overlong;
+	check(!parseVarint(in, overlong + sizeof(overlong), value), "parseVarint rejects varints longer than 64 bits");
+
+	std::vector<int> ascending = randomInts(1000, INT_MIN, INT_MAX, 92);
+	std::sort(ascending.begin(), ascending.end());
+	std::vector<int> descending(ascending.rbegin(), ascending.rend());
+	struct Case { std::vector<int> values; CompactEncoding encoding; const char* name; };
+	for (const Case& test : { Case{ {}, CompactEncoding::AscendingVarint, "empty" },
+		Case{ { 5, 5, 9 }, CompactEncoding::AscendingVarint, "short ascending" },
+		Case{ { INT_MAX, 0, INT_MIN }, CompactEncoding::DescendingVarint, "short descending" },
+		Case{ { 3, INT_MIN, INT_MAX, -1 }, CompactEncoding::ZigzagVarint, "unsorted" },
+		Case{ ascending, CompactEncoding::AscendingBlocks, "long ascending" },
+		Case{ descending, CompactEncoding::DescendingBlocks, "long descending" } })
+	{
+		std::vector<unsigned char> payload;
+		std::vector<int> decoded;
+		const CompactEncoding encoding = encodeCompactLeaf(test.values.data(), test.values.size(), payload);
+		check(encoding == test.encoding, std::string("encoding of a ") + test.name + " leaf");
+		check(decodeCompactLeaf(encoding, test.values.size(), payload.data(), payload.size(), decoded) && decoded == test.values,
+			std::string("round trip of a ") + test.name + " leaf");
+	}
+}
+
+//*****************
+// Function name: testCompactStream
+// Purpose: Writes several compact records back to back and reads them in order, then reads single leaves
+//          through CompactLeafReader.
+//*****************
+BUBBLESORT_TEST(compact_io, testCompactStream)
+{
+	std::vector<std::vector<int>> nested = { randomInts(5000, -100, 100, 8), {}, randomInts(70, 0, 1000000, 9) };
+	recursiveSort(nested, std::greater<int>());
+	const std::list<long long> listed = { -4, 9, 1LL << 40 };
+	std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+	check(writeCompact(stream, nested) && writeCompact(stream, listed) && writeCompact(stream, nested), "write compact records");
+	std::vector<std::vector<int>> first, third;
+	std::list<long long> second;
+	check(readCompact(stream, first) && first == nested, "read the first compact record");
+	check(readCompact(stream, second) && second == listed, "read the second compact record");
+	check(readCompact(stream, third) && third == nested, "read the third compact record");
+
+	std::stringstream single(std::ios::in | std::ios::out | std::ios::binary);
+	check(writeCompact(single, nested), "write a compact record for random access");
+	CompactLeafReader<int> reader;
+	check(reader.open(single) && reader.leafCount() == nested.size(), "CompactLeafReader reads the index");
+	for (std::size_t leaf : { std::size_t(2), std::size_t(0), std::size_t(1) })
+	{
+		std::vector<int> values;
+		check(reader.leafSize(leaf) == nested[leaf].size() && reader.readLeaf(leaf, values) && values == nested[leaf],
+			"CompactLeafReader reads leaf " + std::to_string(leaf));
+	}
+	single.seekg(0);
+	CompactLeafReader<long long> wrongType;
+	check(!wrongType.open(single), "CompactLeafReader rejects another element type");
+}
+
+//*****************
+// Function name: readsCleanly
+// Purpose: Reads a compact record from bytes, reporting through ok whether readCompact succeeded.
+// Returns: false if readCompact threw (std::bad_alloc included).
+//*****************
+static bool readsCleanly(const std::string& bytes, bool& ok)
+{
+	std::stringstream stream(bytes, std::ios::in | std::ios::binary);
+	std::vector<std::vector<int>> nested;
+	try
+	{
+		ok = readCompact(stream, nested);
+		return true;
+	}
+	catch (...)
+	{
+		return false;
+	}
+}
+
+//*****************
+// Function name: testMalformedStreams
+// Purpose: Feeds readCompact every truncation of a valid record, the record with single bytes corrupted, and
+//          headers claiming enormous sizes; it must return false (or, for corrupted payload bytes, at most
+//          decode other values) and never throw.
+//*****************
+BUBBLESORT_TEST(compact_io, testMalformedStreams)
+{
+	std::vector<int> sorted = randomInts(300, 0, 100000, 93);
+	std::sort(sorted.begin(), sorted.end());
+	const std::vector<std::vector<int>> nested = { sorted, { 4, -7, 12 }, {} };
+	std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+	check(writeCompact(stream, nested), "write the record to corrupt");
+	const std::string valid = stream.str();
+
+	bool ok = false, clean = true, rejected = true;
+	for (std::size_t length = 0; length < valid.size(); ++length)
+	{
+		clean = readsCleanly(valid.substr(0, length), ok) && clean;
+		rejected = !ok && rejected;
+	}
+	check(clean && rejected, "every truncated record is rejected without throwing");
+
+	for (std::size_t position = 0; position < valid.size(); ++position)
+	{
+		for (unsigned char corrupt : { 0x00, 0x80, 0xFF })
+		{
+			std::string bytes(valid);
+			bytes[position] = static_cast<char>(corrupt);
+			clean = readsCleanly(bytes, ok) && clean;
+		}
+	}
+	check(clean, "corrupted records never throw");
+
+	// A header whose shape length and a segment whose size are close to 2^64
+	const std::string huge = "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x01";
+	const std::string header = valid.substr(0, kCompactHeaderBytes), shape = "\x01\x03", encoding(1, '\0');
+	check(readsCleanly(header + huge, ok) && !ok, "an enormous shape length is rejected without allocating it");
+	check(readsCleanly(header + shape + huge + encoding + huge, ok) && !ok, "an enormous leaf size is rejected without allocating it");
+	check(readsCleanly(header + shape + "\x03" + encoding + huge, ok) && !ok, "an enormous payload length is rejected without allocating it");
+}
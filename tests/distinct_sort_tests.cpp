@@ -0,0 +1,118 @@
+//*****************
+// tests/distinct_sort_tests.cpp
+// Sorting to distinct values: sortDistinct and its run counts checked against std::sort and std::unique
+// on the counting, LSD, in-place radix and comparison paths, for several containers and budgets.
+//*****************
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: referenceDistinct
+// Purpose: Sorts values with std::sort and returns the distinct values with std::unique, filling counts with
+//          the length of every run.
+//*****************
+template <typename T>
+static std::vector<T> referenceDistinct(std::vector<T> values, bool descending, std::vector<std::size_t>& counts)
+{
+	std::sort(values.begin(), values.end());
+	if (descending) std::reverse(values.begin(), values.end());
+	counts.clear();
+	for (std::size_t i = 0; i < values.size(); ++i)
+	{
+		if (i == 0 || values[i] != values[i - 1]) counts.push_back(0);
+		++counts.back();
+	}
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+	return values;
+}
+
+//*****************
+// Function name: testDistinctSort
+// Purpose: Compares sortDistinct with its counts against std::sort and std::unique on small, wide and
+//          medium value ranges, in both orders, with every engine choice and under unlimited and zero
+//          budgets, and checks the engine it reports.
+//*****************
+BUBBLESORT_TEST(distinct_sort, testDistinctSort)
+{
+	const std::vector<int> inputs[] = { randomInts(300000, 0, 999, 4), randomInts(300000, -2000000000.0, 2000000000.0, 5),
+		randomInts(300000, -50000, 50000, 6) };
+	for (const std::vector<int>& values : inputs)
+	{
+		for (bool descending : { false, true })
+		{
+			std::vector<std::size_t> expectedCounts;
+			const std::vector<int> expected = referenceDistinct(values, descending, expectedCounts);
+			for (SortEngine engine : { SortEngine::Automatic, SortEngine::InPlaceRadix })
+			{
+				for (std::size_t budget : { kUnlimitedScratch, std::size_t(0) })
+				{
+					SortReport report;
+					std::vector<int> result(values);
+					std::vector<std::size_t> counts;
+					const std::size_t distinct = sortDistinct(result, descending, SortOptions(engine, budget, &report), &counts);
+					const std::string name = " of " + std::to_string(expected.size()) + " distinct values" + (descending ? ", descending" : "")
+						+ (engine == SortEngine::InPlaceRadix ? ", in place" : "") + (budget ? "" : ", no scratch");
+					check(distinct == expected.size() && result == expected && counts == expectedCounts, "sortDistinct matches std::unique" + name);
+
+					const bool counted = expected.size() <= 1000;
+					const SortAlgorithm engineUsed = budget == 0 ? SortAlgorithm::AmericanFlag : counted ? SortAlgorithm::Counting
+						: engine == SortEngine::InPlaceRadix ? SortAlgorithm::AmericanFlag : SortAlgorithm::LsdRadix;
+					check(report.last == engineUsed && report.peakScratchBytes <= budget, "sortDistinct engine" + name);
+				}
+			}
+		}
+	}
+}
+
+//*****************
+// Function name: testDistinctContainers
+// Purpose: Runs sortDistinct on lists and deques (gathered through a copy, or compared in place without
+//          scratch), on long longs and on strings, and on empty and single-value containers.
+//*****************
+BUBBLESORT_TEST(distinct_sort, testDistinctContainers)
+{
+	std::list<int> listed = { 3, 1, 3, 2, 1 };
+	sortDistinct(listed);
+	check(listed == std::list<int>({ 1, 2, 3 }), "sortDistinct of a list");
+
+	const std::vector<int> values = randomInts(20000, -300, 300, 115);
+	std::vector<std::size_t> expectedCounts, counts;
+	const std::vector<int> expected = referenceDistinct(values, true, expectedCounts);
+	for (std::size_t budget : { kUnlimitedScratch, std::size_t(0) })
+	{
+		SortReport report;
+		std::deque<int> deque(values.begin(), values.end());
+		std::list<int> list(values.begin(), values.end());
+		sortDistinct(deque, true, SortOptions(SortEngine::Automatic, budget, &report), &counts);
+		check(std::equal(deque.begin(), deque.end(), expected.begin(), expected.end()) && counts == expectedCounts,
+			std::string("sortDistinct of a deque") + (budget ? "" : " without scratch"));
+		check(report.last == (budget ? SortAlgorithm::Counting : SortAlgorithm::Comparison), std::string("deque engine") + (budget ? "" : " without scratch"));
+		sortDistinct(list, true, SortOptions(SortEngine::Automatic, budget), &counts);
+		check(std::equal(list.begin(), list.end(), expected.begin(), expected.end()) && counts == expectedCounts,
+			std::string("sortDistinct of a list") + (budget ? "" : " without scratch"));
+	}
+
+	GeneratorOptions options;
+	options.low = -9e18;
+	options.high = 9e18;
+	std::vector<long long> wide = generateData<long long>(50000, options);
+	wide.insert(wide.end(), wide.begin(), wide.begin() + 1000);
+	const std::vector<long long> expectedWide = referenceDistinct(wide, false, expectedCounts);
+	check(sortDistinct(wide, false, SortOptions(), &counts) == expectedWide.size() && wide == expectedWide && counts == expectedCounts,
+		"sortDistinct of long longs");
+
+	std::vector<std::string> words = generateStrings(5000, 0, 3, 116, "ab");
+	const std::vector<std::string> expectedWords = referenceDistinct(words, false, expectedCounts);
+	check(sortDistinct(words, false, SortOptions(), &counts) == expectedWords.size() && words == expectedWords && counts == expectedCounts,
+		"sortDistinct of strings");
+
+	std::vector<int> empty, single = { 7, 7, 7 };
+	check(sortDistinct(empty, false, SortOptions(), &counts) == 0 && empty.empty() && counts.empty(), "sortDistinct of an empty vector");
+	check(sortDistinct(single, false, SortOptions(), &counts) == 1 && single == std::vector<int>({ 7 }) && counts == std::vector<std::size_t>({ 3 }),
+		"sortDistinct of one repeated value");
+}
@@ -0,0 +1,94 @@
+//*****************
+// tests/divisibility_tests.cpp
+// Modulo classification: divisibilityTest constants, every classifyDivisible kernel variant the CPU
+// supports, and the DivisibilityClass and ModuloClass functors checked against the % operator, for
+// negative values and both extremes of int.
+//*****************
+#include <climits>    // for INT_MIN and INT_MAX
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+// The inverse times the odd part of the divisor is 1 modulo 2^32
+static_assert(divisibilityTest(3).inverse * 3u == 1u && divisibilityTest(3).shift == 0, "divisibilityTest of 3");
+static_assert(divisibilityTest(24).inverse * 3u == 1u && divisibilityTest(24).shift == 3, "divisibilityTest of 24");
+static_assert(divisibilityTest(1).threshold == UINT32_MAX, "divisibilityTest of 1");
+
+static const unsigned kDivisors[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 16, 100, 1u << 20, 1000003, INT_MAX };
+
+//*****************
+// Function name: divisibilityInputs
+// Purpose: Returns n random ints, a share of them multiples of divisor, with INT_MIN, INT_MAX, 0 and
+//          -divisor among the first values.
+//*****************
+static std::vector<int> divisibilityInputs(std::size_t n, unsigned divisor, std::uint64_t seed)
+{
+	std::vector<int> values = randomInts(n, INT_MIN, INT_MAX, seed);
+	for (std::size_t i = 0; i < n; i += 3)
+	{
+		const long long multiple = static_cast<long long>(values[i] / static_cast<long long>(divisor)) * divisor;
+		values[i] = static_cast<int>(multiple);
+	}
+	const int specials[] = { INT_MIN, INT_MAX, 0, -static_cast<int>(divisor) };
+	for (std::size_t i = 0; i < n && i < 4; ++i) values[i] = specials[i];
+	return values;
+}
+
+//*****************
+// Function name: testClassifyKernels
+// Purpose: Runs the classifyDivisible kernel of every supported instruction set on lengths around the vector
+//          widths, for every divisor and both class orders, and compares it with the % operator.
+//*****************
+BUBBLESORT_TEST(divisibility, testClassifyKernels)
+{
+	for (SimdIsa isa : { SimdIsa::Baseline, SimdIsa::Sse42, SimdIsa::Avx2, SimdIsa::Avx512 })
+	{
+		if (isa > detectSimdIsa()) break;
+		const SimdKernels& kernels = simdKernelsFor(isa);
+		for (unsigned divisor : kDivisors)
+		{
+			for (std::size_t n : { 0, 1, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33, 1000 })
+			{
+				const std::vector<int> values = divisibilityInputs(n, divisor, n + divisor);
+				for (bool divisibleFirst : { false, true })
+				{
+					std::vector<unsigned char> classes(n + 1, 0xAB);
+					kernels.classifyDivisible(values.data(), n, divisor, divisibleFirst, classes.data());
+					bool matches = classes[n] == 0xAB;
+					for (std::size_t i = 0; i < n; ++i)
+					{
+						matches = matches && classes[i] == ((values[i] % static_cast<long long>(divisor) == 0) != divisibleFirst);
+					}
+					check(matches, std::string(simdIsaName(isa)) + " classifyDivisible by " + std::to_string(divisor) + " of " + std::to_string(n)
+						+ " values" + (divisibleFirst ? ", multiples first" : ""));
+				}
+			}
+		}
+	}
+}
+
+//*****************
+// Function name: testClassFunctors
+// Purpose: Compares DivisibilityClass, ModuloClass and classifyElements (the kernel path for
+//          DivisibilityClass) with the % operator.
+//*****************
+BUBBLESORT_TEST(divisibility, testClassFunctors)
+{
+	const std::vector<int> values = divisibilityInputs(20000, 3, 124);
+	std::vector<unsigned char> classes(values.size());
+	bool divisibility = true, modulo = true;
+	DivisibilityClass<3, true> divisibleBy3;
+	classifyElements(values.data(), values.size(), divisibleBy3, classes.data());
+	for (std::size_t i = 0; i < values.size(); ++i)
+	{
+		const int remainder = values[i] % 3, residue = remainder < 0 ? remainder + 3 : remainder;
+		divisibility = divisibility && classes[i] == (remainder != 0) && divisibleBy3(values[i]) == (remainder != 0)
+			&& DivisibilityClass<2, false>()(values[i]) == (values[i] % 2 == 0);
+		modulo = modulo && ModuloClass<3>()(values[i]) == static_cast<std::size_t>(residue)
+			&& ModuloClass<256>()(values[i]) == static_cast<std::size_t>((values[i] % 256 + 256) % 256);
+	}
+	check(divisibility, "DivisibilityClass and classifyElements match the % operator");
+	check(modulo, "ModuloClass gives remainders in [0, Divisor) for negative values too");
+}
@@ -0,0 +1,152 @@
+//*****************
+// tests/external_sort_tests.cpp
+// External sorting and background I/O: externalSortFile in memory, through spilled runs and through
+// multi-pass merges checked against std::sort, and AsyncIo reads and writes on both backends.
+//*****************
+#include <algorithm>
+#include <cstdio>     // for std::remove
+#include <cstdlib>    // for setenv and unsetenv
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: writeFile
+// Purpose: Writes values to a file, replacing it. Returns false on failure.
+//*****************
+template <typename T>
+static bool writeFile(const std::string& path, const std::vector<T>& values)
+{
+	IoFile file;
+	return file.openWrite(path) && (values.empty() || file.writeAt(values.data(), values.size() * sizeof(T), 0)) && file.close();
+}
+
+//*****************
+// Function name: readFile
+// Purpose: Reads a whole file of T values; fails the check when it cannot be read.
+//*****************
+template <typename T>
+static std::vector<T> readFile(const std::string& path)
+{
+	IoFile file;
+	const bool opened = file.openRead(path);
+	std::vector<T> values(opened ? static_cast<std::size_t>(file.size() / sizeof(T)) : 0);
+	check(opened && (values.empty() || file.readAt(values.data(), values.size() * sizeof(T), 0)), "read " + path);
+	return values;
+}
+
+//*****************
+// Function name: testExternalSort
+// Purpose: Sorts files in memory (the file fits the budget), through spilled runs merged in one pass, and
+//          through multi-pass merges, in both orders and in place, and compares them with std::sort.
+//*****************
+BUBBLESORT_TEST(external_sort, testExternalSort)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path();
+	const std::string input = (directory / "bubblesort_test_external_in.bin").string();
+	const std::string output = (directory / "bubblesort_test_external_out.bin").string();
+
+	struct Case { std::size_t n; std::size_t budget; const char* name; };
+	for (const Case& test : { Case{ 50000, kUnlimitedScratch, "in memory" }, Case{ 1 << 16, kExternalSortMinBudget, "one merge pass" },
+		Case{ 1 << 20, kExternalSortMinBudget, "multi-pass merge" }, Case{ 0, 0, "empty file" } })
+	{
+		const std::vector<int> values = randomInts(test.n, -2000000000.0, 2000000000.0, test.n);
+		std::vector<int> expected(values);
+		std::sort(expected.begin(), expected.end());
+		for (bool descending : { false, true })
+		{
+			const std::string name = std::string(" (") + test.name + (descending ? ", descending)" : ")");
+			check(writeFile(input, values), "write the external sort input" + name);
+			SortReport report;
+			const bool sorted = externalSortFile<int>(input, output, SortOptions(SortEngine::Automatic, test.budget, &report), descending, directory.string());
+			check(sorted, "externalSortFile succeeds" + name);
+			const std::vector<int> result = readFile<int>(output);
+			check(descending ? std::equal(result.rbegin(), result.rend(), expected.begin(), expected.end()) : result == expected,
+				"externalSortFile matches std::sort" + name);
+			if (test.budget == kExternalSortMinBudget)
+			{
+				const bool multiPass = report.spilledRuns > kExternalMergeFanIn;
+				check(report.last == SortAlgorithm::External && report.spilledRuns > 1 && multiPass == (test.n == (1 << 20)),
+					"externalSortFile spills runs" + name);
+			}
+		}
+	}
+
+	// Sorting a file onto itself, with 64-bit keys
+	GeneratorOptions options;
+	options.low = -9e18;
+	options.high = 9e18;
+	const std::vector<long long> wide = generateData<long long>(200000, options);
+	std::vector<long long> expectedWide(wide);
+	std::sort(expectedWide.begin(), expectedWide.end());
+	check(writeFile(input, wide) && externalSortFile<long long>(input, input, SortOptions(SortEngine::Automatic, kExternalSortMinBudget))
+		&& readFile<long long>(input) == expectedWide, "externalSortFile sorts a file of long longs in place");
+
+	// A size that is not a multiple of the element and a missing file are refused
+	check(writeFile(input, std::vector<char>(7)) && !externalSortFile<int>(input, output), "externalSortFile refuses a partial element");
+	std::remove(input.c_str());
+	check(!externalSortFile<int>(input, output), "externalSortFile fails on a missing input");
+	std::remove(output.c_str());
+}
+
+//*****************
+// Function name: testAsyncIo
+// Purpose: Writes and reads back a temporary file through AsyncIo with many requests in flight, on io_uring
+//          where the kernel allows it and on the worker threads, and checks that a read past the end fails.
+//*****************
+BUBBLESORT_TEST(external_sort, testAsyncIo)
+{
+	const std::vector<int> values = randomInts(1 << 18, -2000000000.0, 2000000000.0, 94);
+	const std::size_t blockInts = 1000;
+	const std::size_t blocks = (values.size() + blockInts - 1) / blockInts;
+	for (bool threads : { false, true })
+	{
+#if BUBBLESORT_POSIX_IO
+		if (threads) setenv("BUBBLESORT_ASYNC_IO", "threads", 1);
+		else unsetenv("BUBBLESORT_ASYNC_IO");
+#else
+		if (!threads) continue;
+#endif
+		AsyncIo io;
+		const std::string name = std::string(" with ") + io.backendName();
+		check(!threads || std::string(io.backendName()) == "threads", "BUBBLESORT_ASYNC_IO selects the worker threads");
+		IoFile file;
+		check(file.openTemporary(std::string()), "open a temporary file" + name);
+
+		// Blocks are written back to front in batches that fill most of the queue
+		bool written = true;
+		for (std::size_t batch = 0; batch < blocks; batch += kAsyncIoQueueDepth / 2)
+		{
+			std::vector<AsyncIo::Ticket> tickets;
+			for (std::size_t b = batch; b < std::min(blocks, batch + kAsyncIoQueueDepth / 2); ++b)
+			{
+				const std::size_t block = blocks - 1 - b, begin = block * blockInts, count = std::min(blockInts, values.size() - begin);
+				tickets.push_back(io.write(file, values.data() + begin, count * sizeof(int), begin * sizeof(int)));
+			}
+			for (AsyncIo::Ticket ticket : tickets) written = io.wait(ticket) && written;
+		}
+		check(written && file.size() == values.size() * sizeof(int), "AsyncIo writes every block" + name);
+
+		std::vector<int> result(values.size());
+		bool read = true;
+		for (std::size_t batch = 0; batch < blocks; batch += kAsyncIoQueueDepth)
+		{
+			std::vector<AsyncIo::Ticket> tickets;
+			for (std::size_t b = batch; b < std::min(blocks, batch + kAsyncIoQueueDepth); ++b)
+			{
+				const std::size_t begin = b * blockInts, count = std::min(blockInts, values.size() - begin);
+				tickets.push_back(io.read(file, result.data() + begin, count * sizeof(int), begin * sizeof(int)));
+			}
+			for (AsyncIo::Ticket ticket : tickets) read = io.wait(ticket) && read;
+		}
+		check(read && result == values, "AsyncIo reads back what it wrote" + name);
+
+		int past = 0;
+		check(!io.wait(io.read(file, &past, sizeof(past), values.size() * sizeof(int))), "AsyncIo fails a read past the end" + name);
+	}
+#if BUBBLESORT_POSIX_IO
+	unsetenv("BUBBLESORT_ASYNC_IO");
+#endif
+}
@@ -0,0 +1,135 @@
+//*****************
+// tests/fence_index_tests.cpp
+// Fence indexes over sorted files: SortedFileReader lookups and range reads checked against
+// std::lower_bound, std::upper_bound and std::binary_search on the same data, in both orders and for
+// several strides, with indexes from buildFenceIndex and from externalSortFile.
+//*****************
+#include <algorithm>
+#include <climits>    // for INT_MIN and INT_MAX
+#include <cstdio>     // for std::remove
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: checkReader
+// Purpose: Opens a sorted file through its index and compares every lookup with the standard algorithms on
+//          expected, probing every value of a sample, its neighbours and both extremes.
+//*****************
+static void checkReader(const std::string& dataPath, const std::string& indexPath, const std::vector<int>& expected, bool descending, const std::string& name)
+{
+	SortedFileReader<int> reader;
+	check(reader.open(dataPath, indexPath) && reader.size() == expected.size() && reader.descending() == descending, "open the fence index" + name);
+	const auto ordered = [descending](int a, int b) { return descending ? b < a : a < b; };
+	std::vector<int> probes = { INT_MIN, INT_MAX, 0 };
+	for (std::size_t i = 0; i < expected.size(); i += 1 + expected.size() / 200)
+	{
+		probes.insert(probes.end(), { expected[i], expected[i] - 1, expected[i] + 1 });
+	}
+
+	bool bounds = true, found = true, blocks = true, ranges = true;
+	for (int probe : probes)
+	{
+		const std::size_t readBefore = reader.blocksRead();
+		const auto lower = std::lower_bound(expected.begin(), expected.end(), probe, ordered);
+		bounds = bounds && reader.lowerBound(probe) == static_cast<std::uint64_t>(lower - expected.begin());
+		blocks = blocks && reader.blocksRead() <= readBefore + 1;
+		const auto upper = std::upper_bound(expected.begin(), expected.end(), probe, ordered);
+		bounds = bounds && reader.upperBound(probe) == static_cast<std::uint64_t>(upper - expected.begin());
+		found = found && reader.contains(probe) == std::binary_search(expected.begin(), expected.end(), probe, ordered);
+
+		std::vector<int> values;
+		const int high = probe > INT_MAX - 500 ? INT_MAX : probe + 500;
+		const auto first = std::lower_bound(expected.begin(), expected.end(), descending ? high : probe, ordered);
+		const auto last = std::upper_bound(expected.begin(), expected.end(), descending ? probe : high, ordered);
+		ranges = ranges && reader.readRange(high, probe, values) && std::equal(values.begin(), values.end(), first, std::max(first, last));
+	}
+	check(bounds, "lowerBound and upperBound match the standard algorithms" + name);
+	check(blocks, "a lookup reads at most one block" + name);
+	check(found, "contains matches std::binary_search" + name);
+	check(ranges, "readRange matches the reference range" + name);
+	check(reader.ok(), "no read failed" + name);
+}
+
+//*****************
+// Function name: writeSorted
+// Purpose: Writes values to a file; fails the check when it cannot.
+//*****************
+static void writeSorted(const std::string& path, const std::vector<int>& values)
+{
+	IoFile file;
+	check(file.openWrite(path) && (values.empty() || file.writeAt(values.data(), values.size() * sizeof(int), 0)) && file.close(), "write " + path);
+}
+
+//*****************
+// Function name: testBuiltIndexes
+// Purpose: Builds fence indexes with buildFenceIndex over files of several sizes, with runs of equal values
+//          crossing block boundaries, for several strides and both orders, and checks the reader on each.
+//*****************
+BUBBLESORT_TEST(fence_index, testBuiltIndexes)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path();
+	const std::string data = (directory / "bubblesort_test_fence.bin").string();
+	const std::string index = (directory / "bubblesort_test_fence.idx").string();
+	for (std::size_t n : { std::size_t(0), std::size_t(1), kFenceIndexStride, kFenceIndexStride + 1, std::size_t(100000) })
+	{
+		for (double high : { 50.0, 2e9 })
+		{
+			std::vector<int> expected = randomInts(n, -high, high, n + 103);
+			std::sort(expected.begin(), expected.end());
+			for (bool descending : { false, true })
+			{
+				if (descending) std::reverse(expected.begin(), expected.end());
+				writeSorted(data, expected);
+				for (std::size_t stride : { std::size_t(1), std::size_t(7), kFenceIndexStride })
+				{
+					const std::string name = " over " + std::to_string(n) + " values up to " + std::to_string(high) + " with stride "
+						+ std::to_string(stride) + (descending ? ", descending" : "");
+					check(buildFenceIndex<int>(data, index, descending, stride), "buildFenceIndex" + name);
+					checkReader(data, index, expected, descending, name);
+				}
+			}
+		}
+	}
+
+	SortedFileReader<long long> wrongType;
+	check(!wrongType.open(data, index), "SortedFileReader rejects an index for another element type");
+	writeSorted(data, { 1, 2, 3 });
+	SortedFileReader<int> wrongSize;
+	check(!wrongSize.open(data, index), "SortedFileReader rejects an index for a file of another size");
+	check(!buildFenceIndex<int>(data, index, false, 0), "buildFenceIndex refuses a zero stride");
+	for (const std::string& path : { data, index }) std::remove(path.c_str());
+}
+
+//*****************
+// Function name: testExternalSortIndex
+// Purpose: Sorts a file with externalSortFile through spilled runs, asking for a fence index, and checks the
+//          reader on the output in both orders.
+//*****************
+BUBBLESORT_TEST(fence_index, testExternalSortIndex)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path();
+	const std::string input = (directory / "bubblesort_test_external_in.bin").string();
+	const std::string output = (directory / "bubblesort_test_external_out.bin").string();
+	const std::string index = (directory / "bubblesort_test_external_out.idx").string();
+	const std::vector<int> values = randomInts(1 << 18, -2000000000.0, 2000000000.0, 104);
+	for (bool descending : { false, true })
+	{
+		for (std::size_t budget : { kUnlimitedScratch, kExternalSortMinBudget })
+		{
+			writeSorted(input, values);
+			const bool sorted = externalSortFile<int>(input, output, SortOptions(SortEngine::Automatic, budget), descending, directory.string(), index);
+			std::vector<int> expected(values);
+			std::sort(expected.begin(), expected.end());
+			if (descending) std::reverse(expected.begin(), expected.end());
+			const std::string name = std::string(" of the external sort output") + (budget == kUnlimitedScratch ? ", in memory" : ", spilled")
+				+ (descending ? ", descending" : "");
+			check(sorted, "externalSortFile writes a fence index" + name);
+			checkReader(output, index, expected, descending, name);
+		}
+	}
+	for (const std::string& path : { input, output, index }) std::remove(path.c_str());
+}
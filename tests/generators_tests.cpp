@@ -0,0 +1,171 @@
+//*****************
+// tests/generators_tests.cpp
+// The synthetic data generators: the random words against a scalar xoshiro256** reference, the ordered
+// distributions against the order they promise, and reproducibility independent of size and threads.
+//*****************
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: referenceRandomWords
+// Purpose: Returns the first n words fillRandomWords promises for a seed, from a scalar xoshiro256**:
+//          block b seeds four generators from splitMix64(seed ^ b * 0xD1B54A32D192ED03), whose outputs
+//          interleave.
+//*****************
+static std::vector<std::uint64_t> referenceRandomWords(std::size_t n, std::uint64_t seed)
+{
+	const auto rotl = [](std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); };
+	std::vector<std::uint64_t> words(n);
+	for (std::size_t begin = 0; begin < n; begin += kGeneratorBlock)
+	{
+		std::uint64_t blockSeed = seed ^ (begin / kGeneratorBlock * 0xD1B54A32D192ED03ull);
+		std::uint64_t laneSeed = splitMix64(blockSeed);
+		std::uint64_t state[4][4];
+		for (auto& lane : state)
+		{
+			for (std::uint64_t& word : lane) word = splitMix64(laneSeed);
+		}
+		for (std::size_t i = begin; i < std::min(n, begin + kGeneratorBlock); ++i)
+		{
+			std::uint64_t* s = state[(i - begin) % 4];
+			words[i] = rotl(s[1] * 5, 7) * 9;
+			const std::uint64_t t = s[1] << 17;
+			s[2] ^= s[0];
+			s[3] ^= s[1];
+			s[1] ^= s[2];
+			s[0] ^= s[3];
+			s[2] ^= t;
+			s[3] = rotl(s[3], 45);
+		}
+	}
+	return words;
+}
+
+//*****************
+// Function name: testRandomWords
+// Purpose: Checks splitMix64 against its published first output and fillRandomWords against the scalar
+//          reference across several blocks, including a partial last group of lanes.
+//*****************
+BUBBLESORT_TEST(generators, testRandomWords)
+{
+	std::uint64_t state = 0;
+	check(splitMix64(state) == 0xE220A8397B1DCDAFull, "splitMix64 of seed 0");
+
+	for (std::size_t n : { std::size_t(1), std::size_t(7), 2 * kGeneratorBlock + 3 })
+	{
+		std::vector<std::uint64_t> words(n);
+		fillRandomWords(words.data(), n, 1234);
+		check(words == referenceRandomWords(n, 1234), "fillRandomWords of " + std::to_string(n) + " words matches scalar xoshiro256**");
+	}
+}
+
+//*****************
+// Function name: testOrderedDistributions
+// Purpose: Checks the deterministic distributions against the order they describe: Sorted is ascending from
+//          low to high, Reverse is Sorted reversed, OrganPipe rises then falls, AllEqual repeats low, SortedRuns
+//          sorts every run of the uniform values, and AntiQuicksort is Musser's permutation.
+//*****************
+BUBBLESORT_TEST(generators, testOrderedDistributions)
+{
+	const auto generate = [](Distribution distribution, std::size_t n, double low, double high)
+	{
+		GeneratorOptions options;
+		options.distribution = distribution;
+		options.low = low;
+		options.high = high;
+		options.runLength = 100;
+		return generateData<int>(n, options);
+	};
+	const std::vector<int> sorted = generate(Distribution::Sorted, 1001, -500, 500);
+	check(std::is_sorted(sorted.begin(), sorted.end()) && sorted.front() == -500 && sorted.back() == 500 && sorted[500] == 0,
+		"Sorted is ascending over [low, high]");
+	std::vector<int> reverse = generate(Distribution::Reverse, 1001, -500, 500);
+	std::reverse(reverse.begin(), reverse.end());
+	check(reverse == sorted, "Reverse is Sorted reversed");
+
+	const std::vector<int> pipe = generate(Distribution::OrganPipe, 1001, 0, 1000);
+	check(std::is_sorted(pipe.begin(), pipe.begin() + 501) && std::is_sorted(pipe.rbegin(), pipe.rbegin() + 501) && pipe[500] == 1000,
+		"OrganPipe rises to high and falls back");
+	const std::vector<int> equal = generate(Distribution::AllEqual, 100, 7, 1000);
+	check(std::count(equal.begin(), equal.end(), 7) == 100, "AllEqual repeats low");
+
+	std::vector<int> runs = generate(Distribution::SortedRuns, 1050, 0, 1000000), uniform = generate(Distribution::Uniform, 1050, 0, 1000000);
+	for (std::size_t begin = 0; begin < uniform.size(); begin += 100) std::sort(uniform.begin() + begin, uniform.begin() + std::min<std::size_t>(begin + 100, 1050));
+	check(runs == uniform, "SortedRuns sorts every run of the uniform values");
+
+	check(generate(Distribution::AntiQuicksort, 8, 1, 8) == std::vector<int>({ 1, 5, 3, 7, 2, 4, 6, 8 }), "AntiQuicksort of 8 is 1 5 3 7 2 4 6 8");
+	std::vector<int> killer = generate(Distribution::AntiQuicksort, 1003, 0, 1002);
+	std::sort(killer.begin(), killer.end());
+	check(killer == generate(Distribution::Sorted, 1003, 0, 1002), "AntiQuicksort is a permutation of the sorted values");
+}
+
+//*****************
+// Function name: testRandomDistributions
+// Purpose: Checks the range and shape of the random distributions: Uniform reaches both ends, Zipf makes low
+//          values the most frequent, Gaussian clusters around the middle, and doubles stay in [low, high].
+//*****************
+BUBBLESORT_TEST(generators, testRandomDistributions)
+{
+	GeneratorOptions options;
+	options.low = -3;
+	options.high = 3;
+	const std::vector<int> uniform = generateData<int>(100000, options);
+	const auto bounds = std::minmax_element(uniform.begin(), uniform.end());
+	check(*bounds.first == -3 && *bounds.second == 3, "Uniform ints cover [low, high]");
+	check(std::count(uniform.begin(), uniform.end(), 3) > 100000 / 7 * 9 / 10, "Uniform ints reach high as often as other values");
+
+	options.distribution = Distribution::Zipf;
+	options.low = 0;
+	options.high = 1000;
+	const std::vector<int> zipf = generateData<int>(100000, options);
+	std::map<int, std::size_t> counts;
+	for (int value : zipf) ++counts[value];
+	check(counts.begin()->first == 0 && counts[0] > counts[1] && counts[1] > counts[2] && counts[2] > counts[10] && counts.rbegin()->first <= 1000,
+		"Zipf ranks are most frequent at low");
+
+	options.distribution = Distribution::Gaussian;
+	const std::vector<double> gaussian = generateData<double>(100000, options);
+	const std::size_t central = static_cast<std::size_t>(std::count_if(gaussian.begin(), gaussian.end(), [](double v) { return v > 333.3 && v < 666.7; }));
+	check(central > 66000 && central < 70500, "Gaussian puts about 68% of the values within one standard deviation");
+	check(std::all_of(gaussian.begin(), gaussian.end(), [](double v) { return v >= 0 && v <= 1000; }), "Gaussian values stay in [low, high]");
+}
+
+//*****************
+// Function name: testReproducibility
+// Purpose: Checks that outputs depend only on the seed: equal seeds repeat, different seeds differ, and a
+//          shorter request is a prefix of a longer one (so the thread count, which follows n, never matters).
+//*****************
+BUBBLESORT_TEST(generators, testReproducibility)
+{
+	GeneratorOptions options;
+	const std::vector<int> large = generateData<int>(300000, options), small = generateData<int>(1000, options);
+	check(generateData<int>(300000, options) == large, "generateData repeats for the same seed");
+	check(std::equal(small.begin(), small.end(), large.begin()), "generateData of fewer values is a prefix");
+	options.seed = 43;
+	check(generateData<int>(1000, options) != small, "generateData differs for another seed");
+
+	const std::vector<std::string> strings = generateStrings(kGeneratorBlock + 100, 2, 9, 5, "xyz");
+	const std::vector<std::string> prefix = generateStrings(10, 2, 9, 5, "xyz");
+	check(std::equal(prefix.begin(), prefix.end(), strings.begin()) && generateStrings(kGeneratorBlock + 100, 2, 9, 5, "xyz") == strings,
+		"generateStrings repeats and is independent of n");
+	check(std::all_of(strings.begin(), strings.end(), [](const std::string& s)
+	{
+		return s.size() >= 2 && s.size() <= 9 && s.find_first_not_of("xyz") == std::string::npos;
+	}), "generateStrings lengths and alphabet");
+
+	const std::vector<std::vector<int>> ragged = generateRagged2D<int>(20, 3, 8, options);
+	bool rowsMatch = true;
+	for (std::size_t r = 0; r < ragged.size(); ++r)
+	{
+		GeneratorOptions rowOptions = options;
+		rowOptions.seed = options.seed + r + 1;
+		rowsMatch = rowsMatch && ragged[r].size() >= 3 && ragged[r].size() <= 8 && ragged[r] == generateData<int>(ragged[r].size(), rowOptions);
+	}
+	check(rowsMatch, "generateRagged2D rows come from generateData with derived seeds");
+}
@@ -0,0 +1,98 @@
+//*****************
+// tests/group_by_tests.cpp
+// Grouped aggregation: groupByKeys and groupBy with every strategy checked against aggregation into a
+// std::map, for few and many groups, negative and 64-bit keys, and integer and floating-point values.
+//*****************
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: matchesMap
+// Purpose: Aggregates keys and values into a std::map (count, sum, minimum and maximum per key) and tells
+//          whether result holds the same groups in the same ascending key order.
+//*****************
+template <typename Key, typename Value>
+static bool matchesMap(const std::vector<Key>& keys, const std::vector<Value>& values, const GroupByResult<Key, Value>& result)
+{
+	struct Group { std::size_t count = 0; group_sum_t<Value> sum = 0; Value min = Value(); Value max = Value(); };
+	std::map<Key, Group> expected;
+	for (std::size_t i = 0; i < keys.size(); ++i)
+	{
+		Group& group = expected[keys[i]];
+		group.min = group.count == 0 ? values[i] : std::min(group.min, values[i]);
+		group.max = group.count == 0 ? values[i] : std::max(group.max, values[i]);
+		group.sum += values[i];
+		++group.count;
+	}
+	bool same = result.size() == expected.size() && result.counts.size() == expected.size() && result.sums.size() == expected.size()
+		&& result.mins.size() == expected.size() && result.maxs.size() == expected.size();
+	std::size_t g = 0;
+	for (auto it = expected.begin(); same && it != expected.end(); ++it, ++g)
+	{
+		same = result.keys[g] == it->first && result.counts[g] == it->second.count && result.sums[g] == it->second.sum
+			&& result.mins[g] == it->second.min && result.maxs[g] == it->second.max;
+	}
+	return same;
+}
+
+//*****************
+// Function name: testGroupBy
+// Purpose: Compares every strategy with std::map aggregation for few groups (one hash table per thread),
+//          many groups (partitioned hash tables) and keys nearly all distinct, and checks the strategy
+//          Automatic picks.
+//*****************
+BUBBLESORT_TEST(group_by, testGroupBy)
+{
+	for (double high : { 15.0, 20000.0, 2e9 })
+	{
+		const std::vector<int> keys = randomInts(200000, -high, high, 10), values = randomInts(200000, -1000, 1000, 11);
+		for (GroupByStrategy strategy : { GroupByStrategy::Automatic, GroupByStrategy::Hash, GroupByStrategy::Sort })
+		{
+			const GroupByResult<int, int> result = groupByKeys(keys.data(), values.data(), keys.size(), strategy);
+			const GroupByStrategy ran = strategy != GroupByStrategy::Automatic ? strategy : high > 1e6 ? GroupByStrategy::Sort : GroupByStrategy::Hash;
+			const std::string name = std::string("groupByKeys ") + (strategy == GroupByStrategy::Hash ? "hash" : strategy == GroupByStrategy::Sort ? "sort" : "automatic")
+				+ " over keys up to " + std::to_string(high);
+			check(matchesMap(keys, values, result), name + " matches std::map aggregation");
+			check(result.strategy == ran, name + " reports the strategy that ran");
+		}
+	}
+}
+
+//*****************
+// Function name: testGroupByTypes
+// Purpose: Groups with 64-bit keys, unsigned and floating-point values, through groupBy with a key function,
+//          and an empty input, comparing each with std::map aggregation.
+//*****************
+BUBBLESORT_TEST(group_by, testGroupByTypes)
+{
+	GeneratorOptions options;
+	options.low = -9e18;
+	options.high = 9e18;
+	options.seed = 117;
+	std::vector<long long> wideKeys = generateData<long long>(50000, options);
+	std::transform(wideKeys.begin(), wideKeys.end(), wideKeys.begin(), [](long long key) { return key / 1000000000000000LL; });
+	const std::vector<int> raw = randomInts(wideKeys.size(), 0, 4000000, 118);
+	const std::vector<unsigned> unsignedValues(raw.begin(), raw.end());
+	std::vector<double> doubleValues(raw.size());
+	std::transform(raw.begin(), raw.end(), doubleValues.begin(), [](int v) { return v / 4.0; });
+	for (GroupByStrategy strategy : { GroupByStrategy::Hash, GroupByStrategy::Sort })
+	{
+		const std::string name = strategy == GroupByStrategy::Hash ? " with hashing" : " with sorting";
+		check(matchesMap(wideKeys, unsignedValues, groupByKeys(wideKeys.data(), unsignedValues.data(), wideKeys.size(), strategy)),
+			"long long keys and unsigned values" + name);
+		check(matchesMap(wideKeys, doubleValues, groupByKeys(wideKeys.data(), doubleValues.data(), wideKeys.size(), strategy)),
+			"long long keys and double values" + name);
+
+		const std::vector<int> values = randomInts(10000, -1000000, 1000000, 119);
+		std::vector<int> residues(values.size());
+		std::transform(values.begin(), values.end(), residues.begin(), [](int v) { return v % 3; });
+		check(matchesMap(residues, values, groupBy(values, [](int v) { return v % 3; }, strategy)), "groupBy value % 3" + name);
+
+		const std::vector<int> none;
+		check(groupByKeys(none.data(), none.data(), 0, strategy).size() == 0, "groupByKeys of nothing" + name);
+	}
+}
@@ -0,0 +1,111 @@
+//*****************
+// tests/leaf_types_tests.cpp
+// recursiveSort stops at leaf types: containers of strings are sorted as whole strings, checked against
+// std::sort, and the strings themselves are left unchanged.
+//*****************
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: randomWords
+// Purpose: Returns n lowercase words of 0 to 12 letters from a fixed seed, with repeats and shared prefixes.
+//*****************
+static std::vector<std::string> randomWords(std::size_t n, std::uint64_t seed)
+{
+	std::mt19937_64 random(seed);
+	std::vector<std::string> words(n);
+	for (std::string& word : words)
+	{
+		const std::size_t length = random() % 13;
+		for (std::size_t i = 0; i < length; ++i) word += static_cast<char>('a' + random() % (i < 2 ? 3 : 26));
+	}
+	return words;
+}
+
+// A container-like type the caller declares a leaf, so recursiveSort orders whole Words
+struct Word
+{
+	std::vector<char> letters;
+
+	using value_type = char;
+	using iterator = std::vector<char>::const_iterator;
+	using const_iterator = std::vector<char>::const_iterator;
+	iterator begin() const { return letters.begin(); }
+	iterator end() const { return letters.end(); }
+	std::size_t size() const { return letters.size(); }
+	bool operator<(const Word& other) const { return letters < other.letters; }
+	bool operator>(const Word& other) const { return other < *this; }
+	bool operator==(const Word& other) const { return letters == other.letters; }
+};
+
+template <>
+struct is_leaf<Word> : std::true_type {};
+
+//*****************
+// Function name: testStringLeaves
+// Purpose: Sorts containers of strings in both orders, small ones through bubbleSort and large ones through
+//          the string radix engine, and compares them with std::sort.
+//*****************
+BUBBLESORT_TEST(leaf_types, testStringLeaves)
+{
+	static_assert(is_leaf<std::string>::value && is_leaf<std::string_view>::value, "strings are leaves");
+	static_assert(is_nested_container<std::vector<std::string>>::value && !is_nested_container<std::string>::value,
+		"a vector of strings is the innermost container");
+
+	for (std::size_t n : { std::size_t(40), std::size_t(20000) })
+	{
+		const std::vector<std::string> words = randomWords(n, n);
+		std::vector<std::string> expected(words);
+		std::sort(expected.begin(), expected.end());
+
+		std::vector<std::string> ascending(words);
+		recursiveSort(ascending);
+		check(ascending == expected, "recursiveSort of " + std::to_string(n) + " strings, ascending");
+
+		std::list<std::string> listed(words.begin(), words.end());
+		recursiveSort(listed, std::greater<std::string>());
+		check(std::equal(listed.begin(), listed.end(), expected.begin(), expected.end()), "recursiveSort of a list of " + std::to_string(n) + " strings");
+
+		std::vector<std::string> descending(words);
+		recursiveSort(descending, std::less<std::string>());
+		check(std::equal(descending.rbegin(), descending.rend(), expected.begin(), expected.end()), "recursiveSort of " + std::to_string(n) + " strings, descending");
+
+		std::vector<std::string_view> views(words.begin(), words.end());
+		recursiveSort(views, std::greater<std::string_view>());
+		check(std::equal(views.begin(), views.end(), expected.begin(), expected.end()), "recursiveSort of " + std::to_string(n) + " string views");
+	}
+}
+
+//*****************
+// Function name: testNestedStringLeaves
+// Purpose: Checks that a nested container of strings sorts every inner container and no string's characters,
+//          including with a custom comparator, and that user leaf types stop the recursion too.
+//*****************
+BUBBLESORT_TEST(leaf_types, testNestedStringLeaves)
+{
+	std::vector<std::vector<std::string>> nested = { randomWords(30, 1), {}, randomWords(500, 2) };
+	std::vector<std::vector<std::string>> expected(nested);
+	for (std::vector<std::string>& row : expected) std::sort(row.begin(), row.end());
+	recursiveSort(nested, std::greater<std::string>());
+	check(nested == expected, "recursiveSort of nested strings sorts the strings of every row");
+
+	std::vector<std::string> positions = { "cab", "zz", "a", "bad", "abc" };
+	std::vector<std::string> expectedPositions(positions);
+	bubbleSort(expectedPositions, AlphabeticalPosition());
+	recursiveSort(positions, AlphabeticalPosition());
+	check(positions == expectedPositions, "recursiveSort of strings with AlphabeticalPosition matches bubbleSort");
+	check(std::find(positions.begin(), positions.end(), "cab") != positions.end(), "the characters of the strings are not sorted");
+
+	static_assert(is_container<Word>::value && !is_nested_container<Word>::value, "Word is a container declared a leaf");
+	std::vector<Word> words = { { { 'c', 'a' } }, { { 'a', 'b' } }, { { 'b' } } };
+	recursiveSort(words);
+	check(words[0].letters == std::vector<char>({ 'a', 'b' }) && words[1].letters == std::vector<char>({ 'b' })
+		&& words[2].letters == std::vector<char>({ 'c', 'a' }), "recursiveSort stops at a type specializing is_leaf");
+}
@@ -0,0 +1,75 @@
+//*****************
+// tests/library_tests.cpp
+// bubbleSort and recursiveSort through the library headers: orders checked against std::stable_sort, and
+// nested containers against sorting every leaf on its own.
+//*****************
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: testBubbleSortOrders
+// Purpose: Compares bubbleSort with std::greater, std::less and the grouping functors against
+//          std::stable_sort with the reversed comparator, in a vector, a deque and a list.
+//*****************
+BUBBLESORT_TEST(library, testBubbleSortOrders)
+{
+	const std::vector<int> values = randomInts(500, -1000, 1000, 21);
+	const auto expect = [&values](auto compare)
+	{
+		std::vector<int> expected(values);
+		std::stable_sort(expected.begin(), expected.end(), [&compare](int a, int b) { return compare(b, a); });
+		return expected;
+	};
+	const auto checkOrder = [&values](auto compare, const std::vector<int>& expected, const std::string& name)
+	{
+		std::vector<int> vec(values);
+		bubbleSort(vec, compare);
+		check(vec == expected, "bubbleSort " + name + " vector");
+		std::deque<int> deq(values.begin(), values.end());
+		bubbleSort(deq, compare);
+		check(std::equal(deq.begin(), deq.end(), expected.begin(), expected.end()), "bubbleSort " + name + " deque");
+		std::list<int> lst(values.begin(), values.end());
+		bubbleSort(lst, compare);
+		check(std::equal(lst.begin(), lst.end(), expected.begin(), expected.end()), "bubbleSort " + name + " list");
+	};
+	checkOrder(std::greater<int>(), expect(std::greater<int>()), "std::greater");
+	checkOrder(std::less<int>(), expect(std::less<int>()), "std::less");
+	checkOrder(OddFirst(), expect(OddFirst()), "OddFirst");
+	checkOrder(SumOfDigits(), expect(SumOfDigits()), "SumOfDigits");
+
+	std::vector<int> ascending(values);
+	bubbleSort(ascending);
+	check(std::is_sorted(ascending.begin(), ascending.end()), "bubbleSort defaults to ascending order");
+}
+
+//*****************
+// Function name: testNestedContainers
+// Purpose: Checks that recursiveSort of 2D and 3D containers sorts every innermost container as a leaf sort
+//          would and leaves the order of the outer containers alone.
+//*****************
+BUBBLESORT_TEST(library, testNestedContainers)
+{
+	std::vector<std::vector<int>> vec2D;
+	for (std::uint64_t seed = 0; seed < 8; ++seed) vec2D.push_back(randomInts(100 + 50 * seed, -500, 500, 30 + seed));
+	std::vector<std::vector<int>> expected2D(vec2D);
+	for (std::vector<int>& row : expected2D) std::sort(row.begin(), row.end());
+	recursiveSort(vec2D, std::greater<int>());
+	check(vec2D == expected2D, "recursiveSort of a 2D vector sorts every row");
+
+	std::list<std::list<std::list<int>>> list3D = { { { 1, 20, 5 }, { 8, 15, 2 } }, { { 30, 12, 4 }, {} } };
+	const std::list<std::list<std::list<int>>> expected3D = { { { 5, 1, 20 }, { 15, 8, 2 } }, { { 30, 12, 4 }, {} } };
+	recursiveSort(list3D, OddFirst());
+	check(list3D == expected3D, "recursiveSort of a 3D list with OddFirst");
+
+	std::array<std::array<int, 3>, 3> arr2D = { { { 234, 56, 123 }, { 789, 23, 456 }, { 12, 345, 678 } } };
+	const std::array<std::array<int, 3>, 3> expectedArr = { { { 56, 234, 123 }, { 789, 456, 23 }, { 678, 345, 12 } } };
+	recursiveSort(arr2D, SumOfDigits());
+	check(arr2D == expectedArr, "recursiveSort of a 2D array by sum of digits");
+}
@@ -0,0 +1,132 @@
+//*****************
+// tests/natural_sort_tests.cpp
+// Natural string ordering: hand-written reference orders, and naturalSort and recursiveSort against a stable
+// sort with an independent token-by-token comparator.
+//*****************
+#include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: referenceNaturalLess
+// Purpose: The natural order compared token by token instead of through keys: text bytes compare by value
+//          (ASCII letters folded when caseInsensitive) and sort before a number when below '0', digit runs
+//          compare by value. Ties go to fewer leading zeros, then lowercase first, then the raw bytes.
+//*****************
+static bool referenceNaturalLess(const std::string& a, const std::string& b, bool caseInsensitive)
+{
+	const auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+	const auto fold = [caseInsensitive](char c) { return static_cast<unsigned char>(caseInsensitive && c >= 'A' && c <= 'Z' ? c + 0x20 : c); };
+	std::vector<std::size_t> zerosA, zerosB;
+	std::size_t i = 0, j = 0;
+	while (i < a.size() && j < b.size())
+	{
+		if (isDigit(a[i]) && isDigit(b[j]))
+		{
+			std::size_t startA = i, startB = j;
+			while (i < a.size() && a[i] == '0') ++i;
+			while (j < b.size() && b[j] == '0') ++j;
+			zerosA.push_back(i - startA);
+			zerosB.push_back(j - startB);
+			startA = i;
+			startB = j;
+			while (i < a.size() && isDigit(a[i])) ++i;
+			while (j < b.size() && isDigit(b[j])) ++j;
+			const std::string numberA = a.substr(startA, i - startA), numberB = b.substr(startB, j - startB);
+			if (numberA.size() != numberB.size()) return numberA.size() < numberB.size();
+			if (numberA != numberB) return numberA < numberB;
+		}
+		else
+		{
+			const unsigned char x = isDigit(a[i]) ? '0' : fold(a[i]), y = isDigit(b[j]) ? '0' : fold(b[j]);
+			if (x != y) return x < y;
+			++i;
+			++j;
+		}
+	}
+	if (i < a.size() || j < b.size()) return j < b.size();
+	if (zerosA != zerosB) return zerosA < zerosB;
+	if (caseInsensitive)
+	{
+		for (std::size_t k = 0; k < a.size(); ++k)
+		{
+			const bool upperA = a[k] >= 'A' && a[k] <= 'Z', upperB = b[k] >= 'A' && b[k] <= 'Z';
+			if (upperA != upperB) return upperB;
+		}
+	}
+	return a < b;
+}
+
+//*****************
+// Function name: testReferenceOrders
+// Purpose: Sorts shuffled names whose natural order is known, case-sensitively and case-insensitively, in
+//          both directions.
+//*****************
+BUBBLESORT_TEST(natural_sort, testReferenceOrders)
+{
+	const std::string longNumber = "x" + std::string(300, '9'), longerNumber = "x1" + std::string(300, '0');
+	const std::vector<std::string> names = { "", "1.9", "1.10", "file1", "file2", "file9", "file10", "file010", "file10a", "file11",
+		longNumber, longerNumber };
+	std::vector<std::string> sorted(names.rbegin(), names.rend());
+	std::rotate(sorted.begin(), sorted.begin() + 4, sorted.end());
+	recursiveSort(sorted, NaturalOrder<>());
+	check(sorted == names, "NaturalOrder reference order");
+	recursiveSort(sorted, NaturalOrder<false, true>());
+	check(std::equal(sorted.rbegin(), sorted.rend(), names.begin(), names.end()), "descending NaturalOrder reverses the reference order");
+
+	std::vector<std::string> mixed = { "b1", "A10", "B1", "a2" };
+	std::vector<std::string> caseSensitive(mixed);
+	recursiveSort(caseSensitive, NaturalOrder<>());
+	check(caseSensitive == std::vector<std::string>({ "A10", "B1", "a2", "b1" }), "NaturalOrder compares case by byte");
+	recursiveSort(mixed, NaturalCaseInsensitiveOrder());
+	check(mixed == std::vector<std::string>({ "a2", "A10", "b1", "B1" }), "NaturalCaseInsensitiveOrder folds case and puts lowercase first");
+}
+
+//*****************
+// Function name: testNaturalEngines
+// Purpose: Sorts random strings of letters, digits and separators with naturalSort and recursiveSort, in
+//          vectors and lists, both orders and case modes, with and without scratch for the keys, and compares
+//          them with std::stable_sort by referenceNaturalLess.
+//*****************
+BUBBLESORT_TEST(natural_sort, testNaturalEngines)
+{
+	const std::vector<std::string> words = generateStrings(3000, 0, 10, 80, "aAb0019 .");
+	for (bool caseInsensitive : { false, true })
+	{
+		std::vector<std::string> expected(words);
+		std::stable_sort(expected.begin(), expected.end(), [caseInsensitive](const std::string& a, const std::string& b)
+		{
+			return referenceNaturalLess(a, b, caseInsensitive);
+		});
+		const std::string name = caseInsensitive ? "case-insensitive" : "case-sensitive";
+
+		std::vector<std::string> direct(words);
+		naturalSort(direct, caseInsensitive);
+		check(direct == expected, "naturalSort " + name + " matches the reference comparator");
+		naturalSort(direct, caseInsensitive, true);
+		check(std::equal(direct.rbegin(), direct.rend(), expected.begin(), expected.end()), "descending naturalSort " + name);
+
+		for (std::size_t budget : { kUnlimitedScratch, std::size_t(0) })
+		{
+			std::vector<std::string> vec(words);
+			std::list<std::string> listed(words.begin(), words.end());
+			const SortOptions options(SortEngine::Automatic, budget);
+			if (caseInsensitive)
+			{
+				recursiveSort(vec, NaturalOrder<true>(), options);
+				recursiveSort(listed, NaturalOrder<true>(), options);
+			}
+			else
+			{
+				recursiveSort(vec, NaturalOrder<false>(), options);
+				recursiveSort(listed, NaturalOrder<false>(), options);
+			}
+			const std::string how = budget ? " with keys" : " by comparison";
+			check(vec == expected, "recursiveSort " + name + " natural vector" + how);
+			check(std::equal(listed.begin(), listed.end(), expected.begin(), expected.end()), "recursiveSort " + name + " natural list" + how);
+		}
+	}
+}
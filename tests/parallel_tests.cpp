@@ -0,0 +1,149 @@
+//*****************
+// tests/parallel_tests.cpp
+// The parallel primitives and the radix engines built on them: scans, histograms and scatters checked
+// against sequential reference code, WorkerPool task and exception handling, and the LSD radix and counting
+// sorts against std::sort.
+//*****************
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <numeric>    // for std::exclusive_scan
+#include <stdexcept>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: testExclusiveScan
+// Purpose: Compares exclusiveScan with std::exclusive_scan for lengths around the SIMD widths, with an
+//          initial value, and in place.
+//*****************
+BUBBLESORT_TEST(parallel, testExclusiveScan)
+{
+	for (std::size_t n : { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 1000 })
+	{
+		std::vector<std::size_t> counts(n);
+		for (std::size_t i = 0; i < n; ++i) counts[i] = (i * 2654435761u) % 1000;
+		std::vector<std::size_t> expected(n), result(n);
+		std::exclusive_scan(counts.begin(), counts.end(), expected.begin(), std::size_t(7));
+		const std::size_t total = exclusiveScan(counts.data(), result.data(), n, 7);
+		check(result == expected && total == std::accumulate(counts.begin(), counts.end(), std::size_t(7)),
+			"exclusiveScan of " + std::to_string(n) + " counts");
+		exclusiveScan(counts.data(), counts.data(), n, 7);
+		check(counts == expected, "exclusiveScan in place of " + std::to_string(n) + " counts");
+	}
+}
+
+//*****************
+// Function name: testHistogramScatter
+// Purpose: Runs parallelHistogram, scatterOffsets and parallelScatter on a four-thread pool and compares the
+//          result with std::stable_sort by bucket, which also checks that equal buckets keep their order.
+//*****************
+BUBBLESORT_TEST(parallel, testHistogramScatter)
+{
+	WorkerPool pool(4);
+	const unsigned threads = pool.size();
+	for (std::size_t n : { std::size_t(0), std::size_t(3), std::size_t(100000) })
+	{
+		std::vector<std::uint64_t> values(n);
+		const std::vector<int> random = randomInts(n, 0, 1000000, 40);
+		for (std::size_t i = 0; i < n; ++i) values[i] = (static_cast<std::uint64_t>(random[i]) << 32) | i; // The index breaks ties
+		const std::size_t buckets = 37;
+		const auto bucketOf = [](std::uint64_t value) { return static_cast<std::size_t>((value >> 32) % 37); };
+
+		std::vector<std::size_t> histograms(threads * buckets), totals(buckets), expectedTotals(buckets);
+		parallelHistogram(values.data(), n, bucketOf, buckets, pool, histograms.data());
+		sumHistograms(histograms.data(), buckets, threads, totals.data());
+		for (std::uint64_t value : values) ++expectedTotals[bucketOf(value)];
+		check(totals == expectedTotals, "parallelHistogram of " + std::to_string(n) + " values counts every bucket");
+
+		std::vector<std::uint64_t> scattered(n), expected(values);
+		scatterOffsets(histograms.data(), buckets, threads, histograms.data());
+		parallelScatter(values.data(), scattered.data(), n, bucketOf, buckets, pool, histograms.data());
+		std::stable_sort(expected.begin(), expected.end(), [&](std::uint64_t a, std::uint64_t b) { return bucketOf(a) < bucketOf(b); });
+		check(scattered == expected, "parallelScatter of " + std::to_string(n) + " values is a stable bucket sort");
+	}
+}
+
+//*****************
+// Function name: testWorkerPool
+// Purpose: Checks that WorkerPool::run calls every index once per run across many runs, and that an
+//          exception thrown by a worker or by the calling thread reaches the caller without stopping the pool.
+//*****************
+BUBBLESORT_TEST(parallel, testWorkerPool)
+{
+	WorkerPool pool(4);
+	std::vector<std::atomic<int>> calls(pool.size());
+	for (int run = 0; run < 200; ++run) pool.run([&](unsigned t) { ++calls[t]; });
+	bool everyOnce = true;
+	for (const std::atomic<int>& count : calls) everyOnce = everyOnce && count == 200;
+	check(everyOnce, "WorkerPool::run calls every index once per run");
+
+	for (unsigned thrower : { 0u, pool.size() - 1 })
+	{
+		bool caught = false;
+		try
+		{
+			pool.run([thrower](unsigned t) { if (t == thrower) throw std::runtime_error("worker failed"); });
+		}
+		catch (const std::runtime_error&)
+		{
+			caught = true;
+		}
+		check(caught, "WorkerPool::run rethrows the exception of index " + std::to_string(thrower));
+	}
+	std::atomic<int> after{ 0 };
+	pool.run([&](unsigned) { ++after; });
+	check(after == static_cast<int>(pool.size()), "WorkerPool runs tasks after one threw");
+
+	bool caught = false;
+	try
+	{
+		parallelFor(3, [](unsigned t) { if (t == 2) throw std::logic_error("worker failed"); });
+	}
+	catch (const std::logic_error&)
+	{
+		caught = true;
+	}
+	check(caught, "parallelFor rethrows a worker exception");
+}
+
+//*****************
+// Template Function: checkIntegerSorts
+// Purpose: Compares lsdRadixSort, and countingSort where the values span a small range, with std::sort.
+//*****************
+template <typename T>
+static void checkIntegerSorts(double low, double high, const std::string& name)
+{
+	for (std::size_t n : { std::size_t(1), std::size_t(1000), std::size_t(300000) })
+	{
+		GeneratorOptions options;
+		options.low = low;
+		options.high = high;
+		options.seed = n;
+		const std::vector<T> values = generateData<T>(n, options);
+		std::vector<T> expected(values), result(values);
+		std::sort(expected.begin(), expected.end());
+		lsdRadixSort(result.data(), n);
+		check(result == expected, "lsdRadixSort of " + std::to_string(n) + " " + name);
+		if (high - low < kCountingSortMaxRange)
+		{
+			result = values;
+			countingSort(result.data(), n, expected.front(), expected.back());
+			check(result == expected, "countingSort of " + std::to_string(n) + " " + name);
+		}
+	}
+}
+
+//*****************
+// Function name: testRadixEngines
+// Purpose: Checks the radix engines on signed, unsigned, narrow and wide integers, in full and small ranges.
+//*****************
+BUBBLESORT_TEST(parallel, testRadixEngines)
+{
+	checkIntegerSorts<int>(-2000000000.0, 2000000000.0, "ints");
+	checkIntegerSorts<int>(-300, 300, "ints in a small range");
+	checkIntegerSorts<std::int64_t>(-9e18, 9e18, "64-bit ints");
+	checkIntegerSorts<std::uint8_t>(0, 255, "bytes");
+	checkIntegerSorts<std::uint32_t>(0, 4e9, "unsigned ints");
+}
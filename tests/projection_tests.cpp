@@ -0,0 +1,106 @@
+//*****************
+// tests/projection_tests.cpp
+// Sorting by projection: recursiveSort with projections checked against bubbleSort with the same projection
+// and std::stable_sort on the projected keys, for the counting, radix and comparison key paths.
+//*****************
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+// An element with a 64-bit key, which projectedSort orders with LSD radix passes; tag tells equal keys apart
+struct WideKeyed
+{
+	long long key;
+	int tag;
+
+	bool operator==(const WideKeyed& other) const { return key == other.key && tag == other.tag; }
+};
+
+//*****************
+// Function name: testDigitSumProjection
+// Purpose: Compares recursiveSort with the DigitSum projection and with SumOfDigits, which declares it, against
+//          bubbleSort with the same comparator.
+//*****************
+BUBBLESORT_TEST(projection, testDigitSumProjection)
+{
+	for (std::size_t n : { std::size_t(50), std::size_t(3000) })
+	{
+		const std::vector<int> values = randomInts(n, 0, 1000000, n + 1);
+		std::vector<int> expected(values), result(values);
+		bubbleSort(expected, std::greater<int>(), DigitSum());
+		recursiveSort(result, std::greater<int>(), DigitSum());
+		check(result == expected, "projected DigitSum sort of " + std::to_string(n));
+
+		result = values;
+		recursiveSort(result, SumOfDigits());
+		expected = values;
+		bubbleSort(expected, SumOfDigits());
+		check(result == expected, "SumOfDigits sort of " + std::to_string(n));
+	}
+
+	std::vector<std::vector<int>> nested = { randomInts(100, 0, 99999, 60), randomInts(2000, 0, 99999, 61) };
+	std::vector<std::vector<int>> expectedNested(nested);
+	for (std::vector<int>& row : expectedNested) bubbleSort(row, std::less<int>(), DigitSum());
+	recursiveSort(nested, std::less<int>(), DigitSum());
+	check(nested == expectedNested, "projected sort of nested vectors by descending digit sum");
+}
+
+//*****************
+// Function name: testProjectedKeyPaths
+// Purpose: Sorts elements with wide integer keys (radix passes), small-range keys (counting pass) and string
+//          keys (comparison sort) in both orders and containers, under unlimited and zero scratch budgets, and
+//          compares them with std::stable_sort on the projected keys.
+//*****************
+BUBBLESORT_TEST(projection, testProjectedKeyPaths)
+{
+	for (double high : { 9e15, 300.0 })
+	{
+		const std::vector<int> tags = randomInts(50000, 0, 1000000, 62);
+		GeneratorOptions options;
+		options.low = -high;
+		options.high = high;
+		options.seed = 63;
+		const std::vector<long long> keys = generateData<long long>(tags.size(), options);
+		std::vector<WideKeyed> values(tags.size());
+		for (std::size_t i = 0; i < values.size(); ++i) values[i] = { keys[i], tags[i] };
+
+		for (bool descending : { false, true })
+		{
+			std::vector<WideKeyed> expected(values);
+			std::stable_sort(expected.begin(), expected.end(), [descending](const WideKeyed& a, const WideKeyed& b)
+			{
+				return descending ? b.key < a.key : a.key < b.key;
+			});
+			for (std::size_t budget : { kUnlimitedScratch, std::size_t(0) })
+			{
+				std::vector<WideKeyed> result(values);
+				std::list<WideKeyed> listed(values.begin(), values.end());
+				const auto key = [](const WideKeyed& value) { return value.key; };
+				const std::string name = " keys up to " + std::to_string(high) + (descending ? ", descending" : "") + (budget ? "" : ", no scratch");
+				if (descending)
+				{
+					recursiveSort(result, std::less<long long>(), key, SortOptions(SortEngine::Automatic, budget));
+					recursiveSort(listed, std::less<long long>(), &WideKeyed::key, SortOptions(SortEngine::Automatic, budget));
+				}
+				else
+				{
+					recursiveSort(result, std::greater<long long>(), key, SortOptions(SortEngine::Automatic, budget));
+					recursiveSort(listed, std::greater<long long>(), &WideKeyed::key, SortOptions(SortEngine::Automatic, budget));
+				}
+				check(result == expected, "projected vector sort by 64-bit" + name);
+				check(std::equal(listed.begin(), listed.end(), expected.begin(), expected.end()), "projected list sort by 64-bit" + name);
+			}
+		}
+	}
+
+	std::vector<int> numbers = randomInts(5000, 0, 100000, 64);
+	std::vector<int> expected(numbers);
+	const auto asText = [](int value) { return std::to_string(value); };
+	std::stable_sort(expected.begin(), expected.end(), [&asText](int a, int b) { return asText(a) < asText(b); });
+	recursiveSort(numbers, std::greater<std::string>(), asText);
+	check(numbers == expected, "projected sort by string keys orders numbers as text");
+}
@@ -0,0 +1,117 @@
+//*****************
+// tests/record_sort_tests.cpp
+// Sorting records by an integer member: recordSort and recursiveSort with member projections checked
+// against std::stable_sort on the member, for counting and radix key ranges and every member width.
+//*****************
+#include <algorithm>
+#include <climits>    // for INT_MIN and INT_MAX
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+// A record sorted by one of its members; payload tells equal keys apart, so stability is checked too
+struct TestRecord
+{
+	int key;
+	unsigned short shortKey;
+	signed char byteKey;
+	int payload;
+
+	bool operator==(const TestRecord& other) const
+	{
+		return key == other.key && shortKey == other.shortKey && byteKey == other.byteKey && payload == other.payload;
+	}
+};
+
+//*****************
+// Function name: testRecords
+// Purpose: Returns n records whose key lies in [low, high], with the extremes of every member near the front.
+//*****************
+static std::vector<TestRecord> testRecords(std::size_t n, double low, double high, std::uint64_t seed)
+{
+	const std::vector<int> keys = randomInts(n, low, high, seed), others = randomInts(n, -128, 65535, seed + 1);
+	std::vector<TestRecord> records(n);
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		records[i] = { keys[i], static_cast<unsigned short>(others[i]), static_cast<signed char>(others[i]), static_cast<int>(i) };
+	}
+	if (n > 2 && high - low > 1e9)
+	{
+		records[0].key = INT_MIN;
+		records[1].key = INT_MAX;
+	}
+	return records;
+}
+
+//*****************
+// Function name: stableByMember
+// Purpose: Returns the records stably sorted by one member with std::stable_sort, the reference order.
+//*****************
+template <typename Key>
+static std::vector<TestRecord> stableByMember(std::vector<TestRecord> records, Key TestRecord::* member, bool descending)
+{
+	std::stable_sort(records.begin(), records.end(), [member, descending](const TestRecord& a, const TestRecord& b)
+	{
+		return descending ? b.*member < a.*member : a.*member < b.*member;
+	});
+	return records;
+}
+
+//*****************
+// Function name: testRecordSort
+// Purpose: Sorts vectors and lists of records with recordSort by 32-, 16- and 8-bit members, in both orders,
+//          over small key ranges (one counting pass) and full ranges (radix passes).
+//*****************
+BUBBLESORT_TEST(record_sort, testRecordSort)
+{
+	for (std::size_t n : { std::size_t(0), std::size_t(1), std::size_t(100), std::size_t(100000) })
+	{
+		for (double high : { 50.0, 2e9 })
+		{
+			const std::vector<TestRecord> records = testRecords(n, -high, high, n + 70);
+			const std::string name = " of " + std::to_string(n) + " records up to " + std::to_string(high);
+			for (bool descending : { false, true })
+			{
+				const std::string how = name + (descending ? ", descending" : "");
+				std::vector<TestRecord> byKey(records), byShort(records), byByte(records);
+				std::list<TestRecord> listed(records.begin(), records.end());
+				recordSort(byKey, &TestRecord::key, descending);
+				recordSort(byShort, &TestRecord::shortKey, descending);
+				recordSort(byByte, &TestRecord::byteKey, descending);
+				recordSort(listed, &TestRecord::key, descending);
+				const std::vector<TestRecord> expected = stableByMember(records, &TestRecord::key, descending);
+				check(byKey == expected, "recordSort by int" + how);
+				check(std::equal(listed.begin(), listed.end(), expected.begin(), expected.end()), "recordSort of a list by int" + how);
+				check(byShort == stableByMember(records, &TestRecord::shortKey, descending), "recordSort by unsigned short" + how);
+				check(byByte == stableByMember(records, &TestRecord::byteKey, descending), "recordSort by signed char" + how);
+			}
+		}
+	}
+}
+
+//*****************
+// Function name: testMemberProjections
+// Purpose: Sorts records through recursiveSort with member projections under unlimited and zero scratch
+//          budgets, compares them with bubbleSort by the same projection, and checks the engine report.
+//*****************
+BUBBLESORT_TEST(record_sort, testMemberProjections)
+{
+	for (std::size_t n : { std::size_t(50), std::size_t(3000) })
+	{
+		const std::vector<TestRecord> records = testRecords(n, 0, 96, n + 1);
+		for (std::size_t budget : { kUnlimitedScratch, std::size_t(0) })
+		{
+			SortReport report;
+			std::vector<TestRecord> expected(records), sorted(records);
+			bubbleSort(expected, std::less<int>(), &TestRecord::key);
+			recursiveSort(sorted, std::less<int>(), &TestRecord::key, SortOptions(SortEngine::Automatic, budget, &report));
+			const std::string name = " of " + std::to_string(n) + " records" + (budget ? "" : ", no scratch");
+			check(sorted == expected, "member projection sort" + name);
+			const SortAlgorithm engine = n < 64 ? SortAlgorithm::Bubble : budget ? SortAlgorithm::RecordPairs : SortAlgorithm::Comparison;
+			check(report.last == engine, "member projection engine" + name);
+		}
+	}
+}
@@ -0,0 +1,124 @@
+//*****************
+// tests/scratch_budget_tests.cpp
+// Scratch budgets: recursiveSort under shrinking budgets must stay correct against std::sort and
+// std::stable_sort and never report more scratch than it was allowed; the in-place fallbacks are checked
+// on their own.
+//*****************
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+// Budgets from unlimited down to strictly in place
+static const std::size_t kTestBudgets[] = { kUnlimitedScratch, std::size_t(1) << 20, std::size_t(4096), std::size_t(0) };
+
+//*****************
+// Function name: budgetName
+// Purpose: Returns a readable name for a scratch budget in check messages.
+//*****************
+static std::string budgetName(std::size_t budget)
+{
+	return budget == kUnlimitedScratch ? "unlimited scratch" : std::to_string(budget) + " bytes of scratch";
+}
+
+//*****************
+// Function name: testBudgetedIntegers
+// Purpose: Sorts ints and long longs in vectors, lists and nested vectors under every test budget with every
+//          engine, compares them with std::sort and checks that the report stays within the budget.
+//*****************
+BUBBLESORT_TEST(scratch_budget, testBudgetedIntegers)
+{
+	const std::vector<int> values = randomInts(100000, -2000000000.0, 2000000000.0, 89);
+	std::vector<int> expected(values);
+	std::sort(expected.begin(), expected.end());
+	GeneratorOptions wideOptions;
+	wideOptions.low = -9e18;
+	wideOptions.high = 9e18;
+	wideOptions.seed = 90;
+	const std::vector<long long> wide = generateData<long long>(50000, wideOptions);
+	std::vector<long long> expectedWide(wide);
+	std::sort(expectedWide.begin(), expectedWide.end());
+
+	for (std::size_t budget : kTestBudgets)
+	{
+		for (SortEngine engine : { SortEngine::Automatic, SortEngine::Radix, SortEngine::InPlaceRadix })
+		{
+			SortReport report;
+			const SortOptions options(engine, budget, &report);
+			std::vector<int> vec(values);
+			std::list<int> listed(values.begin(), values.end());
+			std::vector<long long> longs(wide);
+			std::vector<std::vector<int>> nested = { values, randomInts(300, 0, 50, 91), {} };
+			recursiveSort(vec, std::greater<int>(), options);
+			recursiveSort(listed, std::less<int>(), options);
+			recursiveSort(longs, std::greater<long long>(), options);
+			recursiveSort(nested, std::greater<int>(), options);
+
+			const std::string name = " with engine " + std::to_string(static_cast<int>(engine)) + " and " + budgetName(budget);
+			check(vec == expected, "int vector" + name);
+			check(std::equal(listed.begin(), listed.end(), expected.rbegin(), expected.rend()), "descending int list" + name);
+			check(longs == expectedWide, "long long vector" + name);
+			check(nested[0] == expected && std::is_sorted(nested[1].begin(), nested[1].end()) && nested[2].empty(), "nested vectors" + name);
+			check(report.leaves == 6 && report.elements == 3 * values.size() + wide.size() + 300, "report counts every leaf" + name);
+			check(report.peakScratchBytes <= budget, "reported scratch stays within the budget" + name);
+		}
+	}
+}
+
+//*****************
+// Function name: testBudgetedStrings
+// Purpose: Sorts strings in vectors and lists under every test budget in both orders and compares them with
+//          std::sort, checking that the report stays within the budget.
+//*****************
+BUBBLESORT_TEST(scratch_budget, testBudgetedStrings)
+{
+	const std::vector<std::string> words = generateStrings(20000, 0, 12, 92, "abcd");
+	std::vector<std::string> expected(words);
+	std::sort(expected.begin(), expected.end());
+	for (std::size_t budget : kTestBudgets)
+	{
+		SortReport report;
+		const SortOptions options(SortEngine::Automatic, budget, &report);
+		std::vector<std::string> vec(words);
+		std::list<std::string> listed(words.begin(), words.end());
+		recursiveSort(vec, std::less<std::string>(), options);
+		recursiveSort(listed, std::greater<std::string>(), options);
+		check(std::equal(vec.rbegin(), vec.rend(), expected.begin(), expected.end()), "descending string vector with " + budgetName(budget));
+		check(std::equal(listed.begin(), listed.end(), expected.begin(), expected.end()), "string list with " + budgetName(budget));
+		check(report.peakScratchBytes <= budget, "string sorts stay within " + budgetName(budget));
+	}
+}
+
+//*****************
+// Function name: testInPlaceFallbacks
+// Purpose: Compares comparisonSort and stableInPlaceSort, the sorts used when nothing else fits the budget,
+//          with std::sort and std::stable_sort on vectors and lists, including equal keys.
+//*****************
+BUBBLESORT_TEST(scratch_budget, testInPlaceFallbacks)
+{
+	for (std::size_t n : { std::size_t(0), std::size_t(1), std::size_t(31), std::size_t(32), std::size_t(33), std::size_t(10000) })
+	{
+		const std::vector<int> values = randomInts(n, 0, 999, n + 93);
+		const auto byHundreds = [](int a, int b) { return a / 100 < b / 100; };
+		const std::string name = " of " + std::to_string(n);
+
+		std::vector<int> expected(values), sorted(values);
+		std::list<int> listed(values.begin(), values.end());
+		std::sort(expected.begin(), expected.end());
+		comparisonSort(sorted, std::less<int>());
+		comparisonSort(listed, std::less<int>());
+		check(sorted == expected, "comparisonSort of a vector" + name);
+		check(std::equal(listed.begin(), listed.end(), expected.begin(), expected.end()), "comparisonSort of a list" + name);
+
+		std::vector<int> expectedStable(values), stable(values);
+		std::list<int> stableList(values.begin(), values.end());
+		std::stable_sort(expectedStable.begin(), expectedStable.end(), byHundreds);
+		stableInPlaceSort(stable, byHundreds);
+		stableInPlaceSort(stableList, byHundreds);
+		check(stable == expectedStable, "stableInPlaceSort of a vector" + name);
+		check(std::equal(stableList.begin(), stableList.end(), expectedStable.begin(), expectedStable.end()), "stableInPlaceSort of a list" + name);
+	}
+}
@@ -0,0 +1,124 @@
+//*****************
+// tests/search_tree_tests.cpp
+// Search layouts: EytzingerIndex and STreeIndex lookups checked against std::lower_bound and
+// std::upper_bound on the same sorted keys, for sizes around the node and level boundaries, duplicate
+// keys, the extremes of every key type, and indexes built over the leaves of a sorted container.
+//*****************
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: checkIndexes
+// Purpose: Builds both indexes over sorted keys and compares their lookups with the standard algorithms,
+//          probing every key, values between keys and the extremes of Key.
+//*****************
+template <typename Key>
+static void checkIndexes(const std::vector<Key>& sorted, const std::string& name)
+{
+	const EytzingerIndex<Key> eytzinger(sorted);
+	const STreeIndex<Key> stree(sorted);
+	std::vector<Key> probes = { std::numeric_limits<Key>::lowest(), std::numeric_limits<Key>::max(), Key(0) };
+	for (Key key : sorted)
+	{
+		probes.push_back(key);
+		if (key > std::numeric_limits<Key>::lowest()) probes.push_back(static_cast<Key>(key - 1));
+		if (key < std::numeric_limits<Key>::max()) probes.push_back(static_cast<Key>(key + 1));
+	}
+
+	bool eytzingerMatches = eytzinger.size() == sorted.size(), streeMatches = stree.size() == sorted.size();
+	for (Key probe : probes)
+	{
+		const std::size_t lower = static_cast<std::size_t>(std::lower_bound(sorted.begin(), sorted.end(), probe) - sorted.begin());
+		const std::size_t upper = static_cast<std::size_t>(std::upper_bound(sorted.begin(), sorted.end(), probe) - sorted.begin());
+		eytzingerMatches = eytzingerMatches && eytzinger.lowerBound(probe) == lower && eytzinger.upperBound(probe) == upper;
+		streeMatches = streeMatches && stree.lowerBound(probe) == lower && stree.upperBound(probe) == upper;
+	}
+	check(eytzingerMatches, "EytzingerIndex matches std::lower_bound and std::upper_bound" + name);
+	check(streeMatches, "STreeIndex matches std::lower_bound and std::upper_bound" + name);
+}
+
+//*****************
+// Function name: checkKeyType
+// Purpose: Runs checkIndexes on random keys of one type for sizes around the S-tree node size and its
+//          levels, with few and with many distinct keys, and with the extremes of the type among them.
+//*****************
+template <typename Key>
+static void checkKeyType(const std::string& type)
+{
+	for (std::size_t n : { 0, 1, 2, 15, 16, 17, 31, 255, 272, 273, 289, 4913, 5000, 30000 })
+	{
+		for (double spread : { 20.0, 2e9 })
+		{
+			GeneratorOptions options;
+			options.high = std::min(spread, static_cast<double>(std::numeric_limits<Key>::max()));
+			options.low = std::is_signed<Key>::value ? -options.high : 0.0;
+			options.seed = n + 105;
+			std::vector<Key> sorted = generateData<Key>(n, options);
+			if (n > 4)
+			{
+				sorted[0] = std::numeric_limits<Key>::lowest();
+				sorted[1] = std::numeric_limits<Key>::max();
+				sorted[2] = std::numeric_limits<Key>::max();
+			}
+			std::sort(sorted.begin(), sorted.end());
+			checkIndexes(sorted, " for " + std::to_string(n) + " " + type + " keys up to " + std::to_string(spread));
+		}
+	}
+}
+
+//*****************
+// Function name: testIndexLookups
+// Purpose: Checks both indexes for signed and unsigned integers (the SIMD node search for 32-bit keys) and
+//          floating-point keys.
+//*****************
+BUBBLESORT_TEST(search_tree, testIndexLookups)
+{
+	checkKeyType<int>("int");
+	checkKeyType<unsigned>("unsigned");
+	checkKeyType<short>("short");
+	checkKeyType<long long>("long long");
+	checkKeyType<double>("double");
+}
+
+//*****************
+// Function name: testLeafIndexes
+// Purpose: Builds indexes over every leaf of a nested container sorted by recursiveSort, compares their
+//          lookups with the standard algorithms on each leaf, and checks that an unsorted leaf is refused.
+//*****************
+BUBBLESORT_TEST(search_tree, testLeafIndexes)
+{
+	std::vector<std::list<int>> nested = { std::list<int>(), { 7 } };
+	for (std::size_t n : { std::size_t(100), std::size_t(20000) })
+	{
+		const std::vector<int> values = randomInts(n, -1000, 1000, n + 106);
+		nested.emplace_back(values.begin(), values.end());
+	}
+	recursiveSort(nested, std::greater<int>());
+
+	std::vector<STreeIndex<int>> strees;
+	std::vector<EytzingerIndex<int>> eytzingers;
+	check(buildSearchIndexes(nested, strees) && buildSearchIndexes(nested, eytzingers) && strees.size() == nested.size()
+		&& eytzingers.size() == nested.size(), "buildSearchIndexes builds one index per leaf");
+	bool matches = true;
+	for (std::size_t leaf = 0; leaf < nested.size(); ++leaf)
+	{
+		const std::vector<int> sorted(nested[leaf].begin(), nested[leaf].end());
+		for (int probe = -1001; probe <= 1001; probe += 7)
+		{
+			const std::size_t lower = static_cast<std::size_t>(std::lower_bound(sorted.begin(), sorted.end(), probe) - sorted.begin());
+			const std::size_t upper = static_cast<std::size_t>(std::upper_bound(sorted.begin(), sorted.end(), probe) - sorted.begin());
+			matches = matches && strees[leaf].lowerBound(probe) == lower && strees[leaf].upperBound(probe) == upper
+				&& eytzingers[leaf].lowerBound(probe) == lower && eytzingers[leaf].upperBound(probe) == upper;
+		}
+	}
+	check(matches, "leaf indexes match std::lower_bound and std::upper_bound");
+
+	recursiveSort(nested, std::less<int>());
+	check(!buildSearchIndexes(nested, strees) && strees.empty(), "buildSearchIndexes refuses leaves in descending order");
+}
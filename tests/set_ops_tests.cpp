@@ -0,0 +1,174 @@
+//*****************
+// tests/set_ops_tests.cpp
+// Sorted-set operations: runs, leaves of sorted containers and sorted files checked against std::merge,
+// std::set_union, std::set_intersection and std::set_difference of the distinct values, and every
+// intersectInts kernel variant the CPU supports.
+//*****************
+#include <algorithm>
+#include <climits>    // for INT_MIN and INT_MAX
+#include <cstdio>     // for std::remove
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <utility>    // for std::make_pair
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: referenceSetOperation
+// Purpose: Applies a SetOperation with the standard algorithms: std::merge of the runs, or the set algorithm
+//          on their distinct values.
+//*****************
+template <typename T>
+static std::vector<T> referenceSetOperation(SetOperation operation, std::vector<T> a, std::vector<T> b)
+{
+	std::vector<T> expected;
+	if (operation == SetOperation::Merge)
+	{
+		std::merge(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+		return expected;
+	}
+	a.erase(std::unique(a.begin(), a.end()), a.end());
+	b.erase(std::unique(b.begin(), b.end()), b.end());
+	if (operation == SetOperation::Union) std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+	else if (operation == SetOperation::Intersection) std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+	else std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+	return expected;
+}
+
+static const SetOperation kOperations[] = { SetOperation::Merge, SetOperation::Union, SetOperation::Intersection, SetOperation::Difference };
+
+//*****************
+// Function name: testSetOperations
+// Purpose: Compares setOperation on ints and long longs with the standard algorithms on runs of similar and
+//          of very different sizes (the galloping paths), in both argument orders.
+//*****************
+BUBBLESORT_TEST(set_ops, testSetOperations)
+{
+	std::vector<int> large = randomInts(200000, -100000, 100000, 2);
+	std::sort(large.begin(), large.end());
+	for (std::size_t small : { std::size_t(150000), std::size_t(1000), std::size_t(0) })
+	{
+		std::vector<int> other = randomInts(small, -100000, 100000, 3);
+		std::sort(other.begin(), other.end());
+		for (bool swapped : { false, true })
+		{
+			const std::vector<int>& a = swapped ? other : large;
+			const std::vector<int>& b = swapped ? large : other;
+			const std::vector<long long> wideA(a.begin(), a.end()), wideB(b.begin(), b.end());
+			for (SetOperation operation : kOperations)
+			{
+				const std::string name = "setOperation " + std::to_string(static_cast<int>(operation)) + " of " + std::to_string(a.size())
+					+ " and " + std::to_string(b.size()) + " values";
+				std::vector<int> result(a.size() + b.size());
+				result.resize(setOperation(operation, a.data(), a.size(), b.data(), b.size(), result.data()));
+				check(result == referenceSetOperation(operation, a, b), name + " matches the standard algorithm");
+				std::vector<long long> wide(a.size() + b.size());
+				wide.resize(setOperation(operation, wideA.data(), wideA.size(), wideB.data(), wideB.size(), wide.data()));
+				check(wide == referenceSetOperation(operation, wideA, wideB), name + " on long longs matches the standard algorithm");
+			}
+		}
+	}
+}
+
+//*****************
+// Function name: testIntersectionKernels
+// Purpose: Runs the intersectInts kernel of every supported instruction set on sets of distinct ints with
+//          lengths around the vector widths and high and low overlap, and compares it with
+//          std::set_intersection.
+//*****************
+BUBBLESORT_TEST(set_ops, testIntersectionKernels)
+{
+	for (SimdIsa isa : { SimdIsa::Baseline, SimdIsa::Sse42, SimdIsa::Avx2, SimdIsa::Avx512 })
+	{
+		if (isa > detectSimdIsa()) break;
+		const SimdKernels& kernels = simdKernelsFor(isa);
+		for (std::size_t n : { 0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 63, 64, 65, 1000, 5000 })
+		{
+			for (double range : { 2.0 * n + 10, 1e9 })
+			{
+				std::vector<int> a = randomInts(n, -range, range, n + 107), b = randomInts(n + n / 3, -range, range, n + 108);
+				for (std::vector<int>* set : { &a, &b })
+				{
+					set->insert(set->end(), { INT_MIN, INT_MAX });
+					std::sort(set->begin(), set->end());
+					set->erase(std::unique(set->begin(), set->end()), set->end());
+				}
+				std::vector<int> expected, result(std::min(a.size(), b.size()));
+				std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+				result.resize(kernels.intersectInts(a.data(), a.size(), b.data(), b.size(), result.data()));
+				check(result == expected, std::string(simdIsaName(isa)) + " intersectInts of " + std::to_string(a.size()) + " and "
+					+ std::to_string(b.size()) + " values in +-" + std::to_string(range));
+			}
+		}
+	}
+}
+
+//*****************
+// Function name: testLeafSetOperations
+// Purpose: Applies every SetOperation leaf by leaf to nested containers sorted by recursiveSort and compares
+//          each result leaf with the standard algorithms; mismatched and unsorted containers are refused.
+//*****************
+BUBBLESORT_TEST(set_ops, testLeafSetOperations)
+{
+	std::vector<std::vector<int>> a = { randomInts(5000, 0, 3000, 109), {}, randomInts(40, -5, 5, 110) };
+	std::vector<std::vector<int>> b = { randomInts(3000, 0, 3000, 111), randomInts(10, 0, 9, 112), {} };
+	recursiveSort(a, std::greater<int>());
+	recursiveSort(b, std::greater<int>());
+	for (SetOperation operation : kOperations)
+	{
+		std::vector<std::vector<int>> result;
+		bool matches = applySetOperation(operation, a, b, result) && result.size() == a.size();
+		for (std::size_t leaf = 0; matches && leaf < a.size(); ++leaf)
+		{
+			matches = result[leaf] == referenceSetOperation(operation, a[leaf], b[leaf]);
+		}
+		check(matches, "applySetOperation " + std::to_string(static_cast<int>(operation)) + " matches the standard algorithm per leaf");
+	}
+
+	std::vector<std::vector<int>> result, shorter(a.begin(), a.end() - 1), descending(a);
+	recursiveSort(descending, std::less<int>());
+	check(!applySetOperation(SetOperation::Union, a, shorter, result), "applySetOperation refuses containers with other leaf counts");
+	check(!applySetOperation(SetOperation::Union, a, descending, result), "applySetOperation refuses leaves that are not ascending");
+}
+
+//*****************
+// Function name: testFileSetOperations
+// Purpose: Applies every SetOperation to sorted files larger than a read chunk, in both orders, and compares
+//          the output file with the standard algorithms.
+//*****************
+BUBBLESORT_TEST(set_ops, testFileSetOperations)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path();
+	const std::string pathA = (directory / "bubblesort_test_set_a.bin").string();
+	const std::string pathB = (directory / "bubblesort_test_set_b.bin").string();
+	const std::string pathOut = (directory / "bubblesort_test_set_out.bin").string();
+	std::vector<int> a = randomInts(3 * kSetFileChunk, -200000, 200000, 113), b = randomInts(kSetFileChunk / 2, -200000, 200000, 114);
+	std::sort(a.begin(), a.end());
+	std::sort(b.begin(), b.end());
+
+	for (bool descending : { false, true })
+	{
+		for (const auto& [path, values] : { std::make_pair(pathA, a), std::make_pair(pathB, b) })
+		{
+			std::vector<int> ordered(values);
+			if (descending) std::reverse(ordered.begin(), ordered.end());
+			IoFile file;
+			check(file.openWrite(path) && file.writeAt(ordered.data(), ordered.size() * sizeof(int), 0) && file.close(), "write " + path);
+		}
+		for (SetOperation operation : kOperations)
+		{
+			std::vector<int> expected = referenceSetOperation(operation, a, b);
+			if (descending) std::reverse(expected.begin(), expected.end());
+			IoFile file;
+			std::vector<int> result;
+			const bool applied = setOperationFiles<int>(operation, pathA, pathB, pathOut, descending) && file.openRead(pathOut);
+			result.resize(applied ? static_cast<std::size_t>(file.size() / sizeof(int)) : 0);
+			check(applied && (result.empty() || file.readAt(result.data(), result.size() * sizeof(int), 0)) && result == expected,
+				"setOperationFiles " + std::to_string(static_cast<int>(operation)) + (descending ? " descending" : "") + " matches the standard algorithm");
+		}
+	}
+	for (const std::string& path : { pathA, pathB, pathOut }) std::remove(path.c_str());
+}
@@ -0,0 +1,76 @@
+//*****************
+// tests/simd_dispatch_tests.cpp
+// Every SIMD kernel variant the CPU supports, checked against scalar reference code on the same input,
+// so the dispatched table can never change a result.
+//*****************
+#include <algorithm>
+#include <climits>    // for INT_MIN and INT_MAX
+#include <numeric>    // for std::exclusive_scan
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: testIsaSelection
+// Purpose: Checks that the selected instruction set is one the CPU supports and that every table reports the
+//          instruction set it was asked for.
+//*****************
+BUBBLESORT_TEST(simd_dispatch, testIsaSelection)
+{
+	const SimdIsa detected = detectSimdIsa();
+	check(selectSimdIsa() <= detected && simdKernels().isa == selectSimdIsa(), "the selected kernels run on this CPU");
+	for (SimdIsa isa : { SimdIsa::Baseline, SimdIsa::Sse42, SimdIsa::Avx2, SimdIsa::Avx512 })
+	{
+		if (isa > detected) break;
+		check(simdKernelsFor(isa).isa == isa || !BUBBLESORT_MULTIVERSION, std::string("simdKernelsFor(") + simdIsaName(isa) + ") returns its table");
+	}
+}
+
+//*****************
+// Function name: testKernelVariants
+// Purpose: Runs the scan, digit sum, merge and sort kernels of every supported instruction set on lengths
+//          around the vector widths and the sort block sizes, and compares them with the standard library.
+//*****************
+BUBBLESORT_TEST(simd_dispatch, testKernelVariants)
+{
+	for (SimdIsa isa : { SimdIsa::Baseline, SimdIsa::Sse42, SimdIsa::Avx2, SimdIsa::Avx512 })
+	{
+		if (isa > detectSimdIsa()) break;
+		const SimdKernels& kernels = simdKernelsFor(isa);
+		const std::string name = simdIsaName(isa);
+		for (std::size_t n : { 0, 1, 3, 7, 8, 9, 63, 64, 65, 511, 1024, 1025, 5000 })
+		{
+			std::vector<int> values = randomInts(n, -1000000, 1000000, n);
+			if (n > 2)
+			{
+				values[0] = INT_MIN;
+				values[1] = INT_MAX;
+			}
+
+			std::vector<std::size_t> counts(n), scanned(n), expectedScan(n);
+			for (std::size_t i = 0; i < n; ++i) counts[i] = static_cast<std::size_t>(values[i] & 0xFFFF);
+			std::exclusive_scan(counts.begin(), counts.end(), expectedScan.begin(), std::size_t(3));
+			kernels.exclusiveScan(counts.data(), scanned.data(), n, 3);
+			check(scanned == expectedScan, name + " exclusiveScan of " + std::to_string(n));
+
+			std::vector<int> sums(n), expectedSums(n);
+			std::transform(values.begin(), values.end(), expectedSums.begin(), DigitSum());
+			kernels.digitSums(values.data(), sums.data(), n);
+			check(sums == expectedSums, name + " digitSums of " + std::to_string(n) + " matches DigitSum");
+
+			std::vector<int> sorted(values), expected(values);
+			std::sort(expected.begin(), expected.end());
+			kernels.sortInts(sorted.data(), n);
+			check(sorted == expected, name + " sortInts of " + std::to_string(n));
+
+			std::vector<int> left(expected.begin(), expected.begin() + n / 3), right(expected.begin() + n / 3, expected.end());
+			std::reverse(right.begin(), right.end());
+			std::transform(right.begin(), right.end(), right.begin(), [](int v) { return v / 2; });
+			std::sort(right.begin(), right.end());
+			std::vector<int> merged(n), expectedMerge(n);
+			std::merge(left.begin(), left.end(), right.begin(), right.end(), expectedMerge.begin());
+			kernels.mergeInts(left.data(), left.size(), right.data(), right.size(), merged.data());
+			check(merged == expectedMerge, name + " mergeInts of " + std::to_string(n));
+		}
+	}
+}
@@ -0,0 +1,94 @@
+//*****************
+// tests/string_table_tests.cpp
+// StringTable and std::string_view sorting: every path that permutes table records checked against
+// std::sort or std::stable_sort of the same strings held as std::string.
+//*****************
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "test_support.hpp"
+
+//*****************
+// Function name: tableWords
+// Purpose: Returns random strings for the table tests: short words, words sharing a prefix longer than the
+//          eight inline bytes, and words with embedded zero and 0xFF bytes next to their shorter prefixes.
+//*****************
+static std::vector<std::string> tableWords()
+{
+	std::vector<std::string> words = generateStrings(4000, 0, 6, 90, "abc");
+	for (const std::string& suffix : generateStrings(2000, 0, 6, 91, "ab"))
+	{
+		words.push_back("common-prefix-" + suffix);
+	}
+	for (std::string word : { "ab", "abc" })
+	{
+		words.push_back(word);
+		words.push_back(word + std::string(1, '\0'));
+		words.push_back(word + std::string(2, '\0'));
+		words.push_back(word + "\xFF");
+	}
+	return words;
+}
+
+// The strings of a table in its current order
+static std::vector<std::string> tableStrings(const StringTable& table)
+{
+	return std::vector<std::string>(table.begin(), table.end());
+}
+
+//*****************
+// Function name: testTableSorts
+// Purpose: Sorts a table with recursiveSort in both orders, with bubbleSort and a custom comparator, and by a
+//          projection, and compares it with the same sorts of a vector of std::string; checks that the
+//          inline prefix is the big-endian packing of the first eight bytes.
+//*****************
+BUBBLESORT_TEST(string_table, testTableSorts)
+{
+	check(StringTable::packPrefix("ab") == 0x6162000000000000ull && StringTable::packPrefix("abcdefghij") == 0x6162636465666768ull,
+		"packPrefix packs the first eight bytes big-endian");
+
+	const std::vector<std::string> words = tableWords();
+	std::vector<std::string> expected(words);
+	std::sort(expected.begin(), expected.end());
+
+	StringTable table(words.begin(), words.end());
+	check(tableStrings(table) == words, "StringTable keeps the strings in insertion order");
+	recursiveSort(table, std::greater<std::string_view>());
+	check(tableStrings(table) == expected, "recursiveSort of a StringTable, ascending");
+	recursiveSort(table, std::less<std::string_view>());
+	check(std::equal(table.begin(), table.end(), expected.rbegin(), expected.rend()), "recursiveSort of a StringTable, descending");
+
+	const auto byLength = [](std::string_view a, std::string_view b) { return a.size() > b.size(); };
+	StringTable small(words.begin(), words.begin() + 300);
+	std::vector<std::string> expectedSmall(words.begin(), words.begin() + 300);
+	std::stable_sort(expectedSmall.begin(), expectedSmall.end(), [](const std::string& a, const std::string& b) { return a.size() < b.size(); });
+	bubbleSort(small, byLength);
+	check(tableStrings(small) == expectedSmall, "bubbleSort of a StringTable by length is stable");
+
+	std::vector<std::string> expectedProjected(words);
+	std::stable_sort(expectedProjected.begin(), expectedProjected.end(), [](const std::string& a, const std::string& b) { return a.size() > b.size(); });
+	for (std::size_t budget : { kUnlimitedScratch, std::size_t(0) })
+	{
+		StringTable projected(words.begin(), words.end());
+		recursiveSort(projected, std::less<std::size_t>(), [](std::string_view s) { return s.size(); }, SortOptions(SortEngine::Automatic, budget));
+		check(tableStrings(projected) == expectedProjected, std::string("projected sort of a StringTable by descending length") + (budget ? "" : ", no scratch"));
+	}
+}
+
+//*****************
+// Function name: testStringViews
+// Purpose: Sorts vectors of std::string_view with the string engine and checks them against std::sort.
+//*****************
+BUBBLESORT_TEST(string_table, testStringViews)
+{
+	const std::vector<std::string> words = tableWords();
+	std::vector<std::string_view> views(words.begin(), words.end()), expected(views);
+	std::sort(expected.begin(), expected.end());
+	stringSort(views);
+	check(views == expected, "stringSort of string views");
+	stringSort(views, true);
+	check(std::equal(views.begin(), views.end(), expected.rbegin(), expected.rend()), "descending stringSort of string views");
+}
@@ -0,0 +1,31 @@
+//*****************
+// tests/test_main.cpp
+// Runs the registered tests: those of the features named on the command line, or all of them.
+// Usage: bubblesort_tests [feature...]
+//*****************
+#include <cstring>    // for std::strcmp
+#include <iostream>
+
+#include "test_support.hpp"
+
+int main(int argc, char* argv[])
+{
+	std::size_t ran = 0;
+	for (const TestCase& test : testRegistry())
+	{
+		bool selected = argc < 2;
+		for (int i = 1; i < argc && !selected; ++i) selected = std::strcmp(argv[i], test.feature) == 0;
+		if (!selected) continue;
+		std::cout << test.feature << ": " << test.name << "\n";
+		test.run();
+		++ran;
+	}
+	if (ran == 0)
+	{
+		std::cerr << "No tests registered for the requested features\n";
+		return 1;
+	}
+	if (failedChecks == 0) std::cout << "All " << ran << " test(s) passed\n";
+	else std::cout << failedChecks << " check(s) failed\n";
+	return failedChecks == 0 ? 0 : 1;
+}
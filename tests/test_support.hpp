@@ -0,0 +1,72 @@
+//*****************
+// tests/test_support.hpp
+// Checks and test registration shared by the test sources. Each source registers its tests under the name of
+// the feature it covers with BUBBLESORT_TEST; bubblesort_tests runs the tests of the features named on its
+// command line (every test without arguments) and returns a non-zero exit code when any check fails.
+//*****************
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bubblesort/bubblesort.hpp"
+
+// Checks that failed; main returns 1 when there are any
+inline std::size_t failedChecks = 0;
+
+//*****************
+// Function name: check
+// Purpose: Records the outcome of one check and reports a failure with its description.
+//*****************
+inline void check(bool passed, const std::string& what)
+{
+	if (passed) return;
+	++failedChecks;
+	std::cerr << "FAILED: " << what << "\n";
+}
+
+//*****************
+// Function name: randomInts
+// Purpose: Returns n ints from generateData in [low, high] with a fixed seed.
+//*****************
+inline std::vector<int> randomInts(std::size_t n, double low, double high, std::uint64_t seed = 1)
+{
+	GeneratorOptions options;
+	options.low = low;
+	options.high = high;
+	options.seed = seed;
+	return generateData<int>(n, options);
+}
+
+//*****************
+// Struct: TestCase
+// Purpose: A registered test: the feature it belongs to, its name and the function running its checks.
+//*****************
+struct TestCase
+{
+	const char* feature;
+	const char* name;
+	void (*run)();
+};
+
+// The registered tests, in registration order within each source
+inline std::vector<TestCase>& testRegistry()
+{
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+// Registers a test when constructed; BUBBLESORT_TEST declares one per test function
+struct TestRegistration
+{
+	TestRegistration(const char* feature, const char* name, void (*run)()) { testRegistry().push_back({ feature, name, run }); }
+};
+
+// Defines a test function and registers it under a feature: BUBBLESORT_TEST(feature, name) { checks }
+#define BUBBLESORT_TEST(feature, name) \
+	static void name(); \
+	static const TestRegistration name##Registration(#feature, #name, name); \
+	static void name()